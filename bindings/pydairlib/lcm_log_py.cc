@@ -0,0 +1,70 @@
+#include <limits>
+
+#include <pybind11/eigen.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "systems/log_parser/lcm_log_reader.h"
+
+namespace py = pybind11;
+
+namespace dairlib {
+namespace pydairlib {
+
+using multibody::LcmLogReader;
+using multibody::RobotInputLog;
+using multibody::RobotOutputLog;
+
+PYBIND11_MODULE(lcm_log, m) {
+  m.doc() = "Binding functions for reading lcm logs";
+
+  const double inf = std::numeric_limits<double>::infinity();
+
+  // Matrices are exposed as read-only views, without copies. Columns are
+  // messages, e.g. log.positions[:, i] is the i-th message's positions.
+  py::class_<RobotOutputLog>(m, "RobotOutputLog")
+      .def_readonly("t", &RobotOutputLog::t)
+      .def_readonly("positions", &RobotOutputLog::positions)
+      .def_readonly("velocities", &RobotOutputLog::velocities)
+      .def_readonly("efforts", &RobotOutputLog::efforts)
+      .def_readonly("imu_accel", &RobotOutputLog::imu_accel)
+      .def_readonly("position_names", &RobotOutputLog::position_names)
+      .def_readonly("velocity_names", &RobotOutputLog::velocity_names)
+      .def_readonly("effort_names", &RobotOutputLog::effort_names)
+      .def_readonly("num_skipped", &RobotOutputLog::num_skipped);
+
+  py::class_<RobotInputLog>(m, "RobotInputLog")
+      .def_readonly("t", &RobotInputLog::t)
+      .def_readonly("efforts", &RobotInputLog::efforts)
+      .def_readonly("effort_names", &RobotInputLog::effort_names)
+      .def_readonly("num_skipped", &RobotInputLog::num_skipped);
+
+  py::class_<LcmLogReader>(m, "LcmLogReader")
+      .def(py::init<const std::string&, bool>(), py::arg("file"),
+           py::arg("use_index") = true)
+      .def("loaded_index", &LcmLogReader::loaded_index)
+      .def("GetChannels", &LcmLogReader::GetChannels)
+      .def("HasChannel", &LcmLogReader::HasChannel, py::arg("channel"))
+      .def("GetNumMessages", &LcmLogReader::GetNumMessages,
+           py::arg("channel"))
+      .def("GetLogTimes", &LcmLogReader::GetLogTimes, py::arg("channel"))
+      .def("GetDuration", &LcmLogReader::GetDuration)
+      // Encoded message, e.g. for lcmt_type.decode() of other lcmtypes
+      .def(
+          "GetMessage",
+          [](const LcmLogReader& self, const std::string& channel, int i) {
+            return py::bytes(
+                reinterpret_cast<const char*>(self.GetMessageData(channel, i)),
+                self.GetMessageSize(channel, i));
+          },
+          py::arg("channel"), py::arg("i"))
+      .def("ReadRobotOutput", &LcmLogReader::ReadRobotOutput,
+           py::arg("channel"), py::arg("start") = 0, py::arg("end") = inf,
+           py::call_guard<py::gil_scoped_release>())
+      .def("ReadRobotInput", &LcmLogReader::ReadRobotInput,
+           py::arg("channel"), py::arg("start") = 0, py::arg("end") = inf,
+           py::call_guard<py::gil_scoped_release>());
+}
+
+}  // namespace pydairlib
+}  // namespace dairlib
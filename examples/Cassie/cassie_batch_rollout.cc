@@ -0,0 +1,333 @@
+#include "examples/Cassie/cassie_batch_rollout.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "dairlib/lcmt_loop_timing.hpp"
+#include "dairlib/lcmt_osc_output.hpp"
+#include "examples/Cassie/cassie_utils.h"
+#include "multibody/multibody_utils.h"
+#include "systems/framework/loop_timing.h"
+#include "systems/primitives/gaussian_noise_pass_through.h"
+#include "systems/primitives/subvector_pass_through.h"
+#include "systems/robot_lcm_systems.h"
+
+#include "drake/common/random.h"
+#include "drake/geometry/scene_graph.h"
+#include "drake/systems/analysis/simulator.h"
+#include "drake/systems/framework/diagram_builder.h"
+#include "drake/systems/primitives/zero_order_hold.h"
+
+namespace dairlib {
+
+using drake::geometry::SceneGraph;
+using drake::multibody::MultibodyPlant;
+using drake::systems::Context;
+using drake::systems::Diagram;
+using drake::systems::DiagramBuilder;
+using drake::systems::Simulator;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+
+using cassie::osc::OscWalkingController;
+using systems::LoopTimer;
+
+namespace {
+
+// Name of the loop timing section of OperationalSpaceControl's control tick
+const char kOscSection[] = "osc";
+
+// Capacity of a LoopTimer ring which holds one sample per control tick
+int TimingCapacity(const CassieRolloutOptions& options) {
+  const int num_ticks =
+      std::ceil(options.end_time / options.control_period) + 1;
+  int capacity = 1;
+  while (capacity < num_ticks) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+}  // namespace
+
+CassieRolloutMetrics::CassieRolloutMetrics(int num_rollouts)
+    : fell(Eigen::VectorXi::Zero(num_rollouts)),
+      failed(Eigen::VectorXi::Zero(num_rollouts)),
+      end_time(VectorXd::Zero(num_rollouts)),
+      tracking_cost(VectorXd::Zero(num_rollouts)),
+      soft_constraint_cost(VectorXd::Zero(num_rollouts)),
+      solve_time_mean_us(VectorXd::Zero(num_rollouts)),
+      solve_time_p99_us(VectorXd::Zero(num_rollouts)),
+      solve_time_max_us(VectorXd::Zero(num_rollouts)),
+      wall_time(VectorXd::Zero(num_rollouts)) {}
+
+// The controller plants of one thread, and the diagram, Simulator and Context
+// of its current rollout
+class CassieBatchRollout::Worker {
+ public:
+  explicit Worker(const CassieRolloutOptions& options)
+      : options_(options),
+        timer_("cassie_batch_rollout", TimingCapacity(options)) {
+    addCassieMultibody(&plant_w_spr_, nullptr, true /*floating base*/,
+                       "examples/Cassie/urdf/cassie_v2.urdf",
+                       true /*spring model*/, false /*loop closure*/);
+    plant_w_spr_.Finalize();
+    addCassieMultibody(&plant_wo_spr_, nullptr, true,
+                       "examples/Cassie/urdf/cassie_fixed_springs.urdf",
+                       false, false);
+    plant_wo_spr_.Finalize();
+  }
+
+  void Run(const CassieRolloutSpec& spec, int index,
+           CassieRolloutMetrics* metrics);
+
+ private:
+  void Build(double incline);
+
+  const CassieRolloutOptions& options_;
+  MultibodyPlant<double> plant_w_spr_{0.0};
+  MultibodyPlant<double> plant_wo_spr_{0.0};
+
+  std::unique_ptr<Diagram<double>> diagram_;
+  const MultibodyPlant<double>* plant_ = nullptr;
+  const OscWalkingController* controller_ = nullptr;
+  std::unique_ptr<Simulator<double>> simulator_;
+  Vector3d ground_normal_;
+
+  LoopTimer timer_;
+};
+
+void CassieBatchRollout::Worker::Build(double incline) {
+  // The simulator refers to the diagram
+  simulator_.reset();
+  diagram_.reset();
+
+  DiagramBuilder<double> builder;
+  SceneGraph<double>& scene_graph = *builder.AddSystem<SceneGraph>();
+  scene_graph.set_name("scene_graph");
+  MultibodyPlant<double>& plant =
+      *builder.AddSystem<MultibodyPlant>(options_.sim_dt);
+  ground_normal_ = Vector3d(-std::sin(incline), 0, std::cos(incline));
+  multibody::addFlatTerrain(&plant, &scene_graph, options_.mu, options_.mu,
+                            ground_normal_);
+  addCassieMultibody(&plant, &scene_graph, true,
+                     "examples/Cassie/urdf/cassie_v2.urdf", true, true);
+  plant.Finalize();
+  plant.set_penetration_allowance(options_.penetration_allowance);
+  plant.set_stiction_tolerance(options_.v_stiction);
+  builder.Connect(
+      plant.get_geometry_poses_output_port(),
+      scene_graph.get_source_pose_port(plant.get_source_id().value()));
+  builder.Connect(scene_graph.get_query_output_port(),
+                  plant.get_geometry_query_input_port());
+
+  // Pass the state to the controller as it would be sent over LCM
+  auto state_sender = builder.AddSystem<systems::RobotOutputSender>(plant);
+  auto state_receiver =
+      builder.AddSystem<systems::RobotOutputReceiver>(plant_w_spr_);
+  builder.Connect(plant.get_state_output_port(),
+                  state_sender->get_input_port_state());
+  builder.Connect(*state_sender, *state_receiver);
+
+  auto controller = builder.AddSystem<OscWalkingController>(
+      plant_w_spr_, plant_wo_spr_, options_.controller);
+  if (options_.position_noise.size() > 0 ||
+      options_.velocity_noise.size() > 0) {
+    const int n_q = plant_w_spr_.num_positions();
+    const int n_v = plant_w_spr_.num_velocities();
+    MatrixXd position_noise = MatrixXd::Zero(n_q, n_q);
+    MatrixXd velocity_noise = MatrixXd::Zero(n_v, n_v);
+    if (options_.position_noise.size() > 0) {
+      position_noise = options_.position_noise;
+    }
+    if (options_.velocity_noise.size() > 0) {
+      velocity_noise = options_.velocity_noise;
+    }
+    auto noise = builder.AddSystem<systems::GaussianNoisePassThrough>(
+        n_q, n_v, plant_w_spr_.num_actuators(), position_noise,
+        velocity_noise);
+    builder.Connect(state_receiver->get_output_port(0),
+                    noise->get_input_port());
+    builder.Connect(noise->get_output_port(),
+                    controller->get_state_input_port());
+  } else {
+    builder.Connect(state_receiver->get_output_port(0),
+                    controller->get_state_input_port());
+  }
+
+  // Hold the command (u, t) for a control period. The controller's plants and
+  // the simulation are built from the same URDF, so the actuators are in the
+  // same order.
+  const int command_size = controller->get_control_output_port().size();
+  auto command_hold = builder.AddSystem<drake::systems::ZeroOrderHold>(
+      options_.control_period, command_size);
+  auto passthrough = builder.AddSystem<systems::SubvectorPassThrough>(
+      command_size, 0, plant.num_actuators());
+  builder.Connect(controller->get_control_output_port(),
+                  command_hold->get_input_port(0));
+  builder.Connect(command_hold->get_output_port(0),
+                  passthrough->get_input_port());
+  builder.Connect(passthrough->get_output_port(),
+                  plant.get_actuation_input_port());
+
+  diagram_ = builder.Build();
+  diagram_->set_name("cassie_batch_rollout");
+  plant_ = &plant;
+  controller_ = controller;
+
+  simulator_ = std::make_unique<Simulator<double>>(*diagram_);
+  simulator_->set_publish_every_time_step(false);
+  simulator_->set_publish_at_initialization(false);
+}
+
+void CassieBatchRollout::Worker::Run(const CassieRolloutSpec& spec, int index,
+                                     CassieRolloutMetrics* metrics) {
+  const int64_t start_ns = LoopTimer::Now();
+  DRAKE_THROW_UNLESS(spec.q_init.size() == plant_w_spr_.num_positions());
+  DRAKE_THROW_UNLESS(spec.v_init.size() == plant_w_spr_.num_velocities());
+  // The controller systems keep mutable data outside of their Context, e.g.
+  // the OSC's QP warm start, so every rollout gets a fresh diagram. Otherwise
+  // its result would depend on the rollouts run before it on this thread.
+  Build(spec.incline);
+
+  // Draw the seeds of the random generators of the Context's systems from the
+  // spec's seed
+  Context<double>& context = simulator_->get_mutable_context();
+  context.SetTime(0);
+  drake::RandomGenerator generator(spec.seed);
+  diagram_->SetRandomContext(&context, &generator);
+  Context<double>& plant_context =
+      diagram_->GetMutableSubsystemContext(*plant_, &context);
+  plant_->SetPositions(&plant_context, spec.q_init);
+  plant_->SetVelocities(&plant_context, spec.v_init);
+  const Context<double>& controller_context =
+      diagram_->GetSubsystemContext(*controller_, context);
+
+  double tracking_cost = 0;
+  double soft_constraint_cost = 0;
+  int num_ticks = 0;
+  bool fell = false;
+  bool failed = false;
+  bool in_iteration = false;
+  const int num_periods =
+      std::floor(options_.end_time / options_.control_period + 1e-9);
+  try {
+    simulator_->Initialize();
+    for (int k = 1; k <= num_periods; k++) {
+      // The OSC's tick in this step is timed by its "osc" section
+      timer_.BeginIteration(LoopTimer::Now());
+      in_iteration = true;
+      simulator_->AdvanceTo(k * options_.control_period);
+      in_iteration = false;
+      timer_.EndIteration();
+
+      const auto& osc_output =
+          controller_->get_osc_debug_port().Eval<dairlib::lcmt_osc_output>(
+              controller_context);
+      for (double cost : osc_output.tracking_cost) {
+        tracking_cost += cost;
+      }
+      soft_constraint_cost += osc_output.soft_constraint_cost;
+      num_ticks++;
+
+      // Height of the pelvis above the ground plane
+      const VectorXd q = plant_->GetPositions(plant_context);
+      if (ground_normal_.dot(q.segment<3>(4)) < options_.fall_height) {
+        fell = true;
+        break;
+      }
+    }
+  } catch (const std::exception&) {
+    if (in_iteration) {
+      timer_.EndIteration();
+    }
+    failed = true;
+  }
+
+  metrics->fell(index) = fell;
+  metrics->failed(index) = failed;
+  metrics->end_time(index) = context.get_time();
+  if (num_ticks > 0) {
+    metrics->tracking_cost(index) = tracking_cost / num_ticks;
+    metrics->soft_constraint_cost(index) = soft_constraint_cost / num_ticks;
+  }
+  const lcmt_loop_timing timing = timer_.Summarize();
+  for (const auto& stat : timing.stats) {
+    if (stat.name == kOscSection) {
+      metrics->solve_time_mean_us(index) = stat.mean_us;
+      metrics->solve_time_p99_us(index) = stat.p99_us;
+      metrics->solve_time_max_us(index) = stat.max_us;
+    }
+  }
+  metrics->wall_time(index) = 1e-9 * (LoopTimer::Now() - start_ns);
+}
+
+CassieBatchRollout::CassieBatchRollout(const CassieRolloutOptions& options,
+                                       int num_threads)
+    : options_(options),
+      num_threads_(
+          (num_threads > 0)
+              ? num_threads
+              : std::max<int>(1, std::thread::hardware_concurrency())) {
+  DRAKE_DEMAND(num_threads >= 0);
+  DRAKE_DEMAND(options_.control_period > 0);
+  DRAKE_DEMAND(options_.sim_dt > 0);
+  workers_.resize(num_threads_);
+}
+
+CassieBatchRollout::~CassieBatchRollout() = default;
+
+CassieRolloutMetrics CassieBatchRollout::Run(
+    const std::vector<CassieRolloutSpec>& specs) {
+  const int num_rollouts = specs.size();
+  CassieRolloutMetrics metrics(num_rollouts);
+
+  // Each thread takes the next rollout until none are left. A rollout only
+  // writes its own entries of the metrics.
+  std::atomic<int> next_rollout{0};
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  const auto run_rollouts = [&](int thread_index) {
+    try {
+      // The worker is created on its thread, so the threads parse the URDFs
+      // concurrently
+      if (workers_[thread_index] == nullptr) {
+        workers_[thread_index] = std::make_unique<Worker>(options_);
+      }
+      while (true) {
+        const int i = next_rollout.fetch_add(1);
+        if (i >= num_rollouts) {
+          return;
+        }
+        workers_[thread_index]->Run(specs[i], i, &metrics);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+      next_rollout = num_rollouts;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads_; i++) {
+    threads.emplace_back(run_rollouts, i);
+  }
+  run_rollouts(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return metrics;
+}
+
+}  // namespace dairlib
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "examples/Cassie/osc/osc_walking_controller.h"
+
+#include "drake/common/eigen_types.h"
+
+namespace dairlib {
+
+/// The initial condition, terrain and noise seed of one rollout
+struct CassieRolloutSpec {
+  /// Initial positions and velocities of Cassie with springs (cassie_v2.urdf)
+  Eigen::VectorXd q_init;
+  Eigen::VectorXd v_init;
+  /// Slope (rad) of the ground, rising along the world x axis. The ground
+  /// plane passes through the world origin.
+  double incline = 0;
+  /// Seeds the random generators of the diagram, i.e. the SimulatorDrift of
+  /// the controller and the state noise
+  uint32_t seed = 0;
+};
+
+struct CassieRolloutOptions {
+  double end_time = 5;
+  /// Time step of the (discrete) simulation plant
+  double sim_dt = 8e-5;
+  /// Period at which the controller samples the state and updates its command,
+  /// i.e. the period of the state messages in the LCM setup
+  double control_period = 1e-3;
+  double penetration_allowance = 1e-5;
+  double v_stiction = 1e-3;
+  /// Friction coefficient of the ground
+  double mu = 0.8;
+  /// A rollout falls when the pelvis is closer than this to the ground
+  double fall_height = 0.5;
+  /// Scales the uniform noise of the positions and velocities that the
+  /// controller receives (see GaussianNoisePassThrough). Empty for no noise.
+  Eigen::MatrixXd position_noise;
+  Eigen::MatrixXd velocity_noise;
+  cassie::osc::OscWalkingControllerOptions controller;
+};
+
+/// Metrics of a batch of rollouts, one entry per rollout
+struct CassieRolloutMetrics {
+  explicit CassieRolloutMetrics(int num_rollouts);
+
+  /// 1 if the pelvis fell below fall_height
+  Eigen::VectorXi fell;
+  /// 1 if the simulation or the controller threw, e.g. because the discrete
+  /// solver of the plant failed. The other metrics cover the rollout until
+  /// then.
+  Eigen::VectorXi failed;
+  /// Time at which the rollout stopped, i.e. end_time unless it fell or failed
+  Eigen::VectorXd end_time;
+  /// Mean over the control ticks of the total OSC tracking cost, i.e. the sum
+  /// of lcmt_osc_output::tracking_cost
+  Eigen::VectorXd tracking_cost;
+  /// Mean over the control ticks of lcmt_osc_output::soft_constraint_cost
+  Eigen::VectorXd soft_constraint_cost;
+  /// Statistics of the time of the OSC's control ticks (the "osc" loop timing
+  /// section, which includes the QP solve), in microseconds
+  Eigen::VectorXd solve_time_mean_us;
+  Eigen::VectorXd solve_time_p99_us;
+  Eigen::VectorXd solve_time_max_us;
+  /// Wall-clock time of the rollout (s)
+  Eigen::VectorXd wall_time;
+};
+
+/// Runs batches of closed-loop simulations of Cassie and the OSC walking
+/// controller (OscWalkingController) in one process, without LCM.
+///
+/// Each rollout simulates the plant with a flat, possibly inclined ground and
+/// the controller in one diagram. The controller receives the plant's state
+/// through RobotOutputSender and RobotOutputReceiver, as it would over LCM,
+/// and its command is held for control_period by a ZeroOrderHold, so the OSC
+/// is solved once per control tick.
+///
+/// The rollouts of a batch are distributed over a fixed number of threads.
+/// Each thread owns its controller plants, which it parses once. The
+/// controller systems keep mutable data outside of their Context (e.g. the
+/// OSC's QP warm start), so each rollout builds its own diagram, Simulator and
+/// Context, and its metrics only depend on its spec, whichever thread runs it
+/// and whatever ran before. The threads share nothing but the rollout index,
+/// so the batch scales with the number of cores.
+class CassieBatchRollout {
+ public:
+  /// @param num_threads Number of threads to run rollouts on. 0 for the
+  ///   number of hardware threads.
+  CassieBatchRollout(const CassieRolloutOptions& options, int num_threads = 0);
+
+  ~CassieBatchRollout();
+
+  /// Runs the rollouts, and returns their metrics in the order of specs
+  CassieRolloutMetrics Run(const std::vector<CassieRolloutSpec>& specs);
+
+  int num_threads() const { return num_threads_; }
+
+ private:
+  class Worker;
+
+  const CassieRolloutOptions options_;
+  const int num_threads_;
+  // Created by their threads on the first Run()
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+}  // namespace dairlib
@@ -0,0 +1,273 @@
+#include "examples/Cassie/cassie_dispatchers.h"
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+#include "examples/Cassie/cassie_utils.h"
+#include "examples/Cassie/networking/cassie_input_translator.h"
+#include "examples/Cassie/networking/cassie_udp_publisher.h"
+#include "examples/Cassie/networking/simple_cassie_udp_subscriber.h"
+#include "multibody/multibody_solvers.h"
+#include "systems/framework/output_vector.h"
+#include "systems/primitives/subvector_pass_through.h"
+
+#include "drake/solvers/choose_best_solver.h"
+#include "drake/solvers/solve.h"
+
+namespace dairlib {
+
+using drake::multibody::MultibodyPlant;
+using drake::systems::Context;
+using drake::systems::Diagram;
+using drake::systems::DiagramBuilder;
+using drake::systems::Simulator;
+using drake::systems::TriggerType;
+
+using Eigen::Matrix3d;
+using Eigen::Vector3d;
+
+void setInitialEkfState(double t0, const cassie_out_t& cassie_output,
+                        const MultibodyPlant<double>& plant,
+                        const Diagram<double>& diagram,
+                        const systems::CassieStateEstimator& state_estimator,
+                        Context<double>* diagram_context) {
+  // Copy the joint positions from cassie_out_t to OutputVector
+  systems::OutputVector<double> robot_output(
+      plant.num_positions(), plant.num_velocities(), plant.num_actuators());
+  state_estimator.AssignNonFloatingBaseStateToOutputVector(cassie_output,
+                                                            &robot_output);
+
+  multibody::KinematicEvaluatorSet<double> evaluators(plant);
+  auto left_toe = LeftToeFront(plant);
+  auto left_toe_evaluator = multibody::WorldPointEvaluator(
+      plant, left_toe.first, left_toe.second, Eigen::Vector3d(0, 0, 1),
+      Eigen::Vector3d::Zero(), false);
+  evaluators.add_evaluator(&left_toe_evaluator);
+  auto left_heel = LeftToeRear(plant);
+  auto left_heel_evaluator = multibody::WorldPointEvaluator(
+      plant, left_heel.first, left_heel.second, Eigen::Vector3d(0, 0, 1),
+      Eigen::Vector3d::Zero(), false);
+  evaluators.add_evaluator(&left_heel_evaluator);
+  auto right_toe = RightToeFront(plant);
+  auto right_toe_evaluator = multibody::WorldPointEvaluator(
+      plant, right_toe.first, right_toe.second, Eigen::Vector3d(0, 0, 1),
+      Eigen::Vector3d::Zero(), false);
+  evaluators.add_evaluator(&right_toe_evaluator);
+  auto right_heel = RightToeRear(plant);
+  auto right_heel_evaluator = multibody::WorldPointEvaluator(
+      plant, right_heel.first, right_heel.second, Eigen::Vector3d(0, 0, 1),
+      Eigen::Vector3d::Zero(), false);
+  evaluators.add_evaluator(&right_heel_evaluator);
+
+  auto program = multibody::MultibodyProgram(plant);
+  auto q = program.AddPositionVariables();
+  auto kinematic_constraint = program.AddKinematicConstraint(evaluators, q);
+
+  // Soft constraint on the joint positions
+  int n_joints = plant.num_positions() - 7;
+  program.AddQuadraticErrorCost(Eigen::MatrixXd::Identity(n_joints, n_joints),
+                                robot_output.GetPositions().tail(n_joints),
+                                q.tail(n_joints));
+
+  Eigen::VectorXd q_guess(plant.num_positions());
+  q_guess << 1, 0, 0, 0, 0, 0, 1, robot_output.GetPositions().tail(n_joints);
+  program.SetInitialGuess(q, q_guess);
+
+  std::cout << "Solving inverse kinematics to get initial robot height\n";
+  std::cout << "Choose the best solver: "
+            << drake::solvers::ChooseBestSolver(program).name() << std::endl;
+  auto start = std::chrono::high_resolution_clock::now();
+  const auto result = drake::solvers::Solve(program, program.initial_guess());
+  auto finish = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> elapsed = finish - start;
+  auto q_sol = result.GetSolution(q);
+  std::cout << to_string(result.get_solution_result()) << std::endl;
+  std::cout << "Solve time:" << elapsed.count() << std::endl;
+  std::cout << "Cost:" << result.get_optimal_cost() << std::endl;
+  std::cout << "q sol = " << q_sol.transpose() << "\n\n";
+
+  // Set initial time and floating base position
+  auto& state_estimator_context =
+      diagram.GetMutableSubsystemContext(state_estimator, diagram_context);
+  state_estimator.setPreviousTime(&state_estimator_context, t0);
+  state_estimator.setInitialPelvisPose(&state_estimator_context, q_sol.head(4),
+                                        q_sol.segment<3>(4));
+  // Set initial imu value
+  // Note that initial imu values are all 0 if the robot is dropped from the air
+  Eigen::VectorXd init_prev_imu_value = Eigen::VectorXd::Zero(6);
+  init_prev_imu_value << 0, 0, 0, 0, 0, 9.81;
+  state_estimator.setPreviousImuMeasurement(&state_estimator_context,
+                                             init_prev_imu_value);
+}
+
+// Evaluators for contact points (The position doesn't matter. It's not used
+// in OSC)
+RobotOutDispatcher::RobotOutDispatcher(const MultibodyPlant<double>& plant,
+                                       DiagramBuilder<double>* builder,
+                                       bool test_with_ground_truth_state,
+                                       bool print_ekf_info, int test_mode)
+    : plant_(plant),
+      left_loop_(LeftLoopClosureEvaluator(plant)),
+      right_loop_(RightLoopClosureEvaluator(plant)),
+      left_toe_evaluator_(plant, LeftToeFront(plant).first,
+                          LeftToeFront(plant).second, Matrix3d::Identity(),
+                          Vector3d::Zero(), {1, 2}),
+      left_heel_evaluator_(plant, LeftToeRear(plant).first,
+                           LeftToeRear(plant).second, Matrix3d::Identity(),
+                           Vector3d::Zero(), {0, 1, 2}),
+      right_toe_evaluator_(plant, RightToeFront(plant).first,
+                           RightToeFront(plant).second, Matrix3d::Identity(),
+                           Vector3d::Zero(), {1, 2}),
+      right_heel_evaluator_(plant, RightToeRear(plant).first,
+                            RightToeRear(plant).second, Matrix3d::Identity(),
+                            Vector3d::Zero(), {0, 1, 2}),
+      fourbar_evaluator_(plant),
+      left_contact_evaluator_(plant),
+      right_contact_evaluator_(plant) {
+  // Evaluators for fourbar linkages
+  fourbar_evaluator_.add_evaluator(&left_loop_);
+  fourbar_evaluator_.add_evaluator(&right_loop_);
+  left_contact_evaluator_.add_evaluator(&left_toe_evaluator_);
+  left_contact_evaluator_.add_evaluator(&left_heel_evaluator_);
+  right_contact_evaluator_.add_evaluator(&right_toe_evaluator_);
+  right_contact_evaluator_.add_evaluator(&right_heel_evaluator_);
+
+  // Create state estimator
+  state_estimator_ = builder->AddSystem<systems::CassieStateEstimator>(
+      plant, &fourbar_evaluator_, &left_contact_evaluator_,
+      &right_contact_evaluator_, test_with_ground_truth_state, print_ekf_info,
+      test_mode);
+
+  // This echoes the messages from the robot
+  output_sender_ = builder->AddSystem<systems::CassieOutputSender>();
+
+  // Create RobotOutput sender.
+  robot_output_sender_ =
+      builder->AddSystem<systems::RobotOutputSender>(plant, true);
+
+  // Pass through to drop all but positions and velocities
+  auto state_passthrough = builder->AddSystem<systems::SubvectorPassThrough>(
+      state_estimator_->get_output_port(0).size(), 0,
+      robot_output_sender_->get_input_port_state().size());
+
+  // Passthrough to pass efforts
+  auto effort_passthrough = builder->AddSystem<systems::SubvectorPassThrough>(
+      state_estimator_->get_output_port(0).size(),
+      robot_output_sender_->get_input_port_state().size(),
+      robot_output_sender_->get_input_port_effort().size());
+
+  builder->Connect(state_estimator_->get_output_port(0),
+                   state_passthrough->get_input_port());
+  builder->Connect(state_passthrough->get_output_port(),
+                   robot_output_sender_->get_input_port_state());
+
+  builder->Connect(state_estimator_->get_output_port(0),
+                   effort_passthrough->get_input_port());
+  builder->Connect(effort_passthrough->get_output_port(),
+                   robot_output_sender_->get_input_port_effort());
+}
+
+void RobotOutDispatcher::RunUdpLoop(const std::string& address, int port,
+                                    bool initialize_ekf,
+                                    const Diagram<double>& diagram,
+                                    Simulator<double>* simulator) const {
+  auto& diagram_context = simulator->get_mutable_context();
+  auto& output_sender_context =
+      diagram.GetMutableSubsystemContext(*output_sender_, &diagram_context);
+  auto& state_estimator_context =
+      diagram.GetMutableSubsystemContext(*state_estimator_, &diagram_context);
+
+  // Wait for the first message.
+  SimpleCassieUdpSubscriber udp_sub(address, port);
+  drake::log()->info("Waiting for first UDP message from Cassie");
+  udp_sub.Poll();
+
+  // Initialize the context based on the first message.
+  const double t0 = udp_sub.message_time();
+  if (initialize_ekf) {
+    // Set EKF time and initial states
+    setInitialEkfState(t0, udp_sub.message(), plant_, diagram,
+                       *state_estimator_, &diagram_context);
+  }
+  diagram_context.SetTime(t0);
+  auto& output_sender_value = output_sender_->get_input_port(0).FixValue(
+      &output_sender_context, udp_sub.message());
+  auto& state_estimator_value = state_estimator_->get_input_port(0).FixValue(
+      &state_estimator_context, udp_sub.message());
+  drake::log()->info("dispatcher_robot_out started");
+
+  while (true) {
+    udp_sub.Poll();
+    output_sender_value.GetMutableData()->set_value(udp_sub.message());
+    state_estimator_value.GetMutableData()->set_value(udp_sub.message());
+    const double time = udp_sub.message_time();
+
+    // Check if we are very far ahead or behind
+    // (likely due to a restart of the driving clock)
+    if (time > simulator->get_context().get_time() + 1.0 ||
+        time < simulator->get_context().get_time()) {
+      std::cout << "Dispatcher time is " << simulator->get_context().get_time()
+                << ", but stepping to " << time << std::endl;
+      std::cout << "Difference is too large, resetting dispatcher time."
+                << std::endl;
+      simulator->get_mutable_context().SetTime(time);
+    }
+
+    state_estimator_->set_next_message_time(time);
+
+    simulator->AdvanceTo(time);
+    // Force-publish via the diagram
+    diagram.Publish(diagram_context);
+  }
+}
+
+RobotInDispatcher AddRobotInDispatcher(const MultibodyPlant<double>& plant,
+                                       const std::string& address, int port,
+                                       double max_joint_velocity,
+                                       int supervisor_N, double input_limit,
+                                       DiagramBuilder<double>* builder) {
+  RobotInDispatcher dispatcher;
+
+  // Create LCM receiver for commands
+  dispatcher.command_receiver =
+      builder->AddSystem<systems::RobotInputReceiver>(plant);
+
+  // Create state estimate receiver, used for safety checks
+  dispatcher.state_receiver =
+      builder->AddSystem<systems::RobotOutputReceiver>(plant);
+
+  double input_supervisor_update_period = 1.0 / 1000.0;
+  if (input_limit < 0) {
+    input_limit = std::numeric_limits<double>::max();
+  }
+
+  dispatcher.input_supervisor = builder->AddSystem<InputSupervisor>(
+      plant, max_joint_velocity, input_supervisor_update_period, supervisor_N,
+      input_limit);
+  builder->Connect(dispatcher.state_receiver->get_output_port(0),
+                   dispatcher.input_supervisor->get_input_port_state());
+  builder->Connect(dispatcher.command_receiver->get_output_port(0),
+                   dispatcher.input_supervisor->get_input_port_command());
+
+  // Create and connect translator
+  auto input_translator =
+      builder->AddSystem<systems::CassieInputTranslator>(plant);
+  builder->Connect(dispatcher.input_supervisor->get_output_port_command(),
+                   input_translator->get_input_port(0));
+
+  // Create and connect input publisher.
+  auto input_pub = builder->AddSystem(systems::CassieUDPPublisher::Make(
+      address, port, {TriggerType::kForced}));
+  builder->Connect(*input_translator, *input_pub);
+
+  // Create the command echo to the network
+  dispatcher.net_command_sender =
+      builder->AddSystem<systems::RobotCommandSender>(plant);
+  builder->Connect(dispatcher.input_supervisor->get_output_port_command(),
+                   dispatcher.net_command_sender->get_input_port(0));
+
+  return dispatcher;
+}
+
+}  // namespace dairlib
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+
+#include "examples/Cassie/cassie_state_estimator.h"
+#include "examples/Cassie/datatypes/cassie_out_t.h"
+#include "examples/Cassie/input_supervisor.h"
+#include "examples/Cassie/networking/cassie_output_sender.h"
+#include "multibody/kinematic/distance_evaluator.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "systems/robot_lcm_systems.h"
+
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/systems/analysis/simulator.h"
+#include "drake/systems/framework/diagram.h"
+#include "drake/systems/framework/diagram_builder.h"
+
+namespace dairlib {
+
+/// The systems of dispatcher_robot_out and dispatcher_robot_in, without the
+/// transport on either side of them, so that they can be connected to LCM
+/// (as in the dispatcher binaries) or to an InMemoryBus in the controller's
+/// process (see run_osc_walking_controller --transport=in_memory).
+
+// Run inverse kinematics to get initial pelvis height (assume both feet are
+// on the ground), and set the initial state for the EKF.
+// Note that we assume the ground is flat in the IK.
+void setInitialEkfState(double t0, const cassie_out_t& cassie_output,
+                        const drake::multibody::MultibodyPlant<double>& plant,
+                        const drake::systems::Diagram<double>& diagram,
+                        const systems::CassieStateEstimator& state_estimator,
+                        drake::systems::Context<double>* diagram_context);
+
+/// The state estimator of dispatcher_robot_out, the RobotOutputSender of its
+/// estimate, and a CassieOutputSender which echoes the robot's messages. The
+/// estimator's first input and the output sender's input take the robot's
+/// cassie_out_t. The kinematic evaluators the estimator uses are owned here,
+/// so this must outlive the diagram.
+class RobotOutDispatcher {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(RobotOutDispatcher)
+
+  /// @param plant Cassie with springs, without loop closures
+  RobotOutDispatcher(const drake::multibody::MultibodyPlant<double>& plant,
+                     drake::systems::DiagramBuilder<double>* builder,
+                     bool test_with_ground_truth_state, bool print_ekf_info,
+                     int test_mode);
+
+  systems::CassieStateEstimator* state_estimator() const {
+    return state_estimator_;
+  }
+  systems::RobotOutputSender* robot_output_sender() const {
+    return robot_output_sender_;
+  }
+  systems::CassieOutputSender* output_sender() const { return output_sender_; }
+
+  /// Receives cassie_out_t over UDP, and for each message writes it into the
+  /// estimator's and the output sender's inputs, advances the simulator to
+  /// the message time and force-publishes, as dispatcher_robot_out does for
+  /// the real robot. Never returns.
+  /// @param initialize_ekf Initialize the EKF from the first message (for a
+  ///   floating base)
+  void RunUdpLoop(const std::string& address, int port, bool initialize_ekf,
+                  const drake::systems::Diagram<double>& diagram,
+                  drake::systems::Simulator<double>* simulator) const;
+
+ private:
+  const drake::multibody::MultibodyPlant<double>& plant_;
+  multibody::DistanceEvaluator<double> left_loop_;
+  multibody::DistanceEvaluator<double> right_loop_;
+  multibody::WorldPointEvaluator<double> left_toe_evaluator_;
+  multibody::WorldPointEvaluator<double> left_heel_evaluator_;
+  multibody::WorldPointEvaluator<double> right_toe_evaluator_;
+  multibody::WorldPointEvaluator<double> right_heel_evaluator_;
+  multibody::KinematicEvaluatorSet<double> fourbar_evaluator_;
+  multibody::KinematicEvaluatorSet<double> left_contact_evaluator_;
+  multibody::KinematicEvaluatorSet<double> right_contact_evaluator_;
+
+  systems::CassieStateEstimator* state_estimator_;
+  systems::RobotOutputSender* robot_output_sender_;
+  systems::CassieOutputSender* output_sender_;
+};
+
+/// The systems of dispatcher_robot_in: the command receiver, the input
+/// supervisor checking commands against the receiver of the estimated state,
+/// and the translation of supervised commands to UDP for the robot, plus a
+/// RobotCommandSender of the supervised commands to echo on the network.
+struct RobotInDispatcher {
+  systems::RobotInputReceiver* command_receiver;
+  systems::RobotOutputReceiver* state_receiver;
+  InputSupervisor* input_supervisor;
+  systems::RobotCommandSender* net_command_sender;
+};
+
+/// @param input_limit Maximum torque. Negative values are infinite.
+RobotInDispatcher AddRobotInDispatcher(
+    const drake::multibody::MultibodyPlant<double>& plant,
+    const std::string& address, int port, double max_joint_velocity,
+    int supervisor_N, double input_limit,
+    drake::systems::DiagramBuilder<double>* builder);
+
+}  // namespace dairlib
@@ -5,10 +5,8 @@
 #include <fstream>
 #include <utility>
 
+#include "systems/framework/loop_timing.h"
 #include "drake/math/orthonormal_basis.h"
-#include "drake/solvers/equality_constrained_qp_solver.h"
-#include "drake/solvers/mathematical_program.h"
-#include "drake/solvers/solve.h"
 
 namespace dairlib {
 namespace systems {
@@ -26,8 +24,6 @@ using Eigen::VectorXd;
 using drake::AbstractValue;
 using drake::multibody::JacobianWrtVariable;
 using drake::multibody::MultibodyPlant;
-using drake::solvers::MathematicalProgram;
-using drake::solvers::Solve;
 using drake::systems::Context;
 using drake::systems::DiscreteValues;
 using drake::systems::EventStatus;
@@ -150,77 +146,16 @@ CassieStateEstimator::CassieStateEstimator(
     filtered_residual_right_idx_ =
         DeclareDiscreteState(VectorXd::Zero(n_v_, 1));
 
-    // Contact Estimation - Quadratic Programing
+    // Contact Estimation - least squares over the contact hypotheses
     n_b_ = fourbar_evaluator->count_full();
     n_cl_ = left_contact_evaluator->count_full();
     n_cl_active_ = left_contact_evaluator->count_active();
     n_cr_ = right_contact_evaluator->count_full();
     n_cr_active_ = right_contact_evaluator->count_active();
-    // MathematicalProgram
-    quadprog_ = std::make_unique<drake::solvers::MathematicalProgram>();
-    // Add variables to the optimization program
-    ddq_ = quadprog_->NewContinuousVariables(n_v_, "ddq");
-    lambda_b_ = quadprog_->NewContinuousVariables(n_b_, "lambda_b");
-    lambda_cl_ = quadprog_->NewContinuousVariables(n_cl_, "lambda_cl");
-    lambda_cr_ = quadprog_->NewContinuousVariables(n_cr_, "lambda_cr");
-    eps_cl_ = quadprog_->NewContinuousVariables(n_cl_active_, "eps_cl");
-    eps_cr_ = quadprog_->NewContinuousVariables(n_cr_active_, "eps_cr");
-    eps_imu_ = quadprog_->NewContinuousVariables(SPACE_DIM, "eps_imu");
-    // Add equality constraints to the optimization program
-    fourbar_constraint_ =
-        quadprog_
-            ->AddLinearEqualityConstraint(MatrixXd::Zero(n_b_, n_v_),
-                                          VectorXd::Zero(n_b_), ddq_)
-            .evaluator()
-            .get();
-    left_contact_constraint_ =
-        quadprog_
-            ->AddLinearEqualityConstraint(
-                MatrixXd::Zero(n_cl_active_, n_v_ + n_cl_active_),
-                VectorXd::Zero(n_cl_active_), {ddq_, eps_cl_})
-            .evaluator()
-            .get();
-    right_contact_constraint_ =
-        quadprog_
-            ->AddLinearEqualityConstraint(
-                MatrixXd::Zero(n_cr_active_, n_v_ + n_cr_active_),
-                VectorXd::Zero(n_cr_active_), {ddq_, eps_cr_})
-            .evaluator()
-            .get();
-    imu_accel_constraint_ = quadprog_
-                                ->AddLinearEqualityConstraint(
-                                    MatrixXd::Zero(SPACE_DIM, n_v_ + SPACE_DIM),
-                                    VectorXd::Zero(SPACE_DIM), {ddq_, eps_imu_})
-                                .evaluator()
-                                .get();
-    // Add costs to the optimization program
-    int n_lambda = n_b_ + n_cl_ + n_cr_;
-    quadcost_eom_ =
-        quadprog_
-            ->AddQuadraticCost(MatrixXd::Zero(n_v_ + n_lambda, n_v_ + n_lambda),
-                               MatrixXd::Zero(n_v_ + n_lambda, 1),
-                               {ddq_, lambda_b_, lambda_cl_, lambda_cr_})
-            .evaluator()
-            .get();
-    quadcost_eps_cl_ =
-        quadprog_
-            ->AddQuadraticCost(MatrixXd::Zero(n_cl_active_, n_cl_active_),
-                               VectorXd::Zero(n_cl_active_), eps_cl_)
-            .evaluator()
-            .get();
-    quadcost_eps_cr_ =
-        quadprog_
-            ->AddQuadraticCost(MatrixXd::Zero(n_cr_active_, n_cr_active_),
-                               VectorXd::Zero(n_cr_active_), eps_cr_)
-            .evaluator()
-            .get();
-    quadcost_eps_imu_ =
-        quadprog_
-            ->AddQuadraticCost(
-                w_soft_constraint_ * MatrixXd::Identity(SPACE_DIM, SPACE_DIM),
-                VectorXd::Zero(SPACE_DIM), eps_imu_)
-            .evaluator()
-            .get();
+    contact_estimator_ = std::make_unique<ContactHypothesisEstimator>(
+        n_v_, n_b_, std::vector<int>{n_cl_, n_cr_},
+        std::vector<int>{n_cl_active_, n_cr_active_}, eps_cost_,
+        w_soft_constraint_);
   }
 }
 
@@ -509,7 +444,8 @@ void CassieStateEstimator::AssignFloatingBaseStateToOutputVector(
 ///  foot. The acceleration of the pelvis is also constrained to match the imu
 ///  acceleration. The cost from the three optimizations are compared. In
 ///  general, the optimization with the least cost is assumed to be the actual
-///  stance.
+///  stance. All three are solved by ContactHypothesisEstimator from a single
+///  factorization of the shared equations of motion.
 void CassieStateEstimator::UpdateContactEstimationCosts(
     const OutputVector<double>& output, const double& dt,
     DiscreteValues<double>* discrete_state,
@@ -558,195 +494,38 @@ void CassieStateEstimator::UpdateContactEstimationCosts(
   const auto& R_WB = pelvis_pose.rotation();
   Vector3d imu_accel_wrt_world = R_WB * output.GetIMUAccelerations() + gravity_;
 
-  // Mathematical program - double contact
-  // Equality constraint
-  fourbar_constraint_->UpdateCoefficients(J_b, -1 * JdotV_b);
-
-  MatrixXd IMU_coeff(SPACE_DIM, n_v_ + SPACE_DIM);
-  IMU_coeff << J_imu, MatrixXd::Identity(SPACE_DIM, SPACE_DIM);
-  imu_accel_constraint_->UpdateCoefficients(
-      IMU_coeff, -1 * JdotV_imu + imu_accel_wrt_world);
-
-  MatrixXd CL_coeff(n_cl_active_, n_v_ + n_cl_active_);
-  CL_coeff << J_cl_active, MatrixXd::Identity(n_cl_active_, n_cl_active_);
-  left_contact_constraint_->UpdateCoefficients(CL_coeff, -1 * JdotV_cl_active);
-
-  MatrixXd CR_coeff(n_cr_active_, n_v_ + n_cr_active_);
-  CR_coeff << J_cr_active, MatrixXd::Identity(n_cr_active_, n_cr_active_);
-  right_contact_constraint_->UpdateCoefficients(CR_coeff, -1 * JdotV_cr_active);
-
-  // Cost
-  int A_cols = n_v_ + n_b_ + n_cl_ + n_cr_;
-  MatrixXd A_dyn(n_v_, A_cols);
-  A_dyn << M, -1 * J_b.transpose(), -1 * J_cl.transpose(),
-      -1 * J_cr.transpose();
-  VectorXd b_dyn(n_v_);
-  b_dyn = -C;
-
-  quadcost_eom_->UpdateCoefficients(
-      2 * A_dyn.transpose() * A_dyn +
-          eps_cost_ * MatrixXd::Identity(A_cols, A_cols),
-      -2 * A_dyn.transpose() * b_dyn);
-  quadcost_eps_cl_->UpdateCoefficients(
-      w_soft_constraint_ * MatrixXd::Identity(n_cl_active_, n_cl_active_),
-      VectorXd::Zero(n_cl_active_));
-  quadcost_eps_cr_->UpdateCoefficients(
-      w_soft_constraint_ * MatrixXd::Identity(n_cr_active_, n_cr_active_),
-      VectorXd::Zero(n_cr_active_));
-
-  // Initial guess
-  // EqualityConstrainedQPSolver doesn't depend on the initial guess. There is a
-  // closed form solution.
-
-  // Solve the optimization problem
-  drake::solvers::EqualityConstrainedQPSolver solver;
-  drake::solvers::SolverOptions solver_options;
-  solver_options.SetOption(drake::solvers::EqualityConstrainedQPSolver::id(),
-                           "FeasibilityTol", 1e-6); // default 1e-12
-  drake::solvers::MathematicalProgramResult result_double =
-      solver.Solve(*quadprog_, {}, solver_options);
-
-  if (!result_double.is_success()) {
-    // If the optimization fails, push infinity into the optimal_cost vector
-    optimal_cost->at(0) = std::numeric_limits<double>::infinity();
-
-  } else {
-    // Push the optimal cost to the optimal_cost vector
-    optimal_cost->at(0) =
-        result_double.get_optimal_cost() +
-        b_dyn.transpose() * b_dyn;  // the second term is the cosntant term
-
-    // Residual calculation
-    // TODO(Nanda): Remove the residual calculation after testing on the real
-    // robot
-    VectorXd ddq_val = result_double.GetSolution(ddq_);
-    VectorXd curr_residual = ddq_val * dt;
-    curr_residual -=
-        (output.GetVelocities() -
-         discrete_state->get_vector(previous_velocity_idx_).get_value());
-    VectorXd filtered_residual_double =
-        discrete_state->get_vector(filtered_residual_double_idx_).get_value();
-    filtered_residual_double =
-        filtered_residual_double +
-        alpha_ * (curr_residual - filtered_residual_double);
-    discrete_state->get_mutable_vector(filtered_residual_double_idx_)
-            .get_mutable_value()
-        << filtered_residual_double;
-  }
-
-  // Mathematical program - left contact
-  // Equality constraints
-  left_contact_constraint_->UpdateCoefficients(CL_coeff, -1 * JdotV_cl_active);
-  right_contact_constraint_->UpdateCoefficients(
-      MatrixXd::Zero(n_cr_active_, n_v_ + n_cr_active_),
-      VectorXd::Zero(n_cr_active_));
-  imu_accel_constraint_->UpdateCoefficients(
-      IMU_coeff, -1 * JdotV_imu + imu_accel_wrt_world);
-
-  // Cost
-  A_dyn << M, -1 * J_b.transpose(), -1 * J_cl.transpose(),
-      MatrixXd::Zero(n_v_, n_cr_);
-
-  quadcost_eom_->UpdateCoefficients(
-      2 * A_dyn.transpose() * A_dyn +
-          eps_cost_ * MatrixXd::Identity(A_cols, A_cols),
-      -2 * A_dyn.transpose() * b_dyn);
-  quadcost_eps_cl_->UpdateCoefficients(
-      w_soft_constraint_ * MatrixXd::Identity(n_cl_active_, n_cl_active_),
-      VectorXd::Zero(n_cl_active_));
-  quadcost_eps_cr_->UpdateCoefficients(
-      MatrixXd::Zero(n_cr_active_, n_cr_active_), VectorXd::Zero(n_cr_active_));
-
-  // Initial guess
-  // EqualityConstrainedQPSolver doesn't depend on the initial guess. There is a
-  // closed form solution.
-
-  // Solve the optimization problem
-  drake::solvers::MathematicalProgramResult result_left =
-      solver.Solve(*quadprog_, {}, solver_options);
-
-  if (!result_left.is_success()) {
-    // Push infinity into optimal_cost vector if the optimization fails
-    optimal_cost->at(1) = std::numeric_limits<double>::infinity();
-
-  } else {
-    // Push the optimal cost to the optimal_cost vector
-    optimal_cost->at(1) =
-        result_left.get_optimal_cost() + b_dyn.transpose() * b_dyn;
-
-    // Residual calculation
-    // TODO(Nanda): Remove the residual calculation after testing on the real
-    // robot
-    VectorXd ddq_val = result_left.GetSolution(ddq_);
-    VectorXd curr_residual = ddq_val * dt;
-    curr_residual -=
-        (output.GetVelocities() -
-         discrete_state->get_vector(previous_velocity_idx_).get_value());
-    VectorXd filtered_residual_left =
-        discrete_state->get_vector(filtered_residual_left_idx_).get_value();
-    filtered_residual_left = filtered_residual_left +
-                             alpha_ * (curr_residual - filtered_residual_left);
-    discrete_state->get_mutable_vector(filtered_residual_left_idx_)
-            .get_mutable_value()
-        << filtered_residual_left;
-  }
-
-  // Mathematical program - right contact
-  // Equality constraint
-  left_contact_constraint_->UpdateCoefficients(
-      MatrixXd::Zero(n_cl_active_, n_v_ + n_cl_active_),
-      VectorXd::Zero(n_cl_active_));
-  right_contact_constraint_->UpdateCoefficients(CR_coeff, -1 * JdotV_cr_active);
-  imu_accel_constraint_->UpdateCoefficients(
-      IMU_coeff, -1 * JdotV_imu + imu_accel_wrt_world);
-
-  // Cost
-  A_dyn << M, -1 * J_b.transpose(), MatrixXd::Zero(n_v_, n_cl_),
-      -1 * J_cr.transpose();
-
-  quadcost_eom_->UpdateCoefficients(
-      2 * A_dyn.transpose() * A_dyn +
-          eps_cost_ * MatrixXd::Identity(A_cols, A_cols),
-      -2 * A_dyn.transpose() * b_dyn);
-  quadcost_eps_cl_->UpdateCoefficients(
-      MatrixXd::Zero(n_cl_active_, n_cl_active_), VectorXd::Zero(n_cl_active_));
-  quadcost_eps_cr_->UpdateCoefficients(
-      w_soft_constraint_ * MatrixXd::Identity(n_cr_active_, n_cr_active_),
-      VectorXd::Zero(n_cr_active_));
-
-  // Initial guess
-  // EqualityConstrainedQPSolver doesn't depend on the initial guess. There is a
-  // closed form solution.
-
-  // Solve the optimization problem
-  drake::solvers::MathematicalProgramResult result_right =
-      solver.Solve(*quadprog_, {}, solver_options);
-
-  if (!result_right.is_success()) {
-    // If the optimization fails, push infinity to the optimal_cost vector
-    optimal_cost->at(2) = std::numeric_limits<double>::infinity();
-
-  } else {
-    // Push the optimal cost to optimal_cost vector
-    optimal_cost->at(2) =
-        result_right.get_optimal_cost() + b_dyn.transpose() * b_dyn;
+  // Factor the equations of motion shared by the three hypotheses once, then
+  // solve double, left and right stance
+  contact_estimator_->Update(M, C, J_b, JdotV_b, {J_cl, J_cr},
+                             {J_cl_active, J_cr_active},
+                             {JdotV_cl_active, JdotV_cr_active}, J_imu,
+                             JdotV_imu, imu_accel_wrt_world);
+  const std::vector<std::vector<int>> hypotheses{{0, 1}, {0}, {1}};
+  const std::vector<int> filtered_residual_idx{filtered_residual_double_idx_,
+                                               filtered_residual_left_idx_,
+                                               filtered_residual_right_idx_};
+  for (int i = 0; i < 3; i++) {
+    // If the optimization fails, the cost is infinite
+    const auto solution = contact_estimator_->Solve(hypotheses[i]);
+    optimal_cost->at(i) = solution.cost;
+    if (std::isinf(solution.cost)) {
+      continue;
+    }
 
     // Residual calculation
     // TODO(Nanda): Remove the residual calculation after testing on the real
     // robot
-    VectorXd ddq_val = result_right.GetSolution(ddq_);
-    VectorXd curr_residual = ddq_val * dt;
+    VectorXd curr_residual = solution.ddq * dt;
     curr_residual -=
         (output.GetVelocities() -
          discrete_state->get_vector(previous_velocity_idx_).get_value());
-    VectorXd filtered_residual_right =
-        discrete_state->get_vector(filtered_residual_right_idx_).get_value();
-    filtered_residual_right =
-        filtered_residual_right +
-        alpha_ * (curr_residual - filtered_residual_right);
-    discrete_state->get_mutable_vector(filtered_residual_right_idx_)
+    VectorXd filtered_residual =
+        discrete_state->get_vector(filtered_residual_idx[i]).get_value();
+    filtered_residual =
+        filtered_residual + alpha_ * (curr_residual - filtered_residual);
+    discrete_state->get_mutable_vector(filtered_residual_idx[i])
             .get_mutable_value()
-        << filtered_residual_right;
+        << filtered_residual;
   }
 
   // Record previous velocity (used in acceleration residual)
@@ -938,6 +717,10 @@ void CassieStateEstimator::EstimateContactForController(
 EventStatus CassieStateEstimator::Update(
     const Context<double>& context,
     drake::systems::State<double>* state) const {
+  static const int timing_section =
+      LoopTimer::RegisterSection("state_estimator");
+  ScopedLoopSection timing(timing_section);
+
   // Get cassie output
   const auto& cassie_out =
       this->EvalAbstractInput(context, cassie_out_input_port_)
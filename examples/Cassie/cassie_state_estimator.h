@@ -7,7 +7,6 @@
 #include <memory>
 
 #include "drake/multibody/plant/multibody_plant.h"
-#include "drake/solvers/mathematical_program.h"
 #include "drake/systems/framework/leaf_system.h"
 #include "src/InEKF.h"
 
@@ -16,6 +15,7 @@
 #include "systems/framework/timestamped_vector.h"
 #include "examples/Cassie/datatypes/cassie_out_t.h"
 #include "examples/Cassie/cassie_utils.h"
+#include "examples/Cassie/contact_hypothesis_estimator.h"
 #include "multibody/kinematic/kinematic_evaluator_set.h"
 
 namespace dairlib {
@@ -207,32 +207,14 @@ class CassieStateEstimator : public drake::systems::LeafSystem<double> {
   const double alpha_ = 0.9;  // Low-pass filter constant for the acceleration
                               // residual. 0 < alpha_ < 1. The bigger alpha_ is,
                               // the higher the cut-off frequency is.
-  // Contact Estimation - Quadratic Programing
-  // MathematicalProgram
-  std::unique_ptr<drake::solvers::MathematicalProgram> quadprog_;
+  // Contact Estimation - least squares over the contact hypotheses
+  std::unique_ptr<ContactHypothesisEstimator> contact_estimator_;
   // Variable dimensions
   int n_b_;
   int n_cl_;
   int n_cl_active_;
   int n_cr_;
   int n_cr_active_;
-  // Cost and constraints (Bindings)
-  drake::solvers::LinearEqualityConstraint* fourbar_constraint_;
-  drake::solvers::LinearEqualityConstraint* left_contact_constraint_;
-  drake::solvers::LinearEqualityConstraint* right_contact_constraint_;
-  drake::solvers::LinearEqualityConstraint* imu_accel_constraint_;
-  drake::solvers::QuadraticCost* quadcost_eom_;
-  drake::solvers::QuadraticCost* quadcost_eps_cl_;
-  drake::solvers::QuadraticCost* quadcost_eps_cr_;
-  drake::solvers::QuadraticCost* quadcost_eps_imu_;
-  // Decision variables
-  drake::solvers::VectorXDecisionVariable ddq_;
-  drake::solvers::VectorXDecisionVariable lambda_b_;
-  drake::solvers::VectorXDecisionVariable lambda_cl_;
-  drake::solvers::VectorXDecisionVariable lambda_cr_;
-  drake::solvers::VectorXDecisionVariable eps_cl_;
-  drake::solvers::VectorXDecisionVariable eps_cr_;
-  drake::solvers::VectorXDecisionVariable eps_imu_;
 
   // flag for testing and tuning
   std::unique_ptr<drake::systems::Context<double>> context_gt_;
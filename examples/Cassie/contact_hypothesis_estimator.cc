@@ -0,0 +1,196 @@
+#include "examples/Cassie/contact_hypothesis_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "drake/common/drake_assert.h"
+
+namespace dairlib {
+namespace systems {
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::vector;
+
+ContactHypothesisEstimator::ContactHypothesisEstimator(
+    int n_v, int n_b, vector<int> contact_dims,
+    vector<int> active_contact_dims, double eps, double w)
+    : n_v_(n_v),
+      n_b_(n_b),
+      contact_dims_(contact_dims),
+      active_contact_dims_(active_contact_dims),
+      eps_(eps),
+      w_(w) {
+  DRAKE_DEMAND(contact_dims.size() == active_contact_dims.size());
+  DRAKE_DEMAND(eps > 0);
+  DRAKE_DEMAND(w >= 0);
+  // Decision variables are [ddq, λ_b, λ_c...]
+  n_w_ = n_v_ + n_b_;
+  int n_active = 0;
+  for (size_t c = 0; c < contact_dims.size(); c++) {
+    contact_starts_.push_back(n_w_);
+    active_contact_starts_.push_back(n_active);
+    n_w_ += contact_dims[c];
+    n_active += active_contact_dims[c];
+  }
+
+  H_.resize(n_w_, n_w_);
+  f_.resize(n_w_);
+  U_ = MatrixXd::Zero(n_w_, n_active);
+  JdotV_c_active_.resize(n_active);
+  llt_ = Eigen::LLT<MatrixXd>(n_w_);
+}
+
+void ContactHypothesisEstimator::Update(
+    const MatrixXd& M, const VectorXd& C, const MatrixXd& J_b,
+    const VectorXd& JdotV_b, const vector<MatrixXd>& J_c,
+    const vector<MatrixXd>& J_c_active, const vector<VectorXd>& JdotV_c_active,
+    const MatrixXd& J_imu, const VectorXd& JdotV_imu,
+    const Eigen::Vector3d& imu_accel) {
+  const int n_contacts = contact_dims_.size();
+  DRAKE_DEMAND(static_cast<int>(J_c.size()) == n_contacts);
+  DRAKE_DEMAND(static_cast<int>(J_c_active.size()) == n_contacts);
+  DRAKE_DEMAND(static_cast<int>(JdotV_c_active.size()) == n_contacts);
+  DRAKE_DEMAND(J_b.rows() == n_b_);
+
+  // Equations of motion residual, A w - b, with b = -C
+  MatrixXd A(n_v_, n_w_);
+  A.leftCols(n_v_) = M;
+  A.middleCols(n_v_, n_b_) = -J_b.transpose();
+  for (int c = 0; c < n_contacts; c++) {
+    A.middleCols(contact_starts_[c], contact_dims_[c]) = -J_c[c].transpose();
+  }
+  H_.noalias() = 2 * A.transpose() * A;
+  H_.diagonal().array() += eps_;
+  f_.noalias() = -2 * A.transpose() * C;
+  constant_ = C.squaredNorm();
+
+  // Soft imu acceleration constraint
+  const VectorXd r_imu = imu_accel - JdotV_imu;
+  H_.topLeftCorner(n_v_, n_v_).noalias() += w_ * J_imu.transpose() * J_imu;
+  f_.head(n_v_).noalias() += w_ * J_imu.transpose() * r_imu;
+  constant_ += 0.5 * w_ * r_imu.squaredNorm();
+
+  // Soft contact constraints, with every contact
+  const double sqrt_w = std::sqrt(w_);
+  for (int c = 0; c < n_contacts; c++) {
+    const int start = active_contact_starts_[c];
+    const int n_active = active_contact_dims_[c];
+    U_.block(0, start, n_v_, n_active) = sqrt_w * J_c_active[c].transpose();
+    JdotV_c_active_.segment(start, n_active) = JdotV_c_active[c];
+    constant_ += 0.5 * w_ * JdotV_c_active[c].squaredNorm();
+  }
+  H_.topLeftCorner(n_v_, n_v_).noalias() +=
+      U_.topRows(n_v_) * U_.topRows(n_v_).transpose();
+  f_.noalias() -= sqrt_w * U_ * JdotV_c_active_;
+
+  J_b_ = J_b;
+  JdotV_b_ = JdotV_b;
+
+  llt_.compute(H_);
+  is_updated_ = (llt_.info() == Eigen::Success);
+  if (!is_updated_) {
+    return;
+  }
+
+  // One multi-column solve for everything the hypotheses need
+  const int n_forces = n_w_ - n_v_ - n_b_;
+  MatrixXd rhs = MatrixXd::Zero(n_w_, 1 + n_b_ + U_.cols() + n_forces);
+  rhs.col(0) = f_;
+  rhs.block(0, 1, n_v_, n_b_) = J_b.transpose();
+  rhs.middleCols(1 + n_b_, U_.cols()) = U_;
+  rhs.bottomRightCorner(n_forces, n_forces).setIdentity();
+  llt_.solveInPlace(rhs);
+  Hinv_f_ = rhs.col(0);
+  Hinv_G_ = rhs.middleCols(1, n_b_);
+  Hinv_U_ = rhs.middleCols(1 + n_b_, U_.cols());
+  Hinv_S_ = rhs.rightCols(n_forces);
+}
+
+ContactHypothesisEstimator::Solution ContactHypothesisEstimator::Solve(
+    const vector<int>& contacts) const {
+  Solution solution{std::numeric_limits<double>::infinity(),
+                    VectorXd::Zero(n_v_)};
+  if (!is_updated_) {
+    return solution;
+  }
+
+  // Columns of U (soft constraints to remove) and forces to fix at zero, of
+  // the excluded contacts
+  vector<int> u_cols;
+  vector<int> force_cols;
+  for (size_t c = 0; c < contact_dims_.size(); c++) {
+    if (std::find(contacts.begin(), contacts.end(), c) != contacts.end()) {
+      continue;
+    }
+    for (int i = 0; i < active_contact_dims_[c]; i++) {
+      u_cols.push_back(active_contact_starts_[c] + i);
+    }
+    for (int i = 0; i < contact_dims_[c]; i++) {
+      force_cols.push_back(contact_starts_[c] - n_v_ - n_b_ + i);
+    }
+  }
+  const int k = u_cols.size();
+  const int m = n_b_ + force_cols.size();
+
+  MatrixXd U_X(n_w_, k);
+  MatrixXd Hinv_U_X(n_w_, k);
+  VectorXd d_X(k);
+  for (int i = 0; i < k; i++) {
+    U_X.col(i) = U_.col(u_cols[i]);
+    Hinv_U_X.col(i) = Hinv_U_.col(u_cols[i]);
+    d_X(i) = JdotV_c_active_(u_cols[i]);
+  }
+
+  // H_h⁻¹ [f_h, C_hᵀ], where H_h = H - U_X U_Xᵀ and f_h = f + sqrt(w) U_X d_X
+  MatrixXd Y(n_w_, 1 + m);
+  Y.col(0) = Hinv_f_ + std::sqrt(w_) * Hinv_U_X * d_X;
+  Y.middleCols(1, n_b_) = Hinv_G_;
+  for (size_t i = 0; i < force_cols.size(); i++) {
+    Y.col(1 + n_b_ + i) = Hinv_S_.col(force_cols[i]);
+  }
+  if (k > 0) {
+    // Woodbury: (H - U Uᵀ)⁻¹ = H⁻¹ + H⁻¹U (I - UᵀH⁻¹U)⁻¹ UᵀH⁻¹
+    MatrixXd K = -U_X.transpose() * Hinv_U_X;
+    K.diagonal().array() += 1;
+    Eigen::LLT<MatrixXd> K_llt(K);
+    if (K_llt.info() != Eigen::Success) {
+      return solution;
+    }
+    Y.noalias() += Hinv_U_X * K_llt.solve(U_X.transpose() * Y);
+  }
+
+  // Constraints C_h w = c_h, i.e. J_b ddq = -JdotV_b and the excluded forces
+  // are zero. C_h applied to the columns of Y:
+  MatrixXd CY(m, 1 + m);
+  CY.topRows(n_b_).noalias() = J_b_ * Y.topRows(n_v_);
+  for (size_t i = 0; i < force_cols.size(); i++) {
+    CY.row(n_b_ + i) = Y.row(n_v_ + n_b_ + force_cols[i]);
+  }
+  VectorXd c(m);
+  c << -JdotV_b_, VectorXd::Zero(force_cols.size());
+
+  const Eigen::LDLT<MatrixXd> schur(CY.rightCols(m));
+  if (schur.info() != Eigen::Success) {
+    return solution;
+  }
+  const VectorXd mu = schur.solve(CY.col(0) - c);
+  if (!mu.allFinite()) {
+    return solution;
+  }
+  const VectorXd w_opt = Y.col(0) - Y.rightCols(m) * mu;
+
+  // At the optimum H_h w = f_h - C_hᵀ μ, so the cost
+  //   1/2 wᵀ H_h w - f_hᵀ w + constant_h
+  // reduces to constant_h - 1/2 (f_hᵀ w + μᵀ c_h)
+  const double f_w = f_.dot(w_opt) +
+                     std::sqrt(w_) * d_X.dot(U_X.transpose() * w_opt);
+  const double constant = constant_ - 0.5 * w_ * d_X.squaredNorm();
+  solution.cost = constant - 0.5 * (f_w + mu.dot(c));
+  solution.ddq = w_opt.head(n_v_);
+  return solution;
+}
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dairlib {
+namespace systems {
+
+/// ContactHypothesisEstimator scores contact hypotheses (e.g. double, left and
+/// right stance) by how well each one explains the measured state, input and
+/// imu acceleration through the equations of motion.
+///
+/// For a hypothesis h, a subset of the contacts, it solves
+///   min_{ddq, λ}  |M ddq - J_bᵀ λ_b - Σ_{c∈h} J_cᵀ λ_c + C|²
+///                 + eps/2 |(ddq, λ)|²
+///                 + w/2 Σ_{c∈h} |J_c,active ddq + JdotV_c,active|²
+///                 + w/2 |J_imu ddq + JdotV_imu - a_imu|²
+///   s.t.          J_b ddq + JdotV_b = 0
+/// where C contains the bias, gravity, spring and actuation forces, and the
+/// λ_c of contacts outside of h are zero. This is the least-squares problem
+/// that CassieStateEstimator previously posed as one MathematicalProgram per
+/// hypothesis, with the soft constraint slacks eliminated.
+///
+/// The problems differ only in the contacts they exclude, so the Hessian of the
+/// problem with every contact is factored once. Each hypothesis then removes
+/// its excluded contacts' penalty terms with a Woodbury downdate, and fixes
+/// their forces to zero alongside the four-bar constraint through a small
+/// Schur complement. No MathematicalProgram or solver is involved.
+class ContactHypothesisEstimator {
+ public:
+  /// The optimal cost and acceleration of one hypothesis. If the problem could
+  /// not be solved, the cost is infinite.
+  struct Solution {
+    double cost;
+    Eigen::VectorXd ddq;
+  };
+
+  /// @param n_v Number of generalized velocities
+  /// @param n_b Number of four-bar (loop closure) constraint rows
+  /// @param contact_dims Full dimension of each contact's force
+  /// @param active_contact_dims Active dimension of each contact
+  /// @param eps Regularization of the accelerations and forces
+  /// @param w Weight of the soft contact and imu acceleration constraints
+  ContactHypothesisEstimator(int n_v, int n_b, std::vector<int> contact_dims,
+                             std::vector<int> active_contact_dims, double eps,
+                             double w);
+
+  /// Sets the data shared by all hypotheses and factors the problem with every
+  /// contact. J_c and J_c_active are the full and active Jacobians of each
+  /// contact.
+  void Update(const Eigen::MatrixXd& M, const Eigen::VectorXd& C,
+              const Eigen::MatrixXd& J_b, const Eigen::VectorXd& JdotV_b,
+              const std::vector<Eigen::MatrixXd>& J_c,
+              const std::vector<Eigen::MatrixXd>& J_c_active,
+              const std::vector<Eigen::VectorXd>& JdotV_c_active,
+              const Eigen::MatrixXd& J_imu, const Eigen::VectorXd& JdotV_imu,
+              const Eigen::Vector3d& imu_accel);
+
+  /// Solves the hypothesis in which only the given contacts (indices into
+  /// contact_dims) are active. Requires a prior call to Update().
+  Solution Solve(const std::vector<int>& contacts) const;
+
+ private:
+  int n_v_;
+  int n_b_;
+  int n_w_;
+  std::vector<int> contact_dims_;
+  std::vector<int> active_contact_dims_;
+  std::vector<int> contact_starts_;
+  std::vector<int> active_contact_starts_;
+  double eps_;
+  double w_;
+
+  bool is_updated_ = false;
+  Eigen::LLT<Eigen::MatrixXd> llt_;
+  Eigen::MatrixXd H_;
+  // Linear cost term and constant, with every contact
+  Eigen::VectorXd f_;
+  double constant_;
+  // sqrt(w) * [J_c,activeᵀ; 0] of all contacts, side by side
+  Eigen::MatrixXd U_;
+  Eigen::VectorXd JdotV_c_active_;
+  Eigen::VectorXd JdotV_b_;
+  Eigen::MatrixXd J_b_;
+  // H⁻¹ applied to f, to [J_b, 0]ᵀ, to U and to the contact force selectors
+  Eigen::VectorXd Hinv_f_;
+  Eigen::MatrixXd Hinv_G_;
+  Eigen::MatrixXd Hinv_U_;
+  Eigen::MatrixXd Hinv_S_;
+};
+
+}  // namespace systems
+}  // namespace dairlib
@@ -1,5 +1,4 @@
 #include <memory>
-#include <limits>
 
 #include <gflags/gflags.h>
 #include "drake/lcm/drake_lcm.h"
@@ -10,10 +9,10 @@
 
 #include "multibody/multibody_utils.h"
 #include "systems/robot_lcm_systems.h"
-#include "examples/Cassie/input_supervisor.h"
-#include "examples/Cassie/networking/cassie_udp_publisher.h"
-#include "examples/Cassie/networking/cassie_input_translator.h"
+#include "systems/framework/async_lcm_publisher_system.h"
+#include "examples/Cassie/cassie_dispatchers.h"
 #include "examples/Cassie/cassie_utils.h"
+#include "lcm/shm_lcm.h"
 #include "dairlib/lcmt_robot_output.hpp"
 #include "dairlib/lcmt_controller_switch.hpp"
 #include "systems/framework/lcm_driven_loop.h"
@@ -24,8 +23,6 @@ using drake::systems::Simulator;
 using drake::systems::Context;
 using drake::systems::lcm::LcmSubscriberSystem;
 using drake::systems::lcm::LcmPublisherSystem;
-using systems::RobotInputReceiver;
-using systems::RobotCommandSender;
 using drake::systems::TriggerType;
 using drake::lcm::Subscriber;
 
@@ -52,6 +49,10 @@ DEFINE_string(control_channel_name_2, "OSC_STANDING",
 DEFINE_string(control_channel_name_3, "OSC_WALKING",
               "The name of the lcm channel that sends Cassie's state");
 
+DEFINE_string(lcm_url, "udpm://239.255.76.67:7667?ttl=0",
+              "LCM URL for the messages on this host, e.g. shm://cassie to "
+              "use shared memory. Network messages always use UDP.");
+
 // Cassie model parameter
 DEFINE_bool(floating_base, true, "Fixed or floating base model");
 
@@ -60,7 +61,7 @@ DEFINE_bool(floating_base, true, "Fixed or floating base model");
 int do_main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
 
-  drake::lcm::DrakeLcm lcm_local("udpm://239.255.76.67:7667?ttl=0");
+  auto lcm_local = MakeLcmInterface(FLAGS_lcm_url);
   drake::lcm::DrakeLcm lcm_network("udpm://239.255.76.67:7667?ttl=1");
 
   DiagramBuilder<double> builder;
@@ -72,56 +73,24 @@ int do_main(int argc, char* argv[]) {
                      true /*spring model*/, false /*loop closure*/);
   plant.Finalize();
 
-  // Create LCM receiver for commands
-  auto command_receiver = builder.AddSystem<RobotInputReceiver>(plant);
+  // Create the command receiver, input supervisor and UDP publisher
+  auto dispatcher = AddRobotInDispatcher(
+      plant, FLAGS_address, FLAGS_port, FLAGS_max_joint_velocity,
+      FLAGS_supervisor_N, FLAGS_input_limit, &builder);
+  auto command_receiver = dispatcher.command_receiver;
 
   // Create state estimate receiver, used for safety checks
   auto state_sub = builder.AddSystem(
       LcmSubscriberSystem::Make<dairlib::lcmt_robot_output>(
-          FLAGS_state_channel_name, &lcm_local));
-  auto state_receiver = builder.AddSystem<systems::RobotOutputReceiver>(plant);
-  builder.Connect(*state_sub, *state_receiver);
-
-  double input_supervisor_update_period = 1.0 / 1000.0;
-  double input_limit = FLAGS_input_limit;
-  if (input_limit < 0) {
-    input_limit = std::numeric_limits<double>::max();
-  }
-
-  auto input_supervisor =
-      builder.AddSystem<InputSupervisor>(plant,
-                                         FLAGS_max_joint_velocity,
-                                         input_supervisor_update_period,
-                                         FLAGS_supervisor_N,
-                                         input_limit);
-  builder.Connect(state_receiver->get_output_port(0),
-                  input_supervisor->get_input_port_state());
-  builder.Connect(command_receiver->get_output_port(0),
-                  input_supervisor->get_input_port_command());
-
-  // Create and connect translator
-  auto input_translator =
-      builder.AddSystem<systems::CassieInputTranslator>(plant);
-  builder.Connect(input_supervisor->get_output_port_command(),
-      input_translator->get_input_port(0));
-
-  // Create and connect input publisher.
-  auto input_pub = builder.AddSystem(
-      systems::CassieUDPPublisher::Make(FLAGS_address, FLAGS_port,
-                                        {TriggerType::kForced}));
-  builder.Connect(*input_translator, *input_pub);
-
-  // Create and connect LCM command echo to network
-  auto net_command_sender = builder.AddSystem<RobotCommandSender>(plant);
+          FLAGS_state_channel_name, lcm_local.get()));
+  builder.Connect(*state_sub, *dispatcher.state_receiver);
+
+  // Connect LCM command echo to network
   auto net_command_pub = builder.AddSystem(
-      LcmPublisherSystem::Make<dairlib::lcmt_robot_input>(
+      systems::AsyncLcmPublisherSystem::Make<dairlib::lcmt_robot_input>(
           "NETWORK_CASSIE_INPUT", &lcm_network,
           {TriggerType::kPeriodic}, FLAGS_pub_rate));
-
-  builder.Connect(input_supervisor->get_output_port_command(),
-      net_command_sender->get_input_port(0));
-
-  builder.Connect(*net_command_sender, *net_command_pub);
+  builder.Connect(*dispatcher.net_command_sender, *net_command_pub);
 
   // Finish building the diagram
   auto owned_diagram = builder.Build();
@@ -138,7 +107,7 @@ int do_main(int argc, char* argv[]) {
   // Run lcm-driven simulation
   systems::LcmDrivenLoop<dairlib::lcmt_robot_input,
                          dairlib::lcmt_controller_switch> loop
-      (&lcm_local,
+      (lcm_local.get(),
        std::move(owned_diagram),
        command_receiver,
        input_channels,
@@ -1,3 +1,4 @@
+#include <functional>
 #include <memory>
 
 #include <gflags/gflags.h>
@@ -7,7 +8,9 @@
 #include "dairlib/lcmt_cassie_out.hpp"
 #include "examples/Cassie/cassie_fixed_point_solver.h"
 #include "examples/Cassie/cassie_utils.h"
+#include "lcm/shm_lcm.h"
 #include "multibody/multibody_utils.h"
+#include "systems/framework/lcm_lockstep.h"
 #include "systems/primitives/subvector_pass_through.h"
 #include "systems/robot_lcm_systems.h"
 
@@ -33,6 +36,8 @@ using drake::systems::DiagramBuilder;
 using drake::systems::Simulator;
 using drake::systems::lcm::LcmPublisherSystem;
 using drake::systems::lcm::LcmSubscriberSystem;
+using drake::systems::lcm::TriggerTypeSet;
+using drake::systems::TriggerType;
 
 using drake::math::RotationMatrix;
 using Eigen::Matrix3d;
@@ -62,6 +67,20 @@ DEFINE_double(init_height, .7,
               "Initial starting height of the pelvis above "
               "ground");
 DEFINE_bool(spring_model, true, "Use a URDF with or without legs springs");
+DEFINE_string(lcm_url, "",
+              "LCM URL for the robot's messages, e.g. shm://cassie to use "
+              "shared memory. Empty for LCM_DEFAULT_URL or LCM's default.");
+DEFINE_string(lockstep_channel, "",
+              "Channel on which the controller acknowledges each state "
+              "message (its --lockstep_channel). If set, the simulation runs "
+              "in lockstep with the controller, as fast as both can compute: "
+              "it publishes the state every 1/publish_rate seconds of "
+              "simulation time, and waits for the controller's command for "
+              "that state before it advances. target_realtime_rate is then "
+              "ignored. Empty to run against the wall clock.");
+DEFINE_double(lockstep_timeout, 10,
+              "Seconds to wait for an acknowledgement in lockstep before "
+              "giving up. 0 to wait forever.");
 
 int do_main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
@@ -92,7 +111,9 @@ int do_main(int argc, char* argv[]) {
   plant.set_stiction_tolerance(FLAGS_v_stiction);
 
   // Create lcm systems.
-  auto lcm = builder.AddSystem<drake::systems::lcm::LcmInterfaceSystem>();
+  auto lcm_interface = MakeLcmInterface(FLAGS_lcm_url);
+  auto lcm = builder.AddSystem<drake::systems::lcm::LcmInterfaceSystem>(
+      lcm_interface.get());
   auto input_sub =
       builder.AddSystem(LcmSubscriberSystem::Make<dairlib::lcmt_robot_input>(
           "CASSIE_INPUT", lcm));
@@ -100,9 +121,18 @@ int do_main(int argc, char* argv[]) {
   auto passthrough = builder.AddSystem<SubvectorPassThrough>(
       input_receiver->get_output_port(0).size(), 0,
       plant.get_actuation_input_port().size());
+  // In lockstep, the state is published by the loop below
+  const bool lockstep = !FLAGS_lockstep_channel.empty();
   auto state_pub =
-      builder.AddSystem(LcmPublisherSystem::Make<dairlib::lcmt_robot_output>(
-          "CASSIE_STATE_SIMULATION", lcm, 1.0 / FLAGS_publish_rate));
+      lockstep
+          ? builder.AddSystem(
+                LcmPublisherSystem::Make<dairlib::lcmt_robot_output>(
+                    "CASSIE_STATE_SIMULATION", lcm,
+                    TriggerTypeSet({TriggerType::kForced})))
+          : builder.AddSystem(
+                LcmPublisherSystem::Make<dairlib::lcmt_robot_output>(
+                    "CASSIE_STATE_SIMULATION", lcm,
+                    1.0 / FLAGS_publish_rate));
   auto state_sender = builder.AddSystem<systems::RobotOutputSender>(plant);
 
   // Contact Information
@@ -188,9 +218,37 @@ int do_main(int argc, char* argv[]) {
 
   simulator.set_publish_every_time_step(false);
   simulator.set_publish_at_initialization(false);
-  simulator.set_target_realtime_rate(FLAGS_target_realtime_rate);
+  if (!lockstep) {
+    simulator.set_target_realtime_rate(FLAGS_target_realtime_rate);
+    simulator.Initialize();
+    simulator.AdvanceTo(FLAGS_end_time);
+    return 0;
+  }
+
+  // Lockstep: publish the state, wait until the controller has sent its
+  // command for it, then advance by one publish period with that command
+  systems::LcmLockstep lockstep_sync(lcm_interface.get(),
+                                     FLAGS_lockstep_channel,
+                                     FLAGS_lockstep_timeout);
   simulator.Initialize();
-  simulator.AdvanceTo(FLAGS_end_time);
+  const Context<double>& state_pub_context =
+      diagram->GetSubsystemContext(*state_pub, simulator.get_context());
+  const Context<double>& state_sender_context =
+      diagram->GetSubsystemContext(*state_sender, simulator.get_context());
+  auto publish_state = [&]() { state_pub->Publish(state_pub_context); };
+  const double period = 1.0 / FLAGS_publish_rate;
+  for (int64_t i = 0; i * period <= FLAGS_end_time; i++) {
+    simulator.AdvanceTo(i * period);
+    publish_state();
+    const int64_t utime = state_sender->get_output_port(0)
+                              .Eval<dairlib::lcmt_robot_output>(
+                                  state_sender_context)
+                              .utime;
+    // The controller may not be listening yet when the first state is sent
+    lockstep_sync.WaitForAck(utime,
+                             (i == 0) ? std::function<void()>(publish_state)
+                                      : std::function<void()>());
+  }
 
   return 0;
 }
@@ -1,6 +1,10 @@
 #include "examples/Cassie/networking/cassie_udp_subscriber.h"
 #include <poll.h>
-#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <array>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <utility>
@@ -25,19 +29,39 @@ using std::make_unique;
 
 using std::chrono::duration_cast;
 using std::chrono::steady_clock;
-using std::chrono::microseconds;
 
 namespace {
 constexpr int kStateIndexMessage = 0;
 constexpr int kStateIndexMessageCount = 1;
 constexpr int kStateIndexMessageUTime = 2;
+
+// Packets are a two byte header followed by the message
+constexpr int kPacketSize = 2 + CASSIE_OUT_T_LEN;
+
+// How often the polling thread checks whether to stop, when not busy polling
+constexpr int kPollTimeoutMs = 100;
+
+int64_t ClockNs(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+int64_t SteadyNs() {
+  return duration_cast<std::chrono::nanoseconds>(
+             steady_clock::now().time_since_epoch())
+      .count();
+}
 }  // namespace
 
 CassieUDPSubscriber::CassieUDPSubscriber(const std::string& address,
-    const int port)
+    const int port, const CassieUDPReceiveOptions& options)
     : address_(address),
       port_(port),
+      options_(options),
+      ring_(options.ring_capacity),
       serializer_(std::move(make_unique<CassieUDPOutSerializer>())) {
+  DRAKE_DEMAND(options.batch_size > 0);
 
   // Creating socket file descriptor
   socket_ = socket(AF_INET, SOCK_DGRAM, 0);
@@ -55,6 +79,17 @@ CassieUDPSubscriber::CassieUDPSubscriber(const std::string& address,
       sizeof(server_address_)) >= 0);
   std::cout << "Bound socket!" << std::endl;
 
+  // Kernel receive timestamps, as a control message with each packet
+  const int enable = 1;
+  DRAKE_THROW_UNLESS(setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMPNS, &enable,
+                                sizeof(enable)) == 0);
+  if (options.socket_busy_poll_us > 0 &&
+      setsockopt(socket_, SOL_SOCKET, SO_BUSY_POLL,
+                 &options.socket_busy_poll_us,
+                 sizeof(options.socket_busy_poll_us)) != 0) {
+    drake::log()->warn("CassieUDPSubscriber: unable to set SO_BUSY_POLL");
+  }
+
   // Use the "advanced" method to construct explicit non-member functors
   // to deal with the unusual methods we have available.
   DeclareAbstractOutputPort(
@@ -75,53 +110,110 @@ CassieUDPSubscriber::CassieUDPSubscriber(const std::string& address,
 
 
   keep_polling_ = true;
-  
+  start_ns_ = SteadyNs();
+
   set_name(make_name(address, port));
   std::cout << "Starting polling thread!" << std::endl;
-  polling_thread_ = std::thread(&CassieUDPSubscriber::Poll, this,
-      [this](const void* buffer, int size) {
-        this->HandleMessage(buffer, size);
-      });
-
-  start_ = steady_clock::now();
+  polling_thread_ = std::thread(&CassieUDPSubscriber::Poll, this);
 }
 
 CassieUDPSubscriber::~CassieUDPSubscriber() {
+  StopPolling();
   polling_thread_.join();
+  close(socket_);
 }
 
 void CassieUDPSubscriber::StopPolling() {
   keep_polling_ = false;
 }
 
-void CassieUDPSubscriber::Poll(HandlerFunction handler) {
-  // Create cassie input/output structs
-  char receive_buffer[2 + CASSIE_OUT_T_LEN];
-
-  ssize_t des_len = (sizeof receive_buffer);
+void CassieUDPSubscriber::Poll() {
+  // Receive buffers for a batch of packets, each one byte longer than a valid
+  // packet so that longer packets are detected (with MSG_TRUNC)
+  const int batch_size = options_.batch_size;
+  std::vector<std::array<uint8_t, kPacketSize + 1>> buffers(batch_size);
+  std::vector<std::array<uint8_t, CMSG_SPACE(sizeof(struct timespec))>>
+      controls(batch_size);
+  std::vector<struct iovec> iovecs(batch_size);
+  std::vector<struct mmsghdr> headers(batch_size);
+  for (int i = 0; i < batch_size; i++) {
+    iovecs[i].iov_base = buffers[i].data();
+    iovecs[i].iov_len = buffers[i].size();
+    memset(&headers[i], 0, sizeof(headers[i]));
+    headers[i].msg_hdr.msg_iov = &iovecs[i];
+    headers[i].msg_hdr.msg_iovlen = 1;
+    headers[i].msg_hdr.msg_control = controls[i].data();
+  }
 
-  // Poll for a new packet of the correct length
-  ssize_t nbytes = 0;
   struct pollfd fd = {.fd = socket_, .events = POLLIN, .revents = 0};
   while (keep_polling_) {
-    do {
-        poll(&fd, 1, -1);
-        // Get newest valid packet in RX buffer
-        // Does not use sequence number for determining newest packet
-        ioctl(socket_, FIONREAD, &nbytes);
-        if (des_len <= nbytes) {
-          nbytes = recv(socket_, receive_buffer, des_len, 0);
-        } else {
-          recv(socket_, receive_buffer, 0, 0);  // Discard packet
+    if (!options_.busy_poll && poll(&fd, 1, kPollTimeoutMs) <= 0) {
+      continue;
+    }
+    for (int i = 0; i < batch_size; i++) {
+      headers[i].msg_hdr.msg_controllen = controls[i].size();
+      headers[i].msg_hdr.msg_flags = 0;
+    }
+    const int num_received =
+        recvmmsg(socket_, headers.data(), batch_size, MSG_DONTWAIT, nullptr);
+    if (num_received <= 0) {
+      continue;
+    }
+
+    // Offset from the kernel's (realtime) timestamps to the steady clock
+    const int64_t realtime_to_steady = SteadyNs() - ClockNs(CLOCK_REALTIME);
+    const int64_t now = SteadyNs();
+
+    int count = received_message_count_.load(std::memory_order_relaxed);
+    for (int i = 0; i < num_received; i++) {
+      // Discard packets of the wrong length
+      if (static_cast<int>(headers[i].msg_len) != kPacketSize ||
+          (headers[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+        continue;
+      }
+      bool dropped;
+      Sample* sample = ring_.BeginPushOverwrite(&dropped);
+      if (dropped) {
+        num_dropped_++;
+      }
+      if (sample == nullptr) {
+        num_dropped_++;
+        continue;
+      }
+      sample->receive_ns = now;
+      for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&headers[i].msg_hdr);
+           cmsg != nullptr; cmsg = CMSG_NXTHDR(&headers[i].msg_hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET &&
+            cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+          struct timespec ts;
+          memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+          sample->receive_ns = static_cast<int64_t>(ts.tv_sec) * 1000000000 +
+                               ts.tv_nsec + realtime_to_steady;
         }
-    } while (des_len != nbytes);
-
-    // Split header and data
-    const void *data_in =
-      reinterpret_cast<const unsigned char *>(&receive_buffer[2]);
+      }
+      // Split header and data
+      unpack_cassie_out_t(&buffers[i][2], &sample->message);
+      sample->count = ++count;
+      ring_.CommitPush();
+    }
+
+    // Wake the consumer, once per batch. The consumer sets consumer_waiting_
+    // before checking the count, and both are sequentially consistent, so
+    // either it sees the new count or this sees it waiting.
+    received_message_count_ = count;
+    if (consumer_waiting_) {
+      std::lock_guard<std::mutex> lock(wait_mutex_);
+      wait_condition_variable_.notify_all();
+    }
+  }
+}
 
-    handler(data_in, nbytes - 2);
+const CassieUDPSubscriber::Sample* CassieUDPSubscriber::LatestSample() const {
+  if (ring_.PopLatest(&latest_sample_)) {
+    latest_receive_ns_ = latest_sample_.receive_ns;
   }
+  // Counts start at one
+  return latest_sample_.count > 0 ? &latest_sample_ : nullptr;
 }
 
 void CassieUDPSubscriber::CopyLatestMessageInto(State<double>* state) const {
@@ -135,18 +227,16 @@ int CassieUDPSubscriber::get_message_utime(
 
 void CassieUDPSubscriber::ProcessMessageAndStoreToAbstractState(
     AbstractValues* abstract_state) const {
-  std::lock_guard<std::mutex> lock(received_message_mutex_);
-  if (!received_message_.empty()) {
-    serializer_->Deserialize(
-        received_message_.data(), received_message_.size(),
-        &abstract_state->get_mutable_value(kStateIndexMessage));
+  const Sample* sample = LatestSample();
+  if (sample == nullptr) {
+    return;
   }
+  abstract_state->get_mutable_value(kStateIndexMessage)
+      .get_mutable_value<cassie_out_t>() = sample->message;
   abstract_state->get_mutable_value(kStateIndexMessageCount)
-      .get_mutable_value<int>() = received_message_count_;
-  auto t = duration_cast<microseconds>(steady_clock::now() - start_);
+      .get_mutable_value<int>() = sample->count;
   abstract_state->get_mutable_value(kStateIndexMessageUTime)
-      .get_mutable_value<int>() = t.count();
-  // std::cout << "time: " << t.count() << std::endl;
+      .get_mutable_value<int>() = (sample->receive_ns - start_ns_) / 1000;
 }
 
 int CassieUDPSubscriber::GetMessageCount(const Context<double>& context) const {
@@ -164,11 +254,7 @@ void CassieUDPSubscriber::DoCalcNextUpdateTime(
 
   // Do nothing unless we have a new message.
   const int last_message_count = GetMessageCount(context);
-  const int received_message_count = [this]() {
-    std::unique_lock<std::mutex> lock(received_message_mutex_);
-    return received_message_count_;
-  }();
-  if (last_message_count == received_message_count) {
+  if (last_message_count == received_message_count_.load()) {
     return;
   }
   // Schedule an update event at the current time.
@@ -196,48 +282,31 @@ void CassieUDPSubscriber::CalcSerializerOutputValue(
       context.get_abstract_state().get_value(kStateIndexMessage));
 }
 
-void CassieUDPSubscriber::HandleMessage(const void* buffer, int size) {
-  SPDLOG_TRACE(drake::log(), "Receiving CASSIE message");
-  // std::cout << "Handling message!" << std::endl;
-
-  const uint8_t* const rbuf_begin = static_cast<const uint8_t*>(buffer);
-  const uint8_t* const rbuf_end = rbuf_begin + size;
-  std::lock_guard<std::mutex> lock(received_message_mutex_);
-  received_message_.clear();
-  received_message_.insert(received_message_.begin(), rbuf_begin, rbuf_end);
-  received_message_count_++;
-  received_message_condition_variable_.notify_all();
-}
-
 int CassieUDPSubscriber::WaitForMessage(
     int old_message_count, AbstractValue* message) const {
-  // std::cout << "Waiting for message...";
-  // The message buffer and counter are updated in HandleMessage(), which is
-  // a callback function invoked by a different thread owned by the
-  // drake::lcm::DrakeLcmInterface instance passed to the constructor. Thus,
-  // for thread safety, these need to be properly protected by a mutex.
-  std::unique_lock<std::mutex> lock(received_message_mutex_);
-
-  // This while loop is necessary to guard for spurious wakeup:
-  // https://en.wikipedia.org/wiki/Spurious_wakeup
-  while (old_message_count >= received_message_count_) {
-    // When wait returns, lock is atomically acquired. So it's thread safe to
-    // read received_message_count_.
-    received_message_condition_variable_.wait(lock);
+  if (options_.busy_poll) {
+    while (received_message_count_.load() <= old_message_count) {
+    }
+  } else if (received_message_count_.load() <= old_message_count) {
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    consumer_waiting_ = true;
+    // This while loop is necessary to guard for spurious wakeup:
+    // https://en.wikipedia.org/wiki/Spurious_wakeup
+    while (received_message_count_.load() <= old_message_count) {
+      wait_condition_variable_.wait(lock);
+    }
+    consumer_waiting_ = false;
   }
-  int new_message_count = received_message_count_;
+
+  const Sample* sample = LatestSample();
   if (message) {
-      serializer_->Deserialize(
-          received_message_.data(), received_message_.size(), message);
+    message->get_mutable_value<cassie_out_t>() = sample->message;
   }
-  lock.unlock();
-  // std::cout << "received!" << std::endl;
-  return new_message_count;
+  return sample->count;
 }
 
 int CassieUDPSubscriber::GetInternalMessageCount() const {
-  std::unique_lock<std::mutex> lock(received_message_mutex_);
-  return received_message_count_;
+  return received_message_count_.load();
 }
 
 }  // namespace systems
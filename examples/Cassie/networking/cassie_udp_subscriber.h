@@ -5,6 +5,7 @@
 #include <arpa/inet.h>
 #include <netinet/in.h>
 
+#include <atomic>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -16,10 +17,27 @@
 #include "drake/common/drake_deprecated.h"
 #include "drake/common/drake_throw.h"
 #include "drake/systems/framework/leaf_system.h"
+#include "examples/Cassie/datatypes/cassie_out_t.h"
 #include "examples/Cassie/networking/udp_serializer.h"
+#include "systems/framework/spsc_ring.h"
 
 namespace dairlib {
 namespace systems {
+
+/// Options for the receive path of CassieUDPSubscriber
+struct CassieUDPReceiveOptions {
+  /// Spin on the socket and, in WaitForMessage(), on the ring, rather than
+  /// sleeping. Lowest latency, but each spinning thread needs its own core.
+  bool busy_poll = false;
+  /// If positive, SO_BUSY_POLL time (in microseconds) for the socket, so
+  /// that the kernel polls the device queue in blocking receives
+  int socket_busy_poll_us = 0;
+  /// Capacity of the ring, a power of two
+  int ring_capacity = 16;
+  /// Maximum number of packets read by one recvmmsg call
+  int batch_size = 8;
+};
+
 /**
  * AS OF 5-17-2019, THIS CLASS IS DEPRECATED
  *
@@ -37,19 +55,21 @@ namespace systems {
  * all these operations are taken care of by the Simulator. On the other hand,
  * the user needs to manually replicate this process without the Simulator.
  *
+ * Messages are received by a polling thread, which reads packets in batches
+ * with recvmmsg and unpacks each one directly into a preallocated slot of a
+ * lock-free single-producer, single-consumer ring. The consumer (the thread
+ * calling WaitForMessage() or the update methods, which must be a single
+ * thread) always takes the newest message, without locks on the receive path.
+ * Each message carries the kernel's receive timestamp (SO_TIMESTAMPNS), which
+ * is used as its time (see get_message_utime()). When packets arrive while the
+ * ring is full, i.e. while the consumer is stalled, the oldest ones are
+ * dropped and counted, so the consumer resumes with the newest message.
+ *
  * @ingroup message_passing
  */
 class CassieUDPSubscriber : public drake::systems::LeafSystem<double> {
-  /**
-   * A callback used by Poll(), with arguments:
-   * - `message_buffer` A pointer to the byte vector that is the serial
-   *   representation of the UDP message.
-   * - `message_size` The size of `message_buffer`.
-   */
-  using HandlerFunction = std::function<void(const void*, int)>;
-
-
  public:
+
   DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(CassieUDPSubscriber)
 
   /**
@@ -60,9 +80,10 @@ class CassieUDPSubscriber : public drake::systems::LeafSystem<double> {
    * @param port the port to listen on
    */
   static std::unique_ptr<CassieUDPSubscriber> Make(const std::string& address,
-      const int port) {
+      const int port,
+      const CassieUDPReceiveOptions& options = CassieUDPReceiveOptions{}) {
     return std::make_unique<CassieUDPSubscriber>(
-        address, port);
+        address, port, options);
   }
 
   /**
@@ -72,17 +93,17 @@ class CassieUDPSubscriber : public drake::systems::LeafSystem<double> {
    * @param address the IP address to subscribe to
    *
    * @param port the port to listen on
+   *
+   * @param options see CassieUDPReceiveOptions
    */
-  CassieUDPSubscriber(const std::string& address, const int port);
+  CassieUDPSubscriber(
+      const std::string& address, const int port,
+      const CassieUDPReceiveOptions& options = CassieUDPReceiveOptions{});
 
   ~CassieUDPSubscriber() override;
 
   void StopPolling();
 
-  /// Main polling function.
-  /// @param handler for handling received messages
-  void Poll(HandlerFunction handler);
-
   /// Returns the sole output port.
   const drake::systems::OutputPort<double>& get_output_port() const {
     DRAKE_THROW_UNLESS(this->num_output_ports() == 1);
@@ -95,12 +116,21 @@ class CassieUDPSubscriber : public drake::systems::LeafSystem<double> {
   // This system has no input ports.
   void get_input_port(int) = delete;
 
-  // Gets the last time, in microseconds, of the most recently received message
+  // Gets the time, in microseconds, at which the kernel received the most
+  // recently processed message.
   // Counts from the time this subscriber was initialized, which seems
   // safe because there should only ever be one such subscriber in a process
   // Needed for UDPDrivenLoop
   int get_message_utime(const drake::systems::Context<double>& context) const;
 
+  /// Steady clock time, in nanoseconds since its epoch, at which the kernel
+  /// received the message most recently returned by WaitForMessage() or
+  /// stored in a State, for comparison with LoopTimer::Now()
+  int64_t GetLatestReceiveTimeNs() const { return latest_receive_ns_; }
+
+  /// Number of packets dropped, oldest first, because the ring was full
+  int64_t GetNumDroppedMessages() const { return num_dropped_.load(); }
+
   /**
    * Blocks the caller until its internal message count exceeds
    * `old_message_count`.
@@ -143,11 +173,22 @@ class CassieUDPSubscriber : public drake::systems::LeafSystem<double> {
   }
 
  private:
+  // A received message, in a slot of the ring
+  struct Sample {
+    cassie_out_t message;
+    int count;
+    int64_t receive_ns;
+  };
+
   void ProcessMessageAndStoreToAbstractState(
       drake::systems::AbstractValues* abstract_state) const;
 
-  // Callback entry point from LCM into this class.
-  void HandleMessage(const void*, int);
+  // Entry point of the polling thread
+  void Poll();
+
+  // (Consumer) Takes the newest sample out of the ring, if any arrived since
+  // the last call, and returns it, or nullptr if none has ever arrived
+  const Sample* LatestSample() const;
 
   std::string make_name(const std::string& address, const int port);
 
@@ -164,17 +205,23 @@ class CassieUDPSubscriber : public drake::systems::LeafSystem<double> {
   // The port on which to receive messages
   const int port_;
 
-  // The mutex that guards received_message_ and received_message_count_.
-  mutable std::mutex received_message_mutex_;
+  const CassieUDPReceiveOptions options_;
 
-  // A condition variable that's signaled every time the handler is called.
-  mutable std::condition_variable received_message_condition_variable_;
+  // Messages from the polling thread to the consumer, and the consumer's copy
+  // of the newest one
+  mutable SpscRing<Sample> ring_;
+  mutable Sample latest_sample_{};
 
-  // The bytes of the most recently received LCM message.
-  std::vector<uint8_t> received_message_;
+  // A message counter that's incremented every time a message is pushed.
+  std::atomic<int> received_message_count_{0};
+  std::atomic<int64_t> num_dropped_{0};
+  mutable int64_t latest_receive_ns_{0};
 
-  // A message counter that's incremented every time the handler is called.
-  int received_message_count_{0};
+  // Used to sleep in WaitForMessage(), unless busy polling. The polling thread
+  // only takes the mutex to notify, when the consumer is waiting.
+  mutable std::mutex wait_mutex_;
+  mutable std::condition_variable wait_condition_variable_;
+  mutable std::atomic<bool> consumer_waiting_{false};
 
   int socket_;
   struct sockaddr_in server_address_;
@@ -182,9 +229,10 @@ class CassieUDPSubscriber : public drake::systems::LeafSystem<double> {
 
   const std::unique_ptr<CassieUDPOutSerializer> serializer_;
 
-  std::chrono::time_point<std::chrono::steady_clock> start_;
+  // Steady clock time at construction, in nanoseconds
+  int64_t start_ns_;
 
-  bool keep_polling_;
+  std::atomic<bool> keep_polling_;
 };
 
 }  // namespace systems
@@ -0,0 +1,93 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "examples/Cassie/networking/cassie_udp_subscriber.h"
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+class CassieUDPSubscriberOverflowTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(socket_, 0);
+    // A free port, found by binding to port zero
+    memset(&address_, 0, sizeof(address_));
+    address_.sin_family = AF_INET;
+    inet_aton("127.0.0.1", &address_.sin_addr);
+    address_.sin_port = 0;
+    ASSERT_EQ(bind(socket_, reinterpret_cast<sockaddr*>(&address_),
+                   sizeof(address_)), 0);
+    socklen_t size = sizeof(address_);
+    ASSERT_EQ(getsockname(socket_, reinterpret_cast<sockaddr*>(&address_),
+                          &size), 0);
+    close(socket_);
+    socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(socket_, 0);
+  }
+
+  void TearDown() override { close(socket_); }
+
+  int port() const { return ntohs(address_.sin_port); }
+
+  // Sends a packet whose message is marked with `id`
+  void Send(int id) {
+    cassie_out_t message{};
+    message.leftLeg.kneeDrive.position = id;
+    unsigned char packet[2 + CASSIE_OUT_T_LEN] = {};
+    pack_cassie_out_t(&message, &packet[2]);
+    ASSERT_EQ(sendto(socket_, packet, sizeof(packet), 0,
+                     reinterpret_cast<sockaddr*>(&address_),
+                     sizeof(address_)),
+              static_cast<ssize_t>(sizeof(packet)));
+  }
+
+  // Waits for the subscriber's polling thread to receive `count` packets
+  static void WaitForCount(const CassieUDPSubscriber& subscriber, int count) {
+    for (int i = 0; i < 5000 && subscriber.GetInternalMessageCount() < count;
+         i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(subscriber.GetInternalMessageCount(), count);
+  }
+
+  int socket_;
+  sockaddr_in address_;
+};
+
+TEST_F(CassieUDPSubscriberOverflowTest, KeepsNewestWhenRingIsFull) {
+  CassieUDPReceiveOptions options;
+  options.ring_capacity = 4;
+  CassieUDPSubscriber subscriber("127.0.0.1", port(), options);
+
+  // Nothing reads the ring while ten packets arrive, so the six oldest are
+  // dropped
+  for (int i = 1; i <= 10; i++) {
+    Send(i);
+  }
+  WaitForCount(subscriber, 10);
+  drake::Value<cassie_out_t> message;
+  EXPECT_EQ(subscriber.WaitForMessage(0, &message), 10);
+  EXPECT_EQ(message.get_value().leftLeg.kneeDrive.position, 10);
+  EXPECT_EQ(subscriber.GetNumDroppedMessages(), 6);
+
+  // Packets which fit are not dropped
+  Send(11);
+  Send(12);
+  WaitForCount(subscriber, 12);
+  EXPECT_EQ(subscriber.WaitForMessage(10, &message), 12);
+  EXPECT_EQ(message.get_value().leftLeg.kneeDrive.position, 12);
+  EXPECT_EQ(subscriber.GetNumDroppedMessages(), 6);
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
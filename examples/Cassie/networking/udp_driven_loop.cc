@@ -1,5 +1,7 @@
 #include "examples/Cassie/networking/udp_driven_loop.h"
 
+#include <string>
+
 namespace dairlib {
 namespace systems {
 
@@ -11,11 +13,20 @@ using drake::systems::CompositeEventCollection;
 using drake::systems::Simulator;
 using drake::AbstractValue;
 
+namespace {
+
+std::string LoopName(const System<double>& system) {
+  return system.get_name().empty() ? "udp driven loop" : system.get_name();
+}
+
+}  // namespace
+
 UDPDrivenLoop::UDPDrivenLoop(
     const System<double>& system, const CassieUDPSubscriber& driving_subscriber,
     std::unique_ptr<Context<double>> context)
     : system_(system),
       driving_sub_(driving_subscriber),
+      timer_(LoopName(system)),
       stepper_(
           std::make_unique<Simulator<double>>(system_, std::move(context))) {
   // Allocates extra context and output just for the driving subscriber, so
@@ -49,19 +60,33 @@ const AbstractValue& UDPDrivenLoop::WaitForMessage() {
 void UDPDrivenLoop::RunToSecondsAssumingInitialized(double stop_time) {
   double msg_time;
 
+  if (realtime_options_.enabled()) {
+    ApplyRealtimeOptions(realtime_options_);
+    LogWakeupLatency(LoopName(system_),
+                     MeasureWakeupLatency(realtime_options_.latency_samples,
+                                          realtime_options_.latency_period,
+                                          realtime_options_.spin_wait));
+  }
+  if (realtime_options_.prefault) {
+    PrefaultSystem(system_, stepper_->get_context());
+  }
+
   while (true) {
     // std::cout << "UDPDrivenLoop::WaitForMessage." << std::endl;
     WaitForMessage();
     msg_time = driving_sub_.get_message_utime(*sub_context_)/1.0e6;
     if (msg_time >= stop_time) break;
+    timer_.BeginIteration(driving_sub_.GetLatestReceiveTimeNs());
     // std::cout << "UDPDrivenLoop::Starting step." << std::endl;
     stepper_->AdvanceTo(msg_time);
+    timer_.MarkAdvanceEnd();
     // std::cout << "UDPDrivenLoop::Starting publish" << std::endl; 
     // Explicitly publish after we are done with all the intermediate
     // computation.
     if (publish_on_every_received_message_) {
       system_.Publish(stepper_->get_context());
     }
+    timer_.EndIteration();
   }
 }
 
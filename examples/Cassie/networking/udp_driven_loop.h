@@ -7,6 +7,8 @@
 #include "drake/systems/analysis/simulator.h"
 #include "examples/Cassie/networking/cassie_udp_subscriber.h"
 #include "examples/Cassie/networking/udp_driven_loop.h"
+#include "systems/framework/loop_timing.h"
+#include "systems/framework/realtime.h"
 
 namespace dairlib {
 namespace systems {
@@ -110,6 +112,25 @@ class UDPDrivenLoop {
     publish_on_every_received_message_ = flag;
   }
 
+  /**
+   * Runs RunToSecondsAssumingInitialized() in real-time mode. The scheduler,
+   * affinity and memory settings are applied to the thread which calls it,
+   * the wake-up latency they achieve is measured and logged, and, with
+   * prefault, the system is run once on a copy of the context before the loop
+   * goes live. Whether the loop spins is decided by the subscriber's
+   * CassieUDPReceiveOptions::busy_poll, so spin_wait only selects how the
+   * latency is measured.
+   */
+  void EnableRealtime(const RealtimeOptions& options) {
+    realtime_options_ = options;
+  }
+
+  /**
+   * Times every iteration from the kernel's receive timestamp of the driving
+   * packet, so receive_to_start is the loop's achieved wake-up latency.
+   */
+  LoopTimer& get_timer() { return timer_; }
+
   /**
    * Returns a mutable reference to the context.
    */
@@ -127,6 +148,9 @@ class UDPDrivenLoop {
   // If true, explicitly calls system_.Publish() after every step in the loop.
   bool publish_on_every_received_message_{true};
 
+  RealtimeOptions realtime_options_;
+  LoopTimer timer_;
+
   // Reusing the simulator to manage event handling and state progression.
   std::unique_ptr<drake::systems::Simulator<double>> stepper_;
 
@@ -0,0 +1,369 @@
+#include "examples/Cassie/osc/osc_walking_controller.h"
+
+#include <utility>
+
+#include "examples/Cassie/cassie_utils.h"
+#include "examples/Cassie/osc/deviation_from_cp.h"
+#include "examples/Cassie/osc/heading_traj_generator.h"
+#include "examples/Cassie/osc/high_level_command.h"
+#include "examples/Cassie/simulator_drift.h"
+#include "systems/controllers/cp_traj_gen.h"
+#include "systems/controllers/lipm_traj_gen.h"
+#include "systems/controllers/time_based_fsm.h"
+
+#include "drake/systems/framework/diagram_builder.h"
+
+namespace dairlib {
+namespace cassie {
+namespace osc {
+
+using std::vector;
+
+using Eigen::Matrix3d;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+
+using drake::multibody::Frame;
+using drake::multibody::MultibodyPlant;
+using drake::systems::DiagramBuilder;
+
+using multibody::DistanceEvaluator;
+using multibody::KinematicEvaluatorSet;
+using multibody::WorldPointEvaluator;
+using systems::controllers::ComTrackingData;
+using systems::controllers::JointSpaceTrackingData;
+using systems::controllers::OperationalSpaceControl;
+using systems::controllers::RotTaskSpaceTrackingData;
+using systems::controllers::TransTaskSpaceTrackingData;
+
+OscWalkingController::OscWalkingController(
+    const MultibodyPlant<double>& plant_w_spr,
+    const MultibodyPlant<double>& plant_wo_spr,
+    const OscWalkingControllerOptions& options)
+    : context_w_spr_(plant_w_spr.CreateDefaultContext()),
+      context_wo_spr_(plant_wo_spr.CreateDefaultContext()) {
+  DiagramBuilder<double> builder;
+
+  // Get contact frames and position (doesn't matter whether we use
+  // plant_w_spr or plant_wo_spr because the contact frames exit in both
+  // plants)
+  auto left_toe = LeftToeFront(plant_w_spr);
+  auto left_heel = LeftToeRear(plant_w_spr);
+  auto right_toe = RightToeFront(plant_w_spr);
+  auto right_heel = RightToeRear(plant_w_spr);
+
+  // Get body frames and points
+  Vector3d mid_contact_point = (left_toe.first + left_heel.first) / 2;
+  auto left_toe_mid = std::pair<const Vector3d, const Frame<double>&>(
+      mid_contact_point, plant_w_spr.GetFrameByName("toe_left"));
+  auto right_toe_mid = std::pair<const Vector3d, const Frame<double>&>(
+      mid_contact_point, plant_w_spr.GetFrameByName("toe_right"));
+  auto left_toe_origin = std::pair<const Vector3d, const Frame<double>&>(
+      Vector3d::Zero(), plant_w_spr.GetFrameByName("toe_left"));
+  auto right_toe_origin = std::pair<const Vector3d, const Frame<double>&>(
+      Vector3d::Zero(), plant_w_spr.GetFrameByName("toe_right"));
+
+  // Add emulator for floating base drift
+  Eigen::VectorXd drift_mean =
+      Eigen::VectorXd::Zero(plant_w_spr.num_positions());
+  Eigen::MatrixXd drift_cov = Eigen::MatrixXd::Zero(
+      plant_w_spr.num_positions(), plant_w_spr.num_positions());
+  drift_cov(4, 4) = options.drift_rate;  // x
+  drift_cov(5, 5) = options.drift_rate;  // y
+  drift_cov(6, 6) = options.drift_rate;  // z
+  // Note that we didn't add drift to yaw angle here because it requires
+  // changing SimulatorDrift.
+
+  auto simulator_drift =
+      builder.AddSystem<SimulatorDrift>(plant_w_spr, drift_mean, drift_cov);
+  state_port_ = builder.ExportInput(simulator_drift->get_input_port_state(),
+                                    "x, u, t");
+
+  // Create human high-level control
+  Eigen::Vector2d global_target_position(1, 0);
+  Eigen::Vector2d params_of_no_turning(5, 1);
+  // Logistic function 1/(1+5*exp(x-1))
+  // The function ouputs 0.0007 when x = 0
+  //                     0.5    when x = 1
+  //                     0.9993 when x = 2
+  auto high_level_command = builder.AddSystem<HighLevelCommand>(
+      plant_w_spr, context_w_spr_.get(), global_target_position,
+      params_of_no_turning);
+  builder.ConnectInput(state_port_, high_level_command->get_state_input_port());
+
+  // Create heading traj generator
+  auto head_traj_gen = builder.AddSystem<HeadingTrajGenerator>(
+      plant_w_spr, context_w_spr_.get());
+  builder.Connect(simulator_drift->get_output_port(0),
+                  head_traj_gen->get_state_input_port());
+  builder.Connect(high_level_command->get_yaw_output_port(),
+                  head_traj_gen->get_yaw_input_port());
+
+  // Create finite state machine
+  int left_stance_state = 0;
+  int right_stance_state = 1;
+  int double_support_state = 2;
+  double left_support_duration = 0.35;
+  double right_support_duration = 0.35;
+  double double_support_duration = 0.02;
+  vector<int> fsm_states;
+  vector<double> state_durations;
+  if (options.is_two_phase) {
+    fsm_states = {left_stance_state, right_stance_state};
+    state_durations = {left_support_duration, right_support_duration};
+  } else {
+    fsm_states = {left_stance_state, double_support_state, right_stance_state,
+                  double_support_state};
+    state_durations = {left_support_duration, double_support_duration,
+                       right_support_duration, double_support_duration};
+  }
+  auto fsm = builder.AddSystem<systems::TimeBasedFiniteStateMachine>(
+      plant_w_spr, fsm_states, state_durations);
+  builder.Connect(simulator_drift->get_output_port(0),
+                  fsm->get_input_port_state());
+
+  // Create CoM trajectory generator
+  double desired_com_height = 0.89;
+  vector<int> unordered_fsm_states;
+  vector<double> unordered_state_durations;
+  vector<vector<std::pair<const Vector3d, const Frame<double>&>>>
+      contact_points_in_each_state;
+  if (options.is_two_phase) {
+    unordered_fsm_states = {left_stance_state, right_stance_state};
+    unordered_state_durations = {left_support_duration, right_support_duration};
+    contact_points_in_each_state.push_back({left_toe_mid});
+    contact_points_in_each_state.push_back({right_toe_mid});
+  } else {
+    unordered_fsm_states = {left_stance_state, right_stance_state,
+                            double_support_state};
+    unordered_state_durations = {left_support_duration, right_support_duration,
+                                 double_support_duration};
+    contact_points_in_each_state.push_back({left_toe_mid});
+    contact_points_in_each_state.push_back({right_toe_mid});
+    contact_points_in_each_state.push_back({left_toe_mid, right_toe_mid});
+  }
+  auto lipm_traj_generator = builder.AddSystem<systems::LIPMTrajGenerator>(
+      plant_w_spr, context_w_spr_.get(), desired_com_height,
+      unordered_fsm_states, unordered_state_durations,
+      contact_points_in_each_state);
+  builder.Connect(fsm->get_output_port(0),
+                  lipm_traj_generator->get_input_port_fsm());
+  builder.Connect(simulator_drift->get_output_port(0),
+                  lipm_traj_generator->get_input_port_state());
+
+  // Create velocity control by foot placement
+  auto deviation_from_cp = builder.AddSystem<DeviationFromCapturePoint>(
+      plant_w_spr, context_w_spr_.get());
+  builder.Connect(high_level_command->get_xy_output_port(),
+                  deviation_from_cp->get_input_port_des_hor_vel());
+  builder.Connect(simulator_drift->get_output_port(0),
+                  deviation_from_cp->get_input_port_state());
+
+  // Create swing leg trajectory generator (capture point)
+  double mid_foot_height = 0.1;
+  // Since the ground is soft in the simulation, we raise the desired final
+  // foot height by 1 cm. The controller is sensitive to this number, should
+  // tune this every time we change the simulation parameter or when we move
+  // to the hardware testing.
+  // Additionally, implementing a double support phase might mitigate the
+  // instability around state transition.
+  double desired_final_foot_height = 0.01;
+  double desired_final_vertical_foot_velocity = 0;  //-1;
+  double max_CoM_to_CP_dist = 0.4;
+  double cp_offset = 0.06;
+  double center_line_offset = 0.06;
+  vector<int> left_right_support_fsm_states = {left_stance_state,
+                                               right_stance_state};
+  vector<double> left_right_support_state_durations = {left_support_duration,
+                                                       right_support_duration};
+  vector<std::pair<const Vector3d, const Frame<double>&>> left_right_foot = {
+      left_toe_origin, right_toe_origin};
+  auto cp_traj_generator = builder.AddSystem<systems::CPTrajGenerator>(
+      plant_w_spr, context_w_spr_.get(), left_right_support_fsm_states,
+      left_right_support_state_durations, left_right_foot, "pelvis",
+      mid_foot_height, desired_final_foot_height,
+      desired_final_vertical_foot_velocity, max_CoM_to_CP_dist, true, true,
+      true, cp_offset, center_line_offset);
+  builder.Connect(fsm->get_output_port(0),
+                  cp_traj_generator->get_input_port_fsm());
+  builder.Connect(simulator_drift->get_output_port(0),
+                  cp_traj_generator->get_input_port_state());
+  builder.Connect(lipm_traj_generator->get_output_port(0),
+                  cp_traj_generator->get_input_port_com());
+  builder.Connect(deviation_from_cp->get_output_port(0),
+                  cp_traj_generator->get_input_port_fp());
+
+  // Create Operational space control
+  auto osc = builder.AddSystem<OperationalSpaceControl>(
+      plant_w_spr, plant_wo_spr, context_w_spr_.get(), context_wo_spr_.get(),
+      true, options.print_osc /*print_tracking_info*/);
+
+  // Cost
+  int n_v = plant_wo_spr.num_velocities();
+  MatrixXd Q_accel = 2 * MatrixXd::Identity(n_v, n_v);
+  osc->SetAccelerationCostForAllJoints(Q_accel);
+
+  // Distance constraint
+  evaluators_ = std::make_unique<KinematicEvaluatorSet<double>>(plant_wo_spr);
+  left_loop_ = std::make_unique<DistanceEvaluator<double>>(
+      LeftLoopClosureEvaluator(plant_wo_spr));
+  right_loop_ = std::make_unique<DistanceEvaluator<double>>(
+      RightLoopClosureEvaluator(plant_wo_spr));
+  evaluators_->add_evaluator(left_loop_.get());
+  evaluators_->add_evaluator(right_loop_.get());
+  osc->AddKinematicConstraint(evaluators_.get());
+
+  // Soft constraint
+  // w_contact_relax shouldn't be too big, cause we want tracking error to be
+  // important
+  double w_contact_relax = 2000;
+  osc->SetWeightOfSoftContactConstraint(w_contact_relax);
+  // Friction coefficient
+  double mu = 0.4;
+  osc->SetContactFriction(mu);
+  // Add contact points (The position doesn't matter. It's not used in OSC)
+  auto left_toe_evaluator = std::make_unique<WorldPointEvaluator<double>>(
+      plant_wo_spr, left_toe.first, left_toe.second, Matrix3d::Identity(),
+      Vector3d::Zero(), vector<int>({1, 2}));
+  auto left_heel_evaluator = std::make_unique<WorldPointEvaluator<double>>(
+      plant_wo_spr, left_heel.first, left_heel.second, Matrix3d::Identity(),
+      Vector3d::Zero(), vector<int>({0, 1, 2}));
+  auto right_toe_evaluator = std::make_unique<WorldPointEvaluator<double>>(
+      plant_wo_spr, right_toe.first, right_toe.second, Matrix3d::Identity(),
+      Vector3d::Zero(), vector<int>({1, 2}));
+  auto right_heel_evaluator = std::make_unique<WorldPointEvaluator<double>>(
+      plant_wo_spr, right_heel.first, right_heel.second, Matrix3d::Identity(),
+      Vector3d::Zero(), vector<int>({0, 1, 2}));
+  osc->AddStateAndContactPoint(left_stance_state, left_toe_evaluator.get());
+  osc->AddStateAndContactPoint(left_stance_state, left_heel_evaluator.get());
+  osc->AddStateAndContactPoint(right_stance_state, right_toe_evaluator.get());
+  osc->AddStateAndContactPoint(right_stance_state, right_heel_evaluator.get());
+  if (!options.is_two_phase) {
+    osc->AddStateAndContactPoint(double_support_state,
+                                 left_toe_evaluator.get());
+    osc->AddStateAndContactPoint(double_support_state,
+                                 left_heel_evaluator.get());
+    osc->AddStateAndContactPoint(double_support_state,
+                                 right_toe_evaluator.get());
+    osc->AddStateAndContactPoint(double_support_state,
+                                 right_heel_evaluator.get());
+  }
+  contact_evaluators_.push_back(std::move(left_toe_evaluator));
+  contact_evaluators_.push_back(std::move(left_heel_evaluator));
+  contact_evaluators_.push_back(std::move(right_toe_evaluator));
+  contact_evaluators_.push_back(std::move(right_heel_evaluator));
+
+  // Swing foot tracking
+  MatrixXd W_swing_foot = 400 * MatrixXd::Identity(3, 3);
+  MatrixXd K_p_sw_ft = 100 * MatrixXd::Identity(3, 3);
+  MatrixXd K_d_sw_ft = 10 * MatrixXd::Identity(3, 3);
+  auto swing_foot_traj = std::make_unique<TransTaskSpaceTrackingData>(
+      "cp_traj", K_p_sw_ft, K_d_sw_ft, W_swing_foot, plant_w_spr, plant_wo_spr);
+  swing_foot_traj->AddStateAndPointToTrack(left_stance_state, "toe_right");
+  swing_foot_traj->AddStateAndPointToTrack(right_stance_state, "toe_left");
+  osc->AddTrackingData(swing_foot_traj.get());
+  tracking_data_.push_back(std::move(swing_foot_traj));
+  // Center of mass tracking
+  MatrixXd W_com = MatrixXd::Identity(3, 3);
+  W_com(0, 0) = 2;
+  W_com(1, 1) = 2;
+  W_com(2, 2) = 2000;
+  MatrixXd K_p_com = 50 * MatrixXd::Identity(3, 3);
+  MatrixXd K_d_com = 10 * MatrixXd::Identity(3, 3);
+  auto center_of_mass_traj = std::make_unique<ComTrackingData>(
+      "lipm_traj", K_p_com, K_d_com, W_com, plant_w_spr, plant_wo_spr);
+  osc->AddTrackingData(center_of_mass_traj.get());
+  tracking_data_.push_back(std::move(center_of_mass_traj));
+  // Pelvis rotation tracking (pitch and roll)
+  double w_pelvis_balance = 200;
+  double k_p_pelvis_balance = 200;
+  double k_d_pelvis_balance = 80;
+  Matrix3d W_pelvis_balance = MatrixXd::Zero(3, 3);
+  W_pelvis_balance(0, 0) = w_pelvis_balance;
+  W_pelvis_balance(1, 1) = w_pelvis_balance;
+  Matrix3d K_p_pelvis_balance = MatrixXd::Zero(3, 3);
+  K_p_pelvis_balance(0, 0) = k_p_pelvis_balance;
+  K_p_pelvis_balance(1, 1) = k_p_pelvis_balance;
+  Matrix3d K_d_pelvis_balance = MatrixXd::Zero(3, 3);
+  K_d_pelvis_balance(0, 0) = k_d_pelvis_balance;
+  K_d_pelvis_balance(1, 1) = k_d_pelvis_balance;
+  auto pelvis_balance_traj = std::make_unique<RotTaskSpaceTrackingData>(
+      "pelvis_balance_traj", K_p_pelvis_balance, K_d_pelvis_balance,
+      W_pelvis_balance, plant_w_spr, plant_wo_spr);
+  pelvis_balance_traj->AddFrameToTrack("pelvis");
+  osc->AddTrackingData(pelvis_balance_traj.get());
+  tracking_data_.push_back(std::move(pelvis_balance_traj));
+  // Pelvis rotation tracking (yaw)
+  double w_heading = 200;
+  double k_p_heading = 50;
+  double k_d_heading = 40;
+  Matrix3d W_pelvis_heading = MatrixXd::Zero(3, 3);
+  W_pelvis_heading(2, 2) = w_heading;
+  Matrix3d K_p_pelvis_heading = MatrixXd::Zero(3, 3);
+  K_p_pelvis_heading(2, 2) = k_p_heading;
+  Matrix3d K_d_pelvis_heading = MatrixXd::Zero(3, 3);
+  K_d_pelvis_heading(2, 2) = k_d_heading;
+  auto pelvis_heading_traj = std::make_unique<RotTaskSpaceTrackingData>(
+      "pelvis_heading_traj", K_p_pelvis_heading, K_d_pelvis_heading,
+      W_pelvis_heading, plant_w_spr, plant_wo_spr);
+  pelvis_heading_traj->AddFrameToTrack("pelvis");
+  osc->AddTrackingData(pelvis_heading_traj.get(), 0.1);  // 0.05
+  tracking_data_.push_back(std::move(pelvis_heading_traj));
+  // Swing toe joint tracking (Currently use fix position)
+  // The desired position, -1.5, was derived heuristically. It is roughly the
+  // toe angle when Cassie stands on the ground.
+  MatrixXd W_swing_toe = 200 * MatrixXd::Identity(1, 1);
+  MatrixXd K_p_swing_toe = 200 * MatrixXd::Identity(1, 1);
+  MatrixXd K_d_swing_toe = 20 * MatrixXd::Identity(1, 1);
+  auto swing_toe_traj = std::make_unique<JointSpaceTrackingData>(
+      "swing_toe_traj", K_p_swing_toe, K_d_swing_toe, W_swing_toe, plant_w_spr,
+      plant_wo_spr);
+  swing_toe_traj->AddStateAndJointToTrack(left_stance_state, "toe_right",
+                                          "toe_rightdot");
+  swing_toe_traj->AddStateAndJointToTrack(right_stance_state, "toe_left",
+                                          "toe_leftdot");
+  osc->AddConstTrackingData(swing_toe_traj.get(), -1.5 * VectorXd::Ones(1), 0,
+                            0.3);
+  tracking_data_.push_back(std::move(swing_toe_traj));
+  // Swing hip yaw joint tracking
+  MatrixXd W_hip_yaw = 20 * MatrixXd::Identity(1, 1);
+  MatrixXd K_p_hip_yaw = 200 * MatrixXd::Identity(1, 1);
+  MatrixXd K_d_hip_yaw = 160 * MatrixXd::Identity(1, 1);
+  auto swing_hip_yaw_traj = std::make_unique<JointSpaceTrackingData>(
+      "swing_hip_yaw_traj", K_p_hip_yaw, K_d_hip_yaw, W_hip_yaw, plant_w_spr,
+      plant_wo_spr);
+  swing_hip_yaw_traj->AddStateAndJointToTrack(
+      left_stance_state, "hip_yaw_right", "hip_yaw_rightdot");
+  swing_hip_yaw_traj->AddStateAndJointToTrack(
+      right_stance_state, "hip_yaw_left", "hip_yaw_leftdot");
+  osc->AddConstTrackingData(swing_hip_yaw_traj.get(), VectorXd::Zero(1));
+  tracking_data_.push_back(std::move(swing_hip_yaw_traj));
+  // Build OSC problem
+  if (options.warm_start_qp) {
+    osc->EnableOsqpWarmStart();
+  }
+  osc->Build();
+  // Connect ports
+  builder.Connect(simulator_drift->get_output_port(0),
+                  osc->get_robot_output_input_port());
+  builder.Connect(fsm->get_output_port(0), osc->get_fsm_input_port());
+  builder.Connect(lipm_traj_generator->get_output_port(0),
+                  osc->get_tracking_data_input_port("lipm_traj"));
+  builder.Connect(cp_traj_generator->get_output_port(0),
+                  osc->get_tracking_data_input_port("cp_traj"));
+  builder.Connect(head_traj_gen->get_output_port(0),
+                  osc->get_tracking_data_input_port("pelvis_balance_traj"));
+  builder.Connect(head_traj_gen->get_output_port(0),
+                  osc->get_tracking_data_input_port("pelvis_heading_traj"));
+
+  control_port_ = builder.ExportOutput(osc->get_osc_output_port(), "u, t");
+  osc_debug_port_ =
+      builder.ExportOutput(osc->get_osc_debug_port(), "lcmt_osc_output");
+  builder.BuildInto(this);
+  this->set_name("osc_walking_controller");
+}
+
+}  // namespace osc
+}  // namespace cassie
+}  // namespace dairlib
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "multibody/kinematic/distance_evaluator.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "systems/controllers/osc/operational_space_control.h"
+
+#include "drake/common/drake_copyable.h"
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/systems/framework/diagram.h"
+
+namespace dairlib {
+namespace cassie {
+namespace osc {
+
+struct OscWalkingControllerOptions {
+  /// Drift rate for the floating-base position (see SimulatorDrift)
+  double drift_rate = 0;
+  /// true: only right/left single support
+  /// false: both double and single support
+  bool is_two_phase = false;
+  /// Print the OSC tracking information every tick
+  bool print_osc = false;
+  /// Warm start the OSC QP with the previous solution
+  bool warm_start_qp = false;
+};
+
+/// `OscWalkingController` is the walking controller of
+/// run_osc_walking_controller: the high-level command, heading, LIPM and
+/// capture point trajectory generators, the time-based finite state machine
+/// and the operational space controller, wired into one diagram.
+///
+/// Input:
+///  - State of Cassie with springs (OutputVector)
+///
+/// Output:
+///  - Actuation (TimestampedVector), from the OSC
+///  - lcmt_osc_output, the OSC debug message
+///
+/// The diagram owns the plant contexts, evaluators and tracking data that its
+/// systems refer to. The plants must outlive it. Like its systems, the diagram
+/// keeps mutable data outside of the Context (the plant contexts and the OSC
+/// solution), so a Context of it must not be evaluated concurrently with
+/// another one; build one diagram per thread instead.
+///
+/// Requirement: quaternion floating-based Cassie only
+class OscWalkingController : public drake::systems::Diagram<double> {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(OscWalkingController)
+
+  /// @param plant_w_spr Cassie with springs (cassie_v2.urdf), finalized
+  /// @param plant_wo_spr Cassie with fixed springs (cassie_fixed_springs.urdf),
+  ///   finalized
+  OscWalkingController(
+      const drake::multibody::MultibodyPlant<double>& plant_w_spr,
+      const drake::multibody::MultibodyPlant<double>& plant_wo_spr,
+      const OscWalkingControllerOptions& options =
+          OscWalkingControllerOptions());
+
+  const drake::systems::InputPort<double>& get_state_input_port() const {
+    return this->get_input_port(state_port_);
+  }
+  const drake::systems::OutputPort<double>& get_control_output_port() const {
+    return this->get_output_port(control_port_);
+  }
+  const drake::systems::OutputPort<double>& get_osc_debug_port() const {
+    return this->get_output_port(osc_debug_port_);
+  }
+
+ private:
+  std::unique_ptr<drake::systems::Context<double>> context_w_spr_;
+  std::unique_ptr<drake::systems::Context<double>> context_wo_spr_;
+
+  // Loop closure constraints and contact points of the OSC
+  std::unique_ptr<multibody::DistanceEvaluator<double>> left_loop_;
+  std::unique_ptr<multibody::DistanceEvaluator<double>> right_loop_;
+  std::unique_ptr<multibody::KinematicEvaluatorSet<double>> evaluators_;
+  std::vector<std::unique_ptr<multibody::WorldPointEvaluator<double>>>
+      contact_evaluators_;
+
+  std::vector<std::unique_ptr<systems::controllers::OscTrackingData>>
+      tracking_data_;
+
+  int state_port_;
+  int control_port_;
+  int osc_debug_port_;
+};
+
+}  // namespace osc
+}  // namespace cassie
+}  // namespace dairlib
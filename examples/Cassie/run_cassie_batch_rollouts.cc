@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "common/file_utils.h"
+#include "examples/Cassie/cassie_batch_rollout.h"
+#include "examples/Cassie/cassie_fixed_point_solver.h"
+#include "examples/Cassie/cassie_utils.h"
+#include "systems/framework/loop_timing.h"
+
+/**
+  Evaluates the OSC walking controller over a batch of closed-loop
+  simulations, run in parallel without LCM (see CassieBatchRollout). The
+  rollouts start from Cassie's fixed point with a random initial pelvis
+  velocity, on inclines evenly spaced in [-max_incline, max_incline], with one
+  noise seed each. The usage is:
+
+    run_cassie_batch_rollouts --num_rollouts=1000 --output=metrics.csv
+
+  Each row of the output has the metrics of one rollout:
+    incline, seed, fell, failed, end_time, tracking_cost,
+    soft_constraint_cost, solve_time_mean_us, solve_time_p99_us,
+    solve_time_max_us, wall_time
+*/
+
+DEFINE_int32(num_rollouts, 100, "Number of rollouts");
+DEFINE_int32(num_threads, 0,
+             "Number of threads. 0 for the number of hardware threads.");
+DEFINE_double(end_time, 5, "End time of each rollout (s)");
+DEFINE_double(dt, 8e-5, "Time step of the simulation plant");
+DEFINE_double(control_period, 1e-3,
+              "Period at which the controller receives the state (s)");
+DEFINE_double(v_stiction, 1e-3, "Stiction tolernace (m/s)");
+DEFINE_double(penetration_allowance, 1e-5,
+              "Penetration allowance for the contact model. Nearly equivalent"
+              " to (m)");
+DEFINE_double(mu, 0.8, "Friction coefficient of the ground");
+DEFINE_double(init_height, .95,
+              "Initial starting height of the pelvis above ground");
+DEFINE_double(max_init_vel, 0.2,
+              "Maximum initial horizontal pelvis velocity (m/s)");
+DEFINE_double(max_incline, 0.05, "Maximum incline of the ground (rad)");
+DEFINE_int32(num_inclines, 5, "Number of inclines");
+DEFINE_double(fall_height, 0.5,
+              "A rollout falls when the pelvis is closer than this to the "
+              "ground (m)");
+DEFINE_double(drift_rate, 0.0, "Drift rate for floating-base state");
+DEFINE_double(position_noise, 0.0,
+              "Scale of the noise of the joint positions that the controller "
+              "receives");
+DEFINE_double(velocity_noise, 0.0,
+              "Scale of the noise of the velocities that the controller "
+              "receives");
+DEFINE_bool(is_two_phase, false,
+            "true: only right/left single support"
+            "false: both double and single support");
+DEFINE_bool(warm_start_qp, false,
+            "whether to warm start the OSC QP with the previous solution");
+DEFINE_int32(seed, 0, "Seed of the first rollout, and of the initial states");
+DEFINE_string(output, "", "CSV file to write the metrics to. Empty to skip.");
+
+namespace dairlib {
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+int DoMain(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  DRAKE_DEMAND(FLAGS_num_rollouts > 0);
+  DRAKE_DEMAND(FLAGS_num_inclines > 0);
+
+  // Cassie's fixed point at the initial height, as in multibody_sim
+  drake::multibody::MultibodyPlant<double> plant_for_solver(0.0);
+  addCassieMultibody(&plant_for_solver, nullptr, true /*floating base*/,
+                     "examples/Cassie/urdf/cassie_v2.urdf",
+                     true /*spring model*/, true /*loop closure*/);
+  plant_for_solver.Finalize();
+  VectorXd q_init, u_init, lambda_init;
+  double mu_fp = 0;
+  double min_normal_fp = 70;
+  double toe_spread = .2;
+  CassieFixedPointSolver(plant_for_solver, FLAGS_init_height, mu_fp,
+                         min_normal_fp, true, toe_spread, &q_init, &u_init,
+                         &lambda_init);
+  const int n_q = plant_for_solver.num_positions();
+  const int n_v = plant_for_solver.num_velocities();
+
+  CassieRolloutOptions options;
+  options.end_time = FLAGS_end_time;
+  options.sim_dt = FLAGS_dt;
+  options.control_period = FLAGS_control_period;
+  options.penetration_allowance = FLAGS_penetration_allowance;
+  options.v_stiction = FLAGS_v_stiction;
+  options.mu = FLAGS_mu;
+  options.fall_height = FLAGS_fall_height;
+  if (FLAGS_position_noise > 0) {
+    // The floating-base positions (quaternion and pelvis position) are not
+    // perturbed
+    options.position_noise = MatrixXd::Zero(n_q, n_q);
+    options.position_noise.bottomRightCorner(n_q - 7, n_q - 7) =
+        FLAGS_position_noise * MatrixXd::Identity(n_q - 7, n_q - 7);
+  }
+  if (FLAGS_velocity_noise > 0) {
+    options.velocity_noise =
+        FLAGS_velocity_noise * MatrixXd::Identity(n_v, n_v);
+  }
+  options.controller.drift_rate = FLAGS_drift_rate;
+  options.controller.is_two_phase = FLAGS_is_two_phase;
+  options.controller.warm_start_qp = FLAGS_warm_start_qp;
+
+  // The rollouts are split evenly between the inclines
+  std::mt19937 generator(FLAGS_seed);
+  std::uniform_real_distribution<double> init_vel(-FLAGS_max_init_vel,
+                                                  FLAGS_max_init_vel);
+  std::vector<CassieRolloutSpec> specs(FLAGS_num_rollouts);
+  for (int i = 0; i < FLAGS_num_rollouts; i++) {
+    const int incline_index =
+        (static_cast<int64_t>(i) * FLAGS_num_inclines) / FLAGS_num_rollouts;
+    specs[i].incline =
+        (FLAGS_num_inclines > 1)
+            ? FLAGS_max_incline *
+                  (2.0 * incline_index / (FLAGS_num_inclines - 1) - 1)
+            : 0;
+    specs[i].q_init = q_init;
+    specs[i].v_init = VectorXd::Zero(n_v);
+    // Pelvis x and y velocity
+    specs[i].v_init(3) = init_vel(generator);
+    specs[i].v_init(4) = init_vel(generator);
+    specs[i].seed = FLAGS_seed + i;
+  }
+
+  CassieBatchRollout batch(options, FLAGS_num_threads);
+  std::cout << "Running " << FLAGS_num_rollouts << " rollouts on "
+            << batch.num_threads() << " threads" << std::endl;
+  const int64_t start_ns = systems::LoopTimer::Now();
+  const CassieRolloutMetrics metrics = batch.Run(specs);
+  const double wall_time = 1e-9 * (systems::LoopTimer::Now() - start_ns);
+
+  std::cout << "Falls: " << metrics.fell.sum() << "/" << FLAGS_num_rollouts
+            << ", failures: " << metrics.failed.sum() << std::endl;
+  std::cout << "Mean tracking cost: " << metrics.tracking_cost.mean()
+            << std::endl;
+  std::cout << "OSC tick time (us): mean " << metrics.solve_time_mean_us.mean()
+            << ", max " << metrics.solve_time_max_us.maxCoeff() << std::endl;
+  std::cout << "Wall time: " << wall_time << " s ("
+            << metrics.end_time.sum() / wall_time
+            << " simulated s per s)" << std::endl;
+
+  if (!FLAGS_output.empty()) {
+    MatrixXd table(FLAGS_num_rollouts, 11);
+    for (int i = 0; i < FLAGS_num_rollouts; i++) {
+      table(i, 0) = specs[i].incline;
+      table(i, 1) = specs[i].seed;
+    }
+    table.col(2) = metrics.fell.cast<double>();
+    table.col(3) = metrics.failed.cast<double>();
+    table.col(4) = metrics.end_time;
+    table.col(5) = metrics.tracking_cost;
+    table.col(6) = metrics.soft_constraint_cost;
+    table.col(7) = metrics.solve_time_mean_us;
+    table.col(8) = metrics.solve_time_p99_us;
+    table.col(9) = metrics.solve_time_max_us;
+    table.col(10) = metrics.wall_time;
+    writeCSV(FLAGS_output, table);
+  }
+  return 0;
+}
+
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) { return dairlib::DoMain(argc, argv); }
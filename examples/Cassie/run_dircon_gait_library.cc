@@ -0,0 +1,367 @@
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+/**
+  Builds a library of Dircon gaits over a grid of gait parameters, by running
+  a Dircon binary (run_dircon_walking or run_dircon_jumping) once per solve,
+  in parallel processes. Every grid point is solved twice:
+
+   1. with coarse_knots knot points (per mode), warm started from the coarse
+      solution of the previous point along the last sweep dimension, or from
+      seed_filename (or the binary's own initial guess) for the first point,
+   2. with fine_knots knot points, warm started from the coarse solution of the
+      same point, which the binary upsamples through the reconstructed
+      DirconTrajectory (see DirconTrajectory::SetInitialGuess()).
+
+  The points which differ only in the last sweep dimension thus form a chain
+  of coarse solves, and the chains, as well as the fine solves, run in
+  parallel. Example, for walking gaits:
+
+    run_dircon_gait_library --library_name=walking \
+      --sweep=duration:0.35:0.45:3,stride_length:0.1:0.2:5
+
+  and for jumping gaits:
+
+    run_dircon_gait_library \
+      --solver=bazel-bin/examples/Cassie/run_dircon_jumping \
+      --knot_flag=knot_points --coarse_knots=5 --fine_knots=10 \
+      --coarse_solver_args= \
+      --library_name=jumping --sweep=height:0.1:0.4:4
+
+  The library is written to data_directory: the fine solutions
+  <library_name>_<index> and coarse solutions <library_name>_<index>_coarse
+  (lcmt_saved_traj files), the output of every solve in a .log file next to
+  them, and the index <library_name>_index.csv, with the parameters of each
+  point and whether its solves succeeded.
+*/
+
+DEFINE_string(solver, "bazel-bin/examples/Cassie/run_dircon_walking",
+              "Dircon binary to run. It must take the --data_directory, "
+              "--save_filename, --load_filename and --playback flags.");
+DEFINE_string(knot_flag, "n_node",
+              "Flag of the solver for the number of knot points");
+DEFINE_int32(coarse_knots, 8, "Number of knot points of the coarse solves");
+DEFINE_int32(fine_knots, 16, "Number of knot points of the fine solves");
+DEFINE_string(sweep, "stride_length:0.1:0.2:5",
+              "Comma-separated gait parameters to sweep, each as "
+              "<solver flag>:<min>:<max>:<number of values>. The last one "
+              "varies fastest, and its neighbouring values warm start each "
+              "other.");
+DEFINE_string(data_directory, "../dairlib_data/cassie_trajopt_data/",
+              "Directory to write the library to");
+DEFINE_string(library_name, "gait_library",
+              "Prefix of the files of the library");
+DEFINE_string(seed_filename, "",
+              "Saved DirconTrajectory (in data_directory) to warm start the "
+              "first coarse solve of each chain from. Empty for the solver's "
+              "own initial guess.");
+DEFINE_string(solver_args, "",
+              "Additional space-separated flags for every solve, e.g. "
+              "\"--tol=1e-4 --max_iter=1000\"");
+DEFINE_string(coarse_solver_args, "--allow_low_node_density",
+              "Additional space-separated flags for the coarse solves. The "
+              "default lets run_dircon_walking solve with fewer knot points "
+              "than it requires of a final solution.");
+DEFINE_int32(num_processes, 0,
+             "Maximum number of solves at once. 0 for the number of hardware "
+             "threads.");
+
+namespace dairlib {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+struct SweepDimension {
+  string flag;
+  vector<double> values;
+};
+
+// One run of the solver
+struct Solve {
+  int point;
+  bool coarse;
+  // Solve whose output warm starts this one, or -1
+  int warm_start = -1;
+  string save_filename;
+
+  enum Status { kPending, kRunning, kSucceeded, kFailed };
+  Status status = kPending;
+  double wall_time = 0;
+};
+
+vector<string> Split(const string& str, char delimiter) {
+  vector<string> tokens;
+  std::stringstream stream(str);
+  string token;
+  while (std::getline(stream, token, delimiter)) {
+    if (!token.empty()) {
+      tokens.push_back(token);
+    }
+  }
+  return tokens;
+}
+
+vector<SweepDimension> ParseSweep(const string& sweep) {
+  vector<SweepDimension> dimensions;
+  for (const string& spec : Split(sweep, ',')) {
+    const vector<string> fields = Split(spec, ':');
+    if (fields.size() != 4) {
+      throw std::runtime_error("Invalid sweep dimension " + spec +
+                               ", expected <flag>:<min>:<max>:<number>");
+    }
+    const double min = std::stod(fields[1]);
+    const double max = std::stod(fields[2]);
+    const int num = std::stoi(fields[3]);
+    if (num < 1) {
+      throw std::runtime_error("Invalid number of values in " + spec);
+    }
+    SweepDimension dimension;
+    dimension.flag = fields[0];
+    for (int i = 0; i < num; i++) {
+      dimension.values.push_back(
+          (num > 1) ? min + (max - min) * i / (num - 1) : min);
+    }
+    dimensions.push_back(dimension);
+  }
+  if (dimensions.empty()) {
+    throw std::runtime_error("The sweep has no dimensions");
+  }
+  return dimensions;
+}
+
+string FormatValue(double value) {
+  std::ostringstream stream;
+  stream << std::setprecision(10) << value;
+  return stream.str();
+}
+
+bool FileExists(const string& filepath) {
+  return std::ifstream(filepath).good();
+}
+
+// Starts the solver on its own process, with its output redirected to
+// log_filepath, and returns its pid
+pid_t Launch(const vector<string>& args, const string& log_filepath) {
+  const pid_t pid = fork();
+  if (pid < 0) {
+    throw std::runtime_error("fork() failed");
+  }
+  if (pid == 0) {
+    const int log =
+        open(log_filepath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log >= 0) {
+      dup2(log, STDOUT_FILENO);
+      dup2(log, STDERR_FILENO);
+      close(log);
+    }
+    vector<char*> argv;
+    for (const string& arg : args) {
+      argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    execv(argv[0], argv.data());
+    std::cerr << "Could not execute " << args[0] << std::endl;
+    _exit(127);
+  }
+  return pid;
+}
+
+}  // namespace
+
+int DoMain(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  const vector<SweepDimension> dimensions = ParseSweep(FLAGS_sweep);
+  if (!FLAGS_seed_filename.empty() &&
+      !FileExists(FLAGS_data_directory + FLAGS_seed_filename)) {
+    throw std::runtime_error("Could not find " + FLAGS_data_directory +
+                             FLAGS_seed_filename);
+  }
+  const int num_processes =
+      (FLAGS_num_processes > 0)
+          ? FLAGS_num_processes
+          : std::max<int>(1, std::thread::hardware_concurrency());
+  const vector<string> solver_args = Split(FLAGS_solver_args, ' ');
+  const vector<string> coarse_solver_args =
+      Split(FLAGS_coarse_solver_args, ' ');
+
+  // Grid points, with the last dimension varying fastest
+  int num_points = 1;
+  for (const auto& dimension : dimensions) {
+    num_points *= dimension.values.size();
+  }
+  const int chain_length = dimensions.back().values.size();
+  vector<vector<double>> points(num_points);
+  for (int point = 0; point < num_points; point++) {
+    int remainder = point;
+    points[point].resize(dimensions.size());
+    for (int d = dimensions.size() - 1; d >= 0; d--) {
+      const int num_values = dimensions[d].values.size();
+      points[point][d] = dimensions[d].values[remainder % num_values];
+      remainder /= num_values;
+    }
+  }
+
+  // Solves 2 * point (coarse) and 2 * point + 1 (fine)
+  vector<Solve> solves;
+  for (int point = 0; point < num_points; point++) {
+    const string name = FLAGS_library_name + "_" + std::to_string(point);
+    Solve coarse;
+    coarse.point = point;
+    coarse.coarse = true;
+    coarse.warm_start = (point % chain_length > 0) ? 2 * (point - 1) : -1;
+    coarse.save_filename = name + "_coarse";
+    solves.push_back(coarse);
+
+    Solve fine;
+    fine.point = point;
+    fine.coarse = false;
+    fine.warm_start = 2 * point;
+    fine.save_filename = name;
+    solves.push_back(fine);
+  }
+
+  std::cout << "Solving " << num_points << " gaits on " << num_processes
+            << " processes" << std::endl;
+  const auto start = std::chrono::steady_clock::now();
+  std::map<pid_t, int> running;
+  std::map<int, std::chrono::steady_clock::time_point> start_times;
+  int num_finished = 0;
+  while (num_finished < static_cast<int>(solves.size())) {
+    // Launch the solves whose warm start has finished, coarse ones first, so
+    // that the chains advance
+    for (bool coarse : {true, false}) {
+      for (int i = 0; i < static_cast<int>(solves.size()); i++) {
+        Solve& solve = solves[i];
+        if (static_cast<int>(running.size()) >= num_processes) {
+          break;
+        }
+        if (solve.status != Solve::kPending || solve.coarse != coarse) {
+          continue;
+        }
+        if (solve.warm_start >= 0 &&
+            (solves[solve.warm_start].status == Solve::kPending ||
+             solves[solve.warm_start].status == Solve::kRunning)) {
+          continue;
+        }
+
+        vector<string> args = {
+            FLAGS_solver, "--data_directory=" + FLAGS_data_directory,
+            "--save_filename=" + solve.save_filename, "--playback=false",
+            "--" + FLAGS_knot_flag + "=" +
+                std::to_string(solve.coarse ? FLAGS_coarse_knots
+                                            : FLAGS_fine_knots)};
+        for (size_t d = 0; d < dimensions.size(); d++) {
+          args.push_back("--" + dimensions[d].flag + "=" +
+                         FormatValue(points[solve.point][d]));
+        }
+        // A failed solve still saves its last iterate, which is usually a
+        // better guess than none. A solve which crashed saves nothing.
+        string load_filename;
+        if (solve.warm_start >= 0) {
+          load_filename = solves[solve.warm_start].save_filename;
+        } else {
+          load_filename = FLAGS_seed_filename;
+        }
+        if (!load_filename.empty() &&
+            FileExists(FLAGS_data_directory + load_filename)) {
+          args.push_back("--load_filename=" + load_filename);
+        }
+        args.insert(args.end(), solver_args.begin(), solver_args.end());
+        if (solve.coarse) {
+          args.insert(args.end(), coarse_solver_args.begin(),
+                      coarse_solver_args.end());
+        }
+
+        const pid_t pid = Launch(
+            args, FLAGS_data_directory + solve.save_filename + ".log");
+        running[pid] = i;
+        start_times[i] = std::chrono::steady_clock::now();
+        solve.status = Solve::kRunning;
+      }
+    }
+
+    int wait_status;
+    const pid_t pid = wait(&wait_status);
+    if (pid < 0) {
+      throw std::runtime_error("wait() failed");
+    }
+    const auto it = running.find(pid);
+    if (it == running.end()) {
+      continue;
+    }
+    Solve& solve = solves[it->second];
+    running.erase(it);
+    solve.status = (WIFEXITED(wait_status) && WEXITSTATUS(wait_status) == 0)
+                       ? Solve::kSucceeded
+                       : Solve::kFailed;
+    solve.wall_time = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() -
+                          start_times[it->second])
+                          .count();
+    num_finished++;
+
+    std::cout << "[" << num_finished << "/" << solves.size() << "] "
+              << solve.save_filename << ":";
+    for (size_t d = 0; d < dimensions.size(); d++) {
+      std::cout << " " << dimensions[d].flag << "="
+                << FormatValue(points[solve.point][d]);
+    }
+    std::cout << ((solve.status == Solve::kSucceeded) ? " succeeded"
+                                                      : " failed")
+              << " in " << solve.wall_time << " s" << std::endl;
+  }
+
+  // Index of the library
+  const string index_filepath =
+      FLAGS_data_directory + FLAGS_library_name + "_index.csv";
+  std::ofstream index(index_filepath);
+  if (!index) {
+    throw std::runtime_error("Could not open " + index_filepath);
+  }
+  index << "index";
+  for (const auto& dimension : dimensions) {
+    index << "," << dimension.flag;
+  }
+  index << ",coarse_success,success,coarse_solve_time,solve_time,filename\n";
+  int num_succeeded = 0;
+  for (int point = 0; point < num_points; point++) {
+    const Solve& coarse = solves[2 * point];
+    const Solve& fine = solves[2 * point + 1];
+    index << point;
+    for (double value : points[point]) {
+      index << "," << FormatValue(value);
+    }
+    index << "," << (coarse.status == Solve::kSucceeded) << ","
+          << (fine.status == Solve::kSucceeded) << "," << coarse.wall_time
+          << "," << fine.wall_time << "," << fine.save_filename << "\n";
+    num_succeeded += (fine.status == Solve::kSucceeded);
+  }
+
+  std::cout << num_succeeded << "/" << num_points << " gaits succeeded in "
+            << std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             start)
+                   .count()
+            << " s. Wrote " << index_filepath << std::endl;
+  return (num_succeeded == num_points) ? 0 : 1;
+}
+
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) { return dairlib::DoMain(argc, argv); }
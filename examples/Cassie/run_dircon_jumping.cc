@@ -64,7 +64,10 @@ DEFINE_int32(scale_option, 0,
              "Scale option of SNOPT"
              "Use 2 if seeing snopta exit 40 in log file");
 DEFINE_double(tol, 1e-6, "Tolerance for constraint violation and dual gap");
-DEFINE_string(load_filename, "", "File to load decision vars from.");
+DEFINE_string(load_filename, "",
+              "File (in data_directory) of a saved DirconTrajectory to warm "
+              "start from. It may have a different number of knot points, "
+              "e.g. a coarser solution.");
 DEFINE_string(
     data_directory,
     "/home/yangwill/Documents/research/projects/cassie/jumping/saved_trajs/",
@@ -73,6 +76,9 @@ DEFINE_string(save_filename, "default_filename",
               "Filename to save decision "
               "vars to.");
 DEFINE_string(traj_name, "", "File to load saved LCM trajs from.");
+DEFINE_bool(playback, true,
+            "Playback the solution. Otherwise exit once it is saved, with a "
+            "nonzero status if the solve failed.");
 
 namespace dairlib {
 
@@ -86,8 +92,6 @@ vector<VectorXd> GetInitGuessForQFlight(int num_knot_points, double apex_height,
                                         const MultibodyPlant<double>& plant);
 vector<VectorXd> GetInitGuessForV(const vector<VectorXd>& q_guess, double dt,
                                   const MultibodyPlant<double>& plant);
-MatrixXd loadSavedDecisionVars(const string& filepath);
-
 MatrixXd generateStateAndInputMatrix(const PiecewisePolynomial<double>& states,
                                      const PiecewisePolynomial<double>& inputs,
                                      VectorXd times);
@@ -97,7 +101,7 @@ vector<string> createStateNameVectorFromMap(const map<string, int>& pos_map,
 void printConstraint(const shared_ptr<HybridDircon<double>>& trajopt,
                      const MathematicalProgramResult& result);
 
-void DoMain() {
+bool DoMain() {
   // Drake system initialization stuff
   drake::systems::DiagramBuilder<double> builder;
   SceneGraph<double>& scene_graph = *builder.AddSystem<SceneGraph>();
@@ -263,9 +267,8 @@ void DoMain() {
 
   if (!FLAGS_load_filename.empty()) {
     std::cout << "Loading: " << FLAGS_load_filename << std::endl;
-    MatrixXd decisionVars =
-        loadSavedDecisionVars(FLAGS_data_directory + FLAGS_load_filename);
-    trajopt->SetInitialGuessForAllVariables(decisionVars);
+    DirconTrajectory init_traj(FLAGS_data_directory + FLAGS_load_filename);
+    init_traj.SetInitialGuess(trajopt.get());
   } else {
     // Initialize all decision vars to random by default. Will be overriding
     // later
@@ -352,6 +355,9 @@ void DoMain() {
   saved_traj.WriteToFile(FLAGS_data_directory + FLAGS_save_filename);
   std::cout << "Wrote to file: " << FLAGS_data_directory + FLAGS_save_filename
             << std::endl;
+  if (!FLAGS_playback) {
+    return result.is_success();
+  }
   drake::trajectories::PiecewisePolynomial<double> optimal_traj =
       trajopt->ReconstructStateTrajectory(result);
   multibody::connectTrajectoryVisualizer(&plant, &builder, &scene_graph,
@@ -365,6 +371,7 @@ void DoMain() {
     simulator.Initialize();
     simulator.AdvanceTo(optimal_traj.end_time());
   }
+  return true;
 }
 
 void printConstraint(const shared_ptr<HybridDircon<double>>& trajopt,
@@ -844,14 +851,6 @@ vector<VectorXd> GetInitGuessForV(const vector<VectorXd>& q_guess, double dt,
   }
 }
 
-MatrixXd loadSavedDecisionVars(const string& filepath) {
-  DirconTrajectory loaded_decision_vars = DirconTrajectory(filepath);
-  for (auto& name : loaded_decision_vars.GetTrajectoryNames()) {
-    std::cout << name << std::endl;
-  }
-  return loaded_decision_vars.GetDecisionVariables();
-}
-
 MatrixXd generateStateAndInputMatrix(const PiecewisePolynomial<double>& states,
                                      const PiecewisePolynomial<double>& inputs,
                                      VectorXd times) {
@@ -881,5 +880,5 @@ MatrixXd generateStateAndInputMatrix(const PiecewisePolynomial<double>& states,
 
 int main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  dairlib::DoMain();
+  return dairlib::DoMain() ? 0 : 1;
 }
\ No newline at end of file
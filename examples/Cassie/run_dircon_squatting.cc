@@ -80,6 +80,11 @@ DEFINE_bool(playback, true, "Playback the solution");
 // Parameters which enable dircon-improving features
 DEFINE_bool(scale_constraint, true, "Scale the nonlinear constraint values");
 DEFINE_bool(scale_variable, false, "Scale the decision variable");
+DEFINE_int32(num_threads, 1,
+             "Number of threads used to evaluate the dynamics and kinematic "
+             "constraints");
+DEFINE_bool(analytic_gradient, false,
+            "Use analytic gradients for the collocation constraints");
 
 namespace dairlib {
 using systems::trajectory_optimization::Dircon;
@@ -167,6 +172,8 @@ void DoMain(double duration, int max_iter, string data_directory,
   double max_T = 5;
   auto double_support =
       DirconMode<double>(evaluators, num_knotpoints, min_T, max_T);
+  double_support.set_num_threads(FLAGS_num_threads);
+  double_support.set_analytic_collocation_gradient(FLAGS_analytic_gradient);
 
   // Set x-y coordinates as relative
   double_support.MakeConstraintRelative(left_toe_eval_ind, 0);    // x
@@ -63,6 +63,10 @@ using drake::systems::rendering::MultibodyPositionToGeometryPose;
 using drake::trajectories::PiecewisePolynomial;
 
 DEFINE_string(init_file, "", "the file name of initial guess");
+DEFINE_string(load_filename, "",
+              "File (in data_directory) of a saved DirconTrajectory to warm "
+              "start from. It may have a different number of nodes, e.g. a "
+              "coarser solution. Takes precedence over init_file.");
 DEFINE_string(data_directory, "../dairlib_data/cassie_trajopt_data/",
               "directory to save/read data");
 DEFINE_string(save_filename, "default_filename",
@@ -96,6 +100,13 @@ DEFINE_bool(is_scale_variable, true, "Scale the decision variable");
 // Others
 DEFINE_bool(visualize_init_guess, false,
             "to visualize the poses of the initial guess");
+DEFINE_bool(allow_low_node_density, false,
+            "Only warn when stride_length / n_node is too large for SNOPT to "
+            "converge well, e.g. for a coarse solve which warm starts a finer "
+            "one");
+DEFINE_bool(playback, true,
+            "Playback the solution. Otherwise exit once it is saved, with a "
+            "nonzero status if the solve failed.");
 
 namespace dairlib {
 
@@ -230,7 +241,7 @@ vector<VectorXd> GetInitGuessForV(const vector<VectorXd>& q_seed, double dt,
   return v_seed;
 }
 
-void DoMain(double duration, double stride_length, double ground_incline,
+bool DoMain(double duration, double stride_length, double ground_incline,
             bool is_fix_time, int n_node, int max_iter,
             const string& data_directory, const string& init_file, double tol,
             bool to_store_data, int scale_option) {
@@ -238,8 +249,16 @@ void DoMain(double duration, double stride_length, double ground_incline,
   double minimum_timestep = 0.01;
   DRAKE_DEMAND(duration / (n_node - 1) >= minimum_timestep);
   // If the node density is too low, it's harder for SNOPT to converge well.
+  // A coarse solve which only warm starts a finer one may opt out.
   double max_distance_per_node = 0.2 / 16;
-  DRAKE_DEMAND((stride_length / n_node) <= max_distance_per_node);
+  if (FLAGS_allow_low_node_density) {
+    if ((stride_length / n_node) > max_distance_per_node) {
+      cout << "Warning: stride_length / n_node is larger than "
+           << max_distance_per_node << ", SNOPT may not converge well\n";
+    }
+  } else {
+    DRAKE_DEMAND((stride_length / n_node) <= max_distance_per_node);
+  }
 
   // Cost on velocity and input
   double w_Q = 0.05;
@@ -772,7 +791,12 @@ void DoMain(double duration, double stride_length, double ground_incline,
   }
 
   // initial guess
-  if (!init_file.empty()) {
+  if (!FLAGS_load_filename.empty()) {
+    cout << "Warm starting from " << data_directory + FLAGS_load_filename
+         << endl;
+    DirconTrajectory init_traj(data_directory + FLAGS_load_filename);
+    init_traj.SetInitialGuess(trajopt.get());
+  } else if (!init_file.empty()) {
     MatrixXd z0 = readCSV(data_directory + init_file);
     trajopt->SetInitialGuessForAllVariables(z0);
   } else {
@@ -1090,6 +1114,9 @@ void DoMain(double duration, double stride_length, double ground_incline,
   saved_traj.WriteToFile(FLAGS_data_directory + FLAGS_save_filename);
   std::cout << "Wrote to file: " << FLAGS_data_directory + FLAGS_save_filename
             << std::endl;
+  if (!FLAGS_playback) {
+    return result.is_success();
+  }
 
   // visualizer
   const PiecewisePolynomial<double> pp_xtraj =
@@ -1163,14 +1190,15 @@ void DoMain(double duration, double stride_length, double ground_incline,
     simulator.AdvanceTo(pp_xtraj.end_time());
   }
 
-  return;
+  return true;
 }
 }  // namespace dairlib
 
 int main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  dairlib::DoMain(FLAGS_duration, FLAGS_stride_length, FLAGS_ground_incline,
-                  FLAGS_is_fix_time, FLAGS_n_node, FLAGS_max_iter,
-                  FLAGS_data_directory, FLAGS_init_file, FLAGS_tol,
-                  FLAGS_store_data, FLAGS_scale_option);
+  const bool success = dairlib::DoMain(
+      FLAGS_duration, FLAGS_stride_length, FLAGS_ground_incline,
+      FLAGS_is_fix_time, FLAGS_n_node, FLAGS_max_iter, FLAGS_data_directory,
+      FLAGS_init_file, FLAGS_tol, FLAGS_store_data, FLAGS_scale_option);
+  return success ? 0 : 1;
 }
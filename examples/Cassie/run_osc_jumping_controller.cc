@@ -11,6 +11,7 @@
 #include "examples/Cassie/osc_jump/pelvis_orientation_traj_generator.h"
 #include "lcm/lcm_trajectory.h"
 #include "systems/controllers/osc/operational_space_control.h"
+#include "systems/framework/async_lcm_publisher_system.h"
 #include "systems/controllers/osc/osc_tracking_data.h"
 #include "systems/framework/lcm_driven_loop.h"
 #include "systems/primitives/gaussian_noise_pass_through.h"
@@ -77,6 +78,10 @@ DEFINE_bool(add_noise, false,
             "Whether to add gaussian noise to state "
             "inputted to controller");
 DEFINE_int32(init_fsm_state, BALANCE, "Initial state of the FSM");
+DEFINE_string(lockstep_channel, "",
+              "Channel to acknowledge each state message on, to run in "
+              "lockstep with multibody_sim --lockstep_channel. Empty to "
+              "disable.");
 
 int DoMain(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
@@ -206,8 +211,8 @@ int DoMain(int argc, char* argv[]) {
   auto osc = builder.AddSystem<systems::controllers::OperationalSpaceControl>(
       plant_w_springs, plant_wo_springs, context_w_spr.get(),
       context_wo_spr.get(), true, FLAGS_print_osc); /*print_tracking_info*/
-  auto osc_debug_pub =
-      builder.AddSystem(LcmPublisherSystem::Make<dairlib::lcmt_osc_output>(
+  auto osc_debug_pub = builder.AddSystem(
+      systems::AsyncLcmPublisherSystem::Make<dairlib::lcmt_osc_output>(
           "OSC_DEBUG", &lcm, TriggerTypeSet({TriggerType::kForced})));
 
   LcmSubscriberSystem* contact_results_sub = nullptr;
@@ -383,7 +388,7 @@ int DoMain(int argc, char* argv[]) {
                   command_sender->get_input_port(0));
   builder.Connect(command_sender->get_output_port(0),
                   command_pub->get_input_port());
-  builder.Connect(osc->get_osc_debug_port(), osc_debug_pub->get_input_port());
+  builder.Connect(osc->get_osc_debug_port(), osc_debug_pub->get_input_port(0));
 
   // Run lcm-driven simulation
   // Create the diagram
@@ -393,6 +398,9 @@ int DoMain(int argc, char* argv[]) {
   // Run lcm-driven simulation
   systems::LcmDrivenLoop<dairlib::lcmt_robot_output> loop(
       &lcm, std::move(owned_diagram), state_receiver, FLAGS_channel_x, true);
+  if (!FLAGS_lockstep_channel.empty()) {
+    loop.EnableLockstep(FLAGS_lockstep_channel);
+  }
   loop.Simulate();
 
   return 0;
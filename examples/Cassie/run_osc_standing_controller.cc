@@ -8,6 +8,7 @@
 #include "multibody/kinematic/kinematic_evaluator_set.h"
 #include "multibody/multibody_utils.h"
 #include "systems/controllers/osc/operational_space_control.h"
+#include "systems/framework/async_lcm_publisher_system.h"
 #include "systems/framework/lcm_driven_loop.h"
 #include "systems/robot_lcm_systems.h"
 #include "yaml-cpp/yaml.h"
@@ -50,6 +51,10 @@ DEFINE_bool(print_osc, false, "whether to print the osc debug message or not");
 DEFINE_double(cost_weight_multiplier, 0.001,
               "A cosntant times with cost weight of OSC traj tracking");
 DEFINE_double(height, .89, "The initial COM height (m)");
+DEFINE_string(lockstep_channel, "",
+              "Channel to acknowledge each state message on, to run in "
+              "lockstep with multibody_sim --lockstep_channel. Empty to "
+              "disable.");
 DEFINE_string(gains_filename, "examples/Cassie/osc/osc_standing_gains.yaml",
               "Filepath containing gains");
 
@@ -172,8 +177,8 @@ int DoMain(int argc, char* argv[]) {
                   command_pub->get_input_port());
 
   // Create osc debug sender.
-  auto osc_debug_pub =
-      builder.AddSystem(LcmPublisherSystem::Make<dairlib::lcmt_osc_output>(
+  auto osc_debug_pub = builder.AddSystem(
+      systems::AsyncLcmPublisherSystem::Make<dairlib::lcmt_osc_output>(
           "OSC_DEBUG", &lcm_local, TriggerTypeSet({TriggerType::kForced})));
 
   // Create desired center of mass traj
@@ -250,7 +255,7 @@ int DoMain(int argc, char* argv[]) {
                   osc->get_robot_output_input_port());
   builder.Connect(osc->get_osc_output_port(),
                   command_sender->get_input_port(0));
-  builder.Connect(osc->get_osc_debug_port(), osc_debug_pub->get_input_port());
+  builder.Connect(osc->get_osc_debug_port(), osc_debug_pub->get_input_port(0));
   builder.Connect(com_traj_generator->get_output_port(0),
                   osc->get_tracking_data_input_port("com_traj"));
 
@@ -262,6 +267,9 @@ int DoMain(int argc, char* argv[]) {
   systems::LcmDrivenLoop<dairlib::lcmt_robot_output> loop(
       &lcm_local, std::move(owned_diagram), state_receiver, FLAGS_channel_x,
       true);
+  if (!FLAGS_lockstep_channel.empty()) {
+    loop.EnableLockstep(FLAGS_lockstep_channel);
+  }
 
   //   Get context and initialize the input port of LcmSubsriber for
   //   lcmt_target_standing_height
@@ -1,19 +1,21 @@
+#include <functional>
+#include <thread>
+
 #include <gflags/gflags.h>
 
+#include "dairlib/lcmt_cassie_out.hpp"
 #include "dairlib/lcmt_robot_input.hpp"
 #include "dairlib/lcmt_robot_output.hpp"
+#include "examples/Cassie/cassie_dispatchers.h"
 #include "examples/Cassie/cassie_utils.h"
-#include "examples/Cassie/osc/deviation_from_cp.h"
-#include "examples/Cassie/osc/heading_traj_generator.h"
-#include "examples/Cassie/osc/high_level_command.h"
-#include "examples/Cassie/simulator_drift.h"
-#include "multibody/kinematic/kinematic_evaluator_set.h"
-#include "multibody/multibody_utils.h"
-#include "systems/controllers/cp_traj_gen.h"
-#include "systems/controllers/lipm_traj_gen.h"
-#include "systems/controllers/osc/operational_space_control.h"
-#include "systems/controllers/time_based_fsm.h"
+#include "examples/Cassie/osc/osc_walking_controller.h"
+#include "lcm/shm_lcm.h"
+#include "systems/framework/async_lcm_publisher_system.h"
+#include "systems/framework/in_memory_channel.h"
+#include "systems/framework/in_memory_driven_loop.h"
+#include "systems/framework/in_memory_systems.h"
 #include "systems/framework/lcm_driven_loop.h"
+#include "systems/framework/realtime.h"
 #include "systems/robot_lcm_systems.h"
 
 #include "drake/systems/framework/diagram_builder.h"
@@ -23,24 +25,18 @@ namespace dairlib {
 
 using std::cout;
 using std::endl;
-using std::vector;
-
-using Eigen::Matrix3d;
-using Eigen::MatrixXd;
-using Eigen::Vector3d;
-using Eigen::VectorXd;
 
-using drake::multibody::Frame;
 using drake::systems::DiagramBuilder;
 using drake::systems::TriggerType;
 using drake::systems::lcm::LcmPublisherSystem;
 using drake::systems::lcm::LcmSubscriberSystem;
 using drake::systems::lcm::TriggerTypeSet;
 
-using systems::controllers::ComTrackingData;
-using systems::controllers::JointSpaceTrackingData;
-using systems::controllers::RotTaskSpaceTrackingData;
-using systems::controllers::TransTaskSpaceTrackingData;
+using systems::AsyncLcmPublisherSystem;
+using systems::InMemoryBus;
+using systems::InMemoryPublisherSystem;
+using systems::InMemorySubscriberSystem;
+using systems::InMemoryTriggerTypes;
 
 DEFINE_double(drift_rate, 0.0, "Drift rate for floating-base state");
 
@@ -50,10 +46,52 @@ DEFINE_string(channel_x, "CASSIE_STATE_SIMULATION",
               "use CASSIE_STATE_DISPATCHER to get state from state estimator");
 DEFINE_string(channel_u, "CASSIE_INPUT",
               "The name of the channel which publishes command");
+DEFINE_string(lcm_url, "udpm://239.255.76.67:7667?ttl=0",
+              "LCM URL for state, command and debug messages, e.g. "
+              "shm://cassie to use shared memory");
 
 DEFINE_bool(publish_osc_data, true,
             "whether to publish lcm messages for OscTrackData");
+DEFINE_string(lockstep_channel, "",
+              "Channel to acknowledge each state message on, to run in "
+              "lockstep with multibody_sim --lockstep_channel. Empty to "
+              "disable. Only with --transport=lcm.");
+DEFINE_string(timing_channel, "",
+              "LCM channel for loop timing statistics. Empty to disable.");
+DEFINE_double(deadline, 0.0005,
+              "Per-iteration time budget (s) for loop timing statistics");
+DEFINE_int32(rt_priority, 0,
+             "SCHED_FIFO priority of the control loop. 0 to keep the default "
+             "scheduler.");
+DEFINE_string(cpus, "", "CPUs to pin the control loop to, e.g. 2,3 or 2-3");
+DEFINE_bool(lock_memory, false, "whether to lock the process' memory");
+DEFINE_bool(spin_wait, false,
+            "whether to poll for state messages without sleeping");
+DEFINE_bool(prefault, false,
+            "whether to run the diagram once before the loop goes live");
+DEFINE_string(transport, "lcm",
+              "lcm: receive state and send commands over LCM. in_memory: run "
+              "the state estimator of dispatcher_robot_out and "
+              "dispatcher_robot_in on threads of this process, connected to "
+              "the controller without LCM. Their channels are still "
+              "republished on LCM for logging.");
+DEFINE_string(address, "127.0.0.1",
+              "in_memory: IPv4 address to receive Cassie's UDP messages on");
+DEFINE_int64(port, 25001, "in_memory: Port to receive on");
+DEFINE_string(command_address, "127.0.0.1",
+              "in_memory: IPv4 address to send Cassie's UDP commands to");
+DEFINE_int64(command_port, 25000, "in_memory: Port to send commands to");
+DEFINE_double(pub_rate, 0.02, "in_memory: Network LCM pubishing period (s).");
+DEFINE_double(max_joint_velocity, 10,
+              "in_memory: Maximum joint velocity before error is triggered");
+DEFINE_double(input_limit, -1,
+              "in_memory: Maximum torque limit. Negative values are inf.");
+DEFINE_int64(supervisor_N, 10,
+             "in_memory: Maximum allowed consecutive failures of velocity "
+             "limit.");
 DEFINE_bool(print_osc, false, "whether to print the osc debug message or not");
+DEFINE_bool(warm_start_qp, false,
+            "whether to warm start the OSC QP with the previous solution");
 DEFINE_bool(is_two_phase, false,
             "true: only right/left single support"
             "false: both double and single support");
@@ -64,8 +102,74 @@ DEFINE_bool(is_two_phase, false,
 // Maybe we need to update the lcm driven loop to clear the queue of lcm message
 // if it's more than one message?
 
+// Runs the state estimator of dispatcher_robot_out on Cassie's UDP messages,
+// publishing the estimated state on the bus's state channel. Never returns.
+void RunStateEstimator(const drake::multibody::MultibodyPlant<double>& plant,
+                       InMemoryBus* bus, drake::lcm::DrakeLcm* lcm_network) {
+  DiagramBuilder<double> builder;
+  RobotOutDispatcher dispatcher(plant, &builder,
+                                false /*test_with_ground_truth_state*/,
+                                false /*print_ekf_info*/, -1 /*test_mode*/);
+  auto state_pub =
+      builder.AddSystem<InMemoryPublisherSystem<dairlib::lcmt_robot_output>>(
+          bus->GetChannel<dairlib::lcmt_robot_output>(FLAGS_channel_x),
+          InMemoryTriggerTypes({TriggerType::kForced}));
+  builder.Connect(dispatcher.robot_output_sender()->get_output_port(0),
+                  state_pub->get_input_port(0));
+
+  // Low-rate publishers for the network
+  auto net_state_pub = builder.AddSystem(
+      AsyncLcmPublisherSystem::Make<dairlib::lcmt_robot_output>(
+          "NETWORK_CASSIE_STATE_DISPATCHER", lcm_network,
+          {TriggerType::kPeriodic}, FLAGS_pub_rate));
+  builder.Connect(*dispatcher.robot_output_sender(), *net_state_pub);
+  auto output_pub = builder.AddSystem(
+      AsyncLcmPublisherSystem::Make<dairlib::lcmt_cassie_out>(
+          "CASSIE_OUTPUT_ECHO", lcm_network, {TriggerType::kPeriodic},
+          FLAGS_pub_rate));
+  builder.Connect(*dispatcher.output_sender(), *output_pub);
+
+  auto owned_diagram = builder.Build();
+  owned_diagram->set_name("dispatcher_robot_out");
+  const auto& diagram = *owned_diagram;
+  drake::systems::Simulator<double> simulator(std::move(owned_diagram));
+  dispatcher.RunUdpLoop(FLAGS_address, FLAGS_port, true /*initialize_ekf*/,
+                        diagram, &simulator);
+}
+
+// Runs dispatcher_robot_in on the bus's command channel, checking commands
+// against the bus's state channel. Never returns.
+void RunRobotInDispatcher(const drake::multibody::MultibodyPlant<double>& plant,
+                          InMemoryBus* bus,
+                          drake::lcm::DrakeLcm* lcm_network) {
+  DiagramBuilder<double> builder;
+  auto dispatcher = AddRobotInDispatcher(
+      plant, FLAGS_command_address, FLAGS_command_port,
+      FLAGS_max_joint_velocity, FLAGS_supervisor_N, FLAGS_input_limit,
+      &builder);
+  auto state_sub =
+      builder.AddSystem<InMemorySubscriberSystem<dairlib::lcmt_robot_output>>(
+          bus->GetChannel<dairlib::lcmt_robot_output>(FLAGS_channel_x));
+  builder.Connect(*state_sub, *dispatcher.state_receiver);
+  auto net_command_pub = builder.AddSystem(
+      AsyncLcmPublisherSystem::Make<dairlib::lcmt_robot_input>(
+          "NETWORK_CASSIE_INPUT", lcm_network, {TriggerType::kPeriodic},
+          FLAGS_pub_rate));
+  builder.Connect(*dispatcher.net_command_sender, *net_command_pub);
+
+  auto owned_diagram = builder.Build();
+  owned_diagram->set_name("dispatcher_robot_in");
+  systems::InMemoryDrivenLoop<dairlib::lcmt_robot_input> loop(
+      std::move(owned_diagram), dispatcher.command_receiver,
+      bus->GetChannel<dairlib::lcmt_robot_input>(FLAGS_channel_u), true);
+  loop.Simulate();
+}
+
 int DoMain(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
+  DRAKE_DEMAND(FLAGS_transport == "lcm" || FLAGS_transport == "in_memory");
+  const bool in_memory = FLAGS_transport == "in_memory";
+  DRAKE_DEMAND(!in_memory || FLAGS_lockstep_channel.empty());
 
   // Build Cassie MBP
   drake::multibody::MultibodyPlant<double> plant_w_spr(0.0);
@@ -80,338 +184,111 @@ int DoMain(int argc, char* argv[]) {
                      false);
   plant_wo_spr.Finalize();
 
-  auto context_w_spr = plant_w_spr.CreateDefaultContext();
-  auto context_wo_spr = plant_wo_spr.CreateDefaultContext();
-
   // Build the controller diagram
   DiagramBuilder<double> builder;
 
-  drake::lcm::DrakeLcm lcm_local("udpm://239.255.76.67:7667?ttl=0");
-
-  // Get contact frames and position (doesn't matter whether we use
-  // plant_w_spr or plant_wo_spr because the contact frames exit in both
-  // plants)
-  auto left_toe = LeftToeFront(plant_w_spr);
-  auto left_heel = LeftToeRear(plant_w_spr);
-  auto right_toe = RightToeFront(plant_w_spr);
-  auto right_heel = RightToeRear(plant_w_spr);
-
-  // Get body frames and points
-  Vector3d mid_contact_point = (left_toe.first + left_heel.first) / 2;
-  auto left_toe_mid = std::pair<const Vector3d, const Frame<double>&>(
-      mid_contact_point, plant_w_spr.GetFrameByName("toe_left"));
-  auto right_toe_mid = std::pair<const Vector3d, const Frame<double>&>(
-      mid_contact_point, plant_w_spr.GetFrameByName("toe_right"));
-  auto left_toe_origin = std::pair<const Vector3d, const Frame<double>&>(
-      Vector3d::Zero(), plant_w_spr.GetFrameByName("toe_left"));
-  auto right_toe_origin = std::pair<const Vector3d, const Frame<double>&>(
-      Vector3d::Zero(), plant_w_spr.GetFrameByName("toe_right"));
+  auto lcm_local = MakeLcmInterface(FLAGS_lcm_url);
+  drake::lcm::DrakeLcm lcm_network("udpm://239.255.76.67:7667?ttl=1");
+
+  // With in_memory, the bus is tapped to republish its messages on lcm_local
+  InMemoryBus bus;
+  if (in_memory) {
+    bus.StartLcmTap(lcm_local.get());
+  }
 
   // Create state receiver.
   auto state_receiver =
       builder.AddSystem<systems::RobotOutputReceiver>(plant_w_spr);
 
   // Create command sender.
-  auto command_pub =
-      builder.AddSystem(LcmPublisherSystem::Make<dairlib::lcmt_robot_input>(
-          FLAGS_channel_u, &lcm_local, TriggerTypeSet({TriggerType::kForced})));
+  drake::systems::LeafSystem<double>* command_pub;
+  if (in_memory) {
+    command_pub =
+        builder.AddSystem<InMemoryPublisherSystem<dairlib::lcmt_robot_input>>(
+            bus.GetChannel<dairlib::lcmt_robot_input>(FLAGS_channel_u),
+            InMemoryTriggerTypes({TriggerType::kForced}));
+  } else {
+    command_pub =
+        builder.AddSystem(LcmPublisherSystem::Make<dairlib::lcmt_robot_input>(
+            FLAGS_channel_u, lcm_local.get(),
+            TriggerTypeSet({TriggerType::kForced})));
+  }
   auto command_sender =
       builder.AddSystem<systems::RobotCommandSender>(plant_w_spr);
 
   builder.Connect(command_sender->get_output_port(0),
-                  command_pub->get_input_port());
-
-  // Add emulator for floating base drift
-  Eigen::VectorXd drift_mean =
-      Eigen::VectorXd::Zero(plant_w_spr.num_positions());
-  Eigen::MatrixXd drift_cov = Eigen::MatrixXd::Zero(
-      plant_w_spr.num_positions(), plant_w_spr.num_positions());
-  drift_cov(4, 4) = FLAGS_drift_rate;  // x
-  drift_cov(5, 5) = FLAGS_drift_rate;  // y
-  drift_cov(6, 6) = FLAGS_drift_rate;  // z
-  // Note that we didn't add drift to yaw angle here because it requires
-  // changing SimulatorDrift.
-
-  auto simulator_drift =
-      builder.AddSystem<SimulatorDrift>(plant_w_spr, drift_mean, drift_cov);
-  builder.Connect(state_receiver->get_output_port(0),
-                  simulator_drift->get_input_port_state());
-
-  // Create human high-level control
-  Eigen::Vector2d global_target_position(1, 0);
-  Eigen::Vector2d params_of_no_turning(5, 1);
-  // Logistic function 1/(1+5*exp(x-1))
-  // The function ouputs 0.0007 when x = 0
-  //                     0.5    when x = 1
-  //                     0.9993 when x = 2
-  auto high_level_command = builder.AddSystem<cassie::osc::HighLevelCommand>(
-      plant_w_spr, context_w_spr.get(), global_target_position,
-      params_of_no_turning);
+                  command_pub->get_input_port(0));
+
+  // Create the walking controller (FSM, trajectory generators and OSC)
+  cassie::osc::OscWalkingControllerOptions controller_options;
+  controller_options.drift_rate = FLAGS_drift_rate;
+  controller_options.is_two_phase = FLAGS_is_two_phase;
+  controller_options.print_osc = FLAGS_print_osc;
+  controller_options.warm_start_qp = FLAGS_warm_start_qp;
+  auto controller = builder.AddSystem<cassie::osc::OscWalkingController>(
+      plant_w_spr, plant_wo_spr, controller_options);
   builder.Connect(state_receiver->get_output_port(0),
-                  high_level_command->get_state_input_port());
-
-  // Create heading traj generator
-  auto head_traj_gen = builder.AddSystem<cassie::osc::HeadingTrajGenerator>(
-      plant_w_spr, context_w_spr.get());
-  builder.Connect(simulator_drift->get_output_port(0),
-                  head_traj_gen->get_state_input_port());
-  builder.Connect(high_level_command->get_yaw_output_port(),
-                  head_traj_gen->get_yaw_input_port());
-
-  // Create finite state machine
-  int left_stance_state = 0;
-  int right_stance_state = 1;
-  int double_support_state = 2;
-  double left_support_duration = 0.35;
-  double right_support_duration = 0.35;
-  double double_support_duration = 0.02;
-  vector<int> fsm_states;
-  vector<double> state_durations;
-  if (FLAGS_is_two_phase) {
-    fsm_states = {left_stance_state, right_stance_state};
-    state_durations = {left_support_duration, right_support_duration};
-  } else {
-    fsm_states = {left_stance_state, double_support_state, right_stance_state,
-                  double_support_state};
-    state_durations = {left_support_duration, double_support_duration,
-                       right_support_duration, double_support_duration};
-  }
-  auto fsm = builder.AddSystem<systems::TimeBasedFiniteStateMachine>(
-      plant_w_spr, fsm_states, state_durations);
-  builder.Connect(simulator_drift->get_output_port(0),
-                  fsm->get_input_port_state());
-
-  // Create CoM trajectory generator
-  double desired_com_height = 0.89;
-  vector<int> unordered_fsm_states;
-  vector<double> unordered_state_durations;
-  vector<vector<std::pair<const Vector3d, const Frame<double>&>>>
-      contact_points_in_each_state;
-  if (FLAGS_is_two_phase) {
-    unordered_fsm_states = {left_stance_state, right_stance_state};
-    unordered_state_durations = {left_support_duration, right_support_duration};
-    contact_points_in_each_state.push_back({left_toe_mid});
-    contact_points_in_each_state.push_back({right_toe_mid});
-  } else {
-    unordered_fsm_states = {left_stance_state, right_stance_state,
-                            double_support_state};
-    unordered_state_durations = {left_support_duration, right_support_duration,
-                                 double_support_duration};
-    contact_points_in_each_state.push_back({left_toe_mid});
-    contact_points_in_each_state.push_back({right_toe_mid});
-    contact_points_in_each_state.push_back({left_toe_mid, right_toe_mid});
-  }
-  auto lipm_traj_generator = builder.AddSystem<systems::LIPMTrajGenerator>(
-      plant_w_spr, context_w_spr.get(), desired_com_height,
-      unordered_fsm_states, unordered_state_durations,
-      contact_points_in_each_state);
-  builder.Connect(fsm->get_output_port(0),
-                  lipm_traj_generator->get_input_port_fsm());
-  builder.Connect(simulator_drift->get_output_port(0),
-                  lipm_traj_generator->get_input_port_state());
-
-  // Create velocity control by foot placement
-  auto deviation_from_cp =
-      builder.AddSystem<cassie::osc::DeviationFromCapturePoint>(
-          plant_w_spr, context_w_spr.get());
-  builder.Connect(high_level_command->get_xy_output_port(),
-                  deviation_from_cp->get_input_port_des_hor_vel());
-  builder.Connect(simulator_drift->get_output_port(0),
-                  deviation_from_cp->get_input_port_state());
-
-  // Create swing leg trajectory generator (capture point)
-  double mid_foot_height = 0.1;
-  // Since the ground is soft in the simulation, we raise the desired final
-  // foot height by 1 cm. The controller is sensitive to this number, should
-  // tune this every time we change the simulation parameter or when we move
-  // to the hardware testing.
-  // Additionally, implementing a double support phase might mitigate the
-  // instability around state transition.
-  double desired_final_foot_height = 0.01;
-  double desired_final_vertical_foot_velocity = 0;  //-1;
-  double max_CoM_to_CP_dist = 0.4;
-  double cp_offset = 0.06;
-  double center_line_offset = 0.06;
-  vector<int> left_right_support_fsm_states = {left_stance_state,
-                                               right_stance_state};
-  vector<double> left_right_support_state_durations = {left_support_duration,
-                                                       right_support_duration};
-  vector<std::pair<const Vector3d, const Frame<double>&>> left_right_foot = {
-      left_toe_origin, right_toe_origin};
-  auto cp_traj_generator = builder.AddSystem<systems::CPTrajGenerator>(
-      plant_w_spr, context_w_spr.get(), left_right_support_fsm_states,
-      left_right_support_state_durations, left_right_foot, "pelvis",
-      mid_foot_height, desired_final_foot_height,
-      desired_final_vertical_foot_velocity, max_CoM_to_CP_dist, true, true,
-      true, cp_offset, center_line_offset);
-  builder.Connect(fsm->get_output_port(0),
-                  cp_traj_generator->get_input_port_fsm());
-  builder.Connect(simulator_drift->get_output_port(0),
-                  cp_traj_generator->get_input_port_state());
-  builder.Connect(lipm_traj_generator->get_output_port(0),
-                  cp_traj_generator->get_input_port_com());
-  builder.Connect(deviation_from_cp->get_output_port(0),
-                  cp_traj_generator->get_input_port_fp());
-
-  // Create Operational space control
-  auto osc = builder.AddSystem<systems::controllers::OperationalSpaceControl>(
-      plant_w_spr, plant_wo_spr, context_w_spr.get(), context_wo_spr.get(),
-      true, FLAGS_print_osc /*print_tracking_info*/);
-
-  // Cost
-  int n_v = plant_wo_spr.num_velocities();
-  MatrixXd Q_accel = 2 * MatrixXd::Identity(n_v, n_v);
-  osc->SetAccelerationCostForAllJoints(Q_accel);
-
-  // Distance constraint
-  multibody::KinematicEvaluatorSet<double> evaluators(plant_wo_spr);
-  auto left_loop = LeftLoopClosureEvaluator(plant_wo_spr);
-  auto right_loop = RightLoopClosureEvaluator(plant_wo_spr);
-  evaluators.add_evaluator(&left_loop);
-  evaluators.add_evaluator(&right_loop);
-  osc->AddKinematicConstraint(&evaluators);
-
-  // Soft constraint
-  // w_contact_relax shouldn't be too big, cause we want tracking error to be
-  // important
-  double w_contact_relax = 2000;
-  osc->SetWeightOfSoftContactConstraint(w_contact_relax);
-  // Friction coefficient
-  double mu = 0.4;
-  osc->SetContactFriction(mu);
-  // Add contact points (The position doesn't matter. It's not used in OSC)
-  auto left_toe_evaluator = multibody::WorldPointEvaluator(
-      plant_wo_spr, left_toe.first, left_toe.second, Matrix3d::Identity(),
-      Vector3d::Zero(), {1, 2});
-  auto left_heel_evaluator = multibody::WorldPointEvaluator(
-      plant_wo_spr, left_heel.first, left_heel.second, Matrix3d::Identity(),
-      Vector3d::Zero(), {0, 1, 2});
-  auto right_toe_evaluator = multibody::WorldPointEvaluator(
-      plant_wo_spr, right_toe.first, right_toe.second, Matrix3d::Identity(),
-      Vector3d::Zero(), {1, 2});
-  auto right_heel_evaluator = multibody::WorldPointEvaluator(
-      plant_wo_spr, right_heel.first, right_heel.second, Matrix3d::Identity(),
-      Vector3d::Zero(), {0, 1, 2});
-  osc->AddStateAndContactPoint(left_stance_state, &left_toe_evaluator);
-  osc->AddStateAndContactPoint(left_stance_state, &left_heel_evaluator);
-  osc->AddStateAndContactPoint(right_stance_state, &right_toe_evaluator);
-  osc->AddStateAndContactPoint(right_stance_state, &right_heel_evaluator);
-  if (!FLAGS_is_two_phase) {
-    osc->AddStateAndContactPoint(double_support_state, &left_toe_evaluator);
-    osc->AddStateAndContactPoint(double_support_state, &left_heel_evaluator);
-    osc->AddStateAndContactPoint(double_support_state, &right_toe_evaluator);
-    osc->AddStateAndContactPoint(double_support_state, &right_heel_evaluator);
-  }
-
-  // Swing foot tracking
-  MatrixXd W_swing_foot = 400 * MatrixXd::Identity(3, 3);
-  MatrixXd K_p_sw_ft = 100 * MatrixXd::Identity(3, 3);
-  MatrixXd K_d_sw_ft = 10 * MatrixXd::Identity(3, 3);
-  TransTaskSpaceTrackingData swing_foot_traj(
-      "cp_traj", K_p_sw_ft, K_d_sw_ft, W_swing_foot, plant_w_spr, plant_wo_spr);
-  swing_foot_traj.AddStateAndPointToTrack(left_stance_state, "toe_right");
-  swing_foot_traj.AddStateAndPointToTrack(right_stance_state, "toe_left");
-  osc->AddTrackingData(&swing_foot_traj);
-  // Center of mass tracking
-  MatrixXd W_com = MatrixXd::Identity(3, 3);
-  W_com(0, 0) = 2;
-  W_com(1, 1) = 2;
-  W_com(2, 2) = 2000;
-  MatrixXd K_p_com = 50 * MatrixXd::Identity(3, 3);
-  MatrixXd K_d_com = 10 * MatrixXd::Identity(3, 3);
-  ComTrackingData center_of_mass_traj("lipm_traj", K_p_com, K_d_com, W_com,
-                                      plant_w_spr, plant_wo_spr);
-  osc->AddTrackingData(&center_of_mass_traj);
-  // Pelvis rotation tracking (pitch and roll)
-  double w_pelvis_balance = 200;
-  double k_p_pelvis_balance = 200;
-  double k_d_pelvis_balance = 80;
-  Matrix3d W_pelvis_balance = MatrixXd::Zero(3, 3);
-  W_pelvis_balance(0, 0) = w_pelvis_balance;
-  W_pelvis_balance(1, 1) = w_pelvis_balance;
-  Matrix3d K_p_pelvis_balance = MatrixXd::Zero(3, 3);
-  K_p_pelvis_balance(0, 0) = k_p_pelvis_balance;
-  K_p_pelvis_balance(1, 1) = k_p_pelvis_balance;
-  Matrix3d K_d_pelvis_balance = MatrixXd::Zero(3, 3);
-  K_d_pelvis_balance(0, 0) = k_d_pelvis_balance;
-  K_d_pelvis_balance(1, 1) = k_d_pelvis_balance;
-  RotTaskSpaceTrackingData pelvis_balance_traj(
-      "pelvis_balance_traj", K_p_pelvis_balance, K_d_pelvis_balance,
-      W_pelvis_balance, plant_w_spr, plant_wo_spr);
-  pelvis_balance_traj.AddFrameToTrack("pelvis");
-  osc->AddTrackingData(&pelvis_balance_traj);
-  // Pelvis rotation tracking (yaw)
-  double w_heading = 200;
-  double k_p_heading = 50;
-  double k_d_heading = 40;
-  Matrix3d W_pelvis_heading = MatrixXd::Zero(3, 3);
-  W_pelvis_heading(2, 2) = w_heading;
-  Matrix3d K_p_pelvis_heading = MatrixXd::Zero(3, 3);
-  K_p_pelvis_heading(2, 2) = k_p_heading;
-  Matrix3d K_d_pelvis_heading = MatrixXd::Zero(3, 3);
-  K_d_pelvis_heading(2, 2) = k_d_heading;
-  RotTaskSpaceTrackingData pelvis_heading_traj(
-      "pelvis_heading_traj", K_p_pelvis_heading, K_d_pelvis_heading,
-      W_pelvis_heading, plant_w_spr, plant_wo_spr);
-  pelvis_heading_traj.AddFrameToTrack("pelvis");
-  osc->AddTrackingData(&pelvis_heading_traj, 0.1);  // 0.05
-  // Swing toe joint tracking (Currently use fix position)
-  // The desired position, -1.5, was derived heuristically. It is roughly the
-  // toe angle when Cassie stands on the ground.
-  MatrixXd W_swing_toe = 200 * MatrixXd::Identity(1, 1);
-  MatrixXd K_p_swing_toe = 200 * MatrixXd::Identity(1, 1);
-  MatrixXd K_d_swing_toe = 20 * MatrixXd::Identity(1, 1);
-  JointSpaceTrackingData swing_toe_traj("swing_toe_traj", K_p_swing_toe,
-                                        K_d_swing_toe, W_swing_toe, plant_w_spr,
-                                        plant_wo_spr);
-  swing_toe_traj.AddStateAndJointToTrack(left_stance_state, "toe_right",
-                                         "toe_rightdot");
-  swing_toe_traj.AddStateAndJointToTrack(right_stance_state, "toe_left",
-                                         "toe_leftdot");
-  osc->AddConstTrackingData(&swing_toe_traj, -1.5 * VectorXd::Ones(1), 0, 0.3);
-  // Swing hip yaw joint tracking
-  MatrixXd W_hip_yaw = 20 * MatrixXd::Identity(1, 1);
-  MatrixXd K_p_hip_yaw = 200 * MatrixXd::Identity(1, 1);
-  MatrixXd K_d_hip_yaw = 160 * MatrixXd::Identity(1, 1);
-  JointSpaceTrackingData swing_hip_yaw_traj("swing_hip_yaw_traj", K_p_hip_yaw,
-                                            K_d_hip_yaw, W_hip_yaw, plant_w_spr,
-                                            plant_wo_spr);
-  swing_hip_yaw_traj.AddStateAndJointToTrack(left_stance_state, "hip_yaw_right",
-                                             "hip_yaw_rightdot");
-  swing_hip_yaw_traj.AddStateAndJointToTrack(right_stance_state, "hip_yaw_left",
-                                             "hip_yaw_leftdot");
-  osc->AddConstTrackingData(&swing_hip_yaw_traj, VectorXd::Zero(1));
-  // Build OSC problem
-  osc->Build();
-  // Connect ports
-  builder.Connect(simulator_drift->get_output_port(0),
-                  osc->get_robot_output_input_port());
-  builder.Connect(fsm->get_output_port(0), osc->get_fsm_input_port());
-  builder.Connect(lipm_traj_generator->get_output_port(0),
-                  osc->get_tracking_data_input_port("lipm_traj"));
-  builder.Connect(cp_traj_generator->get_output_port(0),
-                  osc->get_tracking_data_input_port("cp_traj"));
-  builder.Connect(head_traj_gen->get_output_port(0),
-                  osc->get_tracking_data_input_port("pelvis_balance_traj"));
-  builder.Connect(head_traj_gen->get_output_port(0),
-                  osc->get_tracking_data_input_port("pelvis_heading_traj"));
-  builder.Connect(osc->get_output_port(0), command_sender->get_input_port(0));
+                  controller->get_state_input_port());
+  builder.Connect(controller->get_control_output_port(),
+                  command_sender->get_input_port(0));
   if (FLAGS_publish_osc_data) {
-    // Create osc debug sender.
-    auto osc_debug_pub =
-        builder.AddSystem(LcmPublisherSystem::Make<dairlib::lcmt_osc_output>(
-            "OSC_DEBUG", &lcm_local, TriggerTypeSet({TriggerType::kForced})));
-    builder.Connect(osc->get_osc_debug_port(), osc_debug_pub->get_input_port());
+    // Create osc debug sender, which encodes and sends off the control thread
+    auto osc_debug_pub = builder.AddSystem(
+        AsyncLcmPublisherSystem::Make<dairlib::lcmt_osc_output>(
+            "OSC_DEBUG", lcm_local.get(),
+            TriggerTypeSet({TriggerType::kForced})));
+    builder.Connect(controller->get_osc_debug_port(),
+                    osc_debug_pub->get_input_port(0));
   }
 
   // Create the diagram
   auto owned_diagram = builder.Build();
   owned_diagram->set_name("osc walking controller");
 
+  systems::RealtimeOptions realtime_options;
+  realtime_options.priority = FLAGS_rt_priority;
+  realtime_options.cpus = systems::ParseCpuList(FLAGS_cpus);
+  realtime_options.lock_memory = FLAGS_lock_memory;
+  realtime_options.spin_wait = FLAGS_spin_wait;
+  realtime_options.prefault = FLAGS_prefault;
+
+  if (in_memory) {
+    // The estimator and dispatcher share plant_w_spr (Cassie with springs and
+    // a floating base), which is only read after Finalize()
+    std::thread estimator_thread(RunStateEstimator, std::cref(plant_w_spr),
+                                 &bus, &lcm_network);
+    std::thread dispatcher_thread(RunRobotInDispatcher,
+                                  std::cref(plant_w_spr), &bus, &lcm_network);
+
+    // Run the controller driven by the in-memory state channel
+    systems::InMemoryDrivenLoop<dairlib::lcmt_robot_output> loop(
+        std::move(owned_diagram), state_receiver,
+        bus.GetChannel<dairlib::lcmt_robot_output>(FLAGS_channel_x), true);
+    loop.set_deadline(FLAGS_deadline);
+    if (!FLAGS_timing_channel.empty()) {
+      loop.EnableTimingPublisher(lcm_local.get(), FLAGS_timing_channel);
+    }
+    loop.EnableRealtime(realtime_options);
+    loop.Simulate();
+
+    estimator_thread.join();
+    dispatcher_thread.join();
+    return 0;
+  }
+
   // Run lcm-driven simulation
   systems::LcmDrivenLoop<dairlib::lcmt_robot_output> loop(
-      &lcm_local, std::move(owned_diagram), state_receiver, FLAGS_channel_x,
+      lcm_local.get(), std::move(owned_diagram), state_receiver,
+      FLAGS_channel_x,
       true);
+  loop.set_deadline(FLAGS_deadline);
+  if (!FLAGS_timing_channel.empty()) {
+    loop.EnableTimingPublisher(FLAGS_timing_channel);
+  }
+  loop.EnableRealtime(realtime_options);
+  if (!FLAGS_lockstep_channel.empty()) {
+    loop.EnableLockstep(FLAGS_lockstep_channel);
+  }
   loop.Simulate();
 
   return 0;
@@ -1,6 +1,7 @@
 #include "simulator_drift.h"
 
 using dairlib::systems::OutputVector;
+using drake::AbstractValue;
 using Eigen::VectorXd;
 
 SimulatorDrift::SimulatorDrift(
@@ -15,34 +16,54 @@ SimulatorDrift::SimulatorDrift(
                                                         plant_.num_actuators()))
           .get_index();
 
-  DeclarePerStepDiscreteUpdateEvent(&SimulatorDrift::DiscreteVariableUpdate);
+  DeclarePerStepUnrestrictedUpdateEvent(&SimulatorDrift::UnrestrictedUpdate);
   accumulated_drift_index_ =
       this->DeclareDiscreteState(VectorXd::Zero(plant_.num_positions()));
 
   time_idx_ = this->DeclareDiscreteState(1);
+  generator_idx_ =
+      this->DeclareAbstractState(
+          AbstractValue::Make<std::mt19937>(std::mt19937()));
   this->DeclareVectorOutputPort(
       OutputVector<double>(plant_.num_positions(), plant_.num_velocities(),
                            plant_.num_actuators()),
       &SimulatorDrift::CalcAdjustedState);
 }
 
-drake::systems::EventStatus SimulatorDrift::DiscreteVariableUpdate(
+void SimulatorDrift::SetRandomState(
     const drake::systems::Context<double>& context,
-    drake::systems::DiscreteValues<double>* discrete_state) const {
-  const OutputVector<double>* state =
+    drake::systems::State<double>* state,
+    drake::RandomGenerator* generator) const {
+  drake::systems::LeafSystem<double>::SetRandomState(context, state,
+                                                     generator);
+  state->get_mutable_abstract_state<std::mt19937>(generator_idx_)
+      .seed((*generator)());
+}
+
+drake::systems::EventStatus SimulatorDrift::UnrestrictedUpdate(
+    const drake::systems::Context<double>& context,
+    drake::systems::State<double>* state) const {
+  const OutputVector<double>* robot_output =
       (OutputVector<double>*)this->EvalVectorInput(context, state_port_);
-  auto prev_time_stamp =
-      discrete_state->get_mutable_vector(time_idx_).get_mutable_value();
-
-  if (state->get_timestamp() > prev_time_stamp(0)) {
-    auto accumulated_drift =
-        discrete_state->get_mutable_vector(accumulated_drift_index_)
-            .get_mutable_value();
-    double dt = state->get_timestamp() - prev_time_stamp(0);
-    VectorXd v = VectorXd::Random(drift_mean_.size());
+  auto prev_time_stamp = state->get_mutable_discrete_state()
+                             .get_mutable_vector(time_idx_)
+                             .get_mutable_value();
+
+  if (robot_output->get_timestamp() > prev_time_stamp(0)) {
+    auto accumulated_drift = state->get_mutable_discrete_state()
+                                 .get_mutable_vector(accumulated_drift_index_)
+                                 .get_mutable_value();
+    auto& generator =
+        state->get_mutable_abstract_state<std::mt19937>(generator_idx_);
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    double dt = robot_output->get_timestamp() - prev_time_stamp(0);
+    VectorXd v(drift_mean_.size());
+    for (int i = 0; i < v.size(); i++) {
+      v(i) = uniform(generator);
+    }
     accumulated_drift << accumulated_drift +
                              (drift_mean_ + drift_cov_ * v) * dt;
-    prev_time_stamp << state->get_timestamp();
+    prev_time_stamp << robot_output->get_timestamp();
   }
   return drake::systems::EventStatus::Succeeded();
 }
@@ -59,4 +80,4 @@ void SimulatorDrift::CalcAdjustedState(
   data.head(plant_.num_positions()) += accumulated_drift;
   output->SetDataVector(data);
   output->set_timestamp(robotOutput->get_timestamp());
-}
\ No newline at end of file
+}
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <memory>
+#include <random>
 #include <string>
 #include <vector>
 
+#include "drake/common/random.h"
 #include "drake/systems/framework/leaf_system.h"
 #include "systems/framework/output_vector.h"
 #include "drake/multibody/parsing/parser.h"
@@ -13,6 +15,10 @@
 /// random walk governed by the drift rate mean/covariance in m/s
 /// mean/covariance must be of the same size as the number of n_positions/
 /// n_positions x n_positions.
+///
+/// The random numbers are drawn from a generator in the Context's state, so
+/// that contexts can be simulated on separate threads. It is seeded by
+/// System::SetRandomContext(), and with a fixed seed otherwise.
 class SimulatorDrift : public drake::systems::LeafSystem<double> {
  public:
   SimulatorDrift(const drake::multibody::MultibodyPlant<double>& plant,
@@ -27,12 +33,17 @@ class SimulatorDrift : public drake::systems::LeafSystem<double> {
   void CalcAdjustedState(const drake::systems::Context<double>& context,
                          dairlib::systems::OutputVector<double>* output) const;
 
-  drake::systems::EventStatus DiscreteVariableUpdate(
+  drake::systems::EventStatus UnrestrictedUpdate(
       const drake::systems::Context<double>& context,
-      drake::systems::DiscreteValues<double>* discrete_state) const;
+      drake::systems::State<double>* state) const;
+
+  void SetRandomState(const drake::systems::Context<double>& context,
+                      drake::systems::State<double>* state,
+                      drake::RandomGenerator* generator) const override;
 
   int time_idx_;
   int accumulated_drift_index_;
+  int generator_idx_;
   const drake::multibody::MultibodyPlant<double>& plant_;
   Eigen::VectorXd drift_mean_;
   Eigen::MatrixXd drift_cov_;
@@ -0,0 +1,648 @@
+/// Benchmarks trajectory optimization problem construction and evaluation
+/// for the Cassie squatting, walking and jumping problems (see
+/// run_dircon_*.cc) and the planar walker (see run_gait_dircon.cc), and
+/// writes the results as JSON, e.g.
+///
+///   bazel run //examples/Cassie:benchmark_trajopt -- \
+///       --output=/tmp/trajopt.json --label=$(git rev-parse --short HEAD)
+///
+/// Each problem keeps the contact modes, kinematic constraints, dynamics and
+/// running costs of its example, which dominate the cost of evaluation, but
+/// drops task-specific boundary constraints, initial guesses loaded from
+/// file, and visualization. All problems start from the same seeded random
+/// initial guess.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "common/find_resource.h"
+#include "examples/Cassie/cassie_utils.h"
+#include "multibody/kinematic/distance_evaluator.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "multibody/multibody_utils.h"
+#include "solvers/optimization_utils.h"
+#include "systems/trajectory_optimization/dircon/dircon.h"
+#include "systems/trajectory_optimization/dircon_distance_data.h"
+#include "systems/trajectory_optimization/dircon_kinematic_data_set.h"
+#include "systems/trajectory_optimization/dircon_position_data.h"
+#include "systems/trajectory_optimization/hybrid_dircon.h"
+#include "drake/math/autodiff.h"
+#include "drake/multibody/parsing/parser.h"
+#include "drake/solvers/snopt_solver.h"
+
+DEFINE_string(output, "trajopt_benchmark.json",
+              "File to write the JSON results to");
+DEFINE_string(label, "",
+              "Free-form label stored with the results, e.g. a commit hash");
+DEFINE_string(problems, "squatting,walking,jumping,planar_walker",
+              "Comma-separated list of problems to run");
+DEFINE_int32(num_reps, 10, "Repetitions of each evaluation pass");
+DEFINE_int32(solve_iterations, 20,
+             "SNOPT major iteration limit for the fixed-iteration solve. "
+             "Zero skips the solve.");
+DEFINE_int32(num_threads, 1,
+             "Threads used to evaluate the constraints of each Dircon mode");
+DEFINE_bool(analytic_gradient, false,
+            "Use analytic collocation gradients for Dircon problems");
+
+namespace dairlib {
+namespace {
+
+using drake::AutoDiffVecXd;
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using drake::solvers::Binding;
+using drake::solvers::Constraint;
+using drake::solvers::MathematicalProgram;
+using drake::systems::trajectory_optimization::MultipleShooting;
+using Eigen::Matrix3d;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+using multibody::KinematicEvaluator;
+using multibody::KinematicEvaluatorSet;
+using multibody::WorldPointEvaluator;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using systems::trajectory_optimization::Dircon;
+using systems::trajectory_optimization::DirconDistanceData;
+using systems::trajectory_optimization::DirconKinematicData;
+using systems::trajectory_optimization::DirconKinematicDataSet;
+using systems::trajectory_optimization::DirconMode;
+using systems::trajectory_optimization::DirconModeSequence;
+using systems::trajectory_optimization::DirconOptions;
+using systems::trajectory_optimization::DirconPositionData;
+using systems::trajectory_optimization::DynamicsCache;
+using systems::trajectory_optimization::HybridDircon;
+
+/// A trajectory optimization problem, owning everything its program refers to
+class BenchmarkProblem {
+ public:
+  virtual ~BenchmarkProblem() = default;
+
+  virtual MultipleShooting& trajopt() = 0;
+
+  virtual const MultibodyPlant<double>& plant() const = 0;
+
+  /// The DynamicsCache of each mode. Empty for HybridDircon problems.
+  virtual vector<const DynamicsCache<double>*> dynamics_caches() const {
+    return {};
+  }
+};
+
+void LoadCassie(MultibodyPlant<double>* plant) {
+  Parser parser(plant);
+  parser.AddModelFromFile(
+      FindResourceOrThrow("examples/Cassie/urdf/cassie_fixed_springs.urdf"));
+  plant->Finalize();
+}
+
+/// Base class for problems built with Dircon
+class DirconProblem : public BenchmarkProblem {
+ public:
+  MultipleShooting& trajopt() override { return *trajopt_; }
+
+  const MultibodyPlant<double>& plant() const override { return plant_; }
+
+  vector<const DynamicsCache<double>*> dynamics_caches() const override {
+    vector<const DynamicsCache<double>*> caches;
+    for (int i = 0; i < trajopt_->num_modes(); i++) {
+      caches.push_back(&trajopt_->get_dynamics_cache(i));
+    }
+    return caches;
+  }
+
+ protected:
+  // Applies the benchmark's threading and gradient options to a mode
+  DirconMode<double>* AddMode(const KinematicEvaluatorSet<double>& evaluators,
+                              int num_knotpoints, double min_T,
+                              double max_T) {
+    modes_.push_back(std::make_unique<DirconMode<double>>(
+        evaluators, num_knotpoints, min_T, max_T));
+    modes_.back()->set_num_threads(FLAGS_num_threads);
+    modes_.back()->set_analytic_collocation_gradient(FLAGS_analytic_gradient);
+    return modes_.back().get();
+  }
+
+  template <typename E>
+  E* AddEvaluator(unique_ptr<E> evaluator) {
+    E* ptr = evaluator.get();
+    evaluators_.push_back(std::move(evaluator));
+    return ptr;
+  }
+
+  MultibodyPlant<double> plant_{0.0};
+  vector<unique_ptr<KinematicEvaluator<double>>> evaluators_;
+  vector<unique_ptr<KinematicEvaluatorSet<double>>> evaluator_sets_;
+  vector<unique_ptr<DirconMode<double>>> modes_;
+  unique_ptr<DirconModeSequence<double>> sequence_;
+  unique_ptr<Dircon<double>> trajopt_;
+};
+
+/// Double support squatting, from run_dircon_squatting.cc
+class CassieSquatting : public DirconProblem {
+ public:
+  CassieSquatting() {
+    LoadCassie(&plant_);
+    const int n_v = plant_.num_velocities();
+    const int n_u = plant_.num_actuators();
+
+    auto evaluators = std::make_unique<KinematicEvaluatorSet<double>>(plant_);
+    const std::vector<int> toe_active_inds{0, 1, 2};
+    const std::vector<int> heel_active_inds{1, 2};
+    vector<int> contact_inds;
+    for (const auto& contact :
+         {LeftToeFront(plant_), LeftToeRear(plant_), RightToeFront(plant_),
+          RightToeRear(plant_)}) {
+      const bool is_toe = contact_inds.size() % 2 == 0;
+      auto* eval = AddEvaluator(std::make_unique<WorldPointEvaluator<double>>(
+          plant_, contact.first, contact.second, Matrix3d::Identity(),
+          Vector3d::Zero(), is_toe ? toe_active_inds : heel_active_inds));
+      eval->set_frictional();
+      eval->set_mu(1);
+      contact_inds.push_back(evaluators->add_evaluator(eval));
+    }
+    evaluators->add_evaluator(AddEvaluator(
+        std::make_unique<multibody::DistanceEvaluator<double>>(
+            LeftLoopClosureEvaluator(plant_))));
+    evaluators->add_evaluator(AddEvaluator(
+        std::make_unique<multibody::DistanceEvaluator<double>>(
+            RightLoopClosureEvaluator(plant_))));
+
+    const int num_knotpoints = 20;
+    auto* mode = AddMode(*evaluators, num_knotpoints, .2, 5);
+    for (int ind : contact_inds) {
+      mode->MakeConstraintRelative(ind, 0);
+      mode->MakeConstraintRelative(ind, 1);
+    }
+    for (int i = 0; i < num_knotpoints; i++) {
+      mode->SkipQuaternionConstraint(i);
+    }
+    evaluator_sets_.push_back(std::move(evaluators));
+
+    trajopt_ = std::make_unique<Dircon<double>>(mode);
+    auto x = trajopt_->state();
+    auto u = trajopt_->input();
+    const MatrixXd Q = 10 * 12.5 * MatrixXd::Identity(n_v, n_v);
+    const MatrixXd R = 12.5 * MatrixXd::Identity(n_u, n_u);
+    trajopt_->AddRunningCost(x.tail(n_v).transpose() * Q * x.tail(n_v));
+    trajopt_->AddRunningCost(u.transpose() * R * u);
+  }
+};
+
+/// Two-mode walking on the planar walker, from run_gait_dircon.cc
+class PlanarWalker : public DirconProblem {
+ public:
+  PlanarWalker() {
+    Parser parser(&plant_);
+    parser.AddModelFromFile(
+        FindResourceOrThrow("examples/PlanarWalker/PlanarWalker.urdf"));
+    plant_.WeldFrames(plant_.world_frame(), plant_.GetFrameByName("base"),
+                      drake::math::RigidTransform<double>());
+    plant_.Finalize();
+
+    sequence_ = std::make_unique<DirconModeSequence<double>>(plant_);
+    for (const string& leg : {"left_lower_leg", "right_lower_leg"}) {
+      auto* eval = AddEvaluator(std::make_unique<WorldPointEvaluator<double>>(
+          plant_, Vector3d(0, 0, -.5), plant_.GetFrameByName(leg),
+          Matrix3d::Identity(), Vector3d::Zero(), std::vector<int>{0, 2}));
+      eval->set_frictional();
+      eval->set_mu(1);
+      evaluator_sets_.push_back(
+          std::make_unique<KinematicEvaluatorSet<double>>(plant_));
+      evaluator_sets_.back()->add_evaluator(eval);
+      auto* mode = AddMode(*evaluator_sets_.back(), 10, .1, 3);
+      mode->MakeConstraintRelative(0, 0);
+      sequence_->AddMode(mode);
+    }
+
+    trajopt_ = std::make_unique<Dircon<double>>(*sequence_);
+    trajopt_->AddDurationBounds(1, 1);
+    auto u = trajopt_->input();
+    trajopt_->AddRunningCost(10 * u.transpose() * u);
+  }
+};
+
+/// Base class for problems built with HybridDircon
+class HybridDirconProblem : public BenchmarkProblem {
+ public:
+  MultipleShooting& trajopt() override { return *trajopt_; }
+
+  const MultibodyPlant<double>& plant() const override { return plant_; }
+
+ protected:
+  HybridDirconProblem() {
+    LoadCassie(&plant_);
+
+    const auto& toe_left = plant_.GetBodyByName("toe_left");
+    const auto& toe_right = plant_.GetBodyByName("toe_right");
+    const Vector3d pt_front_contact(-0.0457, 0.112, 0);
+    const Vector3d pt_rear_contact(0.088, 0, 0);
+    for (const auto* toe : {&toe_left, &toe_right}) {
+      for (const auto& pt : {pt_front_contact, pt_rear_contact}) {
+        contacts_.push_back(
+            std::make_unique<DirconPositionData<double>>(plant_, *toe, pt));
+        contacts_.back()->addFixedNormalFrictionConstraints(1);
+      }
+    }
+
+    const double rod_length = 0.5012;
+    const Vector3d pt_on_heel_spring(.11877, -.01, 0.0);
+    const Vector3d pt_on_thigh_left(0.0, 0.0, 0.045);
+    const Vector3d pt_on_thigh_right(0.0, 0.0, -0.045);
+    loop_closures_.push_back(std::make_unique<DirconDistanceData<double>>(
+        plant_, plant_.GetBodyByName("thigh_left"), pt_on_thigh_left,
+        plant_.GetBodyByName("heel_spring_left"), pt_on_heel_spring,
+        rod_length));
+    loop_closures_.push_back(std::make_unique<DirconDistanceData<double>>(
+        plant_, plant_.GetBodyByName("thigh_right"), pt_on_thigh_right,
+        plant_.GetBodyByName("heel_spring_right"), pt_on_heel_spring,
+        rod_length));
+  }
+
+  // Adds a contact mode from the given contacts (indices into contacts_,
+  // ordered left front, left rear, right front, right rear) and both loop
+  // closures, skipping the given redundant rows
+  DirconKinematicDataSet<double>* AddMode(const vector<int>& contacts,
+                                          const vector<int>& skip_inds) {
+    constraint_lists_.push_back(
+        std::make_unique<vector<DirconKinematicData<double>*>>());
+    for (int i : contacts) {
+      constraint_lists_.back()->push_back(contacts_.at(i).get());
+    }
+    for (const auto& loop_closure : loop_closures_) {
+      constraint_lists_.back()->push_back(loop_closure.get());
+    }
+    datasets_.push_back(std::make_unique<DirconKinematicDataSet<double>>(
+        plant_, constraint_lists_.back().get(), skip_inds));
+    return datasets_.back().get();
+  }
+
+  void AddCosts(double w_Q, double w_R) {
+    const int n_v = plant_.num_velocities();
+    const int n_u = plant_.num_actuators();
+    auto x = trajopt_->state();
+    auto u = trajopt_->input();
+    const MatrixXd Q = w_Q * MatrixXd::Identity(n_v, n_v);
+    const MatrixXd R = w_R * MatrixXd::Identity(n_u, n_u);
+    trajopt_->AddRunningCost(x.tail(n_v).transpose() * Q * x.tail(n_v));
+    trajopt_->AddRunningCost(u.transpose() * R * u);
+  }
+
+  MultibodyPlant<double> plant_{0.0};
+  vector<unique_ptr<DirconPositionData<double>>> contacts_;
+  vector<unique_ptr<DirconDistanceData<double>>> loop_closures_;
+  vector<unique_ptr<vector<DirconKinematicData<double>*>>> constraint_lists_;
+  vector<unique_ptr<DirconKinematicDataSet<double>>> datasets_;
+  unique_ptr<HybridDircon<double>> trajopt_;
+};
+
+/// Left stance followed by a right touchdown, from run_dircon_walking.cc
+class CassieWalking : public HybridDirconProblem {
+ public:
+  CassieWalking() {
+    auto* left_stance = AddMode({0, 1}, {3});
+    auto* right_stance = AddMode({2, 3}, {3});
+    vector<DirconOptions> options;
+    for (auto* dataset : {left_stance, right_stance}) {
+      options.emplace_back(dataset->countConstraints(), plant_);
+      options.back().setForceCost(sqrt(0.1) * 1.0e-4);
+      options.back().setConstraintRelative(0, true);
+      options.back().setConstraintRelative(1, true);
+      options.back().setConstraintRelative(3, true);
+    }
+    trajopt_ = std::make_unique<HybridDircon<double>>(
+        plant_, vector<int>{16, 1}, vector<double>{0.01, 0.01},
+        vector<double>{0.3, 0.3},
+        vector<DirconKinematicDataSet<double>*>{left_stance, right_stance},
+        options);
+    trajopt_->AddDurationBounds(0.4, 0.4);
+    AddCosts(0.05, 0.0001);
+  }
+};
+
+/// Stance, flight and landing, from run_dircon_jumping.cc
+class CassieJumping : public HybridDirconProblem {
+ public:
+  CassieJumping() {
+    auto* double_stance = AddMode({0, 1, 2, 3}, {3, 9});
+    auto* flight = AddMode({}, {});
+    DirconOptions double_stance_options(double_stance->countConstraints(),
+                                        plant_);
+    for (int i : {0, 1, 3, 5, 6, 8}) {
+      double_stance_options.setConstraintRelative(i, true);
+    }
+    DirconOptions flight_options(flight->countConstraints(), plant_);
+    const int knot_points = 10;
+    trajopt_ = std::make_unique<HybridDircon<double>>(
+        plant_, vector<int>{knot_points, knot_points, knot_points},
+        vector<double>{.03, .03, .03}, vector<double>{.3, .3, .3},
+        vector<DirconKinematicDataSet<double>*>{double_stance, flight,
+                                                double_stance},
+        vector<DirconOptions>{double_stance_options, flight_options,
+                              double_stance_options});
+    AddCosts(0.01, 0.001);
+  }
+};
+
+/// Seeded random initial guess, with unit quaternions and positive timesteps
+void SetInitialGuess(BenchmarkProblem* problem) {
+  MultipleShooting& trajopt = problem->trajopt();
+  std::srand(0);
+  trajopt.SetInitialGuessForAllVariables(
+      VectorXd::Random(trajopt.decision_variables().size()));
+  const auto quat_starts = multibody::QuaternionStartIndices(problem->plant());
+  for (int i = 0; i < trajopt.N(); i++) {
+    auto xi = trajopt.state(i);
+    for (int start : quat_starts) {
+      trajopt.SetInitialGuess(xi.segment(start, 4),
+                              Eigen::Vector4d(1, 0, 0, 0));
+    }
+    if (i < trajopt.N() - 1) {
+      trajopt.SetInitialGuess(trajopt.timestep(i)(0), 0.05);
+    }
+  }
+}
+
+/// A constraint binding, with the indices of its variables in the program
+struct IndexedBinding {
+  Binding<Constraint> binding;
+  vector<int> indices;
+};
+
+vector<IndexedBinding> IndexBindings(const MathematicalProgram& prog) {
+  vector<IndexedBinding> bindings;
+  for (const auto& binding : prog.GetAllConstraints()) {
+    IndexedBinding indexed{binding, {}};
+    for (int i = 0; i < binding.variables().size(); i++) {
+      indexed.indices.push_back(
+          prog.FindDecisionVariableIndex(binding.variables()(i)));
+    }
+    bindings.push_back(indexed);
+  }
+  return bindings;
+}
+
+VectorXd Gather(const IndexedBinding& binding, const VectorXd& z) {
+  VectorXd x(binding.indices.size());
+  for (int i = 0; i < x.size(); i++) {
+    x(i) = z(binding.indices[i]);
+  }
+  return x;
+}
+
+// JSON has no representation of infinity or NaN, so non-finite values (e.g.
+// the cost of a failed solve) are written as null
+string JsonNumber(double value) {
+  if (!std::isfinite(value)) {
+    return "null";
+  }
+  std::ostringstream out;
+  out << std::setprecision(9) << value;
+  return out.str();
+}
+
+// Quoted JSON string, with quotes, backslashes and control characters escaped
+string JsonString(const string& value) {
+  std::ostringstream out;
+  out << '"';
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      case '\r':
+        out << "\\r";
+        break;
+      case '\t':
+        out << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+              << static_cast<int>(c) << std::dec;
+        } else {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+  return out.str();
+}
+
+/// Wall clock times of repeated runs, in seconds
+struct Timing {
+  vector<double> samples;
+
+  void Measure(const std::function<void()>& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto finish = std::chrono::steady_clock::now();
+    samples.push_back(std::chrono::duration<double>(finish - start).count());
+  }
+
+  // With no samples, the mean, min and max are written as null
+  string ToJson() const {
+    double sum = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    for (double t : samples) {
+      sum += t;
+      min = std::min(min, t);
+      max = std::max(max, t);
+    }
+    const double mean = samples.empty()
+                            ? std::numeric_limits<double>::quiet_NaN()
+                            : sum / samples.size();
+    std::ostringstream out;
+    out << "{\"mean\": " << JsonNumber(mean)
+        << ", \"min\": " << JsonNumber(min)
+        << ", \"max\": " << JsonNumber(max)
+        << ", \"reps\": " << samples.size() << "}";
+    return out.str();
+  }
+};
+
+DynamicsCache<double>::Stats SumStats(
+    const vector<const DynamicsCache<double>*>& caches) {
+  DynamicsCache<double>::Stats total;
+  for (const auto* cache : caches) {
+    const auto stats = cache->GetStats();
+    total.hits += stats.hits;
+    total.misses += stats.misses;
+    total.evictions += stats.evictions;
+  }
+  return total;
+}
+
+// Cache statistics accumulated between two snapshots
+string StatsToJson(const DynamicsCache<double>::Stats& before,
+                   const DynamicsCache<double>::Stats& after) {
+  const int64_t hits = after.hits - before.hits;
+  const int64_t misses = after.misses - before.misses;
+  std::ostringstream out;
+  out << std::setprecision(6) << "{\"hits\": " << hits
+      << ", \"misses\": " << misses
+      << ", \"evictions\": " << after.evictions - before.evictions
+      << ", \"hit_rate\": "
+      << ((hits + misses > 0) ? static_cast<double>(hits) / (hits + misses)
+                              : 0.0)
+      << "}";
+  return out.str();
+}
+
+string RunBenchmark(const string& name,
+                    const std::function<unique_ptr<BenchmarkProblem>()>&
+                        construct) {
+  std::cout << "Benchmarking " << name << std::endl;
+  unique_ptr<BenchmarkProblem> problem;
+  Timing construction;
+  construction.Measure([&]() { problem = construct(); });
+  SetInitialGuess(problem.get());
+
+  MultipleShooting& prog = problem->trajopt();
+  const VectorXd z = prog.initial_guess();
+  const auto bindings = IndexBindings(prog);
+  const auto caches = problem->dynamics_caches();
+  const auto stats_start = SumStats(caches);
+
+  // One pass over every constraint in double, and in AutoDiffXd with each
+  // binding seeded by the identity, as a gradient-based solver would
+  Timing eval_double, eval_autodiff, gradient;
+  for (int rep = 0; rep < FLAGS_num_reps; rep++) {
+    eval_double.Measure([&]() {
+      VectorXd y;
+      for (const auto& b : bindings) {
+        b.binding.evaluator()->Eval(Gather(b, z), &y);
+      }
+    });
+    eval_autodiff.Measure([&]() {
+      AutoDiffVecXd y;
+      for (const auto& b : bindings) {
+        b.binding.evaluator()->Eval(
+            drake::math::initializeAutoDiff(Gather(b, z)), &y);
+      }
+    });
+    // The full constraint Jacobian, w.r.t. all decision variables
+    gradient.Measure([&]() {
+      VectorXd y, lb, ub;
+      MatrixXd A;
+      solvers::LinearizeConstraints(prog, z, &y, &A, &lb, &ub);
+    });
+  }
+  const auto stats_eval = SumStats(caches);
+
+  // Fixed-iteration solve
+  string solve_json = "null";
+  drake::solvers::SnoptSolver snopt;
+  if (FLAGS_solve_iterations > 0 && snopt.available()) {
+    const auto id = drake::solvers::SnoptSolver::id();
+    prog.SetSolverOption(id, "Major iterations limit", FLAGS_solve_iterations);
+    prog.SetSolverOption(id, "Iterations limit", 100000);
+    prog.SetSolverOption(id, "Verify level", 0);
+    drake::solvers::MathematicalProgramResult result;
+    Timing solve;
+    solve.Measure([&]() {
+      snopt.Solve(prog, z, prog.solver_options(), &result);
+    });
+    std::ostringstream out;
+    out << "{\"seconds\": " << JsonNumber(solve.samples[0])
+        << ", \"major_iterations_limit\": " << FLAGS_solve_iterations
+        << ", \"result\": "
+        << JsonString(to_string(result.get_solution_result()))
+        << ", \"cost\": " << JsonNumber(result.get_optimal_cost()) << "}";
+    solve_json = out.str();
+  }
+  const auto stats_solve = SumStats(caches);
+
+  std::ostringstream out;
+  out << "    {\n"
+      << "      \"name\": " << JsonString(name) << ",\n"
+      << "      \"num_decision_variables\": " << prog.num_vars() << ",\n"
+      << "      \"num_constraint_bindings\": " << bindings.size() << ",\n"
+      << "      \"num_constraint_rows\": "
+      << solvers::CountConstraintRows(prog) << ",\n"
+      << "      \"construction_seconds\": " << construction.ToJson() << ",\n"
+      << "      \"eval_double_seconds\": " << eval_double.ToJson() << ",\n"
+      << "      \"eval_autodiff_seconds\": " << eval_autodiff.ToJson()
+      << ",\n"
+      << "      \"full_gradient_seconds\": " << gradient.ToJson() << ",\n";
+  if (caches.empty()) {
+    out << "      \"dynamics_cache\": null,\n";
+  } else {
+    out << "      \"dynamics_cache\": {\"evaluation\": "
+        << StatsToJson(stats_start, stats_eval)
+        << ", \"solve\": " << StatsToJson(stats_eval, stats_solve) << "},\n";
+  }
+  out << "      \"solve\": " << solve_json << "\n"
+      << "    }";
+  return out.str();
+}
+
+int DoMain() {
+  const std::vector<
+      std::pair<string, std::function<unique_ptr<BenchmarkProblem>()>>>
+      all_problems{
+          {"squatting", []() { return std::make_unique<CassieSquatting>(); }},
+          {"walking", []() { return std::make_unique<CassieWalking>(); }},
+          {"jumping", []() { return std::make_unique<CassieJumping>(); }},
+          {"planar_walker", []() { return std::make_unique<PlanarWalker>(); }},
+      };
+
+  vector<string> results;
+  std::stringstream requested(FLAGS_problems);
+  string name;
+  while (std::getline(requested, name, ',')) {
+    const auto it = std::find_if(
+        all_problems.begin(), all_problems.end(),
+        [&name](const auto& problem) { return problem.first == name; });
+    if (it == all_problems.end()) {
+      std::cerr << "Unknown problem: " << name << std::endl;
+      return 1;
+    }
+    results.push_back(RunBenchmark(it->first, it->second));
+  }
+
+  std::ofstream out(FLAGS_output);
+  out << "{\n"
+      << "  \"benchmark\": \"trajopt\",\n"
+      << "  \"label\": " << JsonString(FLAGS_label) << ",\n"
+      << "  \"num_reps\": " << FLAGS_num_reps << ",\n"
+      << "  \"num_threads\": " << FLAGS_num_threads << ",\n"
+      << "  \"analytic_gradient\": "
+      << (FLAGS_analytic_gradient ? "true" : "false") << ",\n"
+      << "  \"problems\": [\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    out << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+  std::cout << "Wrote " << FLAGS_output << std::endl;
+  return 0;
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  return dairlib::DoMain();
+}
@@ -0,0 +1,88 @@
+#include "examples/Cassie/cassie_batch_rollout.h"
+
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "examples/Cassie/cassie_fixed_point_solver.h"
+#include "examples/Cassie/cassie_utils.h"
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+
+namespace dairlib {
+namespace {
+
+using drake::CompareMatrices;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+class CassieBatchRolloutTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    drake::multibody::MultibodyPlant<double> plant(0.0);
+    addCassieMultibody(&plant, nullptr, true /*floating base*/,
+                       "examples/Cassie/urdf/cassie_v2.urdf",
+                       true /*spring model*/, true /*loop closure*/);
+    plant.Finalize();
+    VectorXd q_init, u_init, lambda_init;
+    CassieFixedPointSolver(plant, 1.0, 0, 70, true, .2, &q_init, &u_init,
+                           &lambda_init);
+    const int n_v = plant.num_velocities();
+
+    options_.end_time = 0.05;
+    // Noise and warm starts make the metrics depend on the seeds and on the
+    // controller's state
+    options_.velocity_noise = 0.01 * MatrixXd::Identity(n_v, n_v);
+    options_.controller.warm_start_qp = true;
+
+    // Two inclines, in an order which makes the threads alternate between them
+    for (int i = 0; i < 6; i++) {
+      CassieRolloutSpec spec;
+      spec.q_init = q_init;
+      spec.v_init = VectorXd::Zero(n_v);
+      spec.v_init(3) = 0.05 * (i % 3);
+      spec.incline = (i % 2) ? 0.02 : 0;
+      spec.seed = i / 2;
+      specs_.push_back(spec);
+    }
+  }
+
+  // The metrics which don't depend on the speed of the machine
+  static void ExpectSameOutcome(const CassieRolloutMetrics& a,
+                                const CassieRolloutMetrics& b) {
+    EXPECT_EQ(a.fell, b.fell);
+    EXPECT_EQ(a.failed, b.failed);
+    EXPECT_TRUE(CompareMatrices(a.end_time, b.end_time));
+    EXPECT_TRUE(CompareMatrices(a.tracking_cost, b.tracking_cost));
+    EXPECT_TRUE(
+        CompareMatrices(a.soft_constraint_cost, b.soft_constraint_cost));
+  }
+
+  CassieRolloutOptions options_;
+  std::vector<CassieRolloutSpec> specs_;
+};
+
+TEST_F(CassieBatchRolloutTest, ThreadsAndOrderDoNotChangeMetrics) {
+  CassieBatchRollout serial(options_, 1);
+  const CassieRolloutMetrics serial_metrics = serial.Run(specs_);
+  EXPECT_EQ(serial_metrics.failed.sum(), 0);
+  EXPECT_GT(serial_metrics.tracking_cost.minCoeff(), 0);
+  // The seeds matter, so equal metrics below are not a coincidence
+  CassieRolloutSpec reseeded = specs_[0];
+  reseeded.seed = 10;
+  EXPECT_NE(serial.Run({reseeded}).tracking_cost(0),
+            serial_metrics.tracking_cost(0));
+
+  CassieBatchRollout parallel(options_, 3);
+  ExpectSameOutcome(parallel.Run(specs_), serial_metrics);
+
+  // The workers' second batch, after other rollouts, matches the first
+  ExpectSameOutcome(serial.Run(specs_), serial_metrics);
+  ExpectSameOutcome(parallel.Run(specs_), serial_metrics);
+
+  // A rollout on its own matches the same rollout in a batch
+  const CassieRolloutMetrics single = serial.Run({specs_[5]});
+  EXPECT_EQ(single.tracking_cost(0), serial_metrics.tracking_cost(5));
+}
+
+}  // namespace
+}  // namespace dairlib
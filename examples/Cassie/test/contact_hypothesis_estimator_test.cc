@@ -0,0 +1,132 @@
+#include "examples/Cassie/contact_hypothesis_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/solvers/equality_constrained_qp_solver.h"
+#include "drake/solvers/mathematical_program.h"
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+using drake::solvers::MathematicalProgram;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+using std::vector;
+
+// Random problem data, of Cassie's dimensions
+class ContactHypothesisEstimatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::srand(0);
+    const MatrixXd R = MatrixXd::Random(n_v_, n_v_);
+    M_ = R * R.transpose() + n_v_ * MatrixXd::Identity(n_v_, n_v_);
+    C_ = 10 * VectorXd::Random(n_v_);
+    J_b_ = MatrixXd::Random(n_b_, n_v_);
+    JdotV_b_ = VectorXd::Random(n_b_);
+    for (int c = 0; c < 2; c++) {
+      J_c_.push_back(MatrixXd::Random(contact_dims_[c], n_v_));
+      J_c_active_.push_back(J_c_[c].topRows(active_dims_[c]));
+      JdotV_c_active_.push_back(VectorXd::Random(active_dims_[c]));
+    }
+    J_imu_ = MatrixXd::Random(3, n_v_);
+    JdotV_imu_ = VectorXd::Random(3);
+    imu_accel_ = Vector3d::Random();
+  }
+
+  // The hypothesis as a MathematicalProgram, as CassieStateEstimator used to
+  // pose it, returning the optimal cost and writing the accelerations to ddq
+  double SolveWithProgram(const vector<int>& contacts, VectorXd* ddq) {
+    MathematicalProgram prog;
+    auto ddq_var = prog.NewContinuousVariables(n_v_);
+    auto lambda_b = prog.NewContinuousVariables(n_b_);
+    auto eps_imu = prog.NewContinuousVariables(3);
+    drake::solvers::VectorXDecisionVariable w(n_v_ + n_b_);
+    w << ddq_var, lambda_b;
+    MatrixXd A(n_v_, n_v_ + n_b_);
+    A << M_, -J_b_.transpose();
+    for (int c : contacts) {
+      auto lambda = prog.NewContinuousVariables(contact_dims_[c]);
+      auto eps = prog.NewContinuousVariables(active_dims_[c]);
+      w.conservativeResize(w.size() + lambda.size());
+      w.tail(lambda.size()) = lambda;
+      A.conservativeResize(n_v_, A.cols() + lambda.size());
+      A.rightCols(lambda.size()) = -J_c_[c].transpose();
+      MatrixXd coeff(active_dims_[c], n_v_ + active_dims_[c]);
+      coeff << J_c_active_[c], MatrixXd::Identity(active_dims_[c],
+                                                  active_dims_[c]);
+      prog.AddLinearEqualityConstraint(coeff, -JdotV_c_active_[c],
+                                       {ddq_var, eps});
+      prog.AddQuadraticCost(
+          w_ * MatrixXd::Identity(active_dims_[c], active_dims_[c]),
+          VectorXd::Zero(active_dims_[c]), eps);
+    }
+    prog.AddLinearEqualityConstraint(J_b_, -JdotV_b_, ddq_var);
+    MatrixXd imu_coeff(3, n_v_ + 3);
+    imu_coeff << J_imu_, MatrixXd::Identity(3, 3);
+    prog.AddLinearEqualityConstraint(imu_coeff, imu_accel_ - JdotV_imu_,
+                                     {ddq_var, eps_imu});
+    prog.AddQuadraticCost(w_ * MatrixXd::Identity(3, 3), VectorXd::Zero(3),
+                          eps_imu);
+    prog.AddQuadraticCost(
+        2 * A.transpose() * A +
+            eps_ * MatrixXd::Identity(A.cols(), A.cols()),
+        2 * A.transpose() * C_, w);
+
+    drake::solvers::EqualityConstrainedQPSolver solver;
+    const auto result = solver.Solve(prog, {}, {});
+    EXPECT_TRUE(result.is_success());
+    *ddq = result.GetSolution(ddq_var);
+    return result.get_optimal_cost() + C_.squaredNorm();
+  }
+
+  const int n_v_ = 22;
+  const int n_b_ = 2;
+  const vector<int> contact_dims_{6, 6};
+  const vector<int> active_dims_{5, 5};
+  const double eps_ = 1e-6;
+  const double w_ = 100;
+
+  MatrixXd M_;
+  VectorXd C_;
+  MatrixXd J_b_;
+  VectorXd JdotV_b_;
+  vector<MatrixXd> J_c_;
+  vector<MatrixXd> J_c_active_;
+  vector<VectorXd> JdotV_c_active_;
+  MatrixXd J_imu_;
+  VectorXd JdotV_imu_;
+  Vector3d imu_accel_;
+};
+
+TEST_F(ContactHypothesisEstimatorTest, MatchesMathematicalProgram) {
+  ContactHypothesisEstimator estimator(n_v_, n_b_, contact_dims_,
+                                       active_dims_, eps_, w_);
+  estimator.Update(M_, C_, J_b_, JdotV_b_, J_c_, J_c_active_, JdotV_c_active_,
+                   J_imu_, JdotV_imu_, imu_accel_);
+
+  for (const vector<int>& contacts :
+       vector<vector<int>>{{0, 1}, {0}, {1}, {}}) {
+    VectorXd ddq;
+    const double cost = SolveWithProgram(contacts, &ddq);
+    const auto solution = estimator.Solve(contacts);
+    EXPECT_NEAR(solution.cost, cost, 1e-6 * std::max(1.0, cost));
+    EXPECT_TRUE(drake::CompareMatrices(solution.ddq, ddq, 1e-6));
+  }
+}
+
+TEST_F(ContactHypothesisEstimatorTest, FailsBeforeUpdate) {
+  ContactHypothesisEstimator estimator(n_v_, n_b_, contact_dims_,
+                                       active_dims_, eps_, w_);
+  EXPECT_TRUE(std::isinf(estimator.Solve({0, 1}).cost));
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
@@ -75,16 +75,16 @@ DirconTrajectory::DirconTrajectory(
             result.GetSolution(dircon.collocation_force_vars(mode, i));
       }
       AddTrajectory(collocation_force_traj.traj_name, collocation_force_traj);
-      lambda_c_.push_back(&collocation_force_traj);
+      lambda_c_.push_back(&GetTrajectory(collocation_force_traj.traj_name));
     }
 
     AddTrajectory(state_traj.traj_name, state_traj);
     AddTrajectory(state_derivative_traj.traj_name, state_derivative_traj);
     AddTrajectory(force_traj.traj_name, force_traj);
 
-    x_.push_back(&state_traj);
-    xdot_.push_back(&state_derivative_traj);
-    lambda_.push_back(&force_traj);
+    x_.push_back(&GetTrajectory(state_traj.traj_name));
+    xdot_.push_back(&GetTrajectory(state_derivative_traj.traj_name));
+    lambda_.push_back(&GetTrajectory(force_traj.traj_name));
   }
 
   // Input trajectory
@@ -94,18 +94,18 @@ DirconTrajectory::DirconTrajectory(
   input_traj.time_vector = dircon.GetSampleTimes(result);
   input_traj.datatypes = multibody::createActuatorNameVectorFromMap(plant);
   AddTrajectory(input_traj.traj_name, input_traj);
-  u_ = &input_traj;
+  u_ = &GetTrajectory(input_traj.traj_name);
 
   // Decision variables
   LcmTrajectory::Trajectory decision_var_traj;
   decision_var_traj.traj_name = "decision_vars";
   decision_var_traj.datapoints = result.GetSolution();
-  decision_var_traj.time_vector =
-      VectorXd::Zero(decision_var_traj.datapoints.size());
+  // A single column, with one datatype per decision variable
+  decision_var_traj.time_vector = VectorXd::Zero(1);
   decision_var_traj.datatypes =
       vector<string>(decision_var_traj.datapoints.size());
   AddTrajectory(decision_var_traj.traj_name, decision_var_traj);
-  decision_vars_ = &decision_var_traj;
+  decision_vars_ = &GetTrajectory(decision_var_traj.traj_name);
 
   ConstructMetadataObject(name, description);
 }
@@ -171,16 +171,16 @@ DirconTrajectory::DirconTrajectory(
           result.GetSolution(dircon.collocation_force_vars(mode)).data(),
           num_forces, collocation_force_traj.time_vector.size());
       AddTrajectory(collocation_force_traj.traj_name, collocation_force_traj);
-      lambda_c_.push_back(&collocation_force_traj);
+      lambda_c_.push_back(&GetTrajectory(collocation_force_traj.traj_name));
     }
 
     AddTrajectory(state_traj.traj_name, state_traj);
     AddTrajectory(state_derivative_traj.traj_name, state_derivative_traj);
     AddTrajectory(force_traj.traj_name, force_traj);
 
-    x_.push_back(&state_traj);
-    xdot_.push_back(&state_derivative_traj);
-    lambda_.push_back(&force_traj);
+    x_.push_back(&GetTrajectory(state_traj.traj_name));
+    xdot_.push_back(&GetTrajectory(state_derivative_traj.traj_name));
+    lambda_.push_back(&GetTrajectory(force_traj.traj_name));
   }
 
   // Input trajectory
@@ -190,18 +190,18 @@ DirconTrajectory::DirconTrajectory(
   input_traj.time_vector = dircon.GetSampleTimes(result);
   input_traj.datatypes = multibody::createActuatorNameVectorFromMap(plant);
   AddTrajectory(input_traj.traj_name, input_traj);
-  u_ = &input_traj;
+  u_ = &GetTrajectory(input_traj.traj_name);
 
   // Decision variables
   LcmTrajectory::Trajectory decision_var_traj;
   decision_var_traj.traj_name = "decision_vars";
   decision_var_traj.datapoints = result.GetSolution();
-  decision_var_traj.time_vector =
-      VectorXd::Zero(decision_var_traj.datapoints.size());
+  // A single column, with one datatype per decision variable
+  decision_var_traj.time_vector = VectorXd::Zero(1);
   decision_var_traj.datatypes =
       vector<string>(decision_var_traj.datapoints.size());
   AddTrajectory(decision_var_traj.traj_name, decision_var_traj);
-  decision_vars_ = &decision_var_traj;
+  decision_vars_ = &GetTrajectory(decision_var_traj.traj_name);
 
   ConstructMetadataObject(name, description);
 }
@@ -232,6 +232,81 @@ PiecewisePolynomial<double> DirconTrajectory::ReconstructInputTrajectory()
   return input_traj;
 }
 
+void DirconTrajectory::SetInitialGuess(
+    HybridDircon<double>* trajopt) const {
+  DRAKE_DEMAND(trajopt->num_modes() == num_modes_);
+  const vector<int> mode_lengths = trajopt->mode_lengths();
+
+  bool same_knot_points = true;
+  for (int mode = 0; mode < num_modes_; ++mode) {
+    same_knot_points = same_knot_points &&
+        (mode_lengths[mode] == x_[mode]->time_vector.size());
+  }
+  if (same_knot_points) {
+    DRAKE_DEMAND(decision_vars_->datapoints.rows() ==
+        trajopt->decision_variables().size());
+    trajopt->SetInitialGuessForAllVariables(GetDecisionVariables());
+    return;
+  }
+
+  trajopt->SetInitialGuessForAllVariables(
+      VectorXd::Zero(trajopt->decision_variables().size()));
+  const PiecewisePolynomial<double> input_traj = ReconstructInputTrajectory();
+  int mode_start = 0;
+  for (int mode = 0; mode < num_modes_; ++mode) {
+    const VectorXd& breaks = x_[mode]->time_vector;
+    const int num_breaks = breaks.size();
+    const int num_knot_points = mode_lengths[mode];
+    // A mode with a single knot point (e.g. an impact) has no time span
+    DRAKE_DEMAND((num_knot_points > 1) == (num_breaks > 1));
+
+    PiecewisePolynomial<double> state_traj;
+    PiecewisePolynomial<double> force_traj;
+    PiecewisePolynomial<double> collocation_force_traj;
+    if (num_breaks > 1) {
+      state_traj = PiecewisePolynomial<double>::CubicHermite(
+          breaks, x_[mode]->datapoints, xdot_[mode]->datapoints);
+      force_traj = PiecewisePolynomial<double>::FirstOrderHold(
+          lambda_[mode]->time_vector, lambda_[mode]->datapoints);
+      // lambda_c_ skips the modes with a single knot point
+      const Trajectory& lambda_c =
+          GetTrajectory("collocation_force_vars" + std::to_string(mode));
+      collocation_force_traj =
+          (lambda_c.time_vector.size() > 1)
+              ? PiecewisePolynomial<double>::FirstOrderHold(
+                    lambda_c.time_vector, lambda_c.datapoints)
+              : PiecewisePolynomial<double>(lambda_c.datapoints.col(0));
+    } else {
+      state_traj = PiecewisePolynomial<double>(x_[mode]->datapoints.col(0));
+      force_traj =
+          PiecewisePolynomial<double>(lambda_[mode]->datapoints.col(0));
+    }
+
+    const double start_time = breaks(0);
+    const double h = (num_knot_points > 1)
+                         ? (breaks(num_breaks - 1) - start_time) /
+                               (num_knot_points - 1)
+                         : 0;
+    for (int i = 0; i < num_knot_points; ++i) {
+      const double t = start_time + i * h;
+      // For i = 0, this is the post-impact state of the previous mode's last
+      // knot point
+      trajopt->SetInitialGuess(trajopt->state_vars_by_mode(mode, i),
+                               state_traj.value(t));
+      trajopt->SetInitialGuess(trajopt->input(mode_start + i),
+                               input_traj.value(t));
+      trajopt->SetInitialGuess(trajopt->force(mode, i), force_traj.value(t));
+      if (i < num_knot_points - 1) {
+        trajopt->SetInitialGuess(trajopt->collocation_force(mode, i),
+                                 collocation_force_traj.value(t + h / 2));
+        trajopt->SetInitialGuess(trajopt->timestep(mode_start + i),
+                                 VectorXd::Constant(1, h));
+      }
+    }
+    mode_start += num_knot_points - 1;
+  }
+}
+
 void DirconTrajectory::LoadFromFile(const std::string& filepath) {
   LcmTrajectory::LoadFromFile(filepath);
 
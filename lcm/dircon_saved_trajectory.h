@@ -49,6 +49,17 @@ class DirconTrajectory : public LcmTrajectory {
   drake::trajectories::PiecewisePolynomial<double> ReconstructStateTrajectory()
       const;
 
+  /// Sets the initial guess of trajopt, a HybridDircon with the same contact
+  /// modes as the saved solution, to the saved solution. If every mode has as
+  /// many knot points as the saved one, the decision variables are copied.
+  /// Otherwise (e.g. to warm start a finer problem from a coarse solution),
+  /// the knot points of each mode are spread uniformly over the saved mode's
+  /// time span, and the states, inputs and forces are sampled from the
+  /// reconstructed trajectories. The remaining variables (slacks, impulses and
+  /// constraint offsets) then start at zero.
+  void SetInitialGuess(
+      systems::trajectory_optimization::HybridDircon<double>* trajopt) const;
+
   /// Loads the saved state and input trajectory as well as the decision
   /// variables
   void LoadFromFile(const std::string& filepath) override;
@@ -83,7 +94,9 @@ class DirconTrajectory : public LcmTrajectory {
     return lambda_c_[mode]->time_vector;
   }
   Eigen::VectorXd GetDecisionVariables() const {
-    return decision_vars_->datapoints;
+    // Older files have one column per decision variable, of which only the
+    // first holds their values
+    return decision_vars_->datapoints.col(0);
   }
 
   int GetNumModes() const { return num_modes_; }
@@ -0,0 +1,137 @@
+#include "lcm/log_rectifier.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+namespace dairlib {
+
+using multibody::LcmLogReader;
+using std::string;
+using std::vector;
+
+ReorderedLog::ReorderedLog(const string& file, const vector<string>& channels,
+                           double start, double end, int window,
+                           int max_window)
+    : file_(file),
+      reader_(std::make_unique<LcmLogReader>(file)),
+      events_(reader_->GetEvents(channels, start, end)),
+      window_(window),
+      max_window_(max_window) {
+  Fill();
+}
+
+void ReorderedLog::pop() {
+  last_utime_ = heap_.top().event.log_utime;
+  heap_.pop();
+  Fill();
+}
+
+void ReorderedLog::PrintStats() const {
+  std::cout << file_ << (reader_->loaded_index() ? " (indexed)" : "") << ": "
+            << events_.size() << " events, " << num_out_of_order_
+            << " out of order, " << num_late_ << " late, window " << window_
+            << std::endl;
+}
+
+void ReorderedLog::Fill() {
+  while (next_ < events_.size() &&
+         static_cast<int>(heap_.size()) <= window_) {
+    const auto& event = events_[next_];
+    if (next_ > 0 && event.log_utime < events_[next_ - 1].log_utime) {
+      num_out_of_order_++;
+    }
+    if (event.log_utime < last_utime_) {
+      // Older than an event already written, so the window was too small
+      num_late_++;
+      window_ = std::min(2 * window_, max_window_);
+    }
+    heap_.push({event, next_++});
+  }
+}
+
+LogWriter::LogWriter(const string& file, int buffer_size)
+    : file_(std::fopen(file.c_str(), "wb")), buffer_size_(buffer_size) {
+  if (file_ == nullptr) {
+    throw std::runtime_error("LogWriter: unable to open " + file + ": " +
+                             std::strerror(errno));
+  }
+  buffer_.reserve(buffer_size);
+}
+
+LogWriter::~LogWriter() {
+  if (file_ != nullptr) {
+    std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    std::fclose(file_);
+  }
+}
+
+void LogWriter::Write(const LcmLogReader::EventRef& event) {
+  const size_t size = kHeaderSize + event.channel->size() + event.data_size;
+  if (buffer_.size() + size > buffer_size_) {
+    Flush();
+  }
+  AppendBigEndian(kSyncWord, 4);
+  AppendBigEndian(num_events_++, 8);
+  AppendBigEndian(event.log_utime, 8);
+  AppendBigEndian(event.channel->size(), 4);
+  AppendBigEndian(event.data_size, 4);
+  buffer_.insert(buffer_.end(), event.channel->begin(), event.channel->end());
+  // The buffer's capacity may have grown with the header, so it is compared
+  // with the size it was reserved with
+  if (size > buffer_size_) {
+    // Larger than the buffer, so the payload is written directly
+    Flush();
+    Check(std::fwrite(event.data, 1, event.data_size, file_) ==
+          static_cast<size_t>(event.data_size));
+  } else {
+    buffer_.insert(buffer_.end(), event.data, event.data + event.data_size);
+  }
+  num_bytes_ += size;
+}
+
+void LogWriter::Flush() {
+  if (!buffer_.empty()) {
+    Check(std::fwrite(buffer_.data(), 1, buffer_.size(), file_) ==
+          buffer_.size());
+    buffer_.clear();
+  }
+}
+
+void LogWriter::Close() {
+  Flush();
+  const bool ok = std::fclose(file_) == 0;
+  file_ = nullptr;
+  Check(ok);
+}
+
+void LogWriter::Check(bool ok) const {
+  if (!ok) {
+    throw std::runtime_error(string("LogWriter: unable to write: ") +
+                             std::strerror(errno));
+  }
+}
+
+void MergeLogs(const vector<ReorderedLog*>& logs, LogWriter* writer) {
+  using Head = std::pair<int64_t, int>;
+  std::priority_queue<Head, vector<Head>, std::greater<Head>> heads;
+  for (size_t i = 0; i < logs.size(); i++) {
+    if (!logs[i]->empty()) {
+      heads.push({logs[i]->top().log_utime, static_cast<int>(i)});
+    }
+  }
+  while (!heads.empty()) {
+    const int i = heads.top().second;
+    heads.pop();
+    writer->Write(logs[i]->top());
+    logs[i]->pop();
+    if (!logs[i]->empty()) {
+      heads.push({logs[i]->top().log_utime, i});
+    }
+  }
+}
+
+}  // namespace dairlib
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "systems/log_parser/lcm_log_reader.h"
+
+namespace dairlib {
+
+/// One input log of log_sequence_rectifier, reordered in a bounded min-heap
+/// window. The window keeps `window` events beyond the next one to write, and
+/// doubles (up to `max_window`) whenever an event arrives older than one
+/// already written. Such late events are counted, and written as soon as
+/// possible. Events with equal timestamps keep their order in the log.
+class ReorderedLog {
+ public:
+  /// Reads the events of `channels` (all if empty) in the time window
+  /// [start, end), in seconds from the start of the log.
+  /// @throws std::runtime_error if the log cannot be opened
+  ReorderedLog(const std::string& file,
+               const std::vector<std::string>& channels, double start,
+               double end, int window, int max_window);
+
+  bool empty() const { return heap_.empty(); }
+
+  /// The next event to write
+  const multibody::LcmLogReader::EventRef& top() const {
+    return heap_.top().event;
+  }
+
+  void pop();
+
+  void PrintStats() const;
+
+  int num_events() const { return events_.size(); }
+  int num_out_of_order() const { return num_out_of_order_; }
+  int num_late() const { return num_late_; }
+  int window() const { return window_; }
+
+ private:
+  struct Entry {
+    multibody::LcmLogReader::EventRef event;
+    // Position in the log, to keep events with equal timestamps in order
+    size_t index;
+    bool operator>(const Entry& other) const {
+      return event.log_utime != other.event.log_utime
+                 ? event.log_utime > other.event.log_utime
+                 : index > other.index;
+    }
+  };
+
+  // Keeps window_ events beyond the next one to write in the heap
+  void Fill();
+
+  const std::string file_;
+  std::unique_ptr<multibody::LcmLogReader> reader_;
+  const std::vector<multibody::LcmLogReader::EventRef> events_;
+  size_t next_ = 0;
+  int window_;
+  const int max_window_;
+  int64_t last_utime_ = std::numeric_limits<int64_t>::min();
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap_;
+  int num_out_of_order_ = 0;
+  int num_late_ = 0;
+};
+
+/// Writes LCM log events through one large staging buffer, which is written
+/// with one fwrite whenever it is full. Events larger than the buffer have
+/// their payloads written directly.
+class LogWriter {
+ public:
+  /// @throws std::runtime_error if the file cannot be opened
+  LogWriter(const std::string& file, int buffer_size);
+
+  /// Closes the file if Close() was not called, ignoring errors
+  ~LogWriter();
+
+  /// @throws std::runtime_error if the file cannot be written
+  void Write(const multibody::LcmLogReader::EventRef& event);
+
+  /// @throws std::runtime_error if the file cannot be written
+  void Flush();
+
+  /// Flushes and closes the file
+  /// @throws std::runtime_error if the file cannot be written
+  void Close();
+
+  int64_t num_events() const { return num_events_; }
+  int64_t num_bytes() const { return num_bytes_; }
+
+ private:
+  static constexpr uint32_t kSyncWord = 0xEDA1DA01;
+  static constexpr size_t kHeaderSize = 4 + 8 + 8 + 4 + 4;
+
+  template <typename T>
+  void AppendBigEndian(T value, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) {
+      buffer_.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >>
+                                             (8 * i)));
+    }
+  }
+
+  void Check(bool ok) const;
+
+  std::FILE* file_;
+  const size_t buffer_size_;
+  std::vector<uint8_t> buffer_;
+  int64_t num_events_ = 0;
+  int64_t num_bytes_ = 0;
+};
+
+/// Writes the events of `logs` to `writer`, merged by timestamp, with ties
+/// going to the earlier log
+void MergeLogs(const std::vector<ReorderedLog*>& logs, LogWriter* writer);
+
+}  // namespace dairlib
@@ -1,126 +1,127 @@
-#include <string.h>
-#include <inttypes.h>
-#include <lcm/lcm.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
-#include <list>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
 
-/**
-  This is a simple program to fix any LCM messages that may be out of sequence
-  in a log file. The usage is:
+#include <gflags/gflags.h>
 
-    log_sequence_rectifier <file_in> <file_out>
+#include "lcm/log_rectifier.h"
 
-  The program uses a max-length buffer, that must be large enough so that out of
-  sequence messages must appear at most kBufferLength-messages apart. An error
-  message will be generated if this assumption fails.
+/**
+  This is a program to fix any LCM messages that may be out of sequence in a
+  log file, and to merge several logs (e.g. the dispatcher's and the
+  controller's) into one time-ordered log. The usage is:
+
+    log_sequence_rectifier [--channels=A,B] [--start=s] [--end=s]
+        <file_in> [<file_in> ...] <file_out>
+
+  Each input is read through LcmLogReader and its sidecar index, so only the
+  events of the selected channels and time window (in seconds from the start of
+  each log) are read. Events are reordered in a bounded min-heap window, which
+  starts at --window events and doubles (up to --max_window) whenever an event
+  arrives later than the window could absorb. Such events are counted and
+  reported, and written as soon as possible. The reordered inputs are then
+  merged by timestamp.
+
+  Payloads are never copied into the program: they are referenced in the mapped
+  inputs, and staged with their headers in a large output buffer, which is
+  written with one fwrite per --buffer_size bytes.
 */
 
-constexpr int kBufferLength = 20;
+DEFINE_string(channels, "",
+              "Comma-separated list of channels to keep. All if empty.");
+DEFINE_double(start, 0, "Start of the time window to keep (s).");
+DEFINE_double(end, std::numeric_limits<double>::infinity(),
+              "End of the time window to keep (s).");
+DEFINE_int32(window, 20, "Initial size of the reordering window (events).");
+DEFINE_int32(max_window, 1 << 16,
+             "Size the reordering window may grow to (events).");
+DEFINE_int32(buffer_size, 1 << 22, "Size of the output buffer (bytes).");
 
-bool event_sorter(lcm_eventlog_event_t* const& lhs,
-    lcm_eventlog_event_t* const& rhs) {
-  return lhs->timestamp < rhs->timestamp;
-}
+namespace dairlib {
+
+using std::string;
+using std::vector;
 
-int main(int argc, char **argv) {
-  int N = 0;
-  std::list<lcm_eventlog_event_t*> buffer;
+int do_main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
 
-  lcm_eventlog_t *log, *log_out;
   if (argc < 3) {
-    fprintf(stderr, "usage: log_sequence_rectifier <file_in> <file_out>\n");
+    fprintf(stderr, "usage: log_sequence_rectifier [--channels=A,B] "
+                    "[--start=s] [--end=s] <file_in> [<file_in> ...] "
+                    "<file_out>\n");
     return 1;
   }
-
-  log = lcm_eventlog_create(argv[1], "r");
-
-  if (!log) {
-    fprintf(stderr, "couldn't open input log file\n");
+  if (FLAGS_window < 1 || FLAGS_max_window < FLAGS_window) {
+    fprintf(stderr, "--window must be positive, and --max_window at least "
+                    "--window\n");
     return 1;
   }
 
-  log_out = lcm_eventlog_create(argv[2], "w");
-  if (!log_out) {
-    fprintf(stderr, "couldn't open output log file\n");
-    return 1;
-  }
-
-  int64_t last_timestamp = 0;
-  int64_t last_write_timestamp = 0;
-  while (1) {
-    lcm_eventlog_event_t *event = lcm_eventlog_read_next_event(log);
-
-
-    if (!event) {
-      break;
-    }
-
-    // Copy the event and add to the buffer
-    lcm_eventlog_event_t* e = new lcm_eventlog_event_t;
-    e->eventnum = event->eventnum;
-    e->timestamp = event->timestamp;
-    e->channellen = event->channellen;
-    e->datalen = event->datalen;
-    e->channel = strdup(event->channel);
-    e->data = malloc(e->datalen);
-    memcpy(e->data, event->data, e->datalen);
-    buffer.push_back(e);
-    N++;
-
-    // If buffer is long enough, sort and write oldest message
-    if (N == kBufferLength) {
-      buffer.sort(event_sorter);
-      lcm_eventlog_write_event(log_out, buffer.front());
-
-      int64_t timestamp = buffer.front()->timestamp;
-      if (timestamp < last_write_timestamp) {
-        std::cout <<
-            "ERROR: buffer size too small to capture out-of-order message!"
-            << std::endl;
-      }
-      last_write_timestamp = timestamp;
-
-
-
-      // Free and remove message
-      free(buffer.front()->channel);
-      free(buffer.front()->data);
-      delete buffer.front();
-      buffer.pop_front();
-      N--;
+  vector<string> channels;
+  std::stringstream channel_list(FLAGS_channels);
+  string channel;
+  while (std::getline(channel_list, channel, ',')) {
+    if (!channel.empty()) {
+      channels.push_back(channel);
     }
+  }
 
-    if (event->timestamp < last_timestamp) {
-      std::cout << "Found a message out of order." << std::endl;
+  const auto start_time = std::chrono::steady_clock::now();
+
+  vector<std::unique_ptr<ReorderedLog>> logs;
+  vector<ReorderedLog*> log_ptrs;
+  for (int i = 1; i < argc - 1; i++) {
+    try {
+      logs.push_back(std::make_unique<ReorderedLog>(
+          argv[i], channels, FLAGS_start, FLAGS_end, FLAGS_window,
+          FLAGS_max_window));
+    } catch (const std::exception& e) {
+      fprintf(stderr, "couldn't open input log file: %s\n", e.what());
+      return 1;
     }
-
-    last_timestamp = event->timestamp;
-
-    lcm_eventlog_free_event(event);
+    log_ptrs.push_back(logs.back().get());
   }
 
-  // Write remaining messages
-  buffer.sort(event_sorter);
-  while (N > 0) {
-    lcm_eventlog_write_event(log_out, buffer.front());
+  int64_t num_events;
+  int64_t num_bytes;
+  try {
+    LogWriter writer(argv[argc - 1], FLAGS_buffer_size);
+    MergeLogs(log_ptrs, &writer);
+    writer.Close();
+    num_events = writer.num_events();
+    num_bytes = writer.num_bytes();
+  } catch (const std::exception& e) {
+    fprintf(stderr, "couldn't write output log file: %s\n", e.what());
+    return 1;
+  }
 
-      int64_t timestamp = buffer.front()->timestamp;
-      if (timestamp < last_write_timestamp) {
-        std::cout <<
-            "ERROR: buffer size too small to capture out-of-order message!"
+  const double elapsed = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start_time)
+                             .count();
+  int num_late = 0;
+  for (const auto& log : logs) {
+    log->PrintStats();
+    num_late += log->num_late();
+  }
+  std::cout << "Wrote " << num_events << " events (" << 1e-6 * num_bytes
+            << " MB) in " << elapsed << " s, " << num_events / elapsed
+            << " events/s, " << 1e-6 * num_bytes / elapsed << " MB/s"
             << std::endl;
-      }
-      last_write_timestamp = timestamp;
-
-
-    // Free and remove message
-    free(buffer.front()->channel);
-    free(buffer.front()->data);
-    delete buffer.front();
-    buffer.pop_front();
-    N--;
+  if (num_late > 0) {
+    std::cout << "ERROR: " << num_late
+              << " events arrived too late for the reordering window, and "
+                 "remain out of order. Try a larger --window." << std::endl;
+    return 1;
   }
-
-  lcm_eventlog_destroy(log);
   return 0;
 }
+
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) { return dairlib::do_main(argc, argv); }
@@ -0,0 +1,467 @@
+#include "lcm/shm_lcm.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include "drake/common/drake_assert.h"
+#include "drake/common/drake_throw.h"
+#include "drake/common/text_logging.h"
+#include "drake/lcm/drake_lcm.h"
+
+namespace dairlib {
+
+using drake::lcm::DrakeLcmInterface;
+using drake::lcm::DrakeSubscriptionInterface;
+using std::string;
+
+namespace {
+
+const char kUrlPrefix[] = "shm://";
+const uint64_t kMagic = 0x6461697231636d6cull;
+const uint64_t kDefaultCapacity = 8 << 20;
+const uint64_t kMinCapacity = 64 << 10;
+
+// Each message in the ring starts with a RecordHeader, followed by the channel
+// name and the message, and is padded to a multiple of 8 bytes
+struct RecordHeader {
+  uint32_t size;
+  uint32_t channel_size;
+  uint32_t data_size;
+  uint32_t unused;
+  uint64_t sequence;
+};
+
+uint64_t RoundUpTo8(uint64_t n) { return (n + 7) & ~uint64_t{7}; }
+
+uint64_t RoundUpToPowerOfTwo(uint64_t n) {
+  uint64_t result = 1;
+  while (result < n) {
+    result <<= 1;
+  }
+  return result;
+}
+
+[[noreturn]] void ThrowErrno(const string& what, const string& segment) {
+  throw std::runtime_error("ShmLcm: " + what + " " + segment + ": " +
+                           std::strerror(errno));
+}
+
+// Parses shm://<name>[?capacity=<bytes>]
+void ParseUrl(const string& url, string* name, uint64_t* capacity) {
+  if (url.compare(0, sizeof(kUrlPrefix) - 1, kUrlPrefix) != 0) {
+    throw std::runtime_error("ShmLcm: not a shm:// URL: " + url);
+  }
+  const string rest = url.substr(sizeof(kUrlPrefix) - 1);
+  const size_t query = rest.find('?');
+  *name = rest.substr(0, query);
+  if (name->empty() ||
+      !std::all_of(name->begin(), name->end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' ||
+               c == '-' || c == '.';
+      })) {
+    throw std::runtime_error("ShmLcm: invalid segment name in " + url);
+  }
+  *capacity = kDefaultCapacity;
+  if (query != string::npos) {
+    const string option = rest.substr(query + 1);
+    const string key = "capacity=";
+    char* end = nullptr;
+    if (option.compare(0, key.size(), key) == 0) {
+      *capacity = std::strtoull(option.c_str() + key.size(), &end, 10);
+    }
+    if (end == nullptr || *end != '\0' || *capacity == 0) {
+      throw std::runtime_error("ShmLcm: invalid option in " + url);
+    }
+  }
+  *capacity = RoundUpToPowerOfTwo(std::max(*capacity, kMinCapacity));
+}
+
+long Futex(std::atomic<uint32_t>* word, int op, uint32_t value,
+           const struct timespec* timeout) {
+  return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value,
+                 timeout, nullptr, 0);
+}
+
+}  // namespace
+
+// The start of the segment. The atomics are lock-free, so they can be shared
+// between processes, and the mutex is process-shared and robust, so that a
+// publisher which dies while holding it does not block the others.
+struct ShmLcm::Header {
+  std::atomic<uint64_t> magic;
+  uint64_t capacity;
+  pthread_mutex_t mutex;
+  // Number of messages ever published, guarded by mutex
+  uint64_t num_messages;
+  // Absolute ring positions. Bytes before head are complete messages, and
+  // bytes up to reserved are being overwritten by a publisher.
+  alignas(64) std::atomic<uint64_t> head;
+  std::atomic<uint64_t> reserved;
+  // Incremented on every publish, to wake the readers sleeping on it
+  alignas(64) std::atomic<uint32_t> notify;
+  std::atomic<uint32_t> num_waiters;
+};
+
+namespace {
+
+void LockRobust(pthread_mutex_t* mutex, std::atomic<uint64_t>* head,
+                std::atomic<uint64_t>* reserved) {
+  const int result = pthread_mutex_lock(mutex);
+  if (result == EOWNERDEAD) {
+    // The previous owner died, possibly while writing a message, which is
+    // dropped
+    reserved->store(head->load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+    pthread_mutex_consistent(mutex);
+    return;
+  }
+  DRAKE_DEMAND(result == 0);
+}
+
+}  // namespace
+
+class ShmLcm::Subscription final
+    : public DrakeSubscriptionInterface,
+      public std::enable_shared_from_this<Subscription> {
+ public:
+  Subscription(ShmLcm* owner, string channel, bool all_channels,
+               MultichannelHandlerFunction handler)
+      : owner_(owner),
+        channel_(std::move(channel)),
+        all_channels_(all_channels),
+        handler_(std::move(handler)) {}
+
+  void set_unsubscribe_on_delete(bool enabled) override {
+    owner_->SetOwned(this, !enabled);
+  }
+
+  void set_queue_capacity(int) override {}
+
+  bool Matches(const string& channel) const {
+    return all_channels_ || channel == channel_;
+  }
+
+  void Handle(const string& channel, const void* data, int size) const {
+    handler_(channel, data, size);
+  }
+
+ private:
+  ShmLcm* const owner_;
+  const string channel_;
+  const bool all_channels_;
+  const MultichannelHandlerFunction handler_;
+};
+
+ShmLcm::ShmLcm(const string& url) : url_(url) {
+  string name;
+  uint64_t capacity;
+  ParseUrl(url, &name, &capacity);
+  segment_name_ = "/dairlib_lcm_" + name;
+
+  int fd = shm_open(segment_name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+  const bool created = fd >= 0;
+  if (created) {
+    // Let other users' processes open the segment regardless of the umask
+    fchmod(fd, 0666);
+    mapped_size_ = sizeof(Header) + capacity;
+    if (ftruncate(fd, mapped_size_) != 0) {
+      close(fd);
+      shm_unlink(segment_name_.c_str());
+      ThrowErrno("cannot size", segment_name_);
+    }
+  } else {
+    if (errno != EEXIST) {
+      ThrowErrno("cannot create", segment_name_);
+    }
+    fd = shm_open(segment_name_.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+      ThrowErrno("cannot open", segment_name_);
+    }
+    // Wait for the creator to size the segment
+    struct stat status {};
+    for (int i = 0; i < 1000; i++) {
+      if (fstat(fd, &status) != 0) {
+        close(fd);
+        ThrowErrno("cannot stat", segment_name_);
+      }
+      if (status.st_size > static_cast<off_t>(sizeof(Header))) break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    mapped_size_ = status.st_size;
+  }
+
+  void* base = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    ThrowErrno("cannot map", segment_name_);
+  }
+  header_ = static_cast<Header*>(base);
+  ring_ = static_cast<uint8_t*>(base) + sizeof(Header);
+
+  if (created) {
+    new (header_) Header();
+    header_->capacity = capacity;
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&header_->mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+    header_->magic.store(kMagic, std::memory_order_release);
+  } else {
+    // Wait for the creator to initialize the header
+    for (int i = 0; i < 1000; i++) {
+      if (header_->magic.load(std::memory_order_acquire) == kMagic) break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (header_->magic.load(std::memory_order_acquire) != kMagic ||
+        sizeof(Header) + header_->capacity != mapped_size_) {
+      munmap(base, mapped_size_);
+      throw std::runtime_error("ShmLcm: " + segment_name_ +
+                               " is not a valid segment. Remove it with "
+                               "ShmLcm::RemoveSegment() or rm /dev/shm" +
+                               segment_name_);
+    }
+    if (header_->capacity != capacity) {
+      drake::log()->info("ShmLcm: using the existing capacity of " +
+                         std::to_string(header_->capacity) + " bytes of " +
+                         segment_name_);
+    }
+  }
+  mask_ = header_->capacity - 1;
+
+  // Receive the messages published from now on
+  LockRobust(&header_->mutex, &header_->head, &header_->reserved);
+  read_position_ = header_->head.load(std::memory_order_relaxed);
+  next_sequence_ = header_->num_messages;
+  pthread_mutex_unlock(&header_->mutex);
+}
+
+ShmLcm::~ShmLcm() { munmap(header_, mapped_size_); }
+
+bool ShmLcm::IsShmUrl(const string& url) {
+  return url.compare(0, sizeof(kUrlPrefix) - 1, kUrlPrefix) == 0;
+}
+
+void ShmLcm::RemoveSegment(const string& url) {
+  string name;
+  uint64_t capacity;
+  ParseUrl(url, &name, &capacity);
+  shm_unlink(("/dairlib_lcm_" + name).c_str());
+}
+
+string ShmLcm::get_lcm_url() const { return url_; }
+
+int64_t ShmLcm::get_capacity() const { return header_->capacity; }
+
+void ShmLcm::WriteRing(uint64_t position, const void* data, uint64_t n) {
+  const uint64_t offset = position & mask_;
+  const uint64_t first = std::min(n, header_->capacity - offset);
+  std::memcpy(ring_ + offset, data, first);
+  std::memcpy(ring_, static_cast<const uint8_t*>(data) + first, n - first);
+}
+
+void ShmLcm::ReadRing(uint64_t position, void* data, uint64_t n) const {
+  const uint64_t offset = position & mask_;
+  const uint64_t first = std::min(n, header_->capacity - offset);
+  std::memcpy(data, ring_ + offset, first);
+  std::memcpy(static_cast<uint8_t*>(data) + first, ring_, n - first);
+}
+
+void ShmLcm::Publish(const string& channel, const void* data, int data_size,
+                     std::optional<double>) {
+  DRAKE_THROW_UNLESS(data_size >= 0);
+  RecordHeader record{};
+  record.size = RoundUpTo8(sizeof(RecordHeader) + channel.size() + data_size);
+  record.channel_size = channel.size();
+  record.data_size = data_size;
+  if (record.size > header_->capacity / 2) {
+    throw std::runtime_error("ShmLcm: a message of " +
+                             std::to_string(data_size) + " bytes on " +
+                             channel + " does not fit in " + segment_name_);
+  }
+
+  LockRobust(&header_->mutex, &header_->head, &header_->reserved);
+  const uint64_t start = header_->head.load(std::memory_order_relaxed);
+  record.sequence = header_->num_messages++;
+  // Readers check reserved after copying a message, to detect whether it was
+  // overwritten while they copied it
+  header_->reserved.store(start + record.size, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  WriteRing(start, &record, sizeof(record));
+  WriteRing(start + sizeof(record), channel.data(), channel.size());
+  WriteRing(start + sizeof(record) + channel.size(), data, data_size);
+  header_->head.store(start + record.size, std::memory_order_release);
+  pthread_mutex_unlock(&header_->mutex);
+
+  header_->notify.fetch_add(1, std::memory_order_seq_cst);
+  if (header_->num_waiters.load(std::memory_order_seq_cst) > 0) {
+    Futex(&header_->notify, FUTEX_WAKE, INT_MAX, nullptr);
+  }
+}
+
+std::shared_ptr<DrakeSubscriptionInterface> ShmLcm::Subscribe(
+    const string& channel, HandlerFunction handler) {
+  DRAKE_THROW_UNLESS(handler != nullptr);
+  auto subscription = std::make_shared<Subscription>(
+      this, channel, false,
+      [handler = std::move(handler)](const string&, const void* data,
+                                     int size) { handler(data, size); });
+  owned_subscriptions_.push_back(subscription);
+  subscriptions_.push_back(subscription);
+  return subscription;
+}
+
+std::shared_ptr<DrakeSubscriptionInterface> ShmLcm::SubscribeAllChannels(
+    MultichannelHandlerFunction handler) {
+  DRAKE_THROW_UNLESS(handler != nullptr);
+  auto subscription =
+      std::make_shared<Subscription>(this, "", true, std::move(handler));
+  owned_subscriptions_.push_back(subscription);
+  subscriptions_.push_back(subscription);
+  return subscription;
+}
+
+void ShmLcm::SetOwned(Subscription* subscription, bool owned) {
+  auto it = std::find_if(
+      owned_subscriptions_.begin(), owned_subscriptions_.end(),
+      [subscription](const auto& owned_subscription) {
+        return owned_subscription.get() == subscription;
+      });
+  if (!owned && it != owned_subscriptions_.end()) {
+    owned_subscriptions_.erase(it);
+  } else if (owned && it == owned_subscriptions_.end()) {
+    owned_subscriptions_.push_back(subscription->shared_from_this());
+  }
+}
+
+int ShmLcm::DispatchAvailable() {
+  subscriptions_.erase(
+      std::remove_if(subscriptions_.begin(), subscriptions_.end(),
+                     [](const auto& subscription) {
+                       return subscription.expired();
+                     }),
+      subscriptions_.end());
+
+  const uint64_t capacity = header_->capacity;
+  int num_dispatched = 0;
+  while (true) {
+    const uint64_t head = header_->head.load(std::memory_order_acquire);
+    if (read_position_ == head) {
+      break;
+    }
+    bool overwritten = head - read_position_ > capacity;
+    RecordHeader record{};
+    if (!overwritten) {
+      ReadRing(read_position_, &record, sizeof(record));
+      // A record which is being overwritten may be garbage
+      const bool valid =
+          record.size >= sizeof(record) && record.size <= capacity / 2 &&
+          sizeof(record) + uint64_t{record.channel_size} + record.data_size <=
+              record.size;
+      if (valid) {
+        channel_buffer_.resize(record.channel_size);
+        ReadRing(read_position_ + sizeof(record), &channel_buffer_[0],
+                 record.channel_size);
+        message_buffer_.resize(record.data_size);
+        ReadRing(read_position_ + sizeof(record) + record.channel_size,
+                 message_buffer_.data(), record.data_size);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      overwritten =
+          header_->reserved.load(std::memory_order_relaxed) - read_position_ >
+          capacity;
+      DRAKE_DEMAND(valid || overwritten);
+    }
+    if (overwritten) {
+      // Skip to the latest message. The number of lost messages is counted
+      // from the sequence number of the next one.
+      read_position_ = header_->head.load(std::memory_order_acquire);
+      continue;
+    }
+
+    read_position_ += record.size;
+    num_dropped_ += record.sequence - next_sequence_;
+    next_sequence_ = record.sequence + 1;
+    bool handled = false;
+    for (size_t i = 0; i < subscriptions_.size(); i++) {
+      const auto subscription = subscriptions_[i].lock();
+      if (subscription != nullptr && subscription->Matches(channel_buffer_)) {
+        subscription->Handle(channel_buffer_, message_buffer_.data(),
+                             message_buffer_.size());
+        handled = true;
+      }
+    }
+    num_dispatched += handled;
+  }
+  return num_dispatched;
+}
+
+int ShmLcm::HandleSubscriptions(int timeout_millis) {
+  int num_dispatched = DispatchAvailable();
+  if (num_dispatched > 0 || timeout_millis == 0) {
+    return num_dispatched;
+  }
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(timeout_millis);
+  while (true) {
+    const uint32_t observed = header_->notify.load(std::memory_order_seq_cst);
+    num_dispatched = DispatchAvailable();
+    if (num_dispatched > 0) {
+      return num_dispatched;
+    }
+    struct timespec timeout {};
+    if (timeout_millis > 0) {
+      const int64_t remaining =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              deadline - std::chrono::steady_clock::now())
+              .count();
+      if (remaining <= 0) {
+        return 0;
+      }
+      timeout.tv_sec = remaining / 1000000000;
+      timeout.tv_nsec = remaining % 1000000000;
+    }
+    header_->num_waiters.fetch_add(1, std::memory_order_seq_cst);
+    Futex(&header_->notify, FUTEX_WAIT, observed,
+          timeout_millis > 0 ? &timeout : nullptr);
+    header_->num_waiters.fetch_sub(1, std::memory_order_seq_cst);
+  }
+}
+
+std::unique_ptr<DrakeLcmInterface> MakeLcmInterface(const string& url) {
+  string selected = url;
+  if (selected.empty()) {
+    const char* default_url = std::getenv("LCM_DEFAULT_URL");
+    if (default_url != nullptr) {
+      selected = default_url;
+    }
+  }
+  if (ShmLcm::IsShmUrl(selected)) {
+    return std::make_unique<ShmLcm>(selected);
+  }
+  if (url.empty()) {
+    return std::make_unique<drake::lcm::DrakeLcm>();
+  }
+  return std::make_unique<drake::lcm::DrakeLcm>(url);
+}
+
+}  // namespace dairlib
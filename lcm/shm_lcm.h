@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "drake/common/drake_copyable.h"
+#include "drake/lcm/drake_lcm_interface.h"
+
+namespace dairlib {
+
+/// A DrakeLcmInterface for processes on the same host, which passes messages
+/// through a POSIX shared-memory ring instead of UDP multicast. It is selected
+/// by a URL of the form
+///
+///     shm://<name>[?capacity=<bytes>]
+///
+/// Every ShmLcm with the same name (in any process) publishes to and receives
+/// from the same ring, the segment /dev/shm/dairlib_lcm_<name>, which is
+/// created with the given capacity (default 8 MiB, rounded up to a power of
+/// two) by whichever process opens it first. The segment is left in place
+/// when processes exit, so that they can be restarted independently; use
+/// RemoveSegment() to delete it.
+///
+/// Each message is written once into the ring, and each subscribing instance
+/// copies it out once in HandleSubscriptions(), which sleeps on a futex in the
+/// ring when there are no new messages. As with UDP multicast, an instance
+/// receives its own messages, and a reader which falls more than the ring's
+/// capacity behind loses messages; they are counted by get_num_dropped().
+///
+/// Publish() may be called from any thread. HandleSubscriptions() and
+/// Subscribe() must be called from a single thread, as with DrakeLcm.
+/// Subscriptions match channel names exactly, and their queue capacity is the
+/// ring itself, so set_queue_capacity() has no effect.
+class ShmLcm final : public drake::lcm::DrakeLcmInterface {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(ShmLcm)
+
+  using HandlerFunction = drake::lcm::DrakeLcmInterface::HandlerFunction;
+  /// Receives the channel name as well as the message
+  using MultichannelHandlerFunction =
+      std::function<void(const std::string&, const void*, int)>;
+
+  /// @throws std::runtime_error if the URL is not a shm:// URL, or if the
+  /// segment cannot be created or mapped
+  explicit ShmLcm(const std::string& url);
+  ~ShmLcm() override;
+
+  /// Returns true if `url` selects a ShmLcm
+  static bool IsShmUrl(const std::string& url);
+
+  /// Removes the segment of `url` from the system. Processes which have it
+  /// mapped keep using it, but new ShmLcm instances create a new one.
+  static void RemoveSegment(const std::string& url);
+
+  std::string get_lcm_url() const override;
+
+  void Publish(const std::string& channel, const void* data, int data_size,
+               std::optional<double> time_sec) override;
+
+  std::shared_ptr<drake::lcm::DrakeSubscriptionInterface> Subscribe(
+      const std::string& channel, HandlerFunction handler) override;
+
+  /// Subscribes to every channel, e.g. to forward them to another
+  /// DrakeLcmInterface
+  std::shared_ptr<drake::lcm::DrakeSubscriptionInterface> SubscribeAllChannels(
+      MultichannelHandlerFunction handler);
+
+  int HandleSubscriptions(int timeout_millis) override;
+
+  /// Capacity of the ring in bytes. Messages (plus their channel names) must
+  /// be smaller than half of it.
+  int64_t get_capacity() const;
+
+  /// Number of messages which this instance lost by falling behind the ring
+  int64_t get_num_dropped() const { return num_dropped_; }
+
+ private:
+  struct Header;
+  class Subscription;
+
+  // Copies n bytes to and from the ring at the absolute position `position`,
+  // wrapping around its end
+  void WriteRing(uint64_t position, const void* data, uint64_t n);
+  void ReadRing(uint64_t position, void* data, uint64_t n) const;
+  // Dispatches every complete message since read_position_, and returns how
+  // many were subscribed to
+  int DispatchAvailable();
+  // Whether this keeps the subscription alive
+  void SetOwned(Subscription* subscription, bool owned);
+
+  const std::string url_;
+  std::string segment_name_;
+  Header* header_{nullptr};
+  uint8_t* ring_{nullptr};
+  uint64_t mask_{0};
+  size_t mapped_size_{0};
+
+  // Reader state, only used by the thread handling subscriptions
+  uint64_t read_position_{0};
+  uint64_t next_sequence_{0};
+  int64_t num_dropped_{0};
+  std::string channel_buffer_;
+  std::vector<uint8_t> message_buffer_;
+
+  // Subscriptions which are kept alive by this, and all subscriptions
+  std::vector<std::shared_ptr<Subscription>> owned_subscriptions_;
+  std::vector<std::weak_ptr<Subscription>> subscriptions_;
+};
+
+/// Returns a ShmLcm for shm:// URLs, and a DrakeLcm otherwise. An empty URL
+/// selects the LCM_DEFAULT_URL environment variable if it is set (so that
+/// whole deployments can be switched to shared memory without flags), and
+/// DrakeLcm's default otherwise.
+std::unique_ptr<drake::lcm::DrakeLcmInterface> MakeLcmInterface(
+    const std::string& url = "");
+
+}  // namespace dairlib
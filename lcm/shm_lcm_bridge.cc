@@ -0,0 +1,65 @@
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include <gflags/gflags.h>
+
+#include "lcm/shm_lcm.h"
+
+#include "drake/lcm/drake_lcm.h"
+
+/**
+  Forwards the messages of a shared-memory LCM ring (see ShmLcm) to UDP
+  multicast, so that lcm-logger, lcm-spy, director and the other LCM tools
+  can see the channels of processes which use shm:// URLs. The usage is:
+
+    shm_lcm_bridge --shm_url=shm://cassie [--udp_url=...] [--channels=A,B]
+
+  Only the bridge pays the socket overhead; the processes on the ring do not.
+*/
+
+DEFINE_string(shm_url, "shm://cassie", "URL of the shared-memory ring");
+DEFINE_string(udp_url, "udpm://239.255.76.67:7667?ttl=0",
+              "URL to forward the messages to");
+DEFINE_string(channels, "",
+              "Comma-separated channels to forward. Empty for all channels.");
+
+namespace dairlib {
+
+int DoMain(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::set<std::string> channels;
+  std::stringstream channel_list(FLAGS_channels);
+  std::string channel;
+  while (std::getline(channel_list, channel, ',')) {
+    channels.insert(channel);
+  }
+
+  ShmLcm shm_lcm(FLAGS_shm_url);
+  drake::lcm::DrakeLcm udp_lcm(FLAGS_udp_url);
+  shm_lcm.SubscribeAllChannels([&](const std::string& channel_name,
+                                   const void* data, int size) {
+    if (channels.empty() || channels.count(channel_name) > 0) {
+      udp_lcm.Publish(channel_name, data, size, {});
+    }
+  });
+
+  std::cout << "Forwarding " << FLAGS_shm_url << " to " << FLAGS_udp_url
+            << std::endl;
+  int64_t num_dropped = 0;
+  while (true) {
+    shm_lcm.HandleSubscriptions(1000);
+    if (shm_lcm.get_num_dropped() > num_dropped) {
+      num_dropped = shm_lcm.get_num_dropped();
+      std::cerr << "shm_lcm_bridge fell behind the ring; " << num_dropped
+                << " messages dropped so far" << std::endl;
+    }
+  }
+  return 0;
+}
+
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) { return dairlib::DoMain(argc, argv); }
@@ -0,0 +1,192 @@
+#include "lcm/dircon_saved_trajectory.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+
+#include "systems/trajectory_optimization/dircon_distance_data.h"
+#include "systems/trajectory_optimization/dircon_kinematic_data_set.h"
+
+#include "drake/common/find_resource.h"
+#include "drake/common/temp_directory.h"
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/multibody/parsing/parser.h"
+
+namespace dairlib {
+namespace {
+
+using drake::CompareMatrices;
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using drake::solvers::MathematicalProgramResult;
+using drake::trajectories::PiecewisePolynomial;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+using std::string;
+using std::vector;
+using systems::trajectory_optimization::DirconDistanceData;
+using systems::trajectory_optimization::DirconKinematicData;
+using systems::trajectory_optimization::DirconKinematicDataSet;
+using systems::trajectory_optimization::DirconOptions;
+using systems::trajectory_optimization::HybridDircon;
+
+static const double kTol = 1e-10;
+
+/// An acrobot whose links are held together by a distance constraint (see
+/// passive_constrained_pendulum_dircon.cc), with two modes of that constraint
+class DirconSavedTrajectoryTest : public ::testing::Test {
+ protected:
+  DirconSavedTrajectoryTest() : plant_(0.0) {}
+
+  void SetUp() override {
+    Parser parser(&plant_);
+    parser.AddModelFromFile(
+        drake::FindResourceOrThrow("drake/examples/acrobot/Acrobot.urdf"));
+    plant_.WeldFrames(plant_.world_frame(),
+                      plant_.GetFrameByName("base_link"),
+                      drake::math::RigidTransform<double>());
+    plant_.Finalize();
+
+    distance_ = std::make_unique<DirconDistanceData<double>>(
+        plant_, plant_.GetBodyByName("base_link"), Vector3d::Zero(),
+        plant_.GetBodyByName("lower_link"), Vector3d(-1, 0, 0), 0.7);
+    constraints_.push_back(distance_.get());
+    data_set_ = std::make_unique<DirconKinematicDataSet<double>>(
+        plant_, &constraints_);
+  }
+
+  std::unique_ptr<HybridDircon<double>> MakeDircon(
+      const vector<int>& mode_lengths) {
+    const DirconOptions options(data_set_->countConstraints());
+    return std::make_unique<HybridDircon<double>>(
+        plant_, mode_lengths, vector<double>{.01, .01},
+        vector<double>{.3, .3}, vector<DirconKinematicDataSet<double>*>{
+                                    data_set_.get(), data_set_.get()},
+        vector<DirconOptions>{options, options});
+  }
+
+  // A "solution" of trajopt with random values, and time steps of h[mode]
+  // within each mode
+  static MathematicalProgramResult MakeResult(
+      const HybridDircon<double>& trajopt, const vector<double>& h) {
+    VectorXd z = VectorXd::Random(trajopt.decision_variables().size());
+    int mode_start = 0;
+    for (int mode = 0; mode < trajopt.num_modes(); ++mode) {
+      for (int i = 0; i < trajopt.mode_lengths()[mode] - 1; ++i) {
+        z(trajopt.FindDecisionVariableIndex(
+            trajopt.timestep(mode_start + i)(0))) = h[mode];
+      }
+      mode_start += trajopt.mode_lengths()[mode] - 1;
+    }
+    MathematicalProgramResult result;
+    result.set_decision_variable_index(trajopt.decision_variable_index());
+    result.set_x_val(z);
+    return result;
+  }
+
+  // Saves the trajectory of `result` to a file, and returns its path
+  string SaveTrajectory(const HybridDircon<double>& trajopt,
+                        const MathematicalProgramResult& result,
+                        const string& name) {
+    const string file = drake::temp_directory() + "/" + name;
+    DirconTrajectory(plant_, trajopt, result, name, "").WriteToFile(file);
+    return file;
+  }
+
+  MultibodyPlant<double> plant_;
+  std::unique_ptr<DirconDistanceData<double>> distance_;
+  vector<DirconKinematicData<double>*> constraints_;
+  std::unique_ptr<DirconKinematicDataSet<double>> data_set_;
+};
+
+TEST_F(DirconSavedTrajectoryTest, SameKnotPointsRoundTrip) {
+  const auto coarse = MakeDircon({3, 3});
+  const auto result = MakeResult(*coarse, {.1, .2});
+  const DirconTrajectory loaded(
+      SaveTrajectory(*coarse, result, "same_knots"));
+  EXPECT_TRUE(CompareMatrices(loaded.GetDecisionVariables(),
+                              result.get_x_val()));
+  const auto trajopt = MakeDircon({3, 3});
+  loaded.SetInitialGuess(trajopt.get());
+  EXPECT_TRUE(CompareMatrices(trajopt->initial_guess(), result.get_x_val()));
+}
+
+TEST_F(DirconSavedTrajectoryTest, ResamplesOntoFinerKnotPoints) {
+  const auto coarse = MakeDircon({3, 3});
+  const auto result = MakeResult(*coarse, {.1, .2});
+  const DirconTrajectory loaded(SaveTrajectory(*coarse, result, "resample"));
+
+  // Twice as many intervals per mode, so every other knot point is one of the
+  // saved ones
+  const auto fine = MakeDircon({5, 5});
+  loaded.SetInitialGuess(fine.get());
+
+  const vector<double> h{.05, .1};
+  int mode_start = 0;
+  for (int mode = 0; mode < 2; ++mode) {
+    const PiecewisePolynomial<double> state_traj =
+        PiecewisePolynomial<double>::CubicHermite(
+            loaded.GetStateBreaks(mode), loaded.GetStateSamples(mode),
+            loaded.GetStateDerivativeSamples(mode));
+    const double start_time = loaded.GetStateBreaks(mode)(0);
+    for (int i = 0; i < 5; ++i) {
+      const VectorXd x =
+          fine->GetInitialGuess(fine->state_vars_by_mode(mode, i));
+      EXPECT_TRUE(CompareMatrices(
+          x, state_traj.value(start_time + i * h[mode]), kTol));
+      if (i % 2 == 0) {
+        EXPECT_TRUE(CompareMatrices(
+            x, loaded.GetStateSamples(mode).col(i / 2), kTol));
+        EXPECT_TRUE(CompareMatrices(
+            fine->GetInitialGuess(fine->input(mode_start + i)),
+            loaded.GetInputSamples().col(mode_start / 2 + i / 2), kTol));
+        EXPECT_TRUE(CompareMatrices(
+            fine->GetInitialGuess(fine->force(mode, i)),
+            loaded.GetForceSamples(mode).col(i / 2), kTol));
+      }
+      if (i < 4) {
+        EXPECT_NEAR(fine->GetInitialGuess(fine->timestep(mode_start + i))(0),
+                    h[mode], kTol);
+      }
+    }
+    mode_start += 4;
+  }
+}
+
+TEST_F(DirconSavedTrajectoryTest, LoadsOldDecisionVariableLayout) {
+  const auto coarse = MakeDircon({3, 3});
+  const auto result = MakeResult(*coarse, {.1, .2});
+  const DirconTrajectory saved(plant_, *coarse, result, "coarse", "");
+
+  // Older files saved n x n decision variables, of which the first column
+  // holds their values
+  const int n = result.get_x_val().size();
+  vector<LcmTrajectory::Trajectory> trajectories;
+  for (const string& name : saved.GetTrajectoryNames()) {
+    trajectories.push_back(saved.GetTrajectory(name));
+  }
+  for (auto& traj : trajectories) {
+    if (traj.traj_name == "decision_vars") {
+      traj.time_vector = VectorXd::Zero(n);
+      traj.datapoints = MatrixXd::Random(n, n);
+      traj.datapoints.col(0) = result.get_x_val();
+    }
+  }
+  const string file = drake::temp_directory() + "/old_layout";
+  LcmTrajectory(trajectories, saved.GetTrajectoryNames(), "coarse", "")
+      .WriteToFile(file);
+
+  const DirconTrajectory loaded(file);
+  EXPECT_TRUE(CompareMatrices(loaded.GetDecisionVariables(),
+                              result.get_x_val()));
+  const auto trajopt = MakeDircon({3, 3});
+  loaded.SetInitialGuess(trajopt.get());
+  EXPECT_TRUE(CompareMatrices(trajopt->initial_guess(), result.get_x_val()));
+}
+
+}  // namespace
+}  // namespace dairlib
@@ -0,0 +1,157 @@
+#include "lcm/log_rectifier.h"
+
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "dairlib/lcmt_robot_input.hpp"
+
+#include "drake/common/temp_directory.h"
+#include "drake/lcm/drake_lcm_log.h"
+
+namespace dairlib {
+namespace {
+
+using drake::lcm::DrakeLcmLog;
+using multibody::LcmLogReader;
+using std::string;
+using std::vector;
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+// Writes a log with one event per time (in ms after 1 s), in the given order.
+// Each message's utime is its position in the log plus `id_offset`.
+string WriteLog(const string& name, const string& channel,
+                const vector<int>& times_ms, int id_offset = 0) {
+  const string file = drake::temp_directory() + "/" + name + ".lcmlog";
+  DrakeLcmLog log(file, true);
+  for (size_t i = 0; i < times_ms.size(); i++) {
+    lcmt_robot_input msg{};
+    msg.utime = id_offset + i;
+    drake::lcm::Publish(&log, channel, msg, 1.0 + 1e-3 * times_ms[i]);
+  }
+  return file;
+}
+
+// Times (in ms after 1 s) in which `log` writes its events
+vector<int> Drain(ReorderedLog* log) {
+  vector<int> times_ms;
+  while (!log->empty()) {
+    times_ms.push_back(std::lround(1e-3 * log->top().log_utime) - 1000);
+    log->pop();
+  }
+  return times_ms;
+}
+
+string ReadFile(const string& file) {
+  std::ifstream in(file, std::ios::binary);
+  return string(std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>());
+}
+
+TEST(LogRectifierTest, ReordersWithinWindow) {
+  const string file = WriteLog("displaced", "A", {0, 2, 1, 3, 5, 4, 6});
+  ReorderedLog log(file, {}, 0, kInf, 1, 1);
+  EXPECT_EQ(log.num_events(), 7);
+  EXPECT_EQ(Drain(&log), (vector<int>{0, 1, 2, 3, 4, 5, 6}));
+  EXPECT_EQ(log.num_out_of_order(), 2);
+  EXPECT_EQ(log.num_late(), 0);
+  EXPECT_EQ(log.window(), 1);
+}
+
+TEST(LogRectifierTest, WindowGrowsForLateEvents) {
+  // The event at 0 ms is displaced by four events
+  const vector<int> times_ms{10, 20, 30, 40, 0, 50, 60, 70};
+  const string file = WriteLog("late", "A", times_ms);
+
+  // A window of one event writes three events before the displaced one
+  // arrives. It is written as soon as possible, and the window doubles.
+  ReorderedLog small(file, {}, 0, kInf, 1, 4);
+  EXPECT_EQ(Drain(&small), (vector<int>{10, 20, 30, 0, 40, 50, 60, 70}));
+  EXPECT_EQ(small.num_out_of_order(), 1);
+  EXPECT_EQ(small.num_late(), 1);
+  EXPECT_EQ(small.window(), 2);
+
+  // ... but never beyond the maximum
+  ReorderedLog capped(file, {}, 0, kInf, 1, 1);
+  Drain(&capped);
+  EXPECT_EQ(capped.num_late(), 1);
+  EXPECT_EQ(capped.window(), 1);
+
+  // A window of four events absorbs it
+  ReorderedLog large(file, {}, 0, kInf, 4, 4);
+  EXPECT_EQ(Drain(&large), (vector<int>{0, 10, 20, 30, 40, 50, 60, 70}));
+  EXPECT_EQ(large.num_late(), 0);
+}
+
+TEST(LogRectifierTest, ChannelsAndTimeWindow) {
+  const string file = drake::temp_directory() + "/channels.lcmlog";
+  {
+    DrakeLcmLog log(file, true);
+    for (int i = 0; i < 10; i++) {
+      lcmt_robot_input msg{};
+      drake::lcm::Publish(&log, i % 2 ? "B" : "A", msg, 1.0 + 1e-3 * i);
+    }
+  }
+  ReorderedLog log(file, {"B"}, 0.002, 0.006, 2, 2);
+  EXPECT_EQ(log.num_events(), 2);
+  EXPECT_EQ(*log.top().channel, "B");
+  EXPECT_NEAR(log.top().log_utime, 1003000, 1);
+}
+
+TEST(LogRectifierTest, MergesLogs) {
+  // Two out of order logs, e.g. of the dispatcher and of the controller, with
+  // one event at the same time in both
+  const string first = WriteLog("first", "STATE", {0, 20, 10, 30, 50});
+  const string second = WriteLog("second", "INPUT", {5, 30, 25, 40}, 100);
+  const string merged = drake::temp_directory() + "/merged.lcmlog";
+
+  // Writes the merged log through a buffer of `buffer_size` bytes
+  const auto merge = [&](int buffer_size) {
+    ReorderedLog first_log(first, {}, 0, kInf, 2, 2);
+    ReorderedLog second_log(second, {}, 0, kInf, 2, 2);
+    LogWriter writer(merged, buffer_size);
+    MergeLogs({&first_log, &second_log}, &writer);
+    writer.Close();
+    EXPECT_EQ(writer.num_events(), 9);
+    return ReadFile(merged);
+  };
+
+  // A buffer smaller than one event writes every payload directly, and one
+  // of a few events flushes several times, and both match the large buffer
+  const string small_buffer_bytes = merge(16);
+  const string some_buffer_bytes = merge(200);
+  const string bytes = merge(1 << 20);
+  EXPECT_EQ(small_buffer_bytes, bytes);
+  EXPECT_EQ(some_buffer_bytes, bytes);
+
+  // The merged log is in order, ties going to the first input, and the
+  // payloads are intact
+  LcmLogReader reader(merged, false);
+  EXPECT_EQ(reader.GetNumMessages("STATE"), 5);
+  EXPECT_EQ(reader.GetNumMessages("INPUT"), 4);
+  const vector<std::pair<string, int>> expected{
+      {"STATE", 0},   {"INPUT", 100}, {"STATE", 2},
+      {"STATE", 1},   {"INPUT", 102}, {"STATE", 3},
+      {"INPUT", 101}, {"INPUT", 103}, {"STATE", 4}};
+  const auto events = reader.GetEvents({});
+  ASSERT_EQ(events.size(), expected.size());
+  int64_t last_utime = 0;
+  for (size_t i = 0; i < events.size(); i++) {
+    EXPECT_EQ(*events[i].channel, expected[i].first);
+    EXPECT_GE(events[i].log_utime, last_utime);
+    last_utime = events[i].log_utime;
+    lcmt_robot_input msg;
+    ASSERT_EQ(msg.decode(events[i].data, 0, events[i].data_size),
+              events[i].data_size);
+    EXPECT_EQ(msg.utime, expected[i].second);
+  }
+}
+
+}  // namespace
+}  // namespace dairlib
@@ -0,0 +1,153 @@
+#include "lcm/shm_lcm.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace dairlib {
+namespace {
+
+class ShmLcmTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    url_ = "shm://shm_lcm_test_" + std::to_string(getpid()) +
+           "?capacity=65536";
+    ShmLcm::RemoveSegment(url_);
+  }
+  void TearDown() override { ShmLcm::RemoveSegment(url_); }
+
+  std::string url_;
+};
+
+std::vector<uint8_t> MakeMessage(int size, uint8_t value) {
+  return std::vector<uint8_t>(size, value);
+}
+
+TEST_F(ShmLcmTest, PublishSubscribe) {
+  ShmLcm publisher(url_);
+  ShmLcm subscriber(url_);
+  EXPECT_EQ(publisher.get_capacity(), 65536);
+  EXPECT_EQ(subscriber.get_lcm_url(), url_);
+
+  std::vector<std::vector<uint8_t>> received;
+  subscriber.Subscribe("STATE", [&received](const void* data, int size) {
+    const auto bytes = static_cast<const uint8_t*>(data);
+    received.emplace_back(bytes, bytes + size);
+  });
+  std::vector<std::string> all_channels;
+  auto all_subscription = subscriber.SubscribeAllChannels(
+      [&all_channels](const std::string& channel, const void*, int) {
+        all_channels.push_back(channel);
+      });
+  int num_own = 0;
+  publisher.Subscribe("STATE",
+                      [&num_own](const void*, int) { num_own++; });
+
+  EXPECT_EQ(subscriber.HandleSubscriptions(0), 0);
+  // Sizes which are not multiples of 8, and enough messages to wrap around the
+  // end of the ring
+  for (int i = 0; i < 300; i++) {
+    const auto message = MakeMessage(100 + i, i);
+    publisher.Publish("STATE", message.data(), message.size(), {});
+    publisher.Publish("OTHER", message.data(), 10, {});
+    if (i % 100 == 99) {
+      EXPECT_EQ(subscriber.HandleSubscriptions(0), 200);
+      EXPECT_EQ(publisher.HandleSubscriptions(0), 100);
+    }
+  }
+  ASSERT_EQ(received.size(), 300u);
+  for (int i = 0; i < 300; i++) {
+    EXPECT_EQ(received[i], MakeMessage(100 + i, i));
+  }
+  EXPECT_EQ(all_channels.size(), 600u);
+  EXPECT_EQ(all_channels[1], "OTHER");
+  EXPECT_EQ(subscriber.get_num_dropped(), 0);
+  // The publisher receives its own messages
+  EXPECT_EQ(num_own, 300);
+
+  // Unsubscribed when the subscription is deleted. Messages which are not
+  // subscribed to are not counted as handled.
+  all_subscription->set_unsubscribe_on_delete(true);
+  all_subscription.reset();
+  publisher.Publish("OTHER", nullptr, 0, {});
+  EXPECT_EQ(subscriber.HandleSubscriptions(0), 0);
+  EXPECT_EQ(all_channels.size(), 600u);
+
+  const auto too_large = MakeMessage(40000, 0);
+  EXPECT_THROW(publisher.Publish("STATE", too_large.data(), too_large.size(),
+                                 {}),
+               std::runtime_error);
+}
+
+TEST_F(ShmLcmTest, SlowReaderDropsMessages) {
+  ShmLcm publisher(url_);
+  ShmLcm subscriber(url_);
+  int last_value = -1;
+  int num_received = 0;
+  subscriber.Subscribe("STATE", [&](const void* data, int) {
+    last_value = *static_cast<const uint8_t*>(data);
+    num_received++;
+  });
+
+  // 200 messages of 1 KiB overrun the 64 KiB ring
+  for (int i = 0; i < 200; i++) {
+    const auto message = MakeMessage(1024, i);
+    publisher.Publish("STATE", message.data(), message.size(), {});
+  }
+  subscriber.HandleSubscriptions(0);
+  EXPECT_EQ(num_received, 0);
+  EXPECT_EQ(subscriber.get_num_dropped(), 0);
+
+  // The reader skips to the latest message
+  const auto message = MakeMessage(1024, 200);
+  publisher.Publish("STATE", message.data(), message.size(), {});
+  EXPECT_EQ(subscriber.HandleSubscriptions(0), 1);
+  EXPECT_EQ(last_value, 200);
+  EXPECT_EQ(subscriber.get_num_dropped(), 200);
+}
+
+TEST_F(ShmLcmTest, WakesReaderInAnotherProcess) {
+  ShmLcm subscriber(url_);
+  std::vector<int> received;
+  subscriber.Subscribe("STATE", [&received](const void* data, int size) {
+    received.push_back(size == 4 ? *static_cast<const int*>(data) : -1);
+  });
+
+  const pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    ShmLcm publisher(url_);
+    for (int i = 0; i < 10; i++) {
+      usleep(2000);
+      publisher.Publish("STATE", &i, sizeof(i), {});
+    }
+    _exit(0);
+  }
+  while (received.size() < 10) {
+    ASSERT_GT(subscriber.HandleSubscriptions(5000), 0);
+  }
+  int status;
+  waitpid(child, &status, 0);
+  EXPECT_EQ(status, 0);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(received[i], i);
+  }
+  EXPECT_EQ(subscriber.HandleSubscriptions(10), 0);
+}
+
+TEST_F(ShmLcmTest, Urls) {
+  EXPECT_TRUE(ShmLcm::IsShmUrl("shm://state"));
+  EXPECT_FALSE(ShmLcm::IsShmUrl("udpm://239.255.76.67:7667?ttl=0"));
+  EXPECT_THROW(ShmLcm("udpm://239.255.76.67:7667"), std::runtime_error);
+  EXPECT_THROW(ShmLcm("shm://"), std::runtime_error);
+  EXPECT_THROW(ShmLcm("shm://a/b"), std::runtime_error);
+  EXPECT_THROW(ShmLcm("shm://a?capacity=lots"), std::runtime_error);
+  auto lcm = MakeLcmInterface(url_);
+  EXPECT_NE(dynamic_cast<ShmLcm*>(lcm.get()), nullptr);
+}
+
+}  // namespace
+}  // namespace dairlib
@@ -1,5 +1,10 @@
 #include "multibody/kinematic/distance_evaluator.h"
 
+#include <algorithm>
+#include <iterator>
+
+#include "multibody/multibody_utils.h"
+
 #include "drake/math/orthonormal_basis.h"
 
 using drake::MatrixX;
@@ -32,8 +37,8 @@ template <typename T>
 VectorX<T> DistanceEvaluator<T>::EvalFull(const Context<T>& context) const {
   // Transform points A and B to world frame
   const drake::multibody::Frame<T>& world = plant().world_frame();
-  static Vector3<T> pt_A_W;
-  static Vector3<T> pt_B_W;
+  Vector3<T> pt_A_W;
+  Vector3<T> pt_B_W;
 
   plant().CalcPointsPositions(context, frame_A_, pt_A_.template cast<T>(),
                               world, &pt_A_W);
@@ -51,12 +56,10 @@ void DistanceEvaluator<T>::EvalFullJacobian(
   /// Jacobian of ||pt_A - pt_B||, evaluated all in world frame, is
   ///   (pt_A - pt_B)^T * (J_A - J_B) / ||pt_A - pt_B||
 
-  // Create static Jacobians and point positions for re-use. Warning: not thread
-  // safe
-  static Matrix3X<T> J_A(3, plant().num_velocities());
-  static Matrix3X<T> J_B(3, plant().num_velocities());
-  static Vector3<T> pt_A_W;;
-  static Vector3<T> pt_B_W;
+  Matrix3X<T> J_A(3, plant().num_velocities());
+  Matrix3X<T> J_B(3, plant().num_velocities());
+  Vector3<T> pt_A_W;
+  Vector3<T> pt_B_W;
 
   const drake::multibody::Frame<T>& world = plant().world_frame();
 
@@ -86,10 +89,10 @@ VectorX<T> DistanceEvaluator<T>::EvalFullJacobianDotTimesV(
   //   - phidot * (pt_A - pt_B)^T (J_A - J_B) *v / phi^2
   const drake::multibody::Frame<T>& world = plant().world_frame();
 
-  static MatrixX<T> J_A(3, plant().num_velocities());
-  static MatrixX<T> J_B(3, plant().num_velocities());
-  static VectorX<T> pt_A_world(3);
-  static VectorX<T> pt_B_world(3);
+  MatrixX<T> J_A(3, plant().num_velocities());
+  MatrixX<T> J_B(3, plant().num_velocities());
+  VectorX<T> pt_A_world(3);
+  VectorX<T> pt_B_world(3);
 
   auto pt_A_cast = pt_A_.template cast<T>();
   auto pt_B_cast = pt_B_.template cast<T>();
@@ -134,6 +137,94 @@ VectorX<T> DistanceEvaluator<T>::EvalFullJacobianDotTimesV(
   return J_dot_times_v;
 }
 
+template <typename T>
+VectorX<T> DistanceEvaluator<T>::EvalFull(
+    const Context<T>& context, FrameKinematicsCache<T>* cache) const {
+  VectorX<T> difference(1);
+  EvalFullInto(context, cache, &difference);
+  return difference;
+}
+
+template <typename T>
+void DistanceEvaluator<T>::EvalFullJacobian(
+    const Context<T>& context, FrameKinematicsCache<T>* cache,
+    drake::EigenPtr<MatrixX<T>> J) const {
+  if (!cache) {
+    EvalFullJacobian(context, J);
+    return;
+  }
+  Vector3<T> rel_pos = cache->EvalPointPosition(context, frame_A_, pt_A_) -
+                       cache->EvalPointPosition(context, frame_B_, pt_B_);
+  const auto J_A =
+      cache->EvalJacobianTranslationalVelocity(context, frame_A_, pt_A_);
+  const auto J_B =
+      cache->EvalJacobianTranslationalVelocity(context, frame_B_, pt_B_);
+  *J = (rel_pos.transpose() * (J_A - J_B)) / rel_pos.norm();
+}
+
+template <typename T>
+VectorX<T> DistanceEvaluator<T>::EvalFullJacobianDotTimesV(
+    const Context<T>& context, FrameKinematicsCache<T>* cache) const {
+  VectorX<T> J_dot_times_v(1);
+  EvalFullJacobianDotTimesVInto(context, cache, &J_dot_times_v);
+  return J_dot_times_v;
+}
+
+template <typename T>
+void DistanceEvaluator<T>::EvalFullInto(
+    const Context<T>& context, FrameKinematicsCache<T>* cache,
+    drake::EigenPtr<VectorX<T>> phi) const {
+  if (!cache) {
+    *phi = EvalFull(context);
+    return;
+  }
+  Vector3<T> rel_pos = cache->EvalPointPosition(context, frame_A_, pt_A_) -
+                       cache->EvalPointPosition(context, frame_B_, pt_B_);
+  (*phi)(0) = rel_pos.norm() - distance_;
+}
+
+template <typename T>
+void DistanceEvaluator<T>::EvalFullJacobianDotTimesVInto(
+    const Context<T>& context, FrameKinematicsCache<T>* cache,
+    drake::EigenPtr<VectorX<T>> Jdotv) const {
+  if (!cache) {
+    *Jdotv = EvalFullJacobianDotTimesV(context);
+    return;
+  }
+  // See EvalFullJacobianDotTimesV(context) for the derivation
+  Vector3<T> rel_pos = cache->EvalPointPosition(context, frame_A_, pt_A_) -
+                       cache->EvalPointPosition(context, frame_B_, pt_B_);
+  const auto J_A =
+      cache->EvalJacobianTranslationalVelocity(context, frame_A_, pt_A_);
+  const auto J_B =
+      cache->EvalJacobianTranslationalVelocity(context, frame_B_, pt_B_);
+  Vector3<T> J_rel_dot_times_v =
+      cache->EvalBiasTranslationalAcceleration(context, frame_A_, pt_A_) -
+      cache->EvalBiasTranslationalAcceleration(context, frame_B_, pt_B_);
+  T phi = rel_pos.norm();
+
+  const auto& v = plant().GetVelocities(context);
+  Vector3<T> J_rel_v = J_A * v - J_B * v;
+  T phidot = rel_pos.dot(J_rel_v) / phi;
+
+  (*Jdotv)(0) = (J_rel_v).squaredNorm() / phi +
+                rel_pos.dot(J_rel_dot_times_v) / phi -
+                phidot * rel_pos.dot(J_rel_v) / (phi * phi);
+}
+
+template <typename T>
+std::vector<int> DistanceEvaluator<T>::GetDependentIndices(
+    bool velocities) const {
+  const auto path_A =
+      KinematicPathIndices(plant(), frame_A_.body(), velocities);
+  const auto path_B =
+      KinematicPathIndices(plant(), frame_B_.body(), velocities);
+  std::vector<int> indices;
+  std::set_union(path_A.begin(), path_A.end(), path_B.begin(), path_B.end(),
+                 std::back_inserter(indices));
+  return indices;
+}
+
 DRAKE_DEFINE_CLASS_TEMPLATE_INSTANTIATIONS_ON_DEFAULT_NONSYMBOLIC_SCALARS(
     class ::dairlib::multibody::DistanceEvaluator)
 
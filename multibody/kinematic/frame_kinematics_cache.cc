@@ -0,0 +1,201 @@
+#include "multibody/kinematic/frame_kinematics_cache.h"
+
+using drake::MatrixX;
+using drake::Vector3;
+using drake::multibody::Frame;
+using drake::multibody::JacobianWrtVariable;
+using drake::multibody::MultibodyPlant;
+using drake::systems::Context;
+using Eigen::Vector3d;
+
+namespace dairlib {
+namespace multibody {
+
+template <typename T>
+FrameKinematicsCache<T>::FrameKinematicsCache(const MultibodyPlant<T>& plant)
+    : plant_(plant),
+      world_(plant.world_frame()),
+      J_com_(3, plant.num_velocities()) {}
+
+template <typename T>
+void FrameKinematicsCache<T>::Invalidate() {
+  for (auto& entry : entries_) {
+    entry.positions_valid = false;
+    entry.J_valid = false;
+    entry.JdotV_valid = false;
+    entry.J_angular_valid = false;
+    entry.JdotV_angular_valid = false;
+  }
+  com_position_valid_ = false;
+  J_com_valid_ = false;
+  JdotV_com_valid_ = false;
+}
+
+template <typename T>
+typename FrameKinematicsCache<T>::FrameEntry& FrameKinematicsCache<T>::GetEntry(
+    const Frame<T>& frame, JacobianWrtVariable wrt) {
+  for (auto& entry : entries_) {
+    if (entry.frame == &frame && entry.wrt == wrt) {
+      return entry;
+    }
+  }
+  FrameEntry entry;
+  entry.frame = &frame;
+  entry.wrt = wrt;
+  int n = (wrt == JacobianWrtVariable::kV) ? plant_.num_velocities()
+                                           : plant_.num_positions();
+  entry.points.resize(3, 0);
+  entry.positions.resize(3, 0);
+  entry.J.resize(0, n);
+  entry.JdotV.resize(3, 0);
+  entry.J_spatial.resize(6, n);
+  entries_.push_back(entry);
+  return entries_.back();
+}
+
+template <typename T>
+int FrameKinematicsCache<T>::GetPointIndex(FrameEntry* entry,
+                                           const Vector3d& pt) {
+  for (int i = 0; i < entry->points.cols(); i++) {
+    if (entry->points.col(i) == pt.template cast<T>()) {
+      return i;
+    }
+  }
+  // Register a new point. The sizes of the cached quantities change, so they
+  // are all recomputed on the next query.
+  int i = entry->points.cols();
+  entry->points.conservativeResize(3, i + 1);
+  entry->points.col(i) = pt.template cast<T>();
+  entry->positions.resize(3, i + 1);
+  entry->J.resize(3 * (i + 1), entry->J.cols());
+  entry->J_points.emplace_back(3, entry->J.cols());
+  entry->JdotV.resize(3, i + 1);
+  entry->positions_valid = false;
+  entry->J_valid = false;
+  entry->JdotV_valid = false;
+  return i;
+}
+
+template <typename T>
+Vector3<T> FrameKinematicsCache<T>::EvalPointPosition(
+    const Context<T>& context, const Frame<T>& frame, const Vector3d& pt) {
+  // Positions don't depend on wrt, so they are stored in the kV entry
+  auto& entry = GetEntry(frame, JacobianWrtVariable::kV);
+  int i = GetPointIndex(&entry, pt);
+  if (!entry.positions_valid) {
+    plant_.CalcPointsPositions(context, frame, entry.points, world_,
+                               &entry.positions);
+    entry.positions_valid = true;
+    num_plant_queries_++;
+  }
+  return entry.positions.col(i);
+}
+
+template <typename T>
+Eigen::Ref<const MatrixX<T>>
+FrameKinematicsCache<T>::EvalJacobianTranslationalVelocity(
+    const Context<T>& context, const Frame<T>& frame, const Vector3d& pt,
+    JacobianWrtVariable wrt) {
+  auto& entry = GetEntry(frame, wrt);
+  int i = GetPointIndex(&entry, pt);
+  if (!entry.J_valid) {
+    plant_.CalcJacobianTranslationalVelocity(context, wrt, frame, entry.points,
+                                             world_, world_, &entry.J);
+    for (int k = 0; k < static_cast<int>(entry.J_points.size()); k++) {
+      entry.J_points[k] = entry.J.middleRows(3 * k, 3);
+    }
+    entry.J_valid = true;
+    num_plant_queries_++;
+  }
+  return entry.J_points[i];
+}
+
+template <typename T>
+Vector3<T> FrameKinematicsCache<T>::EvalBiasTranslationalAcceleration(
+    const Context<T>& context, const Frame<T>& frame, const Vector3d& pt,
+    JacobianWrtVariable wrt) {
+  auto& entry = GetEntry(frame, wrt);
+  int i = GetPointIndex(&entry, pt);
+  if (!entry.JdotV_valid) {
+    entry.JdotV = plant_.CalcBiasTranslationalAcceleration(
+        context, wrt, frame, entry.points, world_, world_);
+    entry.JdotV_valid = true;
+    num_plant_queries_++;
+  }
+  return entry.JdotV.col(i);
+}
+
+template <typename T>
+Eigen::Ref<const MatrixX<T>>
+FrameKinematicsCache<T>::EvalJacobianAngularVelocity(const Context<T>& context,
+                                                     const Frame<T>& frame,
+                                                     JacobianWrtVariable wrt) {
+  auto& entry = GetEntry(frame, wrt);
+  if (!entry.J_angular_valid) {
+    // The angular part of the spatial Jacobian doesn't depend on the point
+    plant_.CalcJacobianSpatialVelocity(context, wrt, frame,
+                                       Vector3<T>::Zero(), world_, world_,
+                                       &entry.J_spatial);
+    entry.J_angular_valid = true;
+    num_plant_queries_++;
+  }
+  return entry.J_spatial.topRows(3);
+}
+
+template <typename T>
+Vector3<T> FrameKinematicsCache<T>::EvalBiasAngularAcceleration(
+    const Context<T>& context, const Frame<T>& frame,
+    JacobianWrtVariable wrt) {
+  auto& entry = GetEntry(frame, wrt);
+  if (!entry.JdotV_angular_valid) {
+    entry.JdotV_angular =
+        plant_
+            .CalcBiasSpatialAcceleration(context, wrt, frame,
+                                         Vector3<T>::Zero(), world_, world_)
+            .rotational();
+    entry.JdotV_angular_valid = true;
+    num_plant_queries_++;
+  }
+  return entry.JdotV_angular;
+}
+
+template <typename T>
+Vector3<T> FrameKinematicsCache<T>::EvalCenterOfMassPosition(
+    const Context<T>& context) {
+  if (!com_position_valid_) {
+    com_position_ = plant_.CalcCenterOfMassPosition(context);
+    com_position_valid_ = true;
+    num_plant_queries_++;
+  }
+  return com_position_;
+}
+
+template <typename T>
+Eigen::Ref<const MatrixX<T>> FrameKinematicsCache<T>::EvalJacobianCenterOfMass(
+    const Context<T>& context) {
+  if (!J_com_valid_) {
+    plant_.CalcJacobianCenterOfMassTranslationalVelocity(
+        context, JacobianWrtVariable::kV, world_, world_, &J_com_);
+    J_com_valid_ = true;
+    num_plant_queries_++;
+  }
+  return J_com_;
+}
+
+template <typename T>
+Vector3<T> FrameKinematicsCache<T>::EvalBiasCenterOfMassAcceleration(
+    const Context<T>& context) {
+  if (!JdotV_com_valid_) {
+    JdotV_com_ = plant_.CalcBiasCenterOfMassTranslationalAcceleration(
+        context, JacobianWrtVariable::kV, world_, world_);
+    JdotV_com_valid_ = true;
+    num_plant_queries_++;
+  }
+  return JdotV_com_;
+}
+
+}  // namespace multibody
+}  // namespace dairlib
+
+DRAKE_DEFINE_CLASS_TEMPLATE_INSTANTIATIONS_ON_DEFAULT_NONSYMBOLIC_SCALARS(
+    class ::dairlib::multibody::FrameKinematicsCache)
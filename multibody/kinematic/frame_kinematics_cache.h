@@ -0,0 +1,129 @@
+#pragma once
+
+#include <deque>
+
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/systems/framework/context.h"
+
+namespace dairlib {
+namespace multibody {
+
+/// FrameKinematicsCache stores point positions, translational Jacobians and
+/// bias accelerations (Jdot * v) w.r.t. the world frame, so that several
+/// users of the same Context (e.g. OSC tracking data and contact/holonomic
+/// evaluators) compute each of them only once per state.
+///
+/// Entries are keyed by (frame, point, wrt). Points are registered on first
+/// use, and all points registered on the same frame are computed together, in
+/// a single MultibodyPlant query per quantity. Rotational Jacobians and bias
+/// accelerations are keyed by (frame, wrt), since they do not depend on the
+/// point. The center of mass is cached as well.
+///
+/// The cache does not track changes of the Context. The owner must call
+/// Invalidate() every time the state in the Context changes (for instance,
+/// once per control tick).
+///
+/// The Jacobians are returned as references into the cache. Their storage is
+/// never reallocated, so a reference stays valid for the lifetime of the cache,
+/// and holds the value for the current state until the next Invalidate().
+///
+/// Warning: not thread safe. Use one cache per Context.
+template <typename T>
+class FrameKinematicsCache {
+ public:
+  explicit FrameKinematicsCache(
+      const drake::multibody::MultibodyPlant<T>& plant);
+
+  /// Marks every cached entry as stale. Registered points are kept.
+  void Invalidate();
+
+  /// Position of `pt` (expressed in `frame`) in the world frame
+  drake::Vector3<T> EvalPointPosition(
+      const drake::systems::Context<T>& context,
+      const drake::multibody::Frame<T>& frame, const Eigen::Vector3d& pt);
+
+  /// Translational velocity Jacobian (3 x n) of `pt` in the world frame
+  Eigen::Ref<const drake::MatrixX<T>> EvalJacobianTranslationalVelocity(
+      const drake::systems::Context<T>& context,
+      const drake::multibody::Frame<T>& frame, const Eigen::Vector3d& pt,
+      drake::multibody::JacobianWrtVariable wrt =
+          drake::multibody::JacobianWrtVariable::kV);
+
+  /// Translational bias acceleration (Jdot * v) of `pt` in the world frame
+  drake::Vector3<T> EvalBiasTranslationalAcceleration(
+      const drake::systems::Context<T>& context,
+      const drake::multibody::Frame<T>& frame, const Eigen::Vector3d& pt,
+      drake::multibody::JacobianWrtVariable wrt =
+          drake::multibody::JacobianWrtVariable::kV);
+
+  /// Angular velocity Jacobian (3 x n) of `frame` in the world frame
+  Eigen::Ref<const drake::MatrixX<T>> EvalJacobianAngularVelocity(
+      const drake::systems::Context<T>& context,
+      const drake::multibody::Frame<T>& frame,
+      drake::multibody::JacobianWrtVariable wrt =
+          drake::multibody::JacobianWrtVariable::kV);
+
+  /// Rotational bias acceleration of `frame` in the world frame
+  drake::Vector3<T> EvalBiasAngularAcceleration(
+      const drake::systems::Context<T>& context,
+      const drake::multibody::Frame<T>& frame,
+      drake::multibody::JacobianWrtVariable wrt =
+          drake::multibody::JacobianWrtVariable::kV);
+
+  /// Center of mass position, Jacobian (w.r.t. v) and bias acceleration
+  drake::Vector3<T> EvalCenterOfMassPosition(
+      const drake::systems::Context<T>& context);
+  Eigen::Ref<const drake::MatrixX<T>> EvalJacobianCenterOfMass(
+      const drake::systems::Context<T>& context);
+  drake::Vector3<T> EvalBiasCenterOfMassAcceleration(
+      const drake::systems::Context<T>& context);
+
+  /// Number of plant queries since construction, for benchmarking
+  int num_plant_queries() const { return num_plant_queries_; }
+
+  const drake::multibody::MultibodyPlant<T>& plant() const { return plant_; }
+
+ private:
+  // All registered points on one frame, and their kinematics
+  struct FrameEntry {
+    const drake::multibody::Frame<T>* frame;
+    drake::multibody::JacobianWrtVariable wrt;
+    drake::Matrix3X<T> points;
+    drake::Matrix3X<T> positions;
+    // Jacobian of all points, stacked, as computed by the plant
+    drake::MatrixX<T> J;
+    // Jacobian (3 x n) of each point, copied from J. Their storage is stable.
+    std::deque<drake::MatrixX<T>> J_points;
+    drake::Matrix3X<T> JdotV;
+    drake::MatrixX<T> J_spatial;
+    drake::Vector3<T> JdotV_angular;
+    bool positions_valid = false;
+    bool J_valid = false;
+    bool JdotV_valid = false;
+    bool J_angular_valid = false;
+    bool JdotV_angular_valid = false;
+  };
+
+  // Finds (or creates) the entry of `frame`, and the column of `pt` in it.
+  // Registering a new point invalidates the entry.
+  FrameEntry& GetEntry(const drake::multibody::Frame<T>& frame,
+                       drake::multibody::JacobianWrtVariable wrt);
+  int GetPointIndex(FrameEntry* entry, const Eigen::Vector3d& pt);
+
+  const drake::multibody::MultibodyPlant<T>& plant_;
+  const drake::multibody::Frame<T>& world_;
+  // A deque, so that adding an entry doesn't move the others
+  std::deque<FrameEntry> entries_;
+
+  drake::Vector3<T> com_position_;
+  drake::MatrixX<T> J_com_;
+  drake::Vector3<T> JdotV_com_;
+  bool com_position_valid_ = false;
+  bool J_com_valid_ = false;
+  bool JdotV_com_valid_ = false;
+
+  int num_plant_queries_ = 0;
+};
+
+}  // namespace multibody
+}  // namespace dairlib
@@ -43,6 +43,18 @@ KinematicPositionConstraint<T>::KinematicPositionConstraint(
   } else {
     context_ = context;
   }
+
+  // Each row depends on the positions along its kinematic path, and on its
+  // own relative offset
+  drake::MatrixX<bool> sparsity = drake::MatrixX<bool>::Constant(
+      this->num_constraints(), this->num_vars(), false);
+  sparsity.leftCols(plant.num_positions()) =
+      evaluators.GetActiveDependencies(false);
+  int i = 0;
+  for (int row : full_constraint_relative_) {
+    sparsity(row, plant.num_positions() + i++) = true;
+  }
+  this->SetGradientSparsity(sparsity);
 }
 
 template <typename T>
@@ -94,6 +106,11 @@ KinematicVelocityConstraint<T>::KinematicVelocityConstraint(
   } else {
     context_ = context;
   }
+
+  drake::MatrixX<bool> sparsity(this->num_constraints(), this->num_vars());
+  sparsity << evaluators.GetActiveDependencies(false),
+      evaluators.GetActiveDependencies(true);
+  this->SetGradientSparsity(sparsity);
 }
 
 template <typename T>
@@ -136,6 +153,9 @@ KinematicAccelerationConstraint<T>::KinematicAccelerationConstraint(
   } else {
     context_ = context;
   }
+
+  this->SetGradientSparsity(
+      evaluators.GetActiveSecondTimeDerivativeDependencies());
 }
 
 template <typename T>
@@ -94,12 +94,38 @@ VectorX<T> KinematicEvaluator<T>::EvalActiveJacobianDotTimesV(
   return Jdot_v;
 }
 
+template <typename T>
+VectorX<T> KinematicEvaluator<T>::EvalActiveJacobianDotTimesV(
+    const Context<T>& context, FrameKinematicsCache<T>* cache) const {
+  auto Jdot_v_full = EvalFullJacobianDotTimesV(context, cache);
+  if (all_active_default_order_) {
+    return Jdot_v_full;
+  }
+
+  VectorX<T> Jdot_v(num_active_);
+  for (int i = 0; i < num_active_; i++) {
+    Jdot_v(i) = Jdot_v_full(active_inds_.at(i));
+  }
+  return Jdot_v;
+}
+
 template <typename T>
 VectorX<T> KinematicEvaluator<T>::EvalFullTimeDerivative(
     const Context<T>& context) const {
   return EvalFullJacobian(context) * plant_.GetVelocities(context);
 }
 
+template <typename T>
+std::vector<int> KinematicEvaluator<T>::GetDependentIndices(
+    bool velocities) const {
+  std::vector<int> indices(
+      velocities ? plant_.num_velocities() : plant_.num_positions());
+  for (size_t i = 0; i < indices.size(); i++) {
+    indices[i] = i;
+  }
+  return indices;
+}
+
 template <typename T>
 void KinematicEvaluator<T>::set_active_inds(std::vector<int> active_inds) {
   // Check active_inds [0, length()] bounds
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "multibody/kinematic/frame_kinematics_cache.h"
+
 #include "drake/multibody/plant/multibody_plant.h"
 #include "drake/solvers/constraint.h"
 #include "drake/systems/framework/context.h"
@@ -74,6 +76,63 @@ class KinematicEvaluator {
   virtual drake::VectorX<T> EvalFullJacobianDotTimesV(
       const drake::systems::Context<T>& context) const = 0;
 
+  /// Same as EvalFull(context), but reads point kinematics from `cache`,
+  /// which must be built on plant() and be valid for `context`. A nullptr
+  /// cache, here and in the other cache overloads, queries the plant directly.
+  /// Evaluators that don't override this query the plant directly.
+  virtual drake::VectorX<T> EvalFull(const drake::systems::Context<T>& context,
+                                     FrameKinematicsCache<T>* cache) const {
+    return EvalFull(context);
+  }
+
+  /// Same as EvalFullJacobian(context, J), but reads point kinematics from
+  /// `cache`.
+  virtual void EvalFullJacobian(const drake::systems::Context<T>& context,
+                                FrameKinematicsCache<T>* cache,
+                                drake::EigenPtr<drake::MatrixX<T>> J) const {
+    EvalFullJacobian(context, J);
+  }
+
+  /// Same as EvalFullJacobianDotTimesV(context), but reads point kinematics
+  /// from `cache`.
+  virtual drake::VectorX<T> EvalFullJacobianDotTimesV(
+      const drake::systems::Context<T>& context,
+      FrameKinematicsCache<T>* cache) const {
+    return EvalFullJacobianDotTimesV(context);
+  }
+
+  /// Writes phi(q), including inactive rows, into `phi`, which must have
+  /// num_full() rows. Reads point kinematics from `cache` unless it is
+  /// nullptr. Evaluators that don't override this copy the result of
+  /// EvalFull.
+  virtual void EvalFullInto(const drake::systems::Context<T>& context,
+                            FrameKinematicsCache<T>* cache,
+                            drake::EigenPtr<drake::VectorX<T>> phi) const {
+    *phi = cache ? EvalFull(context, cache) : EvalFull(context);
+  }
+
+  /// Writes Jdot * v, including inactive rows, into `Jdotv`, as EvalFullInto
+  /// does phi(q)
+  virtual void EvalFullJacobianDotTimesVInto(
+      const drake::systems::Context<T>& context,
+      FrameKinematicsCache<T>* cache,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv) const {
+    *Jdotv = cache ? EvalFullJacobianDotTimesV(context, cache)
+                   : EvalFullJacobianDotTimesV(context);
+  }
+
+  /// Same as EvalActiveJacobianDotTimesV(context), but reads point kinematics
+  /// from `cache`.
+  drake::VectorX<T> EvalActiveJacobianDotTimesV(
+      const drake::systems::Context<T>& context,
+      FrameKinematicsCache<T>* cache) const;
+
+  /// Sorted indices of the generalized positions (or, if velocities is true,
+  /// the generalized velocities) on which phi(q), J(q) and Jdot * v can
+  /// depend, from the plant topology. Used to declare the gradient sparsity of
+  /// optimization constraints. The default implementation returns every index.
+  virtual std::vector<int> GetDependentIndices(bool velocities) const;
+
   void set_active_inds(std::vector<int> active_inds);
 
   const std::vector<int>& active_inds() const;
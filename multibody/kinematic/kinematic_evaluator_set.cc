@@ -1,14 +1,47 @@
 #include "multibody/kinematic/kinematic_evaluator_set.h"
 
+#include <algorithm>
+
+#include "multibody/multibody_utils.h"
+
 #include "drake/math/autodiff_gradient.h"
 
 namespace dairlib {
 namespace multibody {
 
+using drake::EigenPtr;
 using drake::MatrixX;
 using drake::VectorX;
 using drake::systems::Context;
 
+namespace {
+
+// True if every row of `e` is active, in the default order
+template <typename T>
+bool IsAllActiveInOrder(const KinematicEvaluator<T>& e) {
+  if (e.num_active() != e.num_full()) {
+    return false;
+  }
+  for (int k = 0; k < e.num_active(); k++) {
+    if (e.active_inds().at(k) != k) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+void EvalJacobian(const KinematicEvaluator<T>& e, const Context<T>& context,
+                  FrameKinematicsCache<T>* cache, EigenPtr<MatrixX<T>> J) {
+  if (cache) {
+    e.EvalFullJacobian(context, cache, J);
+  } else {
+    e.EvalFullJacobian(context, J);
+  }
+}
+
+}  // namespace
+
 template <typename T>
 KinematicEvaluatorSet<T>::KinematicEvaluatorSet(
     const drake::multibody::MultibodyPlant<T>& plant)
@@ -100,8 +133,9 @@ template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::EvalFullSecondTimeDerivative(
     Context<T>* context, const VectorX<T>& lambda) const {
   const auto& xdot = CalcTimeDerivativesWithForce(context, lambda);
-  const auto& J = EvalFullJacobian(*context);
-  const auto& Jdotv = EvalFullJacobianDotTimesV(*context);
+  MatrixX<T> J(count_full(), plant_.num_velocities());
+  VectorX<T> Jdotv(count_full());
+  EvalFullInto(*context, nullptr, nullptr, &J, &Jdotv);
   return J * xdot.tail(plant_.num_velocities()) + Jdotv;
 }
 
@@ -109,23 +143,16 @@ template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::EvalActiveSecondTimeDerivative(
     Context<T>* context, const VectorX<T>& lambda) const {
   const auto& xdot = CalcTimeDerivativesWithForce(context, lambda);
-  const auto& J = EvalActiveJacobian(*context);
-  const auto& Jdotv = EvalActiveJacobianDotTimesV(*context);
+  MatrixX<T> J(count_active(), plant_.num_velocities());
+  VectorX<T> Jdotv(count_active());
+  EvalActiveInto(*context, nullptr, nullptr, &J, &Jdotv);
   return J * xdot.tail(plant_.num_velocities()) + Jdotv;
 }
 
 template <typename T>
 void KinematicEvaluatorSet<T>::EvalFullJacobian(
     const Context<T>& context, drake::EigenPtr<MatrixX<T>> J) const {
-  const int num_velocities = plant_.num_velocities();
-  DRAKE_THROW_UNLESS(J->rows() == count_full());
-  DRAKE_THROW_UNLESS(J->cols() == num_velocities);
-  int ind = 0;
-  for (const auto& e : evaluators_) {
-    auto J_i = J->block(ind, 0, e->num_full(), num_velocities);
-    e->EvalFullJacobian(context, &J_i);
-    ind += e->num_full();
-  }
+  EvalFullInto(context, nullptr, nullptr, J, nullptr);
 }
 
 template <typename T>
@@ -148,12 +175,124 @@ VectorX<T> KinematicEvaluatorSet<T>::EvalFullJacobianDotTimesV(
   return Jdotv;
 }
 
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalFullJacobian(
+    const Context<T>& context, FrameKinematicsCache<T>* cache,
+    drake::EigenPtr<MatrixX<T>> J) const {
+  EvalFullInto(context, cache, nullptr, J, nullptr);
+}
+
+template <typename T>
+VectorX<T> KinematicEvaluatorSet<T>::EvalFullJacobianDotTimesV(
+    const Context<T>& context, FrameKinematicsCache<T>* cache) const {
+  VectorX<T> Jdotv(count_full());
+  EvalFullInto(context, cache, nullptr, nullptr, &Jdotv);
+  return Jdotv;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalFullInto(
+    const Context<T>& context, FrameKinematicsCache<T>* cache,
+    EigenPtr<VectorX<T>> phi, EigenPtr<MatrixX<T>> J,
+    EigenPtr<VectorX<T>> Jdotv) const {
+  EvalInto(context, cache, false, phi, J, Jdotv);
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalActiveInto(
+    const Context<T>& context, FrameKinematicsCache<T>* cache,
+    EigenPtr<VectorX<T>> phi, EigenPtr<MatrixX<T>> J,
+    EigenPtr<VectorX<T>> Jdotv) const {
+  EvalInto(context, cache, true, phi, J, Jdotv);
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalInto(const Context<T>& context,
+                                        FrameKinematicsCache<T>* cache,
+                                        bool active, EigenPtr<VectorX<T>> phi,
+                                        EigenPtr<MatrixX<T>> J,
+                                        EigenPtr<VectorX<T>> Jdotv) const {
+  const int num_velocities = plant_.num_velocities();
+  const int num_rows = active ? count_active() : count_full();
+  DRAKE_THROW_UNLESS(!phi || phi->rows() == num_rows);
+  DRAKE_THROW_UNLESS(!J || J->rows() == num_rows);
+  DRAKE_THROW_UNLESS(!J || J->cols() == num_velocities);
+  DRAKE_THROW_UNLESS(!Jdotv || Jdotv->rows() == num_rows);
+
+  // Evaluators whose rows are all active, in order, or any evaluator when
+  // evaluating full rows, write straight into the outputs. The others are
+  // evaluated into these full rows, shared by all of them, and sliced.
+  VectorX<T> phi_sliced;
+  MatrixX<T> J_sliced;
+  VectorX<T> Jdotv_sliced;
+  if (active && max_sliced_rows_ > 0) {
+    if (phi) {
+      phi_sliced.resize(max_sliced_rows_);
+    }
+    if (J) {
+      J_sliced.resize(max_sliced_rows_, num_velocities);
+    }
+    if (Jdotv) {
+      Jdotv_sliced.resize(max_sliced_rows_);
+    }
+  }
+  for (int i = 0; i < num_evaluators(); i++) {
+    const auto& e = *evaluators_[i];
+    const int start = active ? active_starts_[i] : full_starts_[i];
+    if (!active || IsAllActiveInOrder(e)) {
+      const int num_rows_i = e.num_full();
+      if (phi) {
+        auto phi_i = phi->segment(start, num_rows_i);
+        e.EvalFullInto(context, cache, &phi_i);
+      }
+      if (J) {
+        auto J_i = J->block(start, 0, num_rows_i, num_velocities);
+        EvalJacobian<T>(e, context, cache, &J_i);
+      }
+      if (Jdotv) {
+        auto Jdotv_i = Jdotv->segment(start, num_rows_i);
+        e.EvalFullJacobianDotTimesVInto(context, cache, &Jdotv_i);
+      }
+      continue;
+    }
+
+    const int num_full_i = e.num_full();
+    const auto& rows = e.active_inds();
+    if (phi) {
+      auto phi_i = phi_sliced.head(num_full_i);
+      e.EvalFullInto(context, cache, &phi_i);
+      for (int k = 0; k < e.num_active(); k++) {
+        (*phi)(start + k) = phi_i(rows[k]);
+      }
+    }
+    if (J) {
+      auto J_i = J_sliced.topRows(num_full_i);
+      EvalJacobian<T>(e, context, cache, &J_i);
+      for (int k = 0; k < e.num_active(); k++) {
+        J->row(start + k) = J_i.row(rows[k]);
+      }
+    }
+    if (Jdotv) {
+      auto Jdotv_i = Jdotv_sliced.head(num_full_i);
+      e.EvalFullJacobianDotTimesVInto(context, cache, &Jdotv_i);
+      for (int k = 0; k < e.num_active(); k++) {
+        (*Jdotv)(start + k) = Jdotv_i(rows[k]);
+      }
+    }
+  }
+}
+
 template <typename T>
 int KinematicEvaluatorSet<T>::add_evaluator(KinematicEvaluator<T>* e) {
   // Compare plants for equality by reference
   DRAKE_DEMAND(&plant_ == &e->plant());
 
   evaluators_.push_back(e);
+  full_starts_.push_back(full_starts_.back() + e->num_full());
+  active_starts_.push_back(active_starts_.back() + e->num_active());
+  if (!IsAllActiveInOrder(*e)) {
+    max_sliced_rows_ = std::max(max_sliced_rows_, e->num_full());
+  }
   return evaluators_.size() - 1;
 }
 
@@ -203,44 +342,109 @@ std::vector<int> KinematicEvaluatorSet<T>::FindActiveIndicesUnion(
 }
 
 template <typename T>
-VectorX<T> KinematicEvaluatorSet<T>::CalcMassMatrixTimesVDot(
-    const Context<T>& context, const VectorX<T>& lambda) const {
-  // M(q)vdot + C(q,v) = tau_g(q) + F_app + Bu + J(q)^T lambda
+VectorX<T> KinematicEvaluatorSet<T>::CalcNonConstraintForces(
+    const Context<T>& context, const MatrixX<T>& B) const {
   VectorX<T> C(plant_.num_velocities());
   plant_.CalcBiasTerm(context, &C);
 
-  VectorX<T> Bu = plant_.MakeActuationMatrix() *
-                  plant_.get_actuation_input_port().Eval(context);
+  VectorX<T> Bu = B * plant_.get_actuation_input_port().Eval(context);
 
   VectorX<T> tau_g = plant_.CalcGravityGeneralizedForces(context);
 
   drake::multibody::MultibodyForces<T> f_app(plant_);
   plant_.CalcForceElementsContribution(context, &f_app);
 
+  return tau_g + f_app.generalized_forces() + Bu - C;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::UpdateFactorization(
+    const Context<T>& context, bool active,
+    ConstrainedDynamicsFactorization<T>* factorization) const {
+  const int num_velocities = plant_.num_velocities();
+  auto& f = *factorization;
+  if (f.B.rows() != num_velocities) {
+    f.B = plant_.MakeActuationMatrix();
+  }
+
+  const VectorX<T> q = plant_.GetPositions(context);
+  if (f.q.size() != q.size() || !AreVectorsEqual(f.q, q)) {
+    f.q = q;
+    f.M.resize(num_velocities, num_velocities);
+    plant_.CalcMassMatrix(context, &f.M);
+    f.M_llt.compute(f.M);
+    f.J_full.resize(count_full(), num_velocities);
+    EvalFullJacobian(context, &f.J_full);
+    f.has_active_terms = false;
+  }
+
+  if (active && !f.has_active_terms) {
+    // The active rows of J, in the order of EvalActiveJacobian
+    f.J_active.resize(count_active(), num_velocities);
+    for (int i = 0; i < num_evaluators(); i++) {
+      const auto& e = *evaluators_[i];
+      for (int k = 0; k < e.num_active(); k++) {
+        f.J_active.row(active_starts_[i] + k) =
+            f.J_full.row(full_starts_[i] + e.active_inds().at(k));
+      }
+    }
+    f.Minv_JT_active = f.M_llt.solve(f.J_active.transpose());
+    f.schur_ldlt.compute(f.J_active * f.Minv_JT_active);
+    f.has_active_terms = true;
+  }
+}
+
+template <typename T>
+VectorX<T> KinematicEvaluatorSet<T>::CalcMassMatrixTimesVDot(
+    const Context<T>& context, const VectorX<T>& lambda) const {
+  // M(q)vdot + C(q,v) = tau_g(q) + F_app + Bu + J(q)^T lambda
   VectorX<T> J_transpose_lambda =
       EvalFullJacobian(context).transpose() * lambda;
 
-  return tau_g + f_app.generalized_forces() + Bu + J_transpose_lambda - C;
+  return CalcNonConstraintForces(context, plant_.MakeActuationMatrix()) +
+         J_transpose_lambda;
 }
 
 template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::CalcTimeDerivativesWithForce(
     Context<T>* context, const VectorX<T>& lambda) const {
-  static MatrixX<T> J(count_full(), plant_.num_velocities());
-  EvalFullJacobian(*context, &J);
-  VectorX<T> J_transpose_lambda = J.transpose() * lambda;
-
-  context->FixInputPort(
-      plant_.get_applied_generalized_force_input_port().get_index(),
-      J_transpose_lambda);
-
-  // N.B. Evaluating the generalized acceleration port rather than the time
-  // derivatives to ensure that this supports continuous and discrete plants
-  // (discrete plants would not compute time derivatives)
-  const VectorX<T>& v_dot =
-      plant_.get_generalized_acceleration_output_port()
-          .template Eval<drake::systems::BasicVector<double>>(*context)
-          .CopyToVector();
+  ConstrainedDynamicsFactorization<T> factorization;
+  return CalcTimeDerivativesWithForce(context, lambda, &factorization);
+}
+
+template <typename T>
+VectorX<T> KinematicEvaluatorSet<T>::CalcTimeDerivativesWithForce(
+    Context<T>* context, const VectorX<T>& lambda,
+    ConstrainedDynamicsFactorization<T>* factorization) const {
+  VectorX<T> v_dot;
+  if (plant_.is_discrete()) {
+    MatrixX<T> J(count_full(), plant_.num_velocities());
+    EvalFullJacobian(*context, &J);
+    VectorX<T> J_transpose_lambda = J.transpose() * lambda;
+
+    context->FixInputPort(
+        plant_.get_applied_generalized_force_input_port().get_index(),
+        J_transpose_lambda);
+
+    // N.B. Evaluating the generalized acceleration port rather than the time
+    // derivatives, since discrete plants would not compute time derivatives
+    v_dot = plant_.get_generalized_acceleration_output_port()
+                .template Eval<drake::systems::BasicVector<T>>(*context)
+                .CopyToVector();
+  } else {
+    // M(q) vdot = tau_g + f_app + Bu - C + J^T lambda
+    // Unlike the plant's own time derivatives, these don't include the applied
+    // spatial forces or the contact forces of the plant's geometry
+    DRAKE_DEMAND(
+        !plant_.get_applied_spatial_force_input_port().HasValue(*context));
+    DRAKE_DEMAND(plant_.num_collision_geometries() == 0 ||
+                 !plant_.get_geometry_query_input_port().HasValue(*context));
+    UpdateFactorization(*context, false, factorization);
+    v_dot = factorization->M_llt.solve(
+        CalcNonConstraintForces(*context, factorization->B) +
+        factorization->J_full.transpose() * lambda);
+  }
+
   VectorX<T> x_dot(plant_.num_positions() + plant_.num_velocities());
   VectorX<T> q_dot(plant_.num_positions());
   plant_.MapVelocityToQDot(*context, plant_.GetVelocities(*context), &q_dot);
@@ -258,86 +462,152 @@ VectorX<T> KinematicEvaluatorSet<T>::CalcTimeDerivatives(
 template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::CalcTimeDerivatives(
     const Context<T>& context, VectorX<T>* lambda, double alpha) const {
+  ConstrainedDynamicsFactorization<T> factorization;
+  return CalcTimeDerivatives(context, &factorization, lambda, alpha);
+}
+
+template <typename T>
+VectorX<T> KinematicEvaluatorSet<T>::CalcTimeDerivatives(
+    const Context<T>& context,
+    ConstrainedDynamicsFactorization<T>* factorization, VectorX<T>* lambda,
+    double alpha) const {
   // M(q) vdot + C(q,v) = tau_g(q) + f_app + Bu + J(q)^T lambda
   // J vdot + Jdotv  + kp phi + kd phidot = 0
-  // Produces linear system of equations
-  // [[M -J^T]  [[vdot  ]  =  [[tau_g + f_app + Bu - C     ]
-  //  [J  0 ]]  [lambda]]     [ -Jdotv - kp phi - kd phidot]]
-
-  // Evaluate manipulator equation terms
-  MatrixX<T> M(plant_.num_velocities(), plant_.num_velocities());
-  plant_.CalcMassMatrix(context, &M);
-
-  VectorX<T> C(plant_.num_velocities());
-  plant_.CalcBiasTerm(context, &C);
-
-  VectorX<T> Bu = plant_.MakeActuationMatrix() *
-                  plant_.get_actuation_input_port().Eval(context);
-
-  VectorX<T> tau_g = plant_.CalcGravityGeneralizedForces(context);
-
-  drake::multibody::MultibodyForces<T> f_app(plant_);
-  plant_.CalcForceElementsContribution(context, &f_app);
-
-  // Evaluate active constraint terms.
-  VectorX<T> phi = EvalActive(context);
-  VectorX<T> phidot = EvalActiveTimeDerivative(context);
-  MatrixX<T> J = EvalActiveJacobian(context);
-  VectorX<T> Jdotv = EvalActiveJacobianDotTimesV(context);
-
-  MatrixX<T> A(M.rows() + J.rows(), M.cols() + J.rows());
-  VectorX<T> b(M.rows() + J.rows());
-  A << M, -J.transpose(), J, MatrixX<T>::Zero(J.rows(), J.rows());
-  b << tau_g + f_app.generalized_forces() + Bu - C,
-      -(Jdotv + alpha * alpha * phi + 2 * alpha * phidot);
-  const VectorX<T> vdot_lambda = A.ldlt().solve(b);
-
-  *lambda = vdot_lambda.tail(J.rows());
+  // Eliminating vdot = M^-1 (f + J^T lambda), with f = tau_g + f_app + Bu - C,
+  // gives the Schur complement system
+  //   J M^-1 J^T lambda = -(Jdotv + kp phi + kd phidot) - J M^-1 f
+  UpdateFactorization(context, true, factorization);
+  const auto& f = *factorization;
+  const VectorX<T> v = plant_.GetVelocities(context);
+  VectorX<T> v_dot =
+      f.M_llt.solve(CalcNonConstraintForces(context, f.B));
+
+  if (count_active() > 0) {
+    // Evaluate active constraint terms. The Jacobian is in the factorization.
+    VectorX<T> Jdotv(count_active());
+    VectorX<T> rhs = -(f.J_active * v_dot);
+    if (alpha != 0) {
+      VectorX<T> phi(count_active());
+      EvalActiveInto(context, nullptr, &phi, nullptr, &Jdotv);
+      rhs -= alpha * alpha * phi + 2 * alpha * (f.J_active * v);
+    } else {
+      EvalActiveInto(context, nullptr, nullptr, nullptr, &Jdotv);
+    }
+    rhs -= Jdotv;
+    *lambda = f.schur_ldlt.solve(rhs);
+    v_dot += f.Minv_JT_active * (*lambda);
+  } else {
+    lambda->resize(0);
+  }
 
   VectorX<T> x_dot(plant_.num_positions() + plant_.num_velocities());
   VectorX<T> q_dot(plant_.num_positions());
 
-  plant_.MapVelocityToQDot(context, plant_.GetVelocities(context), &q_dot);
+  plant_.MapVelocityToQDot(context, v, &q_dot);
 
-  x_dot << q_dot, vdot_lambda.head(plant_.num_velocities());
+  x_dot << q_dot, v_dot;
 
   return x_dot;
 }
 
 template <typename T>
-int KinematicEvaluatorSet<T>::evaluator_full_start(int index) const {
-  int start = 0;
-  for (int i = 0; i < index; i++) {
-    start += evaluators_.at(i)->num_full();
+MatrixX<bool> KinematicEvaluatorSet<T>::GetActiveDependencies(
+    bool velocities) const {
+  MatrixX<bool> mask = MatrixX<bool>::Constant(count_active(),
+      velocities ? plant_.num_velocities() : plant_.num_positions(), false);
+  int row = 0;
+  for (const auto& e : evaluators_) {
+    for (int index : e->GetDependentIndices(velocities)) {
+      mask.block(row, index, e->num_active(), 1).setConstant(true);
+    }
+    row += e->num_active();
   }
-  return start;
+  return mask;
 }
 
 template <typename T>
-int KinematicEvaluatorSet<T>::evaluator_active_start(int index) const {
-  int start = 0;
-  for (int i = 0; i < index; i++) {
-    start += evaluators_.at(i)->num_active();
+MatrixX<bool> KinematicEvaluatorSet<T>::GetFullDependencies(
+    bool velocities) const {
+  MatrixX<bool> mask = MatrixX<bool>::Constant(count_full(),
+      velocities ? plant_.num_velocities() : plant_.num_positions(), false);
+  int row = 0;
+  for (const auto& e : evaluators_) {
+    for (int index : e->GetDependentIndices(velocities)) {
+      mask.block(row, index, e->num_full(), 1).setConstant(true);
+    }
+    row += e->num_full();
   }
-  return start;
+  return mask;
 }
 
 template <typename T>
-int KinematicEvaluatorSet<T>::count_active() const {
-  int count = 0;
-  for (const auto& e : evaluators_) {
-    count += e->num_active();
+MatrixX<bool> KinematicEvaluatorSet<T>::GetTimeDerivativeDependencies() const {
+  const int n_q = plant_.num_positions();
+  const int n_v = plant_.num_velocities();
+  const int n_u = plant_.num_actuators();
+  const std::vector<int> groups = VelocityCouplingGroups(plant_);
+
+  MatrixX<bool> mask =
+      MatrixX<bool>::Constant(n_v, n_q + n_v + n_u + count_full(), false);
+  mask.leftCols(n_q + n_v).setConstant(true);
+
+  // A generalized force acting on velocity j reaches vdot(i) only if i and j
+  // are in the same subtree
+  auto mark_force = [&](int col, int j) {
+    for (int i = 0; i < n_v; i++) {
+      if (groups[i] == groups[j]) {
+        mask(i, col) = true;
+      }
+    }
+  };
+  const Eigen::MatrixXd B = plant_.MakeActuationMatrix();
+  for (int k = 0; k < n_u; k++) {
+    for (int j = 0; j < n_v; j++) {
+      if (B(j, k) != 0) {
+        mark_force(n_q + n_v + k, j);
+      }
+    }
+  }
+  const MatrixX<bool> J_mask = GetFullDependencies(true);
+  for (int k = 0; k < count_full(); k++) {
+    for (int j = 0; j < n_v; j++) {
+      if (J_mask(k, j)) {
+        mark_force(n_q + n_v + n_u + k, j);
+      }
+    }
   }
-  return count;
+  return mask;
 }
 
 template <typename T>
-int KinematicEvaluatorSet<T>::count_full() const {
-  int count = 0;
-  for (const auto& e : evaluators_) {
-    count += e->num_full();
+MatrixX<bool>
+KinematicEvaluatorSet<T>::GetActiveSecondTimeDerivativeDependencies() const {
+  // d^2/dt^2 phi = J * vdot + Jdot * v, where Jdot * v is covered by the dense
+  // dependence of vdot on q and v
+  const MatrixX<bool> J_mask = GetActiveDependencies(true);
+  const MatrixX<bool> vdot_mask = GetTimeDerivativeDependencies();
+  MatrixX<bool> mask =
+      MatrixX<bool>::Constant(count_active(), vdot_mask.cols(), false);
+  for (int k = 0; k < count_active(); k++) {
+    for (int i = 0; i < J_mask.cols(); i++) {
+      if (J_mask(k, i)) {
+        mask.row(k) = mask.row(k).array() || vdot_mask.row(i).array();
+      }
+    }
   }
-  return count;
+  return mask;
+}
+
+template <typename T>
+int KinematicEvaluatorSet<T>::evaluator_full_start(int index) const {
+  DRAKE_DEMAND(index >= 0 && index <= num_evaluators());
+  return full_starts_[index];
+}
+
+template <typename T>
+int KinematicEvaluatorSet<T>::evaluator_active_start(int index) const {
+  DRAKE_DEMAND(index >= 0 && index <= num_evaluators());
+  return active_starts_[index];
 }
 
 template <typename T>
@@ -346,19 +616,11 @@ bool KinematicEvaluatorSet<T>::is_active(int index) const {
     return false;
   }
 
-  // Loop over the individual evaluators. If the given index is in the index
-  // range for a particular evaluator, check if it is active.
-  // `count` here refers to the starting index of the current evaluator into the
-  // full vector.
-  int count = 0;
-  for (const auto& e : evaluators_) {
-    if (index >= count && index < count + e->num_full()) {
-      return e->is_active(index - count);
-    } else {
-      count += e->num_full();
-    }
-  }
-  DRAKE_UNREACHABLE();
+  // Find the evaluator whose range of full rows contains the given index, and
+  // check if it is active
+  const int i = std::upper_bound(full_starts_.begin(), full_starts_.end(),
+                                 index) - full_starts_.begin() - 1;
+  return evaluators_[i]->is_active(index - full_starts_[i]);
 }
 
 DRAKE_DEFINE_CLASS_TEMPLATE_INSTANTIATIONS_ON_DEFAULT_NONSYMBOLIC_SCALARS(
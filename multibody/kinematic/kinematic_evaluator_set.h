@@ -1,10 +1,38 @@
 #pragma once
 
+#include <vector>
+
 #include "multibody/kinematic/kinematic_evaluator.h"
 
 namespace dairlib {
 namespace multibody {
 
+/// The terms of the constrained dynamics of a KinematicEvaluatorSet which only
+/// depend on the positions q: the Cholesky factorization of the mass matrix
+/// M(q) and the full Jacobian J(q), and, for the active rows, M^-1 J^T and the
+/// factored Schur complement J M^-1 J^T. Passing the same factorization to
+/// KinematicEvaluatorSet::CalcTimeDerivatives or CalcTimeDerivativesWithForce
+/// reuses these terms across calls at the same q (for instance, while
+/// differencing w.r.t. v, u or lambda). They are recomputed when q changes.
+///
+/// A factorization must only be used with one KinematicEvaluatorSet.
+/// Warning: not thread safe. Use one factorization per Context.
+template <typename T>
+struct ConstrainedDynamicsFactorization {
+  // The positions the terms were computed at
+  drake::VectorX<T> q;
+  drake::MatrixX<T> M;
+  Eigen::LLT<drake::MatrixX<T>> M_llt;
+  drake::MatrixX<T> B;
+  drake::MatrixX<T> J_full;
+
+  // Active rows only, computed on first use at each q
+  bool has_active_terms = false;
+  drake::MatrixX<T> J_active;
+  drake::MatrixX<T> Minv_JT_active;
+  Eigen::LDLT<drake::MatrixX<T>> schur_ldlt;
+};
+
 /// Simple class that maintains a vector pointers to KinematicEvaluator
 /// objects. Provides a basic API for counting and accumulating evaluations
 /// and their Jacobians.
@@ -71,6 +99,38 @@ class KinematicEvaluatorSet {
   drake::VectorX<T> EvalFullJacobianDotTimesV(
       const drake::systems::Context<T>& context) const;
 
+  /// Same as EvalFullJacobian(context, J), but the evaluators read point
+  /// kinematics from `cache`, which must be valid for `context`.
+  void EvalFullJacobian(const drake::systems::Context<T>& context,
+                        FrameKinematicsCache<T>* cache,
+                        drake::EigenPtr<drake::MatrixX<T>> J) const;
+
+  /// Same as EvalFullJacobianDotTimesV(context), but the evaluators read point
+  /// kinematics from `cache`.
+  drake::VectorX<T> EvalFullJacobianDotTimesV(
+      const drake::systems::Context<T>& context,
+      FrameKinematicsCache<T>* cache) const;
+
+  /// Evaluates phi(q), J(q) and Jdot * v together, writing each evaluator's
+  /// rows into the given outputs, which must already have count_full() rows.
+  /// Any output may be nullptr to skip it. If `cache` is not nullptr, the
+  /// evaluators read point kinematics from it, so the plant is queried once
+  /// per frame rather than once per evaluator and quantity; it must be valid
+  /// for `context`.
+  void EvalFullInto(const drake::systems::Context<T>& context,
+                    FrameKinematicsCache<T>* cache,
+                    drake::EigenPtr<drake::VectorX<T>> phi,
+                    drake::EigenPtr<drake::MatrixX<T>> J,
+                    drake::EigenPtr<drake::VectorX<T>> Jdotv) const;
+
+  /// Same as EvalFullInto(context, cache, phi, J, Jdotv), limited only to
+  /// active rows. The outputs must already have count_active() rows.
+  void EvalActiveInto(const drake::systems::Context<T>& context,
+                      FrameKinematicsCache<T>* cache,
+                      drake::EigenPtr<drake::VectorX<T>> phi,
+                      drake::EigenPtr<drake::MatrixX<T>> J,
+                      drake::EigenPtr<drake::VectorX<T>> Jdotv) const;
+
   /// Determines the list of evaluators objects contained in the union with
   /// another set Specifically, `index` is in the returned vector if
   /// other.evaluators_.at(index) is an element of other.evaluators, as judged
@@ -116,6 +176,19 @@ class KinematicEvaluatorSet {
       drake::systems::Context<T>* context,
       const drake::VectorX<T>& lambda) const;
 
+  /// Same as CalcTimeDerivativesWithForce(context, lambda), reusing the terms
+  /// in `factorization` if q is unchanged. For continuous plants, vdot is
+  /// solved through the Cholesky factorization of M(q), and the context is not
+  /// changed. Discrete plants fall back to the generalized acceleration port.
+  ///
+  /// For continuous plants, the forces are gravity, the force elements,
+  /// the actuation and J^T lambda only. The applied spatial force input port
+  /// must not have a value, and the plant must have no collision geometry or
+  /// an unconnected geometry query port, i.e. no contact forces.
+  drake::VectorX<T> CalcTimeDerivativesWithForce(
+      drake::systems::Context<T>* context, const drake::VectorX<T>& lambda,
+      ConstrainedDynamicsFactorization<T>* factorization) const;
+
   /// Computes vdot given the state and control inputs, satisfying kinematic
   /// constraints.
   /// Solves for the constraint forces using the ACTIVE kinematic elements.
@@ -140,6 +213,44 @@ class KinematicEvaluatorSet {
       const drake::systems::Context<T>& context, drake::VectorX<T>* lambda,
       double alpha = 0) const;
 
+  /// Same as CalcTimeDerivatives(context, lambda, alpha), reusing the terms in
+  /// `factorization` if q is unchanged.
+  ///
+  /// Rather than factoring the indefinite system [[M, -J^T], [J, 0]], this
+  /// solves for lambda through the Schur complement J M^-1 J^T, which is
+  /// positive semi-definite. Redundant constraints are handled by the
+  /// pivoting LDLT, which zeroes the forces along the singular directions.
+  drake::VectorX<T> CalcTimeDerivatives(
+      const drake::systems::Context<T>& context,
+      ConstrainedDynamicsFactorization<T>* factorization,
+      drake::VectorX<T>* lambda, double alpha = 0) const;
+
+  /// Recomputes the terms of `factorization` if q has changed since they were
+  /// computed, including the active-row terms if `active` is true. This is a
+  /// no-op at the same q.
+  void UpdateFactorization(
+      const drake::systems::Context<T>& context, bool active,
+      ConstrainedDynamicsFactorization<T>* factorization) const;
+
+  /// The structural sparsity of phi(q) (active rows only) w.r.t. the
+  /// generalized positions, or if velocities is true, of J(q) * v w.r.t. the
+  /// generalized velocities. Entry (i, j) is true if row i may depend on
+  /// coordinate j, as given by KinematicEvaluator::GetDependentIndices.
+  drake::MatrixX<bool> GetActiveDependencies(bool velocities) const;
+
+  /// Same as GetActiveDependencies, but for the full rows
+  drake::MatrixX<bool> GetFullDependencies(bool velocities) const;
+
+  /// The structural sparsity of vdot, from CalcTimeDerivativesWithForce,
+  /// w.r.t. [q; v; u; lambda]. The mass matrix only couples velocities in the
+  /// same subtree of the world, so u and lambda may only affect vdot within
+  /// the subtrees they act on. Dependence on q and v is taken to be dense.
+  drake::MatrixX<bool> GetTimeDerivativeDependencies() const;
+
+  /// The structural sparsity of the active rows of d^2/dt^2 phi(q), as in
+  /// EvalActiveSecondTimeDerivative, w.r.t. [q; v; u; lambda]
+  drake::MatrixX<bool> GetActiveSecondTimeDerivativeDependencies() const;
+
   /// Gets the starting index into phi_full of the specified evaluator
   int evaluator_full_start(int index) const;
 
@@ -154,14 +265,16 @@ class KinematicEvaluatorSet {
     return evaluators_;
   };
 
-  /// Adds an evaluator to the end of the list, returning the associated index
+  /// Adds an evaluator to the end of the list, returning the associated index.
+  /// The row offsets of the evaluators are computed here, so the active rows
+  /// of `e` must not be changed after it is added.
   int add_evaluator(KinematicEvaluator<T>* e);
 
   /// Count the total number of active rows
-  int count_active() const;
+  int count_active() const { return active_starts_.back(); }
 
   /// Count the total number of rows
-  int count_full() const;
+  int count_full() const { return full_starts_.back(); }
 
   int num_evaluators() const { return evaluators_.size(); };
 
@@ -173,8 +286,27 @@ class KinematicEvaluatorSet {
   const drake::multibody::MultibodyPlant<T>& plant() const { return plant_; };
 
  private:
+  // tau_g + f_app + B * u - C, all of the generalized forces but J^T lambda
+  drake::VectorX<T> CalcNonConstraintForces(
+      const drake::systems::Context<T>& context,
+      const drake::MatrixX<T>& B) const;
+
+  void EvalInto(const drake::systems::Context<T>& context,
+                FrameKinematicsCache<T>* cache, bool active,
+                drake::EigenPtr<drake::VectorX<T>> phi,
+                drake::EigenPtr<drake::MatrixX<T>> J,
+                drake::EigenPtr<drake::VectorX<T>> Jdotv) const;
+
   const drake::multibody::MultibodyPlant<T>& plant_;
   std::vector<KinematicEvaluator<T>*> evaluators_;
+
+  // Starting rows of each evaluator into phi_full and phi_active, with the
+  // total count appended
+  std::vector<int> full_starts_{0};
+  std::vector<int> active_starts_{0};
+  // Most full rows of an evaluator whose active rows are not all of its rows
+  // in order
+  int max_sliced_rows_ = 0;
 };
 
 }  // namespace multibody
@@ -1,5 +1,8 @@
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <utility>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include "drake/common/test_utilities/eigen_matrix_compare.h"
@@ -8,7 +11,9 @@
 
 #include "common/find_resource.h"
 #include "multibody/kinematic/distance_evaluator.h"
+#include "multibody/kinematic/frame_kinematics_cache.h"
 #include "multibody/kinematic/kinematic_evaluator.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
 #include "multibody/kinematic/world_point_evaluator.h"
 
 namespace dairlib {
@@ -160,6 +165,340 @@ TEST_F(KinematicEvaluatorTest, DistanceEvaluatorTest) {
   EXPECT_TRUE(CompareMatrices(Jdotv, Jdot_approx * v, dt * 100));
 }
 
+TEST_F(KinematicEvaluatorTest, FrameKinematicsCacheTest) {
+  const double tolerance = 1e-10;
+
+  const auto& right_frame = plant_->GetFrameByName("right_lower_leg");
+  const auto& left_frame = plant_->GetFrameByName("left_lower_leg");
+  // Two points on the same frame share one batched plant query
+  auto foot_evaluator = WorldPointEvaluator<double>(
+      *plant_, Vector3d({0, 0, -.5}), right_frame, Vector3d({0, 0, 1}),
+      Vector3d::Zero(), true);
+  auto knee_evaluator = WorldPointEvaluator<double>(
+      *plant_, Vector3d({0, 0, 0}), right_frame, Vector3d({0, 0, 1}),
+      Vector3d::Zero(), true);
+  auto distance_evaluator = DistanceEvaluator<double>(
+      *plant_, Vector3d({0, 0, -.5}), right_frame, Vector3d({0, 0, -.5}),
+      left_frame, .5);
+
+  auto context = plant_->CreateDefaultContext();
+  VectorXd q = VectorXd::Random(plant_->num_positions());
+  VectorXd v = VectorXd::Random(plant_->num_velocities());
+  plant_->SetPositions(context.get(), q);
+  plant_->SetVelocities(context.get(), v);
+
+  FrameKinematicsCache<double> cache(*plant_);
+  for (const KinematicEvaluator<double>* evaluator :
+       std::vector<const KinematicEvaluator<double>*>(
+           {&foot_evaluator, &knee_evaluator, &distance_evaluator})) {
+    MatrixXd J(evaluator->num_full(), plant_->num_velocities());
+    evaluator->EvalFullJacobian(*context, &cache, &J);
+    EXPECT_TRUE(
+        CompareMatrices(J, evaluator->EvalFullJacobian(*context), tolerance));
+    EXPECT_TRUE(CompareMatrices(
+        evaluator->EvalFullJacobianDotTimesV(*context, &cache),
+        evaluator->EvalFullJacobianDotTimesV(*context), tolerance));
+
+    // Without a cache, the plant is queried directly
+    evaluator->EvalFullJacobian(*context, nullptr, &J);
+    EXPECT_TRUE(
+        CompareMatrices(J, evaluator->EvalFullJacobian(*context), tolerance));
+    EXPECT_TRUE(CompareMatrices(evaluator->EvalFull(*context, nullptr),
+                                evaluator->EvalFull(*context), tolerance));
+    EXPECT_TRUE(CompareMatrices(
+        evaluator->EvalFullJacobianDotTimesV(*context, nullptr),
+        evaluator->EvalFullJacobianDotTimesV(*context), tolerance));
+  }
+
+  // Repeated queries are served from the cache until it is invalidated
+  int num_queries = cache.num_plant_queries();
+  MatrixXd J(3, plant_->num_velocities());
+  foot_evaluator.EvalFullJacobian(*context, &cache, &J);
+  foot_evaluator.EvalFullJacobianDotTimesV(*context, &cache);
+  EXPECT_EQ(num_queries, cache.num_plant_queries());
+
+  q = VectorXd::Random(plant_->num_positions());
+  plant_->SetPositions(context.get(), q);
+  cache.Invalidate();
+  foot_evaluator.EvalFullJacobian(*context, &cache, &J);
+  EXPECT_TRUE(
+      CompareMatrices(J, foot_evaluator.EvalFullJacobian(*context), tolerance));
+  EXPECT_EQ(num_queries + 1, cache.num_plant_queries());
+}
+
+// The distance evaluator's first query of a cold cache registers both of its
+// frames, and the second registration must not invalidate the first Jacobian.
+TEST_F(KinematicEvaluatorTest, FrameKinematicsCacheColdTest) {
+  const double tolerance = 1e-10;
+
+  const auto& right_frame = plant_->GetFrameByName("right_lower_leg");
+  const auto& left_frame = plant_->GetFrameByName("left_lower_leg");
+  auto distance_evaluator = DistanceEvaluator<double>(
+      *plant_, Vector3d({0, 0, -.5}), right_frame, Vector3d({0, 0, -.5}),
+      left_frame, .5);
+  auto knee_evaluator = WorldPointEvaluator<double>(
+      *plant_, Vector3d({0, 0, 0}), right_frame, Vector3d({0, 0, 1}),
+      Vector3d::Zero(), true);
+
+  auto context = plant_->CreateDefaultContext();
+  plant_->SetPositions(context.get(),
+                       VectorXd::Random(plant_->num_positions()));
+  plant_->SetVelocities(context.get(),
+                        VectorXd::Random(plant_->num_velocities()));
+  MatrixXd J_expected = distance_evaluator.EvalFullJacobian(*context);
+  VectorXd Jdotv_expected =
+      distance_evaluator.EvalFullJacobianDotTimesV(*context);
+
+  // Two frames that the caches have never seen
+  MatrixXd J(1, plant_->num_velocities());
+  FrameKinematicsCache<double> cache(*plant_);
+  distance_evaluator.EvalFullJacobian(*context, &cache, &J);
+  EXPECT_TRUE(CompareMatrices(J, J_expected, tolerance));
+  FrameKinematicsCache<double> jdotv_cache(*plant_);
+  EXPECT_TRUE(CompareMatrices(
+      distance_evaluator.EvalFullJacobianDotTimesV(*context, &jdotv_cache),
+      Jdotv_expected, tolerance));
+
+  // A known frame, but a new point on it
+  FrameKinematicsCache<double> point_cache(*plant_);
+  MatrixXd J_knee(3, plant_->num_velocities());
+  knee_evaluator.EvalFullJacobian(*context, &point_cache, &J_knee);
+  distance_evaluator.EvalFullJacobian(*context, &point_cache, &J);
+  EXPECT_TRUE(CompareMatrices(J, J_expected, tolerance));
+}
+
+// A Jacobian returned by the cache stays valid while other frames and points
+// are registered
+TEST_F(KinematicEvaluatorTest, FrameKinematicsCacheReferenceTest) {
+  const double tolerance = 1e-10;
+
+  auto context = plant_->CreateDefaultContext();
+  plant_->SetPositions(context.get(),
+                       VectorXd::Random(plant_->num_positions()));
+  const auto& right_frame = plant_->GetFrameByName("right_lower_leg");
+  FrameKinematicsCache<double> cache(*plant_);
+  const auto J_foot = cache.EvalJacobianTranslationalVelocity(
+      *context, right_frame, Vector3d({0, 0, -.5}));
+  const MatrixXd J_foot_expected = J_foot;
+  const double* J_foot_data = J_foot.data();
+  const auto J_com = cache.EvalJacobianCenterOfMass(*context);
+  const MatrixXd J_com_expected = J_com;
+
+  for (int i = 0; i < plant_->num_bodies(); i++) {
+    const auto& frame = plant_->get_body(drake::multibody::BodyIndex(i))
+                            .body_frame();
+    for (double z : {0.0, 0.1, 0.2}) {
+      cache.EvalJacobianTranslationalVelocity(*context, frame,
+                                              Vector3d({0, 0, z}));
+      cache.EvalJacobianAngularVelocity(*context, frame);
+    }
+  }
+  EXPECT_EQ(J_foot.data(), J_foot_data);
+  EXPECT_TRUE(CompareMatrices(J_foot, J_foot_expected, tolerance));
+  EXPECT_TRUE(CompareMatrices(J_com, J_com_expected, tolerance));
+}
+
+TEST_F(KinematicEvaluatorTest, EvaluatorSetIntoTest) {
+  const double tolerance = 1e-10;
+
+  const auto& right_frame = plant_->GetFrameByName("right_lower_leg");
+  const auto& left_frame = plant_->GetFrameByName("left_lower_leg");
+  // Only z active, all rows active, and active rows out of order
+  auto foot_evaluator = WorldPointEvaluator<double>(
+      *plant_, Vector3d({0, 0, -.5}), right_frame, Vector3d({0, 0, 1}),
+      Vector3d::Zero(), false);
+  auto distance_evaluator = DistanceEvaluator<double>(
+      *plant_, Vector3d({0, 0, -.5}), right_frame, Vector3d({0, 0, -.5}),
+      left_frame, .5);
+  auto knee_evaluator = WorldPointEvaluator<double>(
+      *plant_, Vector3d({0, 0, 0}), left_frame, Eigen::Matrix3d::Identity(),
+      Vector3d({1, 2, 3}), {2, 0});
+  KinematicEvaluatorSet<double> evaluators(*plant_);
+  evaluators.add_evaluator(&foot_evaluator);
+  evaluators.add_evaluator(&distance_evaluator);
+  evaluators.add_evaluator(&knee_evaluator);
+  EXPECT_EQ(evaluators.count_full(), 7);
+  EXPECT_EQ(evaluators.count_active(), 4);
+  EXPECT_EQ(evaluators.evaluator_full_start(2), 4);
+  EXPECT_EQ(evaluators.evaluator_active_start(2), 2);
+  EXPECT_FALSE(evaluators.is_active(0));
+  EXPECT_TRUE(evaluators.is_active(3));
+  EXPECT_FALSE(evaluators.is_active(5));
+
+  std::vector<std::unique_ptr<drake::systems::Context<double>>> contexts;
+  std::vector<const drake::systems::Context<double>*> context_ptrs;
+  std::vector<std::unique_ptr<FrameKinematicsCache<double>>> caches;
+  std::vector<FrameKinematicsCache<double>*> cache_ptrs;
+  for (int i = 0; i < 2; i++) {
+    contexts.push_back(plant_->CreateDefaultContext());
+    plant_->SetPositions(contexts.back().get(),
+                         VectorXd::Random(plant_->num_positions()));
+    plant_->SetVelocities(contexts.back().get(),
+                          VectorXd::Random(plant_->num_velocities()));
+    context_ptrs.push_back(contexts.back().get());
+    caches.push_back(std::make_unique<FrameKinematicsCache<double>>(*plant_));
+    cache_ptrs.push_back(caches.back().get());
+  }
+
+  // The evaluations into preallocated outputs, with and without caches, match
+  // the separate ones
+  const int n_v = plant_->num_velocities();
+  for (int i = 0; i < 2; i++) {
+    const auto& context = *context_ptrs[i];
+    for (auto cache : {static_cast<FrameKinematicsCache<double>*>(nullptr),
+                       cache_ptrs[i]}) {
+      VectorXd phi_full(evaluators.count_full());
+      MatrixXd J_full(evaluators.count_full(), n_v);
+      VectorXd Jdotv_full(evaluators.count_full());
+      evaluators.EvalFullInto(context, cache, &phi_full, &J_full, &Jdotv_full);
+      VectorXd phi_active(evaluators.count_active());
+      MatrixXd J_active(evaluators.count_active(), n_v);
+      VectorXd Jdotv_active(evaluators.count_active());
+      evaluators.EvalActiveInto(context, cache, &phi_active, &J_active,
+                                &Jdotv_active);
+      EXPECT_TRUE(
+          CompareMatrices(phi_full, evaluators.EvalFull(context), tolerance));
+      EXPECT_TRUE(CompareMatrices(J_full, evaluators.EvalFullJacobian(context),
+                                  tolerance));
+      EXPECT_TRUE(CompareMatrices(
+          Jdotv_full, evaluators.EvalFullJacobianDotTimesV(context),
+          tolerance));
+      EXPECT_TRUE(CompareMatrices(phi_active, evaluators.EvalActive(context),
+                                  tolerance));
+      EXPECT_TRUE(CompareMatrices(
+          J_active, evaluators.EvalActiveJacobian(context), tolerance));
+      EXPECT_TRUE(CompareMatrices(
+          Jdotv_active, evaluators.EvalActiveJacobianDotTimesV(context),
+          tolerance));
+    }
+  }
+
+  // Outputs may be skipped
+  VectorXd Jdotv(evaluators.count_active());
+  evaluators.EvalActiveInto(*context_ptrs[0], cache_ptrs[0], nullptr, nullptr,
+                            &Jdotv);
+  EXPECT_TRUE(CompareMatrices(
+      Jdotv, evaluators.EvalActiveJacobianDotTimesV(*context_ptrs[0]),
+      tolerance));
+
+  // Evaluators write into blocks of larger outputs, with and without a cache
+  for (auto cache : {static_cast<FrameKinematicsCache<double>*>(nullptr),
+                     cache_ptrs[1]}) {
+    const auto& context = *context_ptrs[1];
+    VectorXd outputs = VectorXd::Zero(6);
+    auto knee_phi = outputs.segment(1, 3);
+    knee_evaluator.EvalFullInto(context, cache, &knee_phi);
+    auto distance_Jdotv = outputs.segment(4, 1);
+    distance_evaluator.EvalFullJacobianDotTimesVInto(context, cache,
+                                                     &distance_Jdotv);
+    EXPECT_EQ(outputs(0), 0);
+    EXPECT_TRUE(CompareMatrices(knee_phi, knee_evaluator.EvalFull(context),
+                                tolerance));
+    EXPECT_TRUE(CompareMatrices(
+        distance_Jdotv, distance_evaluator.EvalFullJacobianDotTimesV(context),
+        tolerance));
+    EXPECT_EQ(outputs(5), 0);
+  }
+}
+
+TEST_F(KinematicEvaluatorTest, ConstrainedDynamicsTest) {
+  const double tolerance = 1e-8;
+
+  const auto& right_frame = plant_->GetFrameByName("right_lower_leg");
+  const auto& left_frame = plant_->GetFrameByName("left_lower_leg");
+  auto foot_evaluator = WorldPointEvaluator<double>(
+      *plant_, Vector3d({0, 0, -.5}), right_frame, Vector3d({0, 0, 1}),
+      Vector3d::Zero(), false);
+  auto distance_evaluator = DistanceEvaluator<double>(
+      *plant_, Vector3d({0, 0, -.5}), right_frame, Vector3d({0, 0, -.5}),
+      left_frame, .5);
+  KinematicEvaluatorSet<double> evaluators(*plant_);
+  evaluators.add_evaluator(&foot_evaluator);
+  evaluators.add_evaluator(&distance_evaluator);
+
+  auto context = plant_->CreateDefaultContext();
+  const int n_v = plant_->num_velocities();
+  plant_->SetPositions(context.get(),
+                       VectorXd::Random(plant_->num_positions()));
+  plant_->SetVelocities(context.get(), VectorXd::Random(n_v));
+  plant_->get_actuation_input_port().FixValue(
+      context.get(), VectorXd::Random(plant_->num_actuators()));
+
+  // The forces satisfy the manipulator equation, and the accelerations the
+  // stabilized constraint
+  const double alpha = 2;
+  VectorXd lambda;
+  ConstrainedDynamicsFactorization<double> factorization;
+  const VectorXd xdot =
+      evaluators.CalcTimeDerivatives(*context, &factorization, &lambda, alpha);
+  const VectorXd vdot = xdot.tail(n_v);
+  MatrixXd M(n_v, n_v);
+  plant_->CalcMassMatrix(*context, &M);
+  MatrixXd J = evaluators.EvalActiveJacobian(*context);
+  VectorXd lambda_full = VectorXd::Zero(evaluators.count_full());
+  lambda_full(2) = lambda(0);
+  lambda_full(3) = lambda(1);
+  EXPECT_TRUE(CompareMatrices(
+      M * vdot, evaluators.CalcMassMatrixTimesVDot(*context, lambda_full),
+      tolerance));
+  EXPECT_TRUE(CompareMatrices(
+      J * vdot + evaluators.EvalActiveJacobianDotTimesV(*context),
+      -(alpha * alpha * evaluators.EvalActive(*context) +
+        2 * alpha * evaluators.EvalActiveTimeDerivative(*context)),
+      tolerance));
+
+  // With the forces given, the accelerations match
+  EXPECT_TRUE(CompareMatrices(
+      evaluators.CalcTimeDerivativesWithForce(context.get(), lambda_full,
+                                              &factorization),
+      xdot, tolerance));
+
+  // At the same q, the factorization is reused, and matches a new one
+  plant_->SetVelocities(context.get(), VectorXd::Random(n_v));
+  const VectorXd xdot_reused =
+      evaluators.CalcTimeDerivatives(*context, &factorization, &lambda, alpha);
+  EXPECT_TRUE(factorization.has_active_terms);
+  EXPECT_TRUE(CompareMatrices(
+      xdot_reused, evaluators.CalcTimeDerivatives(*context, alpha),
+      tolerance));
+}
+
+TEST_F(KinematicEvaluatorTest, DependentIndicesTest) {
+  const auto& right_frame = plant_->GetFrameByName("right_lower_leg");
+  const auto& left_frame = plant_->GetFrameByName("left_lower_leg");
+  auto right_evaluator = WorldPointEvaluator<double>(
+      *plant_, Vector3d({0, 0, -.5}), right_frame);
+  auto left_evaluator = WorldPointEvaluator<double>(
+      *plant_, Vector3d({0, 0, -.5}), left_frame);
+  auto distance_evaluator = DistanceEvaluator<double>(
+      *plant_, Vector3d({0, 0, -.5}), right_frame, Vector3d({0, 0, -.5}),
+      left_frame, .5);
+
+  auto context = plant_->CreateDefaultContext();
+  plant_->SetPositions(context.get(),
+                       VectorXd::Random(plant_->num_positions()));
+
+  // The Jacobian is zero outside of the dependent velocities, and neither leg
+  // depends on the other
+  const auto right_indices = right_evaluator.GetDependentIndices(true);
+  const auto left_indices = left_evaluator.GetDependentIndices(true);
+  EXPECT_LT(static_cast<int>(right_indices.size()), plant_->num_velocities());
+  MatrixXd J = right_evaluator.EvalFullJacobian(*context);
+  for (int j = 0; j < plant_->num_velocities(); j++) {
+    if (std::find(right_indices.begin(), right_indices.end(), j) ==
+        right_indices.end()) {
+      EXPECT_TRUE(J.col(j).isZero(0));
+    }
+  }
+
+  // The distance depends on both legs
+  std::vector<int> both;
+  std::set_union(right_indices.begin(), right_indices.end(),
+                 left_indices.begin(), left_indices.end(),
+                 std::back_inserter(both));
+  EXPECT_EQ(distance_evaluator.GetDependentIndices(true), both);
+}
+
 }  // namespace
 }  // namespace multibody
 }  // namespace dairlib
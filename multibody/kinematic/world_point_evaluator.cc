@@ -1,5 +1,6 @@
 #include "multibody/kinematic/world_point_evaluator.h"
 
+#include "multibody/multibody_utils.h"
 #include "solvers/constraint_factory.h"
 
 #include "drake/math/orthonormal_basis.h"
@@ -86,6 +87,63 @@ VectorX<T> WorldPointEvaluator<T>::EvalFullJacobianDotTimesV(
   return rotation_ * Jdot_times_V;
 }
 
+template <typename T>
+VectorX<T> WorldPointEvaluator<T>::EvalFull(
+    const Context<T>& context, FrameKinematicsCache<T>* cache) const {
+  if (!cache) {
+    return EvalFull(context);
+  }
+  return rotation_ *
+         (cache->EvalPointPosition(context, frame_A_, pt_A_) - offset_);
+}
+
+template <typename T>
+void WorldPointEvaluator<T>::EvalFullJacobian(
+    const Context<T>& context, FrameKinematicsCache<T>* cache,
+    drake::EigenPtr<MatrixX<T>> J) const {
+  if (!cache) {
+    EvalFullJacobian(context, J);
+    return;
+  }
+  *J = rotation_ *
+       cache->EvalJacobianTranslationalVelocity(context, frame_A_, pt_A_);
+}
+
+template <typename T>
+VectorX<T> WorldPointEvaluator<T>::EvalFullJacobianDotTimesV(
+    const Context<T>& context, FrameKinematicsCache<T>* cache) const {
+  if (!cache) {
+    return EvalFullJacobianDotTimesV(context);
+  }
+  return rotation_ *
+         cache->EvalBiasTranslationalAcceleration(context, frame_A_, pt_A_);
+}
+
+template <typename T>
+void WorldPointEvaluator<T>::EvalFullInto(
+    const Context<T>& context, FrameKinematicsCache<T>* cache,
+    drake::EigenPtr<VectorX<T>> phi) const {
+  if (!cache) {
+    *phi = EvalFull(context);
+    return;
+  }
+  phi->noalias() =
+      rotation_ * (cache->EvalPointPosition(context, frame_A_, pt_A_) - offset_);
+}
+
+template <typename T>
+void WorldPointEvaluator<T>::EvalFullJacobianDotTimesVInto(
+    const Context<T>& context, FrameKinematicsCache<T>* cache,
+    drake::EigenPtr<VectorX<T>> Jdotv) const {
+  if (!cache) {
+    *Jdotv = EvalFullJacobianDotTimesV(context);
+    return;
+  }
+  Jdotv->noalias() =
+      rotation_ *
+      cache->EvalBiasTranslationalAcceleration(context, frame_A_, pt_A_);
+}
+
 template <typename T>
 vector<shared_ptr<Constraint>>
 WorldPointEvaluator<T>::CreateConicFrictionConstraints() const {
@@ -120,6 +178,12 @@ WorldPointEvaluator<T>::CreateLinearFrictionConstraints(int num_faces) const {
   return constraints;
 }
 
+template <typename T>
+std::vector<int> WorldPointEvaluator<T>::GetDependentIndices(
+    bool velocities) const {
+  return KinematicPathIndices(plant(), frame_A_.body(), velocities);
+}
+
 DRAKE_DEFINE_CLASS_TEMPLATE_INSTANTIATIONS_ON_DEFAULT_NONSYMBOLIC_SCALARS(
     class ::dairlib::multibody::WorldPointEvaluator)
 
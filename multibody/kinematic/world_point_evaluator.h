@@ -61,6 +61,28 @@ class WorldPointEvaluator : public KinematicEvaluator<T> {
   drake::VectorX<T> EvalFullJacobianDotTimesV(
       const drake::systems::Context<T>& context) const override;
 
+  drake::VectorX<T> EvalFull(const drake::systems::Context<T>& context,
+                             FrameKinematicsCache<T>* cache) const override;
+
+  void EvalFullJacobian(const drake::systems::Context<T>& context,
+                        FrameKinematicsCache<T>* cache,
+                        drake::EigenPtr<drake::MatrixX<T>> J) const override;
+
+  drake::VectorX<T> EvalFullJacobianDotTimesV(
+      const drake::systems::Context<T>& context,
+      FrameKinematicsCache<T>* cache) const override;
+
+  void EvalFullInto(const drake::systems::Context<T>& context,
+                    FrameKinematicsCache<T>* cache,
+                    drake::EigenPtr<drake::VectorX<T>> phi) const override;
+
+  void EvalFullJacobianDotTimesVInto(
+      const drake::systems::Context<T>& context,
+      FrameKinematicsCache<T>* cache,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv) const override;
+
+  std::vector<int> GetDependentIndices(bool velocities) const override;
+
   using KinematicEvaluator<T>::EvalFullJacobian;
   using KinematicEvaluator<T>::plant;
 
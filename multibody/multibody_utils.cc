@@ -1,5 +1,6 @@
 #include "multibody/multibody_utils.h"
 
+#include <algorithm>
 #include <set>
 #include <vector>
 
@@ -381,6 +382,108 @@ int QuaternionStartIndex(const MultibodyPlant<T>& plant) {
   DRAKE_UNREACHABLE();
 }
 
+namespace {
+
+// The coordinates of the mobilizer connecting a body to its parent
+struct Mobilizer {
+  int position_start = 0;
+  int num_positions = 0;
+  int velocity_start = 0;
+  int num_velocities = 0;
+  // The index of the parent body, or -1 for the world and floating bodies
+  int parent_index = -1;
+};
+
+template <typename T>
+Mobilizer GetMobilizer(const MultibodyPlant<T>& plant,
+                       const drake::multibody::Body<T>& body) {
+  Mobilizer mobilizer;
+  if (body.index() == plant.world_body().index()) {
+    return mobilizer;
+  }
+  if (body.is_floating()) {
+    mobilizer.position_start = body.floating_positions_start();
+    mobilizer.num_positions = body.has_quaternion_dofs() ? 7 : 6;
+    mobilizer.velocity_start =
+        body.floating_velocities_start() - plant.num_positions();
+    mobilizer.num_velocities = 6;
+    return mobilizer;
+  }
+  for (JointIndex i(0); i < plant.num_joints(); ++i) {
+    const drake::multibody::Joint<T>& joint = plant.get_joint(i);
+    if (joint.child_body().index() == body.index()) {
+      mobilizer.position_start = joint.position_start();
+      mobilizer.num_positions = joint.num_positions();
+      mobilizer.velocity_start = joint.velocity_start();
+      mobilizer.num_velocities = joint.num_velocities();
+      mobilizer.parent_index = joint.parent_body().index();
+      return mobilizer;
+    }
+  }
+  throw std::logic_error("Body " + body.name() + " has no inboard joint.");
+}
+
+}  // namespace
+
+template <typename T>
+vector<int> KinematicPathIndices(const MultibodyPlant<T>& plant,
+                                 const drake::multibody::Body<T>& body,
+                                 bool velocities) {
+  vector<int> indices;
+  const drake::multibody::Body<T>* current = &body;
+  while (current != nullptr) {
+    const Mobilizer mobilizer = GetMobilizer(plant, *current);
+    const int start =
+        velocities ? mobilizer.velocity_start : mobilizer.position_start;
+    const int size =
+        velocities ? mobilizer.num_velocities : mobilizer.num_positions;
+    for (int i = 0; i < size; i++) {
+      indices.push_back(start + i);
+    }
+    current = (mobilizer.parent_index < 0)
+                  ? nullptr
+                  : &plant.get_body(
+                        drake::multibody::BodyIndex(mobilizer.parent_index));
+  }
+  std::sort(indices.begin(), indices.end());
+  return indices;
+}
+
+template <typename T>
+vector<vector<int>> VelocityToPositionIndices(const MultibodyPlant<T>& plant) {
+  vector<vector<int>> positions(plant.num_velocities());
+  for (drake::multibody::BodyIndex i(1); i < plant.num_bodies(); ++i) {
+    const Mobilizer mobilizer = GetMobilizer(plant, plant.get_body(i));
+    for (int j = 0; j < mobilizer.num_velocities; j++) {
+      for (int k = 0; k < mobilizer.num_positions; k++) {
+        positions.at(mobilizer.velocity_start + j)
+            .push_back(mobilizer.position_start + k);
+      }
+    }
+  }
+  return positions;
+}
+
+template <typename T>
+vector<int> VelocityCouplingGroups(const MultibodyPlant<T>& plant) {
+  vector<int> groups(plant.num_velocities(), -1);
+  for (drake::multibody::BodyIndex i(1); i < plant.num_bodies(); ++i) {
+    // Find the ancestor of this body which is a child of the world. Its index
+    // identifies the subtree.
+    drake::multibody::BodyIndex root = i;
+    Mobilizer mobilizer = GetMobilizer(plant, plant.get_body(root));
+    while (mobilizer.parent_index > 0) {
+      root = drake::multibody::BodyIndex(mobilizer.parent_index);
+      mobilizer = GetMobilizer(plant, plant.get_body(root));
+    }
+    const Mobilizer own = GetMobilizer(plant, plant.get_body(i));
+    for (int j = 0; j < own.num_velocities; j++) {
+      groups.at(own.velocity_start + j) = root;
+    }
+  }
+  return groups;
+}
+
 template <typename T>
 bool isQuaternion(const MultibodyPlant<T>& plant) {
   return QuaternionStartIndex(plant) != -1;
@@ -392,6 +495,12 @@ template std::vector<int> QuaternionStartIndices(const MultibodyPlant<double>& p
 template std::vector<int> QuaternionStartIndices(const MultibodyPlant<AutoDiffXd>& plant);  // NOLINT
 template bool isQuaternion(const MultibodyPlant<double>& plant);  // NOLINT
 template bool isQuaternion(const MultibodyPlant<AutoDiffXd>& plant);  // NOLINT
+template vector<int> KinematicPathIndices(const MultibodyPlant<double>& plant, const drake::multibody::Body<double>& body, bool velocities);  // NOLINT
+template vector<int> KinematicPathIndices(const MultibodyPlant<AutoDiffXd>& plant, const drake::multibody::Body<AutoDiffXd>& body, bool velocities);  // NOLINT
+template vector<vector<int>> VelocityToPositionIndices(const MultibodyPlant<double>& plant);  // NOLINT
+template vector<vector<int>> VelocityToPositionIndices(const MultibodyPlant<AutoDiffXd>& plant);  // NOLINT
+template vector<int> VelocityCouplingGroups(const MultibodyPlant<double>& plant);  // NOLINT
+template vector<int> VelocityCouplingGroups(const MultibodyPlant<AutoDiffXd>& plant);  // NOLINT
 template map<string, int> makeNameToPositionsMap<double>(const MultibodyPlant<double>& plant);  // NOLINT
 template map<string, int> makeNameToPositionsMap<AutoDiffXd>(const MultibodyPlant<AutoDiffXd>& plant);  // NOLINT
 template map<string, int> makeNameToVelocitiesMap<double>(const MultibodyPlant<double>& plant);  // NOLINT
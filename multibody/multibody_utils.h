@@ -2,6 +2,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "drake/multibody/plant/multibody_plant.h"
 
@@ -29,6 +30,12 @@ void setContext(const drake::multibody::MultibodyPlant<T>& plant,
                 const Eigen::Ref<const drake::VectorX<T>>& input,
                 drake::systems::Context<T>* context);
 
+/// Exact equality of two vectors, including their gradients for AutoDiffXd
+bool AreVectorsEqual(const Eigen::Ref<const drake::AutoDiffVecXd>& a,
+                     const Eigen::Ref<const drake::AutoDiffVecXd>& b);
+bool AreVectorsEqual(const Eigen::Ref<const Eigen::VectorXd>& a,
+                     const Eigen::Ref<const Eigen::VectorXd>& b);
+
 /// Update an existing MultibodyPlant context, setting corresponding positions.
 /// Will only set if value if changed from current value.
 template <typename T>
@@ -119,6 +126,30 @@ std::vector<int> QuaternionStartIndices(
 template <typename T>
 int QuaternionStartIndex(const drake::multibody::MultibodyPlant<T>& plant);
 
+/// Returns the sorted indices of the generalized positions (or, if velocities
+/// is true, the generalized velocities) of every joint on the path from the
+/// world to the given body, including a floating base. The pose of any frame
+/// fixed to the body, and so its Jacobian, depends only on these coordinates.
+template <typename T>
+std::vector<int> KinematicPathIndices(
+    const drake::multibody::MultibodyPlant<T>& plant,
+    const drake::multibody::Body<T>& body, bool velocities);
+
+/// For each generalized velocity, returns the indices of the generalized
+/// positions of the same joint (or floating base). Since qdot = N(q) v, where
+/// N(q) is block diagonal by joint, qdot(i) can only depend on v(j) if i is
+/// among the entries for j.
+template <typename T>
+std::vector<std::vector<int>> VelocityToPositionIndices(
+    const drake::multibody::MultibodyPlant<T>& plant);
+
+/// Partitions the generalized velocities by the subtree of the world they
+/// belong to, returning a group id for each velocity. The mass matrix, and
+/// its inverse, are block diagonal over these groups.
+template <typename T>
+std::vector<int> VelocityCouplingGroups(
+    const drake::multibody::MultibodyPlant<T>& plant);
+
 /// Check whether a MultibodyPlant contains quaternion floating-base joint.
 /// Throws an error if there are multiple quaternion floating base joints.
 /// TODO: this method should be deprecated
@@ -27,6 +27,44 @@ void NonlinearConstraint<T>::SetConstraintScaling(
   constraint_scaling_ = map;
 }
 
+template <typename T>
+void NonlinearConstraint<T>::SetGradientSparsity(
+    const drake::MatrixX<bool>& mask) {
+  DRAKE_DEMAND(mask.rows() == num_constraints());
+  DRAKE_DEMAND(mask.cols() == num_vars());
+  sparsity_ = mask;
+
+  std::vector<std::pair<int, int>> pattern;
+  for (int j = 0; j < mask.cols(); j++) {
+    for (int i = 0; i < mask.rows(); i++) {
+      if (mask(i, j)) {
+        pattern.emplace_back(i, j);
+      }
+    }
+  }
+  this->SetGradientSparsityPattern(pattern);
+
+  // Greedy column grouping. Structurally zero columns are left out entirely.
+  column_groups_.clear();
+  std::vector<drake::VectorX<bool>> group_rows;
+  for (int j = 0; j < mask.cols(); j++) {
+    if (!mask.col(j).any()) {
+      continue;
+    }
+    size_t group = 0;
+    while (group < column_groups_.size() &&
+           (group_rows[group].array() && mask.col(j).array()).any()) {
+      group++;
+    }
+    if (group == column_groups_.size()) {
+      column_groups_.emplace_back();
+      group_rows.push_back(drake::VectorX<bool>::Constant(mask.rows(), false));
+    }
+    column_groups_[group].push_back(j);
+    group_rows[group] = group_rows[group].array() || mask.col(j).array();
+  }
+}
+
 template <typename T>
 template <typename U>
 void NonlinearConstraint<T>::ScaleConstraint(VectorX<U>* y) const {
@@ -62,27 +100,110 @@ void NonlinearConstraint<T>::DoEval(
 template <>
 void NonlinearConstraint<AutoDiffXd>::DoEval(
     const Eigen::Ref<const AutoDiffVecXd>& x, AutoDiffVecXd* y) const {
-  EvaluateConstraint(x, y);
+  if (sparsity_.size() == 0) {
+    EvaluateConstraint(x, y);
+  } else {
+    // Evaluate with one derivative direction per column group, and chain the
+    // result through the gradient of x
+    const MatrixXd original_grad = drake::math::autoDiffToGradientMatrix(x);
+    VectorXd y0;
+    MatrixXd dy;
+    EvaluateConstraintWithGradient(drake::math::autoDiffToValueMatrix(x), &y0,
+                                   &dy);
+    if (original_grad.isIdentity(1e-16)) {
+      *y = drake::math::initializeAutoDiffGivenGradientMatrix(y0, dy);
+    } else {
+      *y = drake::math::initializeAutoDiffGivenGradientMatrix(
+          y0, dy * original_grad);
+    }
+  }
   this->ScaleConstraint<AutoDiffXd>(y);
 }
 
+template <>
+void NonlinearConstraint<double>::EvaluateConstraintWithGradient(
+    const Eigen::Ref<const VectorXd>& x, VectorXd* y, MatrixXd* dy) const {
+  // forward differencing
+  VectorXd x_val = x;
+  VectorXd yi;
+  EvaluateConstraint(x_val, y);
+
+  if (sparsity_.size() == 0) {
+    dy->resize(y->size(), x_val.size());
+    for (int i = 0; i < x_val.size(); i++) {
+      x_val(i) += eps_;
+      EvaluateConstraint(x_val, &yi);
+      x_val(i) -= eps_;
+      dy->col(i) = (yi - *y) / eps_;
+    }
+    return;
+  }
+
+  // Perturb every column of a group at once. Since the columns share no
+  // nonzero rows, each row of the difference belongs to a single column.
+  dy->setZero(y->size(), x_val.size());
+  for (const auto& group : column_groups_) {
+    for (int i : group) {
+      x_val(i) += eps_;
+    }
+    EvaluateConstraint(x_val, &yi);
+    for (int i : group) {
+      x_val(i) = x(i);
+      for (int row = 0; row < y->size(); row++) {
+        if (sparsity_(row, i)) {
+          (*dy)(row, i) = (yi(row) - (*y)(row)) / eps_;
+        }
+      }
+    }
+  }
+}
+
+template <>
+void NonlinearConstraint<AutoDiffXd>::EvaluateConstraintWithGradient(
+    const Eigen::Ref<const VectorXd>& x, VectorXd* y, MatrixXd* dy) const {
+  AutoDiffVecXd y_t;
+  if (sparsity_.size() == 0) {
+    EvaluateConstraint(drake::math::initializeAutoDiff(x), &y_t);
+    *y = drake::math::autoDiffToValueMatrix(y_t);
+    *dy = drake::math::autoDiffToGradientMatrix(y_t);
+    return;
+  }
+
+  // Seed one derivative direction per column group
+  const int num_groups = column_groups_.size();
+  MatrixXd seed = MatrixXd::Zero(x.size(), num_groups);
+  for (int group = 0; group < num_groups; group++) {
+    for (int i : column_groups_[group]) {
+      seed(i, group) = 1;
+    }
+  }
+  EvaluateConstraint(
+      drake::math::initializeAutoDiffGivenGradientMatrix(x, seed), &y_t);
+  *y = drake::math::autoDiffToValueMatrix(y_t);
+  const MatrixXd compressed =
+      drake::math::autoDiffToGradientMatrix(y_t, num_groups);
+
+  dy->setZero(y->size(), x.size());
+  for (int group = 0; group < num_groups; group++) {
+    for (int i : column_groups_[group]) {
+      for (int row = 0; row < y->size(); row++) {
+        if (sparsity_(row, i)) {
+          (*dy)(row, i) = compressed(row, group);
+        }
+      }
+    }
+  }
+}
+
 template <>
 void NonlinearConstraint<double>::DoEval(
     const Eigen::Ref<const AutoDiffVecXd>& x, AutoDiffVecXd* y) const {
   MatrixXd original_grad = drake::math::autoDiffToGradientMatrix(x);
 
-  // forward differencing
   VectorXd x_val = drake::math::autoDiffToValueMatrix(x);
-  VectorXd y0, yi;
-  EvaluateConstraint(x_val, &y0);
-
-  MatrixXd dy = MatrixXd(y0.size(), x_val.size());
-  for (int i = 0; i < x_val.size(); i++) {
-    x_val(i) += eps_;
-    EvaluateConstraint(x_val, &yi);
-    x_val(i) -= eps_;
-    dy.col(i) = (yi - y0) / eps_;
-  }
+  VectorXd y0;
+  MatrixXd dy;
+  EvaluateConstraintWithGradient(x_val, &y0, &dy);
 
   // Profiling identified dy * original_grad as a significant runtime event,
   // even though it is almost always the identity matrix.
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "drake/common/symbolic.h"
 #include "drake/solvers/constraint.h"
 
@@ -11,7 +12,14 @@ namespace solvers {
 /// Abstract class for nonlinear constraints that manages 
 /// manages evaluation of functions and numerical differentiation
 /// 
-/// Subclasses should implement the method EvaluateConstraint
+/// Subclasses should implement the method EvaluateConstraint. For T = double,
+/// gradients are computed by numerical differentiation of EvaluateConstraint,
+/// unless the subclass overrides EvaluateConstraintWithGradient.
+///
+/// Subclasses which know the structure of their gradient should declare it
+/// with SetGradientSparsity. Besides reducing the size of the problem the
+/// solver factorizes, this lets gradients be computed in fewer evaluations:
+/// columns which share no nonzero rows are differentiated together.
 template <typename T>
 class NonlinearConstraint : public drake::solvers::Constraint {
  public:
@@ -38,14 +46,38 @@ class NonlinearConstraint : public drake::solvers::Constraint {
 
   void SetConstraintScaling(const std::unordered_map<int, double>& map);
 
+  /// Declares the structural sparsity of the gradient, as a
+  /// num_constraints() x num_vars() mask which must be true wherever dy/dx can
+  /// be nonzero. The pattern is passed on to the solver, via
+  /// SetGradientSparsityPattern. Columns are greedily grouped so that no two
+  /// columns in a group share a nonzero row. For T = double, each group is
+  /// then differenced with a single perturbation, and for T = AutoDiffXd, each
+  /// group is a single derivative direction.
+  void SetGradientSparsity(const drake::MatrixX<bool>& mask);
+
   virtual void EvaluateConstraint(const Eigen::Ref<const drake::VectorX<T>>& x,
                                   drake::VectorX<T>* y) const = 0;
 
+  /// Evaluates the (unscaled) constraint value y and its gradient dy/dx.
+  /// The default implementation uses forward differencing for T = double,
+  /// and automatic differentiation for T = AutoDiffXd. Subclasses may
+  /// override this to supply an analytic gradient.
+  virtual void EvaluateConstraintWithGradient(
+      const Eigen::Ref<const Eigen::VectorXd>& x, Eigen::VectorXd* y,
+      Eigen::MatrixXd* dy) const;
+
+ protected:
+  /// Step size used for numerical gradients
+  double eps() const { return eps_; }
+
  private:
   template <typename U>
   void ScaleConstraint(drake::VectorX<U>* y) const;
   std::unordered_map<int, double> constraint_scaling_;
   double eps_;
+  // Empty if no sparsity was declared
+  drake::MatrixX<bool> sparsity_;
+  std::vector<std::vector<int>> column_groups_;
 };
 
 }  // namespace solvers
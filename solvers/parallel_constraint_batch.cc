@@ -0,0 +1,336 @@
+#include "solvers/parallel_constraint_batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "drake/common/drake_assert.h"
+
+namespace dairlib {
+namespace solvers {
+
+using drake::AutoDiffVecXd;
+using drake::VectorX;
+using drake::solvers::Constraint;
+using drake::solvers::VectorXDecisionVariable;
+using drake::symbolic::Variable;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+/// A minimal fixed-size thread pool. ParallelFor(n, task) runs task(i) for
+/// every i in [0, n), using both the workers and the calling thread, and
+/// returns once all tasks have completed. Only one ParallelFor may be active
+/// at a time.
+class ParallelConstraintBatch::WorkerPool {
+ public:
+  explicit WorkerPool(int num_workers) {
+    for (int i = 0; i < num_workers; i++) {
+      threads_.emplace_back([this]() { WorkerLoop(); });
+    }
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void ParallelFor(int num_tasks, const std::function<void(int)>& task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      task_ = &task;
+      num_tasks_ = num_tasks;
+      next_task_ = 0;
+      remaining_tasks_ = num_tasks;
+      error_ = nullptr;
+      generation_++;
+    }
+    work_cv_.notify_all();
+
+    RunTasks(task, num_tasks);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this]() {
+      return remaining_tasks_ == 0 && active_workers_ == 0;
+    });
+    // Workers waking after this point will find no task and go back to sleep
+    task_ = nullptr;
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+ private:
+  void WorkerLoop() {
+    uint64_t seen_generation = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      work_cv_.wait(lock, [&]() {
+        return stop_ || generation_ != seen_generation;
+      });
+      if (stop_) {
+        return;
+      }
+      seen_generation = generation_;
+      if (task_ == nullptr) {
+        continue;
+      }
+      const std::function<void(int)>& task = *task_;
+      const int num_tasks = num_tasks_;
+      active_workers_++;
+      lock.unlock();
+
+      RunTasks(task, num_tasks);
+
+      lock.lock();
+      if (--active_workers_ == 0) {
+        done_cv_.notify_all();
+      }
+    }
+  }
+
+  void RunTasks(const std::function<void(int)>& task, int num_tasks) {
+    while (true) {
+      const int i = next_task_.fetch_add(1);
+      if (i >= num_tasks) {
+        return;
+      }
+      try {
+        task(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) {
+          error_ = std::current_exception();
+        }
+      }
+      if (--remaining_tasks_ == 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_cv_.notify_all();
+      }
+    }
+  }
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  const std::function<void(int)>* task_ = nullptr;
+  int num_tasks_ = 0;
+  std::atomic<int> next_task_{0};
+  std::atomic<int> remaining_tasks_{0};
+  int active_workers_ = 0;
+  uint64_t generation_ = 0;
+  bool stop_ = false;
+  std::exception_ptr error_;
+};
+
+namespace {
+
+using ConstraintGroup = ParallelConstraintBatch::ConstraintGroup;
+
+VectorXDecisionVariable CollectVariables(
+    const std::vector<ConstraintGroup>& groups) {
+  std::vector<Variable> vars;
+  std::unordered_map<Variable::Id, int> seen;
+  for (const auto& group : groups) {
+    for (const auto& binding : group) {
+      for (int i = 0; i < binding.variables().size(); i++) {
+        const Variable& var = binding.variables()(i);
+        if (seen.emplace(var.get_id(), vars.size()).second) {
+          vars.push_back(var);
+        }
+      }
+    }
+  }
+  VectorXDecisionVariable stacked(vars.size());
+  for (int i = 0; i < stacked.size(); i++) {
+    stacked(i) = vars[i];
+  }
+  return stacked;
+}
+
+VectorXd StackBounds(const std::vector<ConstraintGroup>& groups, bool lower) {
+  int num_rows = 0;
+  for (const auto& group : groups) {
+    for (const auto& binding : group) {
+      num_rows += binding.evaluator()->num_constraints();
+    }
+  }
+  VectorXd bounds(num_rows);
+  int row = 0;
+  for (const auto& group : groups) {
+    for (const auto& binding : group) {
+      const auto& c = binding.evaluator();
+      bounds.segment(row, c->num_constraints()) =
+          lower ? c->lower_bound() : c->upper_bound();
+      row += c->num_constraints();
+    }
+  }
+  return bounds;
+}
+
+}  // namespace
+
+ParallelConstraintBatch::ParallelConstraintBatch(
+    const std::vector<ConstraintGroup>& groups, int num_threads,
+    const std::string& description)
+    : Constraint(StackBounds(groups, true).size(),
+                 CollectVariables(groups).size(), StackBounds(groups, true),
+                 StackBounds(groups, false), description),
+      variables_(CollectVariables(groups)),
+      num_threads_(num_threads) {
+  DRAKE_DEMAND(num_threads >= 1);
+
+  std::unordered_map<Variable::Id, int> var_index;
+  for (int i = 0; i < variables_.size(); i++) {
+    var_index[variables_(i).get_id()] = i;
+  }
+
+  std::vector<std::pair<int, int>> sparsity_pattern;
+  int row = 0;
+  for (const auto& group : groups) {
+    groups_.emplace_back();
+    for (const auto& binding : group) {
+      Element element{binding.evaluator(), {}, row};
+      for (int i = 0; i < binding.variables().size(); i++) {
+        element.var_indices.push_back(
+            var_index.at(binding.variables()(i).get_id()));
+      }
+
+      const auto& c = binding.evaluator();
+      if (c->gradient_sparsity_pattern().has_value()) {
+        for (const auto& entry : c->gradient_sparsity_pattern().value()) {
+          sparsity_pattern.emplace_back(row + entry.first,
+                                        element.var_indices[entry.second]);
+        }
+      } else {
+        for (int i = 0; i < c->num_constraints(); i++) {
+          for (int j : element.var_indices) {
+            sparsity_pattern.emplace_back(row + i, j);
+          }
+        }
+      }
+      row += c->num_constraints();
+      groups_.back().push_back(std::move(element));
+    }
+  }
+  this->SetGradientSparsityPattern(sparsity_pattern);
+
+  if (num_threads_ > 1) {
+    pool_ = std::make_unique<WorkerPool>(num_threads_ - 1);
+  }
+}
+
+ParallelConstraintBatch::~ParallelConstraintBatch() = default;
+
+void ParallelConstraintBatch::DoEval(const Eigen::Ref<const VectorXd>& x,
+                                     VectorXd* y) const {
+  y->resize(num_constraints());
+  auto eval_group = [&](int group_index) {
+    VectorXd x_i, y_i;
+    for (const auto& element : groups_[group_index]) {
+      const int n = element.var_indices.size();
+      x_i.resize(n);
+      for (int j = 0; j < n; j++) {
+        x_i(j) = x(element.var_indices[j]);
+      }
+      element.constraint->Eval(x_i, &y_i);
+      y->segment(element.row_start, y_i.size()) = y_i;
+    }
+  };
+
+  if (pool_) {
+    pool_->ParallelFor(groups_.size(), eval_group);
+  } else {
+    for (int i = 0; i < static_cast<int>(groups_.size()); i++) {
+      eval_group(i);
+    }
+  }
+}
+
+void ParallelConstraintBatch::DoEval(const Eigen::Ref<const AutoDiffVecXd>& x,
+                                     AutoDiffVecXd* y) const {
+  // Solvers typically seed x with the identity gradient, in which case the
+  // gradient of each binding can be scattered directly into place rather than
+  // multiplied through dx/dz.
+  int num_derivatives = 0;
+  for (int i = 0; i < x.size(); i++) {
+    num_derivatives = std::max<int>(num_derivatives, x(i).derivatives().size());
+  }
+  bool identity_gradient = (num_derivatives == x.size());
+  for (int i = 0; i < x.size() && identity_gradient; i++) {
+    const VectorXd& d = x(i).derivatives();
+    identity_gradient = d.size() == num_derivatives && d(i) == 1 &&
+                        d.head(i).isZero(0) &&
+                        d.tail(d.size() - i - 1).isZero(0);
+  }
+
+  y->resize(num_constraints());
+  auto eval_group = [&](int group_index) {
+    AutoDiffVecXd x_i, y_i;
+    MatrixXd x_i_gradient;
+    for (const auto& element : groups_[group_index]) {
+      const int n = element.var_indices.size();
+      x_i.resize(n);
+      for (int j = 0; j < n; j++) {
+        x_i(j).value() = x(element.var_indices[j]).value();
+        x_i(j).derivatives() = VectorXd::Unit(n, j);
+      }
+      element.constraint->Eval(x_i, &y_i);
+
+      if (!identity_gradient) {
+        x_i_gradient = MatrixXd::Zero(n, num_derivatives);
+        for (int j = 0; j < n; j++) {
+          const VectorXd& d = x(element.var_indices[j]).derivatives();
+          x_i_gradient.row(j).head(d.size()) = d.transpose();
+        }
+      }
+
+      for (int k = 0; k < y_i.size(); k++) {
+        auto& y_k = (*y)(element.row_start + k);
+        y_k.value() = y_i(k).value();
+        y_k.derivatives() = VectorXd::Zero(num_derivatives);
+        const VectorXd& dy_k = y_i(k).derivatives();
+        if (dy_k.size() == 0) {
+          continue;
+        }
+        if (identity_gradient) {
+          for (int j = 0; j < n; j++) {
+            y_k.derivatives()(element.var_indices[j]) += dy_k(j);
+          }
+        } else {
+          y_k.derivatives().noalias() = x_i_gradient.transpose() * dy_k;
+        }
+      }
+    }
+  };
+
+  if (pool_) {
+    pool_->ParallelFor(groups_.size(), eval_group);
+  } else {
+    for (int i = 0; i < static_cast<int>(groups_.size()); i++) {
+      eval_group(i);
+    }
+  }
+}
+
+void ParallelConstraintBatch::DoEval(
+    const Eigen::Ref<const VectorX<Variable>>& x,
+    VectorX<drake::symbolic::Expression>* y) const {
+  throw std::logic_error(
+      "ParallelConstraintBatch does not support symbolic evaluation.");
+}
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "drake/common/symbolic.h"
+#include "drake/solvers/binding.h"
+#include "drake/solvers/constraint.h"
+
+namespace dairlib {
+namespace solvers {
+
+/// Wraps a collection of constraint bindings as a single constraint, whose
+/// evaluation is distributed across a pool of worker threads. This allows
+/// solvers which evaluate constraints one at a time (e.g. SNOPT through
+/// MathematicalProgram) to evaluate many expensive constraints concurrently.
+///
+/// Bindings are organized into groups. Groups are evaluated concurrently, but
+/// the bindings within a group are evaluated sequentially, in order. Bindings
+/// which share mutable state, such as a Context, must be placed in the same
+/// group. Constraints in different groups must be safe to evaluate
+/// concurrently.
+///
+/// The decision variables of the batch are the union of the variables of all
+/// bindings, available via variables(), and the constraint rows are the
+/// bindings' rows stacked in order. Each binding is evaluated through its own
+/// Eval(), so any constraint scaling is preserved. The gradient sparsity
+/// pattern of the batch is set to the union of the bindings' patterns, so the
+/// solver sees the same Jacobian structure as if the bindings had been added
+/// individually.
+class ParallelConstraintBatch : public drake::solvers::Constraint {
+ public:
+  using ConstraintGroup =
+      std::vector<drake::solvers::Binding<drake::solvers::Constraint>>;
+
+  /// @param groups The constraint bindings, organized into groups
+  /// @param num_threads The total number of threads used for evaluation,
+  ///   including the calling thread
+  /// @param description (default blank)
+  ParallelConstraintBatch(const std::vector<ConstraintGroup>& groups,
+                          int num_threads,
+                          const std::string& description = "");
+
+  ~ParallelConstraintBatch() override;
+
+  /// The decision variables to bind this constraint to.
+  const drake::solvers::VectorXDecisionVariable& variables() const {
+    return variables_;
+  }
+
+  int num_threads() const { return num_threads_; }
+
+ protected:
+  void DoEval(const Eigen::Ref<const Eigen::VectorXd>& x,
+              Eigen::VectorXd* y) const override;
+
+  void DoEval(const Eigen::Ref<const drake::AutoDiffVecXd>& x,
+              drake::AutoDiffVecXd* y) const override;
+
+  void DoEval(
+      const Eigen::Ref<const drake::VectorX<drake::symbolic::Variable>>& x,
+      drake::VectorX<drake::symbolic::Expression>* y) const override;
+
+ private:
+  class WorkerPool;
+
+  // A binding, with its variables and rows resolved against the batch
+  struct Element {
+    std::shared_ptr<drake::solvers::Constraint> constraint;
+    std::vector<int> var_indices;
+    int row_start;
+  };
+
+  const drake::solvers::VectorXDecisionVariable variables_;
+  const int num_threads_;
+  std::vector<std::vector<Element>> groups_;
+  std::unique_ptr<WorkerPool> pool_;
+};
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -0,0 +1,138 @@
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/math/autodiff.h"
+#include "drake/math/autodiff_gradient.h"
+#include "drake/solvers/mathematical_program.h"
+#include "solvers/parallel_constraint_batch.h"
+
+namespace dairlib {
+namespace solvers {
+namespace {
+
+using drake::AutoDiffVecXd;
+using drake::CompareMatrices;
+using drake::solvers::LinearConstraint;
+using drake::solvers::MathematicalProgram;
+using drake::solvers::QuadraticConstraint;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+class ParallelConstraintBatchTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    x_ = prog_.NewContinuousVariables(6, "x");
+
+    // Bindings which overlap in their variables, and bind some variables in a
+    // different order than they were declared
+    auto linear = std::make_shared<LinearConstraint>(
+        MatrixXd::Random(2, 3), -VectorXd::Ones(2), VectorXd::Ones(2));
+    auto quadratic = std::make_shared<QuadraticConstraint>(
+        MatrixXd::Identity(4, 4), VectorXd::Ones(4), 0, 1);
+    groups_.resize(3);
+    groups_[0].emplace_back(linear, x_.head(3));
+    groups_[0].emplace_back(quadratic, x_.tail(4));
+    groups_[1].emplace_back(linear, x_.tail(3));
+    groups_[2].emplace_back(
+        quadratic, drake::solvers::VectorXDecisionVariable(
+                       (drake::solvers::VectorXDecisionVariable(4) << x_(5),
+                        x_(0), x_(3), x_(1))
+                           .finished()));
+  }
+
+  // Evaluates every binding individually and stacks the results, as a
+  // reference for the batch.
+  VectorXd EvalReference(const VectorXd& x_val, MatrixXd* gradient) {
+    std::vector<VectorXd> values;
+    std::vector<MatrixXd> gradients;
+    const AutoDiffVecXd x_ad = drake::math::initializeAutoDiff(x_val);
+    int rows = 0;
+    for (const auto& group : groups_) {
+      for (const auto& binding : group) {
+        AutoDiffVecXd x_binding(binding.variables().size());
+        for (int i = 0; i < x_binding.size(); i++) {
+          x_binding(i) = x_ad(
+              prog_.FindDecisionVariableIndex(binding.variables()(i)));
+        }
+        AutoDiffVecXd y;
+        binding.evaluator()->Eval(x_binding, &y);
+        values.push_back(drake::math::autoDiffToValueMatrix(y));
+        gradients.push_back(drake::math::autoDiffToGradientMatrix(y));
+        rows += y.size();
+      }
+    }
+    VectorXd value(rows);
+    gradient->resize(rows, x_val.size());
+    int row = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+      value.segment(row, values[i].size()) = values[i];
+      gradient->middleRows(row, values[i].size()) = gradients[i];
+      row += values[i].size();
+    }
+    return value;
+  }
+
+  // Compares the batch against individually evaluated bindings
+  void CheckBatch(const ParallelConstraintBatch& batch) {
+    ASSERT_EQ(batch.num_constraints(), 2 + 1 + 2 + 1);
+    ASSERT_EQ(batch.num_vars(), 6);
+
+    // Order the program's variables to match the batch, and build a reference
+    const VectorXd x_val = VectorXd::Random(6);
+    VectorXd x_batch(batch.num_vars());
+    for (int i = 0; i < batch.num_vars(); i++) {
+      x_batch(i) = x_val(prog_.FindDecisionVariableIndex(batch.variables()(i)));
+    }
+    MatrixXd gradient_reference;
+    const VectorXd y_reference = EvalReference(x_val, &gradient_reference);
+
+    VectorXd y;
+    batch.Eval(x_batch, &y);
+    EXPECT_TRUE(CompareMatrices(y, y_reference, 1e-12));
+
+    // The gradient of the batch is w.r.t. its own variable ordering
+    AutoDiffVecXd y_ad;
+    batch.Eval(drake::math::initializeAutoDiff(x_batch), &y_ad);
+    const MatrixXd gradient = drake::math::autoDiffToGradientMatrix(y_ad);
+    for (int i = 0; i < batch.num_vars(); i++) {
+      const int prog_index =
+          prog_.FindDecisionVariableIndex(batch.variables()(i));
+      EXPECT_TRUE(CompareMatrices(gradient.col(i),
+                                  gradient_reference.col(prog_index), 1e-12));
+    }
+
+    // Every nonzero in the gradient must appear in the sparsity pattern
+    ASSERT_TRUE(batch.gradient_sparsity_pattern().has_value());
+    MatrixXd mask = MatrixXd::Zero(gradient.rows(), gradient.cols());
+    for (const auto& entry : batch.gradient_sparsity_pattern().value()) {
+      mask(entry.first, entry.second) = 1;
+    }
+    EXPECT_TRUE(gradient.cwiseProduct(
+        (MatrixXd::Ones(mask.rows(), mask.cols()) - mask)).isZero(0));
+
+    // A non-identity seed gradient is chained through
+    const MatrixXd seed = MatrixXd::Random(batch.num_vars(), 2);
+    batch.Eval(
+        drake::math::initializeAutoDiffGivenGradientMatrix(x_batch, seed),
+        &y_ad);
+    EXPECT_TRUE(CompareMatrices(drake::math::autoDiffToGradientMatrix(y_ad),
+                                gradient * seed, 1e-12));
+  }
+
+  MathematicalProgram prog_;
+  drake::solvers::VectorXDecisionVariable x_;
+  std::vector<ParallelConstraintBatch::ConstraintGroup> groups_;
+};
+
+TEST_F(ParallelConstraintBatchTest, MatchesIndividualEvaluation) {
+  for (int num_threads : {1, 2, 4}) {
+    ParallelConstraintBatch batch(groups_, num_threads);
+    CheckBatch(batch);
+  }
+}
+
+}  // namespace
+}  // namespace solvers
+}  // namespace dairlib
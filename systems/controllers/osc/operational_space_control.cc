@@ -1,7 +1,9 @@
 #include "systems/controllers/osc/operational_space_control.h"
+#include <algorithm>
 #include <drake/multibody/plant/multibody_plant.h>
 #include "common/eigen_utils.h"
 #include "multibody/multibody_utils.h"
+#include "systems/framework/loop_timing.h"
 #include "drake/common/text_logging.h"
 
 using std::cout;
@@ -22,7 +24,9 @@ using drake::multibody::JointIndex;
 using drake::multibody::MultibodyPlant;
 using drake::solvers::MathematicalProgram;
 using drake::solvers::MathematicalProgramResult;
+using drake::solvers::OsqpSolver;
 using drake::solvers::SolutionResult;
+using drake::solvers::SolverOptions;
 using drake::systems::BasicVector;
 using drake::systems::Context;
 using drake::trajectories::ExponentialPlusPiecewisePolynomial;
@@ -137,6 +141,12 @@ OperationalSpaceControl::OperationalSpaceControl(
 
   // Check if the model is floating based
   is_quaternion_ = multibody::isQuaternion(plant_w_spr);
+
+  // Kinematics caches
+  kinematics_cache_w_spr_ =
+      std::make_unique<multibody::FrameKinematicsCache<double>>(plant_w_spr);
+  kinematics_cache_wo_spr_ =
+      std::make_unique<multibody::FrameKinematicsCache<double>>(plant_wo_spr);
 }
 
 // Cost methods
@@ -217,6 +227,14 @@ void OperationalSpaceControl::AddConstTrackingData(
   t_e_vec_.push_back(t_ub);
 }
 
+// Solver methods
+void OperationalSpaceControl::EnableOsqpWarmStart(
+    const SolverOptions& solver_options) {
+  DRAKE_DEMAND(prog_ == nullptr);
+  warm_start_qp_ = true;
+  solver_options_ = solver_options;
+}
+
 // Osc checkers and constructor
 void OperationalSpaceControl::CheckCostSettings() {
   if (W_input_.size() != 0) {
@@ -242,6 +260,8 @@ void OperationalSpaceControl::Build() {
   CheckConstraintSettings();
   for (auto tracking_data : *tracking_data_vec_) {
     tracking_data->CheckOscTrackingData();
+    tracking_data->SetKinematicsCaches(kinematics_cache_w_spr_.get(),
+                                       kinematics_cache_wo_spr_.get());
   }
 
   // Construct QP
@@ -374,13 +394,72 @@ void OperationalSpaceControl::Build() {
         w_soft_constraint_ * MatrixXd::Identity(n_c_active_, n_c_active_),
         VectorXd::Zero(n_c_active_), epsilon_);
   }
-  // 4. Tracking cost
+  // 4. Tracking cost (all tracking data are summed into one cost)
+  tracking_cost_ = prog_->AddQuadraticCost(MatrixXd::Zero(n_v_, n_v_),
+                                           VectorXd::Zero(n_v_), dv_)
+                       .evaluator()
+                       .get();
+
+  // Active tracking data indices of each finite state machine state.
+  // A tracking data without states is active in every state, including the
+  // states that no tracking data or contact refers to.
+  std::set<int> fsm_states;
+  for (const auto& contact_indices : contact_indices_map_) {
+    fsm_states.insert(contact_indices.first);
+  }
+  for (auto tracking_data : *tracking_data_vec_) {
+    fsm_states.insert(tracking_data->GetStates().begin(),
+                      tracking_data->GetStates().end());
+  }
   for (unsigned int i = 0; i < tracking_data_vec_->size(); i++) {
-    tracking_cost_.push_back(prog_->AddQuadraticCost(MatrixXd::Zero(n_v_, n_v_),
-                                                     VectorXd::Zero(n_v_), dv_)
-                                  .evaluator()
-                                  .get());
+    const auto& states = tracking_data_vec_->at(i)->GetStates();
+    if (states.empty()) {
+      default_active_tracking_data_.push_back(i);
+    }
+    for (int fsm_state : fsm_states) {
+      if (states.empty() ||
+          std::find(states.begin(), states.end(), fsm_state) != states.end()) {
+        active_tracking_data_map_[fsm_state].push_back(i);
+      }
+    }
   }
+  for (int fsm_state : fsm_states) {
+    // Make sure every known state has an entry, even if nothing is tracked
+    active_tracking_data_map_[fsm_state];
+  }
+
+  // Workspace
+  int n_y_max = 0;
+  for (auto tracking_data : *tracking_data_vec_) {
+    n_y_max = std::max(n_y_max, tracking_data->GetYdotDim());
+  }
+  workspace_ = std::make_unique<OscWorkspace>(
+      plant_w_spr_.num_positions() + plant_w_spr_.num_velocities(), n_q_, n_v_,
+      n_u_, n_h_, n_c_, n_c_active_, n_y_max,
+      plant_wo_spr_.MakeActuationMatrix());
+
+  // Persistent solver
+  if (warm_start_qp_) {
+    solver_ = std::make_unique<OsqpSolver>();
+    DRAKE_DEMAND(solver_->available());
+    // The previous solution is close to the current one at the control rate,
+    // so we ask OSQP to start from it instead of from the origin.
+    solver_options_->SetOption(OsqpSolver::id(), "warm_start", 1);
+    // The initial guess is kept in prog_, so that Solve() doesn't copy it
+    prog_->SetInitialGuessForAllVariables(VectorXd::Zero(prog_->num_vars()));
+  }
+  result_ = std::make_unique<MathematicalProgramResult>();
+
+  // Offsets of the decision variables in the solution, which is read without
+  // copying each block through GetSolution()
+  auto start_index = [this](const drake::solvers::VectorXDecisionVariable& v) {
+    return (v.size() > 0) ? prog_->FindDecisionVariableIndex(v(0)) : 0;
+  };
+  dv_start_ = start_index(dv_);
+  u_start_ = start_index(u_);
+  lambda_c_start_ = start_index(lambda_c_);
+  lambda_h_start_ = start_index(lambda_h_);
+  epsilon_start_ = start_index(epsilon_);
 }
 
 drake::systems::EventStatus OperationalSpaceControl::DiscreteVariableUpdate(
@@ -404,18 +483,21 @@ drake::systems::EventStatus OperationalSpaceControl::DiscreteVariableUpdate(
   return drake::systems::EventStatus::Succeeded();
 }
 
-VectorXd OperationalSpaceControl::SolveQp(
+const VectorXd& OperationalSpaceControl::SolveQp(
     const VectorXd& x_w_spr, const VectorXd& x_wo_spr,
     const drake::systems::Context<double>& context, double t, int fsm_state,
     double time_since_last_state_switch) const {
+  OscWorkspace& ws = *workspace_;
+
   // Get active contact indices
-  std::set<int> active_contact_set = {};
+  static const std::set<int> kNoActiveContact = {};
+  const std::set<int>* active_contact_set = &kNoActiveContact;
   if (single_contact_mode_) {
-    active_contact_set = contact_indices_map_.at(-1);
+    active_contact_set = &contact_indices_map_.at(-1);
   } else {
     auto map_iterator = contact_indices_map_.find(fsm_state);
     if (map_iterator != contact_indices_map_.end()) {
-      active_contact_set = map_iterator->second;
+      active_contact_set = &map_iterator->second;
     } else {
       static const drake::logging::Warn log_once(const_cast<char*>(
           (std::to_string(fsm_state) +
@@ -437,49 +519,54 @@ VectorXd OperationalSpaceControl::SolveQp(
   SetVelocitiesIfNew<double>(plant_wo_spr_,
                              x_wo_spr.tail(plant_wo_spr_.num_velocities()),
                              context_wo_spr_);
+  kinematics_cache_w_spr_->Invalidate();
+  kinematics_cache_wo_spr_->Invalidate();
 
   // Get M, f_cg, B matrices of the manipulator equation
-  MatrixXd B = plant_wo_spr_.MakeActuationMatrix();
-  MatrixXd M(n_v_, n_v_);
-  plant_wo_spr_.CalcMassMatrixViaInverseDynamics(*context_wo_spr_, &M);
-  VectorXd bias(n_v_);
-  plant_wo_spr_.CalcBiasTerm(*context_wo_spr_, &bias);
-  VectorXd grav = plant_wo_spr_.CalcGravityGeneralizedForces(*context_wo_spr_);
-  bias = bias - grav;
-
-  // Get J and JdotV for holonomic constraint
-  MatrixXd J_h(n_h_, n_v_);
-  VectorXd JdotV_h(n_h_);
+  // (B is constant and stored in the workspace)
+  plant_wo_spr_.CalcMassMatrixViaInverseDynamics(*context_wo_spr_, &ws.M);
+  plant_wo_spr_.CalcBiasTerm(*context_wo_spr_, &ws.bias);
+  // CalcGravityGeneralizedForces has no overload with an output argument
+  ws.grav = plant_wo_spr_.CalcGravityGeneralizedForces(*context_wo_spr_);
+  ws.bias -= ws.grav;
+
+  // Get J and JdotV for holonomic constraint, in one pass
   if (kinematic_evaluators_ != nullptr) {
-    J_h = kinematic_evaluators_->EvalFullJacobian(*context_wo_spr_);
-    JdotV_h =
-        kinematic_evaluators_->EvalFullJacobianDotTimesV(*context_wo_spr_);
+    kinematic_evaluators_->EvalFullInto(*context_wo_spr_,
+                                        kinematics_cache_wo_spr_.get(),
+                                        nullptr, &ws.J_h, &ws.JdotV_h);
   }
 
   // Get J for external forces in equations of motion
-  MatrixXd J_c = MatrixXd::Zero(n_c_, n_v_);
+  ws.J_c.setZero();
   for (unsigned int i = 0; i < all_contacts_.size(); i++) {
-    if (active_contact_set.find(i) != active_contact_set.end()) {
-      J_c.block(kSpaceDim * i, 0, kSpaceDim, n_v_) =
-          all_contacts_[i]->EvalFullJacobian(*context_wo_spr_);
+    if (active_contact_set->find(i) != active_contact_set->end()) {
+      auto J_c_i = ws.J_c.block(kSpaceDim * i, 0, kSpaceDim, n_v_);
+      all_contacts_[i]->EvalFullJacobian(
+          *context_wo_spr_, kinematics_cache_wo_spr_.get(), &J_c_i);
     }
   }
 
   // Get J and JdotV for contact constraint
-  MatrixXd J_c_active = MatrixXd::Zero(n_c_active_, n_v_);
-  VectorXd JdotV_c_active = VectorXd::Zero(n_c_active_);
+  ws.J_c_active.setZero();
+  ws.JdotV_c_active.setZero();
   int row_idx = 0;
   for (unsigned int i = 0; i < all_contacts_.size(); i++) {
     auto contact_i = all_contacts_[i];
-    if (active_contact_set.find(i) != active_contact_set.end()) {
+    if (active_contact_set->find(i) != active_contact_set->end()) {
       // We don't call EvalActiveJacobian() because it'll repeat the computation
       // of the Jacobian. (J_c_active is just a stack of slices of J_c)
       for (int j = 0; j < contact_i->num_active(); j++) {
-        J_c_active.row(row_idx + j) =
-            J_c.row(kSpaceDim * i + contact_i->active_inds().at(j));
+        ws.J_c_active.row(row_idx + j) =
+            ws.J_c.row(kSpaceDim * i + contact_i->active_inds().at(j));
+      }
+      auto JdotV_c_i = ws.JdotV_c.segment(kSpaceDim * i, kSpaceDim);
+      contact_i->EvalFullJacobianDotTimesVInto(
+          *context_wo_spr_, kinematics_cache_wo_spr_.get(), &JdotV_c_i);
+      for (int j = 0; j < contact_i->num_active(); j++) {
+        ws.JdotV_c_active(row_idx + j) =
+            JdotV_c_i(contact_i->active_inds().at(j));
       }
-      JdotV_c_active.segment(row_idx, contact_i->num_active()) =
-          contact_i->EvalActiveJacobianDotTimesV(*context_wo_spr_);
     }
     row_idx += contact_i->num_active();
   }
@@ -489,32 +576,26 @@ VectorXd OperationalSpaceControl::SolveQp(
   ///    M*dv + bias == J_c^T*lambda_c + J_h^T*lambda_h + B*u
   /// -> M*dv - J_c^T*lambda_c - J_h^T*lambda_h - B*u == - bias
   /// -> [M, -J_c^T, -J_h^T, -B]*[dv, lambda_c, lambda_h, u]^T = - bias
-  MatrixXd A_dyn = MatrixXd::Zero(n_v_, n_v_ + n_c_ + n_h_ + n_u_);
-  A_dyn.block(0, 0, n_v_, n_v_) = M;
-  A_dyn.block(0, n_v_, n_v_, n_c_) = -J_c.transpose();
-  A_dyn.block(0, n_v_ + n_c_, n_v_, n_h_) = -J_h.transpose();
-  A_dyn.block(0, n_v_ + n_c_ + n_h_, n_v_, n_u_) = -B;
-  dynamics_constraint_->UpdateCoefficients(A_dyn, -bias);
+  ws.UpdateDynamicsConstraint();
+  dynamics_constraint_->UpdateCoefficients(ws.A_dyn, ws.b_dyn);
   // 2. Holonomic constraint
   ///    JdotV_h + J_h*dv == 0
   /// -> J_h*dv == -JdotV_h
-  holonomic_constraint_->UpdateCoefficients(J_h, -JdotV_h);
+  ws.UpdateHolonomicConstraint();
+  holonomic_constraint_->UpdateCoefficients(ws.J_h, ws.b_h);
   // 3. Contact constraint
   if (!all_contacts_.empty()) {
+    ws.UpdateContactConstraint();
     if (w_soft_constraint_ <= 0) {
       ///    JdotV_c_active + J_c_active*dv == 0
       /// -> J_c_active*dv == -JdotV_c_active
-      contact_constraints_->UpdateCoefficients(J_c_active, -JdotV_c_active);
+      contact_constraints_->UpdateCoefficients(ws.J_c_active, ws.b_c);
     } else {
       // Relaxed version:
       ///    JdotV_c_active + J_c_active*dv == -epsilon
       /// -> J_c_active*dv + I*epsilon == -JdotV_c_active
       /// -> [J_c_active, I]* [dv, epsilon]^T == -JdotV_c_active
-      MatrixXd A_c = MatrixXd::Zero(n_c_active_, n_v_ + n_c_active_);
-      A_c.block(0, 0, n_c_active_, n_v_) = J_c_active;
-      A_c.block(0, n_v_, n_c_active_, n_c_active_) =
-          MatrixXd::Identity(n_c_active_, n_c_active_);
-      contact_constraints_->UpdateCoefficients(A_c, -JdotV_c_active);
+      contact_constraints_->UpdateCoefficients(ws.A_c, ws.b_c);
     }
   }
   // 4. Friction constraint (approximated firction cone)
@@ -531,42 +612,39 @@ VectorXd OperationalSpaceControl::SolveQp(
   ///     mu_*lambda_c(3*i+2) + lambda_c(3*i+1) >= 0
   ///                           lambda_c(3*i+2) >= 0
   if (!all_contacts_.empty()) {
-    VectorXd inf_vectorxd(1);
-    inf_vectorxd << numeric_limits<double>::infinity();
     for (unsigned int i = 0; i < all_contacts_.size(); i++) {
-      if (active_contact_set.find(i) != active_contact_set.end()) {
-        // when the contact is active
-        friction_constraints_.at(5 * i)->UpdateLowerBound(VectorXd::Zero(1));
-        friction_constraints_.at(5 * i + 1)->UpdateLowerBound(
-            VectorXd::Zero(1));
-        friction_constraints_.at(5 * i + 2)->UpdateLowerBound(
-            VectorXd::Zero(1));
-        friction_constraints_.at(5 * i + 3)->UpdateLowerBound(
-            VectorXd::Zero(1));
-        friction_constraints_.at(5 * i + 4)->UpdateLowerBound(
-            VectorXd::Zero(1));
-      } else {
-        // when the contact is not active
-        friction_constraints_.at(5 * i)->UpdateLowerBound(-inf_vectorxd);
-        friction_constraints_.at(5 * i + 1)->UpdateLowerBound(-inf_vectorxd);
-        friction_constraints_.at(5 * i + 2)->UpdateLowerBound(-inf_vectorxd);
-        friction_constraints_.at(5 * i + 3)->UpdateLowerBound(-inf_vectorxd);
-        friction_constraints_.at(5 * i + 4)->UpdateLowerBound(-inf_vectorxd);
+      // zero lower bound when the contact is active, and -inf otherwise
+      const VectorXd& lb =
+          (active_contact_set->find(i) != active_contact_set->end())
+              ? ws.zero_lb
+              : ws.inf_lb;
+      for (int j = 0; j < 5; j++) {
+        friction_constraints_.at(5 * i + j)->UpdateLowerBound(lb);
       }
     }
   }
 
   // Update costs
   // 4. Tracking cost
-  for (unsigned int i = 0; i < tracking_data_vec_->size(); i++) {
+  auto active_it = active_tracking_data_map_.find(fsm_state);
+  const std::vector<int>& active_tracking_data =
+      (active_it != active_tracking_data_map_.end())
+          ? active_it->second
+          : default_active_tracking_data_;
+  // Mark every tracking data inactive first, so that the ones that are not
+  // tracked in this state are skipped without evaluating their trajectories.
+  for (auto tracking_data : *tracking_data_vec_) {
+    tracking_data->UpdateTrackingFlag(fsm_state);
+  }
+  ws.ClearTrackingCost();
+  for (int i : active_tracking_data) {
     auto tracking_data = tracking_data_vec_->at(i);
 
     // Check whether or not it is a constant trajectory, and update TrackingData
     if (fixed_position_vec_.at(i).size() != 0) {
-      // Create constant trajectory and update
-      tracking_data->Update(
-          x_w_spr, *context_w_spr_, x_wo_spr, *context_wo_spr_,
-          PiecewisePolynomial<double>(fixed_position_vec_.at(i)), t, fsm_state);
+      tracking_data->Update(x_w_spr, *context_w_spr_, x_wo_spr,
+                            *context_wo_spr_, fixed_position_vec_.at(i),
+                            fsm_state);
     } else {
       // Read in traj from input port
       const string& traj_name = tracking_data->GetName();
@@ -580,37 +658,42 @@ VectorXd OperationalSpaceControl::SolveQp(
       tracking_data->Update(x_w_spr, *context_w_spr_, x_wo_spr,
                             *context_wo_spr_, traj, t, fsm_state);
     }
-    // TODO(yangwill): Should only really be updating the trajectory if it's
-    //  active
-    if (tracking_data->IsActive() &&
-        time_since_last_state_switch >= t_s_vec_.at(i) &&
+    if (time_since_last_state_switch >= t_s_vec_.at(i) &&
         time_since_last_state_switch <= t_e_vec_.at(i)) {
-      const VectorXd& ddy_t = tracking_data->GetYddotCommand();
-      const MatrixXd& W = tracking_data->GetWeight();
-      const MatrixXd& J_t = tracking_data->GetJ();
-      const VectorXd& JdotV_t = tracking_data->GetJdotTimesV();
       // The tracking cost is
       // 0.5 * (J_*dv + JdotV - y_command)^T * W * (J_*dv + JdotV - y_command).
       // We ignore the constant term
       // 0.5 * (JdotV - y_command)^T * W * (JdotV - y_command),
       // since it doesn't change the result of QP.
-      tracking_cost_.at(i)->UpdateCoefficients(
-          J_t.transpose() * W * J_t, J_t.transpose() * W * (JdotV_t - ddy_t));
-    } else {
-      tracking_cost_.at(i)->UpdateCoefficients(MatrixXd::Zero(n_v_, n_v_),
-                                               VectorXd::Zero(n_v_));
+      ws.AddTrackingCost(
+          tracking_data->GetJ(), tracking_data->GetWeight(),
+          tracking_data->GetJdotTimesV(), tracking_data->GetYddotCommand());
     }
   }
+  tracking_cost_->UpdateCoefficients(ws.H_tracking, ws.b_tracking);
 
   // Solve the QP
-  const MathematicalProgramResult result = Solve(*prog_);
+  MathematicalProgramResult& result = *result_;
+  if (warm_start_qp_) {
+    // Starts from prog_->initial_guess()
+    solver_->Solve(*prog_, std::nullopt, solver_options_, &result);
+    if (result.is_success()) {
+      prog_->SetInitialGuessForAllVariables(result.get_x_val());
+    } else {
+      // Don't warm start the next tick from a failed solve
+      prog_->SetInitialGuessForAllVariables(VectorXd::Zero(prog_->num_vars()));
+    }
+  } else {
+    result = Solve(*prog_);
+  }
 
   // Extract solutions
-  *dv_sol_ = result.GetSolution(dv_);
-  *u_sol_ = result.GetSolution(u_);
-  *lambda_c_sol_ = result.GetSolution(lambda_c_);
-  *lambda_h_sol_ = result.GetSolution(lambda_h_);
-  *epsilon_sol_ = result.GetSolution(epsilon_);
+  const VectorXd& x_sol = result.get_x_val();
+  *dv_sol_ = x_sol.segment(dv_start_, dv_sol_->size());
+  *u_sol_ = x_sol.segment(u_start_, u_sol_->size());
+  *lambda_c_sol_ = x_sol.segment(lambda_c_start_, lambda_c_sol_->size());
+  *lambda_h_sol_ = x_sol.segment(lambda_h_start_, lambda_h_sol_->size());
+  *epsilon_sol_ = x_sol.segment(epsilon_start_, epsilon_sol_->size());
 
   for (auto tracking_data : *tracking_data_vec_) {
     if (tracking_data->IsActive()) tracking_data->SaveYddotCommandSol(*dv_sol_);
@@ -753,14 +836,16 @@ void OperationalSpaceControl::AssignOscLcmOutput(
 void OperationalSpaceControl::CalcOptimalInput(
     const drake::systems::Context<double>& context,
     systems::TimestampedVector<double>* control) const {
+  static const int timing_section = LoopTimer::RegisterSection("osc");
+  ScopedLoopSection timing(timing_section);
+  OscWorkspace& ws = *workspace_;
+
   // Read in current state and time
   const OutputVector<double>* robot_output =
       (OutputVector<double>*)this->EvalVectorInput(context, state_port_);
-  VectorXd q_w_spr = robot_output->GetPositions();
-  VectorXd v_w_spr = robot_output->GetVelocities();
-  VectorXd x_w_spr(plant_w_spr_.num_positions() +
-                   plant_w_spr_.num_velocities());
-  x_w_spr << q_w_spr, v_w_spr;
+  // The state is at the head of OutputVector. We read it through get_value()
+  // instead of GetPositions()/GetVelocities(), which return copies.
+  ws.x_w_spr = robot_output->get_value().head(ws.x_w_spr.size());
 
   double timestamp = robot_output->get_timestamp();
   auto current_time = static_cast<double>(timestamp);
@@ -768,29 +853,32 @@ void OperationalSpaceControl::CalcOptimalInput(
     cout << "\n\ncurrent_time = " << current_time << endl;
   }
 
-  VectorXd x_wo_spr(n_q_ + n_v_);
-  x_wo_spr << map_position_from_spring_to_no_spring_ * q_w_spr,
-      map_velocity_from_spring_to_no_spring_ * v_w_spr;
+  ws.x_wo_spr.head(n_q_).noalias() =
+      map_position_from_spring_to_no_spring_ *
+      ws.x_w_spr.head(plant_w_spr_.num_positions());
+  ws.x_wo_spr.tail(n_v_).noalias() =
+      map_velocity_from_spring_to_no_spring_ *
+      ws.x_w_spr.tail(plant_w_spr_.num_velocities());
 
-  VectorXd u_sol(n_u_);
   if (used_with_finite_state_machine_) {
     // Read in finite state machine
     const BasicVector<double>* fsm_output =
         (BasicVector<double>*)this->EvalVectorInput(context, fsm_port_);
-    VectorXd fsm_state = fsm_output->get_value();
+    double fsm_state = fsm_output->get_value()(0);
 
     // Get discrete states
     const auto prev_event_time =
         context.get_discrete_state(prev_event_time_idx_).get_value();
 
-    u_sol = SolveQp(x_w_spr, x_wo_spr, context, current_time, fsm_state(0),
-                    current_time - prev_event_time(0));
+    ws.u_sol = SolveQp(ws.x_w_spr, ws.x_wo_spr, context, current_time,
+                       fsm_state, current_time - prev_event_time(0));
   } else {
-    u_sol = SolveQp(x_w_spr, x_wo_spr, context, current_time, -1, current_time);
+    ws.u_sol = SolveQp(ws.x_w_spr, ws.x_wo_spr, context, current_time, -1,
+                       current_time);
   }
 
   // Assign the control input
-  control->SetDataVector(u_sol);
+  control->SetDataVector(ws.u_sol);
   control->set_timestamp(robot_output->get_timestamp());
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -14,12 +15,15 @@
 #include "drake/systems/framework/leaf_system.h"
 
 #include "drake/solvers/mathematical_program.h"
+#include "drake/solvers/osqp_solver.h"
 #include "drake/solvers/solve.h"
 
+#include "multibody/kinematic/frame_kinematics_cache.h"
 #include "multibody/kinematic/kinematic_evaluator_set.h"
 #include "multibody/kinematic/world_point_evaluator.h"
 #include "systems/controllers/control_utils.h"
 #include "systems/controllers/osc/osc_tracking_data.h"
+#include "systems/controllers/osc/osc_workspace.h"
 #include "systems/framework/output_vector.h"
 
 namespace dairlib::systems::controllers {
@@ -151,16 +155,29 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
     return tracking_data_vec_->at(index);
   }
 
+  // Solver methods
+  /// Solve the QP with one OSQP instance that is created in Build() and kept
+  /// for the lifetime of the controller. The instance is warm-started with the
+  /// solution of the previous control tick, and `solver_options` is set once
+  /// instead of every tick. Must be called before Build().
+  void EnableOsqpWarmStart(const drake::solvers::SolverOptions& solver_options =
+                               drake::solvers::SolverOptions());
+
   // OSC LeafSystem builder
   void Build();
 
+  // The QP solved in every control tick (only valid after Build())
+  const drake::solvers::MathematicalProgram& get_prog() const {
+    return *prog_;
+  }
+
  private:
   // Osc checkers and constructor-related methods
   void CheckCostSettings();
   void CheckConstraintSettings();
 
   // Get solution of OSC
-  Eigen::VectorXd SolveQp(const Eigen::VectorXd& x_w_spr,
+  const Eigen::VectorXd& SolveQp(const Eigen::VectorXd& x_w_spr,
                           const Eigen::VectorXd& x_wo_spr,
                           const drake::systems::Context<double>& context,
                           double t, int fsm_state,
@@ -207,6 +224,13 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
   drake::systems::Context<double>* context_w_spr_;
   drake::systems::Context<double>* context_wo_spr_;
 
+  // Per-tick kinematics caches of the contexts, shared by the tracking data
+  // and the contact/holonomic evaluators
+  std::unique_ptr<multibody::FrameKinematicsCache<double>>
+      kinematics_cache_w_spr_;
+  std::unique_ptr<multibody::FrameKinematicsCache<double>>
+      kinematics_cache_wo_spr_;
+
   // Size of position, velocity and input of the MBP without spring
   int n_q_;
   int n_v_;
@@ -241,12 +265,27 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
   drake::solvers::VectorXDecisionVariable lambda_c_;
   drake::solvers::VectorXDecisionVariable lambda_h_;
   drake::solvers::VectorXDecisionVariable epsilon_;
+  // Indices of the first element of each decision variable in the solution
+  int dv_start_;
+  int u_start_;
+  int lambda_c_start_;
+  int lambda_h_start_;
+  int epsilon_start_;
   // Cost and constraints
   drake::solvers::LinearEqualityConstraint* dynamics_constraint_;
   drake::solvers::LinearEqualityConstraint* holonomic_constraint_;
   drake::solvers::LinearEqualityConstraint* contact_constraints_;
   std::vector<drake::solvers::LinearConstraint*> friction_constraints_;
-  std::vector<drake::solvers::QuadraticCost*> tracking_cost_;
+  drake::solvers::QuadraticCost* tracking_cost_;
+
+  // Persistent QP solver (only used when warm start is enabled)
+  bool warm_start_qp_ = false;
+  // The initial guess of the solver, i.e. the previous QP solution, is kept in
+  // prog_
+  std::unique_ptr<drake::solvers::OsqpSolver> solver_;
+  std::optional<drake::solvers::SolverOptions> solver_options_;
+  // Result of the last QP solve, reused across control ticks
+  std::unique_ptr<drake::solvers::MathematicalProgramResult> result_;
 
   // OSC solution
   std::unique_ptr<Eigen::VectorXd> dv_sol_;
@@ -279,9 +318,18 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
   std::unique_ptr<std::vector<OscTrackingData*>> tracking_data_vec_ =
       std::make_unique<std::vector<OscTrackingData*>>();
 
+  // Map finite state machine state to the indices of the tracking data that
+  // are active in that state (computed in Build()). States that are not in
+  // the map use default_active_tracking_data_.
+  std::map<int, std::vector<int>> active_tracking_data_map_;
+  std::vector<int> default_active_tracking_data_;
+
   // Fixed position of constant trajectories
   std::vector<Eigen::VectorXd> fixed_position_vec_;
 
+  // Preallocated intermediate matrices and vectors of one control tick
+  std::unique_ptr<OscWorkspace> workspace_;
+
   // Set a period during which we apply control (Unit: seconds)
   // Let t be the elapsed time since fsm switched to a new state.
   // We only apply the control when t_s <= t <= t_e
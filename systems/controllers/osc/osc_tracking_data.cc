@@ -8,7 +8,6 @@
 using std::cout;
 using std::endl;
 
-using drake::multibody::JacobianWrtVariable;
 using drake::multibody::MultibodyPlant;
 using drake::systems::Context;
 using Eigen::Isometry3d;
@@ -39,7 +38,16 @@ OscTrackingData::OscTrackingData(const string& name, int n_y, int n_ydot,
       n_ydot_(n_ydot),
       K_p_(K_p),
       K_d_(K_d),
-      W_(W) {}
+      W_(W),
+      own_cache_w_spr_(
+          std::make_unique<multibody::FrameKinematicsCache<double>>(
+              plant_w_spr)),
+      own_cache_wo_spr_(
+          std::make_unique<multibody::FrameKinematicsCache<double>>(
+              plant_wo_spr)) {
+  cache_w_spr_ = own_cache_w_spr_.get();
+  cache_wo_spr_ = own_cache_wo_spr_.get();
+}
 
 // Update
 bool OscTrackingData::Update(
@@ -58,20 +66,54 @@ bool OscTrackingData::Update(
     ydot_des_ = traj.EvalDerivative(t, 1);
     yddot_des_ = traj.EvalDerivative(t, 2);
 
-    // Update feedback output (Calling virtual methods)
-    UpdateYAndError(x_w_spr, context_w_spr);
-    UpdateYdotAndError(x_w_spr, context_w_spr);
-    UpdateYddotDes();
-    UpdateJ(x_wo_spr, context_wo_spr);
-    UpdateJdotV(x_wo_spr, context_wo_spr);
+    UpdateFeedbackAndCommand(x_w_spr, context_w_spr, x_wo_spr, context_wo_spr);
+  }
+  return track_at_current_state_;
+}
 
-    // Update command output (desired output with pd control)
-    yddot_command_ =
-        yddot_des_converted_ + K_p_ * (error_y_) + K_d_ * (error_ydot_);
+bool OscTrackingData::Update(const VectorXd& x_w_spr,
+                             const Context<double>& context_w_spr,
+                             const VectorXd& x_wo_spr,
+                             const Context<double>& context_wo_spr,
+                             const VectorXd& y_des,
+                             int finite_state_machine_state) {
+  UpdateTrackingFlag(finite_state_machine_state);
+
+  if (track_at_current_state_) {
+    DRAKE_DEMAND(y_des.size() == n_y_);
+    y_des_ = y_des;
+    ydot_des_.setZero(n_y_);
+    yddot_des_.setZero(n_y_);
+
+    UpdateFeedbackAndCommand(x_w_spr, context_w_spr, x_wo_spr, context_wo_spr);
   }
   return track_at_current_state_;
 }
 
+void OscTrackingData::UpdateFeedbackAndCommand(
+    const VectorXd& x_w_spr, const Context<double>& context_w_spr,
+    const VectorXd& x_wo_spr, const Context<double>& context_wo_spr) {
+  // The own caches don't know whether the state changed since the last call
+  if (cache_w_spr_ == own_cache_w_spr_.get()) {
+    own_cache_w_spr_->Invalidate();
+  }
+  if (cache_wo_spr_ == own_cache_wo_spr_.get()) {
+    own_cache_wo_spr_->Invalidate();
+  }
+
+  // Update feedback output (Calling virtual methods)
+  UpdateYAndError(x_w_spr, context_w_spr);
+  UpdateYdotAndError(x_w_spr, context_w_spr);
+  UpdateYddotDes();
+  UpdateJ(x_wo_spr, context_wo_spr);
+  UpdateJdotV(x_wo_spr, context_wo_spr);
+
+  // Update command output (desired output with pd control)
+  yddot_command_ = yddot_des_converted_;
+  yddot_command_.noalias() += K_p_ * error_y_;
+  yddot_command_.noalias() += K_d_ * error_ydot_;
+}
+
 void OscTrackingData::UpdateTrackingFlag(int finite_state_machine_state) {
   if (state_.empty()) {
     track_at_current_state_ = true;
@@ -101,7 +143,17 @@ void OscTrackingData::PrintFeedbackAndDesiredValues(const VectorXd& dv) {
 
 void OscTrackingData::SaveYddotCommandSol(const VectorXd& dv) {
   DRAKE_ASSERT(track_at_current_state_);
-  yddot_command_sol_ = J_ * dv + JdotV_;
+  yddot_command_sol_ = JdotV_;
+  yddot_command_sol_.noalias() += J_ * dv;
+}
+
+void OscTrackingData::SetKinematicsCaches(
+    multibody::FrameKinematicsCache<double>* cache_w_spr,
+    multibody::FrameKinematicsCache<double>* cache_wo_spr) {
+  DRAKE_DEMAND(&cache_w_spr->plant() == &plant_w_spr_);
+  DRAKE_DEMAND(&cache_wo_spr->plant() == &plant_wo_spr_);
+  cache_w_spr_ = cache_w_spr;
+  cache_wo_spr_ = cache_wo_spr;
 }
 
 void OscTrackingData::AddState(int state) {
@@ -140,17 +192,14 @@ void ComTrackingData::AddStateToTrack(int state) { AddState(state); }
 
 void ComTrackingData::UpdateYAndError(const VectorXd& x_w_spr,
                                       const Context<double>& context_w_spr) {
-  y_ = plant_w_spr_.CalcCenterOfMassPosition(context_w_spr);
+  y_ = cache_w_spr_->EvalCenterOfMassPosition(context_w_spr);
   error_y_ = y_des_ - y_;
 }
 
 void ComTrackingData::UpdateYdotAndError(const VectorXd& x_w_spr,
                                          const Context<double>& context_w_spr) {
-  MatrixXd J_w_spr(kSpaceDim, plant_w_spr_.num_velocities());
-  plant_w_spr_.CalcJacobianCenterOfMassTranslationalVelocity(
-      context_w_spr, JacobianWrtVariable::kV, world_w_spr_, world_w_spr_,
-      &J_w_spr);
-  ydot_ = J_w_spr * x_w_spr.tail(plant_w_spr_.num_velocities());
+  ydot_.noalias() = cache_w_spr_->EvalJacobianCenterOfMass(context_w_spr) *
+                    x_w_spr.tail(plant_w_spr_.num_velocities());
   error_ydot_ = ydot_des_ - ydot_;
 }
 
@@ -158,15 +207,12 @@ void ComTrackingData::UpdateYddotDes() { yddot_des_converted_ = yddot_des_; }
 
 void ComTrackingData::UpdateJ(const VectorXd& x_wo_spr,
                               const Context<double>& context_wo_spr) {
-  J_ = MatrixXd::Zero(kSpaceDim, plant_wo_spr_.num_velocities());
-  plant_wo_spr_.CalcJacobianCenterOfMassTranslationalVelocity(
-      context_wo_spr, JacobianWrtVariable::kV, world_w_spr_, world_w_spr_, &J_);
+  J_ = cache_wo_spr_->EvalJacobianCenterOfMass(context_wo_spr);
 }
 
 void ComTrackingData::UpdateJdotV(const VectorXd& x_wo_spr,
                                   const Context<double>& context_wo_spr) {
-  JdotV_ = plant_wo_spr_.CalcBiasCenterOfMassTranslationalAcceleration(
-      context_wo_spr, JacobianWrtVariable::kV, world_wo_spr_, world_wo_spr_);
+  JdotV_ = cache_wo_spr_->EvalBiasCenterOfMassAcceleration(context_wo_spr);
 }
 
 void ComTrackingData::CheckDerivedOscTrackingData() {}
@@ -208,21 +254,18 @@ void TransTaskSpaceTrackingData::AddStateAndPointToTrack(
 
 void TransTaskSpaceTrackingData::UpdateYAndError(
     const VectorXd& x_w_spr, const Context<double>& context_w_spr) {
-  y_ = Vector3d::Zero();
-  plant_w_spr_.CalcPointsPositions(
-      context_w_spr, *body_frames_wo_spr_[GetStateIdx()],
-      pts_on_body_[GetStateIdx()], world_w_spr_, &y_);
+  y_ = cache_w_spr_->EvalPointPosition(context_w_spr,
+                                      *body_frames_w_spr_.at(GetStateIdx()),
+                                      pts_on_body_.at(GetStateIdx()));
   error_y_ = y_des_ - y_;
 }
 
 void TransTaskSpaceTrackingData::UpdateYdotAndError(
     const VectorXd& x_w_spr, const Context<double>& context_w_spr) {
-  MatrixXd J(kSpaceDim, plant_w_spr_.num_velocities());
-  plant_w_spr_.CalcJacobianTranslationalVelocity(
-      context_w_spr, JacobianWrtVariable::kV,
-      *body_frames_w_spr_.at(GetStateIdx()), pts_on_body_.at(GetStateIdx()),
-      world_w_spr_, world_w_spr_, &J);
-  ydot_ = J * x_w_spr.tail(plant_w_spr_.num_velocities());
+  ydot_.noalias() = cache_w_spr_->EvalJacobianTranslationalVelocity(
+                        context_w_spr, *body_frames_w_spr_.at(GetStateIdx()),
+                        pts_on_body_.at(GetStateIdx())) *
+                    x_w_spr.tail(plant_w_spr_.num_velocities());
   error_ydot_ = ydot_des_ - ydot_;
 }
 
@@ -232,19 +275,16 @@ void TransTaskSpaceTrackingData::UpdateYddotDes() {
 
 void TransTaskSpaceTrackingData::UpdateJ(
     const VectorXd& x_wo_spr, const Context<double>& context_wo_spr) {
-  J_ = MatrixXd::Zero(kSpaceDim, plant_wo_spr_.num_velocities());
-  plant_wo_spr_.CalcJacobianTranslationalVelocity(
-      context_wo_spr, JacobianWrtVariable::kV,
-      *body_frames_wo_spr_.at(GetStateIdx()), pts_on_body_.at(GetStateIdx()),
-      world_wo_spr_, world_wo_spr_, &J_);
+  J_ = cache_wo_spr_->EvalJacobianTranslationalVelocity(
+      context_wo_spr, *body_frames_wo_spr_.at(GetStateIdx()),
+      pts_on_body_.at(GetStateIdx()));
 }
 
 void TransTaskSpaceTrackingData::UpdateJdotV(
     const VectorXd& x_wo_spr, const Context<double>& context_wo_spr) {
-  JdotV_ = plant_wo_spr_.CalcBiasTranslationalAcceleration(
-      context_wo_spr, drake::multibody::JacobianWrtVariable::kV,
-      *body_frames_wo_spr_.at(GetStateIdx()), pts_on_body_.at(GetStateIdx()),
-      world_wo_spr_, world_wo_spr_);
+  JdotV_ = cache_wo_spr_->EvalBiasTranslationalAcceleration(
+      context_wo_spr, *body_frames_wo_spr_.at(GetStateIdx()),
+      pts_on_body_.at(GetStateIdx()));
 }
 
 void TransTaskSpaceTrackingData::CheckDerivedOscTrackingData() {
@@ -312,14 +352,10 @@ void RotTaskSpaceTrackingData::UpdateYAndError(
 
 void RotTaskSpaceTrackingData::UpdateYdotAndError(
     const VectorXd& x_w_spr, const Context<double>& context_w_spr) {
-  MatrixXd J_spatial(6, plant_w_spr_.num_velocities());
-  plant_w_spr_.CalcJacobianSpatialVelocity(
-      context_w_spr, JacobianWrtVariable::kV,
-      *body_frames_w_spr_.at(GetStateIdx()),
-      frame_pose_.at(GetStateIdx()).translation(), world_w_spr_, world_w_spr_,
-      &J_spatial);
-  ydot_ = J_spatial.block(0, 0, kSpaceDim, J_spatial.cols()) *
-          x_w_spr.tail(plant_w_spr_.num_velocities());
+  // The angular velocity doesn't depend on the point of the frame
+  ydot_.noalias() = cache_w_spr_->EvalJacobianAngularVelocity(
+                        context_w_spr, *body_frames_w_spr_.at(GetStateIdx())) *
+                    x_w_spr.tail(plant_w_spr_.num_velocities());
   // Transform qdot to w
   Quaterniond y_quat_des(y_des_(0), y_des_(1), y_des_(2), y_des_(3));
   Quaterniond dy_quat_des(ydot_des_(0), ydot_des_(1), ydot_des_(2),
@@ -339,24 +375,14 @@ void RotTaskSpaceTrackingData::UpdateYddotDes() {
 
 void RotTaskSpaceTrackingData::UpdateJ(const VectorXd& x_wo_spr,
                                        const Context<double>& context_wo_spr) {
-  MatrixXd J_spatial(6, plant_wo_spr_.num_velocities());
-  plant_wo_spr_.CalcJacobianSpatialVelocity(
-      context_wo_spr, JacobianWrtVariable::kV,
-      *body_frames_wo_spr_.at(GetStateIdx()),
-      frame_pose_.at(GetStateIdx()).translation(), world_wo_spr_, world_wo_spr_,
-      &J_spatial);
-  J_ = J_spatial.block(0, 0, kSpaceDim, J_spatial.cols());
+  J_ = cache_wo_spr_->EvalJacobianAngularVelocity(
+      context_wo_spr, *body_frames_wo_spr_.at(GetStateIdx()));
 }
 
 void RotTaskSpaceTrackingData::UpdateJdotV(
     const VectorXd& x_wo_spr, const Context<double>& context_wo_spr) {
-  JdotV_ = plant_wo_spr_
-               .CalcBiasSpatialAcceleration(
-                   context_wo_spr, JacobianWrtVariable::kV,
-                   *body_frames_wo_spr_.at(GetStateIdx()),
-                   frame_pose_.at(GetStateIdx()).translation(), world_wo_spr_,
-                   world_wo_spr_)
-               .rotational();
+  JdotV_ = cache_wo_spr_->EvalBiasAngularAcceleration(
+      context_wo_spr, *body_frames_wo_spr_.at(GetStateIdx()));
 }
 
 void RotTaskSpaceTrackingData::CheckDerivedOscTrackingData() {
@@ -407,9 +433,8 @@ void JointSpaceTrackingData::UpdateYAndError(
 
 void JointSpaceTrackingData::UpdateYdotAndError(
     const VectorXd& x_w_spr, const Context<double>& context_w_spr) {
-  MatrixXd J = MatrixXd::Zero(1, plant_w_spr_.num_velocities());
-  J(0, joint_vel_idx_w_spr_.at(GetStateIdx())) = 1;
-  ydot_ = J * x_w_spr.tail(plant_w_spr_.num_velocities());
+  ydot_ = x_w_spr.segment(
+      plant_w_spr_.num_positions() + joint_vel_idx_w_spr_.at(GetStateIdx()), 1);
   error_ydot_ = ydot_des_ - ydot_;
 }
 
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <Eigen/Dense>
 #include <drake/common/trajectories/trajectory.h>
 #include <drake/multibody/plant/multibody_plant.h>
 
+#include "multibody/kinematic/frame_kinematics_cache.h"
 #include "systems/framework/output_vector.h"
 
 namespace dairlib {
@@ -71,6 +73,8 @@ class OscTrackingData {
                   const drake::multibody::MultibodyPlant<double>& plant_w_spr,
                   const drake::multibody::MultibodyPlant<double>& plant_wo_spr);
 
+  virtual ~OscTrackingData() = default;
+
   // Update() updates the caches. It does the following things in order:
   //  - update track_at_current_state_
   //  - update desired output
@@ -90,6 +94,14 @@ class OscTrackingData {
               const drake::systems::Context<double>& context_wo_spr,
               const drake::trajectories::Trajectory<double>& traj, double t,
               int finite_state_machine_state);
+  // Same as Update() with a constant desired trajectory `y_des`, whose
+  // derivatives are zero. Doesn't evaluate a trajectory, so that it doesn't
+  // allocate memory once the outputs are sized.
+  bool Update(const Eigen::VectorXd& x_w_spr,
+              const drake::systems::Context<double>& context_w_spr,
+              const Eigen::VectorXd& x_wo_spr,
+              const drake::systems::Context<double>& context_wo_spr,
+              const Eigen::VectorXd& y_des, int finite_state_machine_state);
 
   // Getters for debugging
   const Eigen::VectorXd& GetY() const { return y_; }
@@ -117,6 +129,14 @@ class OscTrackingData {
   int GetYDim() const { return n_y_; };
   int GetYdotDim() const { return n_ydot_; };
   bool IsActive() const { return track_at_current_state_; }
+  // Returns the finite state machine states in which the tracking is enabled.
+  // If it's empty, the tracking is always on.
+  const std::vector<int>& GetStates() const { return state_; }
+
+  // Check if we should do tracking in the current state. Update() calls this
+  // too, so this only needs to be called directly to mark a tracking data
+  // inactive without evaluating its trajectory.
+  void UpdateTrackingFlag(int finite_state_machine_state);
 
   void SaveYddotCommandSol(const Eigen::VectorXd& dv);
 
@@ -127,6 +147,15 @@ class OscTrackingData {
   // correctly.
   void CheckOscTrackingData();
 
+  // Set the per-tick kinematics caches of the plants with and without springs.
+  // They are shared with the other tracking data and the contact/holonomic
+  // evaluators of the OSC, so that each Jacobian is computed once per tick.
+  // The caller invalidates them whenever the state changes. Without shared
+  // caches, every Update() queries the plants afresh.
+  void SetKinematicsCaches(
+      multibody::FrameKinematicsCache<double>* cache_w_spr,
+      multibody::FrameKinematicsCache<double>* cache_wo_spr);
+
  protected:
   int GetStateIdx() const { return state_idx_; };
   void AddState(int state);
@@ -165,9 +194,20 @@ class OscTrackingData {
   const drake::multibody::BodyFrame<double>& world_w_spr_;
   const drake::multibody::BodyFrame<double>& world_wo_spr_;
 
+  // Kinematics caches of plant_w_spr_ and plant_wo_spr_. They are the
+  // tracking data's own caches, invalidated on every Update(), unless shared
+  // ones were set.
+  multibody::FrameKinematicsCache<double>* cache_w_spr_;
+  multibody::FrameKinematicsCache<double>* cache_wo_spr_;
+
  private:
-  // Check if we should do tracking in the current state
-  void UpdateTrackingFlag(int finite_state_machine_state);
+  // Updates the feedback and command outputs of Update(), after the desired
+  // output is set
+  void UpdateFeedbackAndCommand(
+      const Eigen::VectorXd& x_w_spr,
+      const drake::systems::Context<double>& context_w_spr,
+      const Eigen::VectorXd& x_wo_spr,
+      const drake::systems::Context<double>& context_wo_spr);
 
   // Updaters of feedback output, jacobian and dJ/dt * v
   virtual void UpdateYAndError(
@@ -205,6 +245,10 @@ class OscTrackingData {
   // Store whether or not the tracking data is active
   bool track_at_current_state_;
   int state_idx_ = 0;
+
+  // Used when no shared caches are set
+  std::unique_ptr<multibody::FrameKinematicsCache<double>> own_cache_w_spr_;
+  std::unique_ptr<multibody::FrameKinematicsCache<double>> own_cache_wo_spr_;
 };
 
 /// ComTrackingData is used when we want to track center of mass trajectory.
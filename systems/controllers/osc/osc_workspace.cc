@@ -0,0 +1,86 @@
+#include "systems/controllers/osc/osc_workspace.h"
+
+#include <limits>
+
+#include "drake/common/drake_assert.h"
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+namespace dairlib {
+namespace systems {
+namespace controllers {
+
+OscWorkspace::OscWorkspace(int n_x_w_spr, int n_q, int n_v, int n_u, int n_h,
+                           int n_c, int n_c_active, int n_y_max,
+                           const MatrixXd& B)
+    : x_w_spr(VectorXd::Zero(n_x_w_spr)),
+      x_wo_spr(VectorXd::Zero(n_q + n_v)),
+      B(B),
+      M(MatrixXd::Zero(n_v, n_v)),
+      bias(VectorXd::Zero(n_v)),
+      grav(VectorXd::Zero(n_v)),
+      J_h(MatrixXd::Zero(n_h, n_v)),
+      JdotV_h(VectorXd::Zero(n_h)),
+      J_c(MatrixXd::Zero(n_c, n_v)),
+      JdotV_c(VectorXd::Zero(n_c)),
+      J_c_active(MatrixXd::Zero(n_c_active, n_v)),
+      JdotV_c_active(VectorXd::Zero(n_c_active)),
+      A_dyn(MatrixXd::Zero(n_v, n_v + n_c + n_h + n_u)),
+      b_dyn(VectorXd::Zero(n_v)),
+      b_h(VectorXd::Zero(n_h)),
+      A_c(MatrixXd::Zero(n_c_active, n_v + n_c_active)),
+      b_c(VectorXd::Zero(n_c_active)),
+      zero_lb(VectorXd::Zero(1)),
+      inf_lb(VectorXd::Constant(1, -std::numeric_limits<double>::infinity())),
+      H_tracking(MatrixXd::Zero(n_v, n_v)),
+      b_tracking(VectorXd::Zero(n_v)),
+      WJ_t(MatrixXd::Zero(n_y_max, n_v)),
+      error_t(VectorXd::Zero(n_y_max)),
+      W_error_t(VectorXd::Zero(n_y_max)),
+      u_sol(VectorXd::Zero(n_u)) {
+  DRAKE_DEMAND(B.rows() == n_v);
+  DRAKE_DEMAND(B.cols() == n_u);
+  // The epsilon block of the relaxed contact constraint never changes
+  A_c.rightCols(n_c_active).setIdentity();
+  // The actuation block of the dynamics constraint never changes
+  A_dyn.rightCols(n_u) = -B;
+}
+
+void OscWorkspace::UpdateDynamicsConstraint() {
+  const int n_v = M.rows();
+  const int n_c = J_c.rows();
+  const int n_h = J_h.rows();
+  A_dyn.leftCols(n_v) = M;
+  A_dyn.middleCols(n_v, n_c) = -J_c.transpose();
+  A_dyn.middleCols(n_v + n_c, n_h) = -J_h.transpose();
+  b_dyn = -bias;
+}
+
+void OscWorkspace::UpdateHolonomicConstraint() { b_h = -JdotV_h; }
+
+void OscWorkspace::UpdateContactConstraint() {
+  A_c.leftCols(J_c_active.cols()) = J_c_active;
+  b_c = -JdotV_c_active;
+}
+
+void OscWorkspace::ClearTrackingCost() {
+  H_tracking.setZero();
+  b_tracking.setZero();
+}
+
+void OscWorkspace::AddTrackingCost(const MatrixXd& J_t, const MatrixXd& W,
+                                   const VectorXd& JdotV_t,
+                                   const VectorXd& ddy_t) {
+  const int n_y = J_t.rows();
+  DRAKE_DEMAND(n_y <= WJ_t.rows());
+  WJ_t.topRows(n_y).noalias() = W * J_t;
+  H_tracking.noalias() += J_t.transpose() * WJ_t.topRows(n_y);
+  error_t.head(n_y) = JdotV_t - ddy_t;
+  W_error_t.head(n_y).noalias() = W * error_t.head(n_y);
+  b_tracking.noalias() += J_t.transpose() * W_error_t.head(n_y);
+}
+
+}  // namespace controllers
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+namespace dairlib {
+namespace systems {
+namespace controllers {
+
+/// OscWorkspace holds every intermediate matrix and vector that
+/// OperationalSpaceControl uses in one control tick. It is sized once in
+/// OperationalSpaceControl::Build(), and the methods below only write into the
+/// preallocated memory, so that assembling the QP does not allocate on the
+/// heap.
+
+/// Inputs of the constructor:
+///  - `n_x_w_spr` the size of the state of the plant with springs
+///  - `n_q`, `n_v`, `n_u` the sizes of position, velocity and input of the
+///    plant without springs
+///  - `n_h` the size of the holonomic constraint
+///  - `n_c`, `n_c_active` the sizes of total/active contact constraints
+///  - `n_y_max` the largest output (ydot) dimension among all tracking data
+///  - `B` the actuation matrix of the plant without springs, which is constant
+struct OscWorkspace {
+  OscWorkspace(int n_x_w_spr, int n_q, int n_v, int n_u, int n_h, int n_c,
+               int n_c_active, int n_y_max, const Eigen::MatrixXd& B);
+
+  /// Assembles the dynamics constraint
+  ///   [M, -J_c^T, -J_h^T, -B]*[dv, lambda_c, lambda_h, u]^T = - bias
+  /// from `M`, `bias`, `J_c` and `J_h`.
+  void UpdateDynamicsConstraint();
+
+  /// Assembles the holonomic constraint J_h*dv == -JdotV_h.
+  void UpdateHolonomicConstraint();
+
+  /// Assembles the relaxed contact constraint
+  ///   [J_c_active, I]* [dv, epsilon]^T == -JdotV_c_active
+  /// The identity block is written once in the constructor, and the hard
+  /// constraint J_c_active*dv == -JdotV_c_active uses `J_c_active` directly.
+  void UpdateContactConstraint();
+
+  /// Zeroes `H_tracking` and `b_tracking`.
+  void ClearTrackingCost();
+
+  /// Adds the tracking cost of one tracking data
+  ///   H = J_t^T * W * J_t,  b = J_t^T * W * (JdotV_t - ddy_t)
+  /// to `H_tracking` and `b_tracking`, so that all tracking data are combined
+  /// into one quadratic cost. Call ClearTrackingCost() before the first one.
+  void AddTrackingCost(const Eigen::MatrixXd& J_t, const Eigen::MatrixXd& W,
+                       const Eigen::VectorXd& JdotV_t,
+                       const Eigen::VectorXd& ddy_t);
+
+  // States of the plant with and without springs
+  Eigen::VectorXd x_w_spr;
+  Eigen::VectorXd x_wo_spr;
+
+  // Manipulator equation M*dv + bias == J_c^T*lambda_c + J_h^T*lambda_h + B*u
+  const Eigen::MatrixXd B;
+  Eigen::MatrixXd M;
+  Eigen::VectorXd bias;
+  Eigen::VectorXd grav;
+
+  // Holonomic constraint
+  Eigen::MatrixXd J_h;
+  Eigen::VectorXd JdotV_h;
+
+  // Contact constraint
+  Eigen::MatrixXd J_c;
+  Eigen::VectorXd JdotV_c;
+  Eigen::MatrixXd J_c_active;
+  Eigen::VectorXd JdotV_c_active;
+
+  // Coefficients of the QP constraints
+  Eigen::MatrixXd A_dyn;
+  Eigen::VectorXd b_dyn;
+  Eigen::VectorXd b_h;
+  Eigen::MatrixXd A_c;
+  Eigen::VectorXd b_c;
+
+  // Bounds of the friction constraints
+  const Eigen::VectorXd zero_lb;
+  const Eigen::VectorXd inf_lb;
+
+  // Coefficients of the tracking cost and its intermediate products
+  Eigen::MatrixXd H_tracking;
+  Eigen::VectorXd b_tracking;
+  Eigen::MatrixXd WJ_t;
+  Eigen::VectorXd error_t;
+  Eigen::VectorXd W_error_t;
+
+  // QP solution
+  Eigen::VectorXd u_sol;
+};
+
+}  // namespace controllers
+}  // namespace systems
+}  // namespace dairlib
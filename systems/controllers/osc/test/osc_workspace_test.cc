@@ -0,0 +1,250 @@
+#include <memory>
+#include <optional>
+#include <gtest/gtest.h>
+
+#include "common/find_resource.h"
+#include "systems/controllers/osc/operational_space_control.h"
+#include "systems/controllers/osc/osc_tracking_data.h"
+#include "systems/controllers/osc/osc_workspace.h"
+#include "systems/framework/output_vector.h"
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/common/test_utilities/limit_malloc.h"
+#include "drake/multibody/parsing/parser.h"
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/solvers/osqp_solver.h"
+
+namespace dairlib {
+namespace systems {
+namespace controllers {
+namespace {
+
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using drake::solvers::MathematicalProgramResult;
+using drake::solvers::OsqpSolver;
+using drake::solvers::SolverOptions;
+using drake::systems::Context;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+class OscWorkspaceTest : public ::testing::Test {
+ protected:
+  // Sizes similar to Cassie walking (fixed springs)
+  static constexpr int n_q_ = 19;
+  static constexpr int n_v_ = 18;
+  static constexpr int n_u_ = 10;
+  static constexpr int n_h_ = 2;
+  static constexpr int n_c_ = 12;
+  static constexpr int n_c_active_ = 10;
+  static constexpr int n_y_max_ = 3;
+
+  OscWorkspaceTest()
+      : B_(MatrixXd::Random(n_v_, n_u_)),
+        ws_(45, n_q_, n_v_, n_u_, n_h_, n_c_, n_c_active_, n_y_max_, B_) {
+    ws_.M = MatrixXd::Random(n_v_, n_v_);
+    ws_.bias = VectorXd::Random(n_v_);
+    ws_.J_h = MatrixXd::Random(n_h_, n_v_);
+    ws_.JdotV_h = VectorXd::Random(n_h_);
+    ws_.J_c = MatrixXd::Random(n_c_, n_v_);
+    ws_.J_c_active = MatrixXd::Random(n_c_active_, n_v_);
+    ws_.JdotV_c_active = VectorXd::Random(n_c_active_);
+  }
+
+  MatrixXd B_;
+  OscWorkspace ws_;
+};
+
+TEST_F(OscWorkspaceTest, AssemblyMatchesDenseExpressions) {
+  ws_.UpdateDynamicsConstraint();
+  MatrixXd A_dyn(n_v_, n_v_ + n_c_ + n_h_ + n_u_);
+  A_dyn << ws_.M, -ws_.J_c.transpose(), -ws_.J_h.transpose(), -B_;
+  EXPECT_TRUE(drake::CompareMatrices(ws_.A_dyn, A_dyn));
+  EXPECT_TRUE(drake::CompareMatrices(ws_.b_dyn, -ws_.bias));
+
+  ws_.UpdateContactConstraint();
+  MatrixXd A_c(n_c_active_, n_v_ + n_c_active_);
+  A_c << ws_.J_c_active, MatrixXd::Identity(n_c_active_, n_c_active_);
+  EXPECT_TRUE(drake::CompareMatrices(ws_.A_c, A_c));
+  EXPECT_TRUE(drake::CompareMatrices(ws_.b_c, -ws_.JdotV_c_active));
+
+  MatrixXd J_t = MatrixXd::Random(2, n_v_);
+  MatrixXd W = MatrixXd::Random(2, 2);
+  VectorXd JdotV_t = VectorXd::Random(2);
+  VectorXd ddy_t = VectorXd::Random(2);
+  ws_.ClearTrackingCost();
+  ws_.AddTrackingCost(J_t, W, JdotV_t, ddy_t);
+  EXPECT_TRUE(
+      drake::CompareMatrices(ws_.H_tracking, J_t.transpose() * W * J_t, 1e-12));
+  EXPECT_TRUE(drake::CompareMatrices(
+      ws_.b_tracking, J_t.transpose() * W * (JdotV_t - ddy_t), 1e-12));
+
+  // A second tracking data is summed into the same cost
+  MatrixXd J_t2 = MatrixXd::Random(1, n_v_);
+  MatrixXd W2 = MatrixXd::Random(1, 1);
+  VectorXd JdotV_t2 = VectorXd::Random(1);
+  VectorXd ddy_t2 = VectorXd::Random(1);
+  ws_.AddTrackingCost(J_t2, W2, JdotV_t2, ddy_t2);
+  EXPECT_TRUE(drake::CompareMatrices(
+      ws_.H_tracking,
+      J_t.transpose() * W * J_t + J_t2.transpose() * W2 * J_t2, 1e-12));
+  EXPECT_TRUE(drake::CompareMatrices(
+      ws_.b_tracking,
+      J_t.transpose() * W * (JdotV_t - ddy_t) +
+          J_t2.transpose() * W2 * (JdotV_t2 - ddy_t2),
+      1e-12));
+}
+
+// The steady-state assembly of the QP coefficients must not allocate.
+TEST_F(OscWorkspaceTest, AssemblyDoesNotAllocate) {
+  MatrixXd J_t = MatrixXd::Random(n_y_max_, n_v_);
+  MatrixXd W = MatrixXd::Identity(n_y_max_, n_y_max_);
+  VectorXd JdotV_t = VectorXd::Random(n_y_max_);
+  VectorXd ddy_t = VectorXd::Random(n_y_max_);
+
+  drake::test::LimitMalloc guard;
+  for (int i = 0; i < 10; i++) {
+    ws_.UpdateDynamicsConstraint();
+    ws_.UpdateHolonomicConstraint();
+    ws_.UpdateContactConstraint();
+    ws_.ClearTrackingCost();
+    ws_.AddTrackingCost(J_t, W, JdotV_t, ddy_t);
+  }
+}
+
+// One full control tick of the OSC (kinematics, QP assembly and a warm-started
+// OSQP solve) on the planar walker.
+class OscTickTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    Parser parser(plant_.get());
+    parser.AddModelFromFile(
+        FindResourceOrThrow("examples/PlanarWalker/PlanarWalker.urdf"));
+    plant_->WeldFrames(plant_->world_frame(), plant_->GetFrameByName("base"),
+                       drake::math::RigidTransform<double>());
+    plant_->Finalize();
+    plant_context_ = plant_->CreateDefaultContext();
+
+    int n_v = plant_->num_velocities();
+    int n_u = plant_->num_actuators();
+    // The planar walker has no springs, so the same plant is used as the model
+    // with and without springs.
+    osc_ = std::make_unique<OperationalSpaceControl>(
+        *plant_, *plant_, plant_context_.get(), plant_context_.get(), false);
+    osc_->SetInputCost(0.01 * MatrixXd::Identity(n_u, n_u));
+    osc_->SetAccelerationCostForAllJoints(0.01 * MatrixXd::Identity(n_v, n_v));
+    hip_traj_ = std::make_unique<JointSpaceTrackingData>(
+        "hip_traj", 100 * MatrixXd::Ones(1, 1), 10 * MatrixXd::Ones(1, 1),
+        MatrixXd::Ones(1, 1), *plant_, *plant_);
+    hip_traj_->AddJointToTrack("hip_pin", "hip_pindot");
+    osc_->AddConstTrackingData(hip_traj_.get(), 0.3 * VectorXd::Ones(1));
+    osc_->EnableOsqpWarmStart();
+    osc_->Build();
+
+    context_ = osc_->CreateDefaultContext();
+    OutputVector<double> robot_output(plant_->num_positions(), n_v, n_u);
+    robot_output.SetPositions(VectorXd::Zero(plant_->num_positions()));
+    robot_output.SetVelocities(VectorXd::Zero(n_v));
+    robot_output.SetEfforts(VectorXd::Zero(n_u));
+    robot_output.set_timestamp(0.1);
+    osc_->get_robot_output_input_port().FixValue(context_.get(), robot_output);
+    output_ = osc_->get_osc_output_port().Allocate();
+  }
+
+  const VectorXd& Tick() {
+    // Calc() bypasses the output port cache, so every call is a full tick
+    osc_->get_osc_output_port().Calc(*context_, output_.get());
+    return output_->get_value<drake::systems::BasicVector<double>>().value();
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  std::unique_ptr<Context<double>> plant_context_;
+  std::unique_ptr<JointSpaceTrackingData> hip_traj_;
+  std::unique_ptr<OperationalSpaceControl> osc_;
+  std::unique_ptr<Context<double>> context_;
+  std::unique_ptr<drake::AbstractValue> output_;
+};
+
+// After warm-up, a full tick allocates only inside the Drake calls below,
+// which have no allocation-free form:
+//  - MultibodyPlant::CalcMassMatrixViaInverseDynamics, CalcBiasTerm and
+//    CalcGravityGeneralizedForces, which allocate their temporaries (and the
+//    latter its result)
+//  - OsqpSolver::Solve, which converts the MathematicalProgram into a new OSQP
+//    instance
+// They are repeated here on the same state and QP, and the tick must allocate
+// exactly as many times as they do. The OSC-owned kinematics, the tracking
+// data and the QP assembly add none.
+TEST_F(OscTickTest, FullTickOnlyAllocatesInDrake) {
+  Tick();
+  const VectorXd u_warm_up = Tick();
+  ASSERT_TRUE(u_warm_up.allFinite());
+
+  VectorXd u(u_warm_up.size());
+  int num_tick_allocations;
+  {
+    drake::test::LimitMalloc guard({.max_num_allocations = -1});
+    u = Tick();
+    num_tick_allocations = guard.num_allocations();
+  }
+  // The state did not change, and the solve starts from the previous solution
+  EXPECT_TRUE(drake::CompareMatrices(u, u_warm_up, 1e-6));
+
+  const int n_v = plant_->num_velocities();
+  MatrixXd M(n_v, n_v);
+  VectorXd bias(n_v);
+  const OsqpSolver solver;
+  SolverOptions options;
+  options.SetOption(OsqpSolver::id(), "warm_start", 1);
+  const std::optional<SolverOptions> solver_options(options);
+  MathematicalProgramResult result;
+  solver.Solve(osc_->get_prog(), std::nullopt, solver_options, &result);
+  int num_drake_allocations;
+  {
+    drake::test::LimitMalloc guard({.max_num_allocations = -1});
+    plant_->CalcMassMatrixViaInverseDynamics(*plant_context_, &M);
+    plant_->CalcBiasTerm(*plant_context_, &bias);
+    const VectorXd grav = plant_->CalcGravityGeneralizedForces(*plant_context_);
+    solver.Solve(osc_->get_prog(), std::nullopt, solver_options, &result);
+    num_drake_allocations = guard.num_allocations();
+  }
+  EXPECT_GT(num_drake_allocations, 0);
+  EXPECT_EQ(num_tick_allocations, num_drake_allocations);
+}
+
+// A tracking data used outside of the OSC, without shared kinematics caches,
+// queries the plant on every update
+TEST_F(OscTickTest, TrackingDataWithoutSharedCaches) {
+  TransTaskSpaceTrackingData foot_traj(
+      "foot_traj", MatrixXd::Identity(3, 3), MatrixXd::Identity(3, 3),
+      MatrixXd::Identity(3, 3), *plant_, *plant_);
+  const Eigen::Vector3d pt(0, 0, -0.5);
+  foot_traj.AddPointToTrack("left_lower_leg", pt);
+  const drake::trajectories::PiecewisePolynomial<double> traj(
+      VectorXd::Zero(3));
+  const auto& frame = plant_->GetFrameByName("left_lower_leg");
+
+  for (int i = 0; i < 2; i++) {
+    VectorXd x = VectorXd::Random(plant_->num_positions() +
+                                  plant_->num_velocities());
+    plant_->SetPositionsAndVelocities(plant_context_.get(), x);
+    ASSERT_TRUE(foot_traj.Update(x, *plant_context_, x, *plant_context_, traj,
+                                 0, -1));
+
+    Eigen::Vector3d y;
+    plant_->CalcPointsPositions(*plant_context_, frame, pt,
+                                plant_->world_frame(), &y);
+    MatrixXd J(3, plant_->num_velocities());
+    plant_->CalcJacobianTranslationalVelocity(
+        *plant_context_, drake::multibody::JacobianWrtVariable::kV, frame, pt,
+        plant_->world_frame(), plant_->world_frame(), &J);
+    EXPECT_TRUE(drake::CompareMatrices(foot_traj.GetY(), y, 1e-12));
+    EXPECT_TRUE(drake::CompareMatrices(foot_traj.GetJ(), J, 1e-12));
+  }
+}
+
+}  // namespace
+}  // namespace controllers
+}  // namespace systems
+}  // namespace dairlib
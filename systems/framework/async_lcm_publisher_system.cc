@@ -0,0 +1,114 @@
+#include "systems/framework/async_lcm_publisher_system.h"
+
+#include <utility>
+
+namespace dairlib {
+namespace systems {
+
+using drake::AbstractValue;
+using drake::lcm::DrakeLcmInterface;
+using drake::systems::Context;
+using drake::systems::EventStatus;
+using drake::systems::TriggerType;
+using drake::systems::lcm::SerializerInterface;
+using drake::systems::lcm::TriggerTypeSet;
+
+AsyncLcmPublisherSystem::AsyncLcmPublisherSystem(
+    const std::string& channel, std::unique_ptr<SerializerInterface> serializer,
+    DrakeLcmInterface* lcm, const TriggerTypeSet& publish_triggers,
+    double publish_period)
+    : channel_(channel), serializer_(std::move(serializer)), lcm_(lcm) {
+  DRAKE_DEMAND(serializer_ != nullptr);
+  DRAKE_DEMAND(lcm_ != nullptr);
+  DRAKE_DEMAND(!publish_triggers.empty());
+  for (const auto& trigger : publish_triggers) {
+    DRAKE_DEMAND((trigger == TriggerType::kForced) ||
+                 (trigger == TriggerType::kPeriodic) ||
+                 (trigger == TriggerType::kPerStep));
+  }
+
+  DeclareAbstractInputPort(channel_, *serializer_->CreateDefaultValue());
+  set_name("AsyncLcmPublisherSystem(" + channel_ + ")");
+
+  if (publish_triggers.count(TriggerType::kForced)) {
+    DeclareForcedPublishEvent(&AsyncLcmPublisherSystem::PublishInputAsMessage);
+  }
+  if (publish_triggers.count(TriggerType::kPeriodic)) {
+    DRAKE_DEMAND(publish_period > 0);
+    DeclarePeriodicPublishEvent(publish_period, 0.0,
+                                &AsyncLcmPublisherSystem::PublishInputAsMessage);
+  } else {
+    DRAKE_DEMAND(publish_period == 0);
+  }
+  if (publish_triggers.count(TriggerType::kPerStep)) {
+    DeclarePerStepEvent(drake::systems::PublishEvent<double>(
+        [this](const Context<double>& context,
+               const drake::systems::PublishEvent<double>&) {
+          this->PublishInputAsMessage(context);
+        }));
+  }
+
+  writing_.message = serializer_->CreateDefaultValue();
+  pending_.message = serializer_->CreateDefaultValue();
+  sending_.message = serializer_->CreateDefaultValue();
+  thread_ = std::thread(&AsyncLcmPublisherSystem::SendLoop, this);
+}
+
+AsyncLcmPublisherSystem::~AsyncLcmPublisherSystem() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_variable_.notify_all();
+  thread_.join();
+}
+
+EventStatus AsyncLcmPublisherSystem::PublishInputAsMessage(
+    const Context<double>& context) const {
+  // Copy-assign the message into writing_, reusing its storage, then swap it
+  // with pending_
+  writing_.message->SetFrom(get_input_port(0).EvalAbstract(context));
+  writing_.time = context.get_time();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::swap(writing_, pending_);
+    if (has_pending_) {
+      num_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    has_pending_ = true;
+  }
+  condition_variable_.notify_all();
+  return EventStatus::Succeeded();
+}
+
+void AsyncLcmPublisherSystem::SendLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    condition_variable_.wait(lock,
+                             [this]() { return stop_ || has_pending_; });
+    if (!has_pending_) {
+      return;
+    }
+    std::swap(pending_, sending_);
+    has_pending_ = false;
+    is_sending_ = true;
+    lock.unlock();
+
+    serializer_->Serialize(*sending_.message, &bytes_);
+    lcm_->Publish(channel_, bytes_.data(), bytes_.size(), sending_.time);
+    num_published_.fetch_add(1, std::memory_order_relaxed);
+
+    lock.lock();
+    is_sending_ = false;
+    condition_variable_.notify_all();
+  }
+}
+
+void AsyncLcmPublisherSystem::Flush() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  condition_variable_.wait(
+      lock, [this]() { return !has_pending_ && !is_sending_; });
+}
+
+}  // namespace systems
+}  // namespace dairlib
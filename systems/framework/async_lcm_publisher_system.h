@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "drake/common/drake_copyable.h"
+#include "drake/lcm/drake_lcm_interface.h"
+#include "drake/systems/framework/leaf_system.h"
+#include "drake/systems/lcm/lcm_publisher_system.h"
+#include "drake/systems/lcm/serializer.h"
+
+namespace dairlib {
+namespace systems {
+
+/// A drop-in replacement for LcmPublisherSystem for telemetry (debug and
+/// network channels), which keeps the encoding and sending of messages off
+/// the thread running the diagram.
+///
+/// A publish event only copies the input message into a preallocated buffer,
+/// which reuses the storage of earlier messages, and hands the buffer to a
+/// background thread. That thread encodes the message into a reused byte
+/// buffer and publishes it. The handoff is double-buffered: if a message is
+/// published while the previous one is still waiting for the thread, the
+/// older one is dropped (and counted by get_num_dropped()), so a slow network
+/// or a burst of forced publishes never blocks the diagram.
+///
+/// The background thread is started by the constructor, before a driven loop
+/// applies its real-time settings, so it keeps the default scheduler and
+/// affinity. The `lcm` must outlive this system, and its Publish() must be
+/// thread-safe, as with DrakeLcm and ShmLcm.
+class AsyncLcmPublisherSystem : public drake::systems::LeafSystem<double> {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(AsyncLcmPublisherSystem)
+
+  /// See LcmPublisherSystem::Make()
+  template <typename LcmMessage>
+  static std::unique_ptr<AsyncLcmPublisherSystem> Make(
+      const std::string& channel, drake::lcm::DrakeLcmInterface* lcm,
+      const drake::systems::lcm::TriggerTypeSet& publish_triggers,
+      double publish_period = 0.0) {
+    return std::make_unique<AsyncLcmPublisherSystem>(
+        channel,
+        std::make_unique<drake::systems::lcm::Serializer<LcmMessage>>(), lcm,
+        publish_triggers, publish_period);
+  }
+
+  /// Publishes periodically, as LcmPublisherSystem::Make() with a period
+  template <typename LcmMessage>
+  static std::unique_ptr<AsyncLcmPublisherSystem> Make(
+      const std::string& channel, drake::lcm::DrakeLcmInterface* lcm,
+      double publish_period) {
+    return Make<LcmMessage>(channel, lcm,
+                            {drake::systems::TriggerType::kPeriodic},
+                            publish_period);
+  }
+
+  /// @param publish_period Period of the periodic publish, which must be
+  ///   positive if and only if publish_triggers contains kPeriodic
+  AsyncLcmPublisherSystem(
+      const std::string& channel,
+      std::unique_ptr<drake::systems::lcm::SerializerInterface> serializer,
+      drake::lcm::DrakeLcmInterface* lcm,
+      const drake::systems::lcm::TriggerTypeSet& publish_triggers,
+      double publish_period = 0.0);
+
+  /// Sends the message which is still waiting, if any, and stops the thread
+  ~AsyncLcmPublisherSystem() override;
+
+  const std::string& get_channel_name() const { return channel_; }
+
+  /// Number of messages which were replaced by a newer one before the
+  /// background thread could send them
+  int64_t get_num_dropped() const {
+    return num_dropped_.load(std::memory_order_relaxed);
+  }
+
+  /// Number of messages which were sent
+  int64_t get_num_published() const {
+    return num_published_.load(std::memory_order_relaxed);
+  }
+
+  /// Blocks until the messages handed to the thread so far are sent
+  void Flush() const;
+
+ private:
+  // A message, and the context time it was published at
+  struct Snapshot {
+    std::unique_ptr<drake::AbstractValue> message;
+    double time{0};
+  };
+
+  drake::systems::EventStatus PublishInputAsMessage(
+      const drake::systems::Context<double>& context) const;
+  void SendLoop();
+
+  const std::string channel_;
+  const std::unique_ptr<drake::systems::lcm::SerializerInterface> serializer_;
+  drake::lcm::DrakeLcmInterface* const lcm_;
+
+  // writing_ is only used by publish events, and sending_ by the thread.
+  // pending_ is handed between them under mutex_.
+  mutable Snapshot writing_;
+  mutable Snapshot pending_;
+  Snapshot sending_;
+  mutable bool has_pending_{false};
+  mutable bool is_sending_{false};
+  bool stop_{false};
+  mutable std::mutex mutex_;
+  mutable std::condition_variable condition_variable_;
+
+  std::vector<uint8_t> bytes_;
+  mutable std::atomic<int64_t> num_dropped_{0};
+  std::atomic<int64_t> num_published_{0};
+  std::thread thread_;
+};
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,109 @@
+#include "systems/framework/in_memory_channel.h"
+
+#include <chrono>
+#include <optional>
+
+namespace dairlib {
+namespace systems {
+
+using std::string;
+using std::vector;
+
+int64_t InMemoryChannelBase::WaitForMessage(int64_t old_sequence,
+                                            bool spin) const {
+  if (spin) {
+    int64_t current;
+    while ((current = sequence()) <= old_sequence) {
+    }
+    return current;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  condition_variable_.wait(
+      lock, [this, old_sequence]() { return sequence() > old_sequence; });
+  return sequence();
+}
+
+void InMemoryChannelBase::Commit(std::shared_ptr<const void> message) {
+  const int64_t publish_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+  if (bus_->tap_enabled_.load(std::memory_order_acquire)) {
+    bus_->Tap(this, message);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    latest_ = std::move(message);
+    latest_publish_ns_ = publish_ns;
+    sequence_.fetch_add(1, std::memory_order_release);
+  }
+  condition_variable_.notify_all();
+}
+
+InMemoryBus::~InMemoryBus() { StopLcmTap(); }
+
+vector<string> InMemoryBus::GetChannelNames() const {
+  std::lock_guard<std::mutex> lock(channels_mutex_);
+  vector<string> names;
+  for (const auto& channel : channels_) {
+    names.push_back(channel.first);
+  }
+  return names;
+}
+
+void InMemoryBus::StartLcmTap(drake::lcm::DrakeLcmInterface* lcm,
+                              int capacity) {
+  DRAKE_DEMAND(lcm != nullptr);
+  DRAKE_DEMAND(capacity > 0);
+  DRAKE_DEMAND(!tap_thread_.joinable());
+  tap_capacity_ = capacity;
+  tap_thread_ = std::thread([this, lcm]() {
+    vector<uint8_t> bytes;
+    std::unique_lock<std::mutex> lock(tap_mutex_);
+    while (true) {
+      tap_condition_variable_.wait(
+          lock, [this]() { return stop_tap_ || !tap_queue_.empty(); });
+      if (tap_queue_.empty()) {
+        return;
+      }
+      const TapEntry entry = std::move(tap_queue_.front());
+      tap_queue_.pop_front();
+      lock.unlock();
+      entry.channel->Encode(entry.message.get(), &bytes);
+      lcm->Publish(entry.channel->name(), bytes.data(), bytes.size(),
+                   std::nullopt);
+      lock.lock();
+    }
+  });
+  tap_enabled_.store(true, std::memory_order_release);
+}
+
+void InMemoryBus::Tap(const InMemoryChannelBase* channel,
+                      const std::shared_ptr<const void>& message) {
+  {
+    std::lock_guard<std::mutex> lock(tap_mutex_);
+    if (tap_queue_.size() >= tap_capacity_) {
+      num_tap_dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    tap_queue_.push_back({channel, message});
+  }
+  tap_condition_variable_.notify_one();
+}
+
+void InMemoryBus::StopLcmTap() {
+  if (!tap_thread_.joinable()) {
+    return;
+  }
+  tap_enabled_.store(false, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(tap_mutex_);
+    stop_tap_ = true;
+  }
+  tap_condition_variable_.notify_all();
+  // The tap drains its queue before stopping
+  tap_thread_.join();
+}
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#include "drake/common/drake_assert.h"
+#include "drake/common/drake_copyable.h"
+#include "drake/common/nice_type_name.h"
+#include "drake/lcm/drake_lcm_interface.h"
+
+namespace dairlib {
+namespace systems {
+
+class InMemoryBus;
+
+/// The type-independent part of an InMemoryChannel
+class InMemoryChannelBase {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(InMemoryChannelBase)
+
+  virtual ~InMemoryChannelBase() = default;
+
+  const std::string& name() const { return name_; }
+
+  virtual const std::type_info& message_type() const = 0;
+
+  /// Sequence number of the latest message, counting from 1, or 0 if nothing
+  /// has been published
+  int64_t sequence() const {
+    return sequence_.load(std::memory_order_acquire);
+  }
+
+  /// Blocks until a message newer than old_sequence is published, and returns
+  /// its sequence number. With spin set, polls without sleeping.
+  int64_t WaitForMessage(int64_t old_sequence, bool spin = false) const;
+
+ protected:
+  InMemoryChannelBase(InMemoryBus* bus, const std::string& name)
+      : bus_(bus), name_(name) {}
+
+  // Makes message the latest, wakes any waiting subscribers, and queues it
+  // for the bus' LCM tap
+  void Commit(std::shared_ptr<const void> message);
+
+  // Encodes a message of this channel as LCM bytes, for the tap
+  virtual void Encode(const void* message,
+                      std::vector<uint8_t>* bytes) const = 0;
+
+  // Guards the latest message and sequence_ updates, and the condition
+  // variable
+  mutable std::mutex mutex_;
+  std::shared_ptr<const void> latest_;
+  int64_t latest_publish_ns_ = 0;
+
+ private:
+  friend class InMemoryBus;
+
+  InMemoryBus* const bus_;
+  const std::string name_;
+  std::atomic<int64_t> sequence_{0};
+  mutable std::condition_variable condition_variable_;
+};
+
+/// InMemoryChannel carries messages of one LCM type between systems (and
+/// threads) of the same process, with the semantics of an LCM channel: any
+/// number of publishers and subscribers, and subscribers which only care about
+/// the latest message see it with a sequence number to detect new ones.
+///
+/// Messages are not encoded. Publish() copies a message into a buffer of the
+/// channel's pool which nobody holds, and subscribers share that buffer
+/// read-only through a shared_ptr. A buffer returns to the pool once the
+/// last reference to it is dropped, so with message types whose vectors keep
+/// their capacity (e.g. LCM types), a warm channel publishes without
+/// allocating.
+template <typename T>
+class InMemoryChannel final : public InMemoryChannelBase {
+ public:
+  const std::type_info& message_type() const final { return typeid(T); }
+
+  void Publish(const T& message) {
+    std::shared_ptr<T> buffer;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      // A buffer only the pool refers to can't gain a reference except
+      // through the pool or latest_, both guarded by the mutex
+      for (const auto& candidate : pool_) {
+        if (candidate.use_count() == 1) {
+          // use_count() is a relaxed load, so this orders the last holder's
+          // reads of the message, before it released its reference, before
+          // the buffer is overwritten
+          std::atomic_thread_fence(std::memory_order_acquire);
+          buffer = candidate;
+          break;
+        }
+      }
+      if (buffer == nullptr) {
+        buffer = std::make_shared<T>();
+        pool_.push_back(buffer);
+      }
+    }
+    *buffer = message;
+    Commit(std::move(buffer));
+  }
+
+  /// The latest message, or nullptr if nothing has been published. The message
+  /// is not modified while the pointer is held. If given, sequence and
+  /// publish_ns are set to the message's sequence number and the steady clock
+  /// time (in nanoseconds) at which it was published.
+  std::shared_ptr<const T> GetLatest(int64_t* sequence = nullptr,
+                                     int64_t* publish_ns = nullptr) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sequence != nullptr) {
+      *sequence = this->sequence();
+    }
+    if (publish_ns != nullptr) {
+      *publish_ns = latest_publish_ns_;
+    }
+    return std::static_pointer_cast<const T>(latest_);
+  }
+
+ private:
+  friend class InMemoryBus;
+
+  InMemoryChannel(InMemoryBus* bus, const std::string& name)
+      : InMemoryChannelBase(bus, name) {}
+
+  void Encode(const void* message, std::vector<uint8_t>* bytes) const final {
+    const T& msg = *static_cast<const T*>(message);
+    bytes->resize(msg.getEncodedSize());
+    msg.encode(bytes->data(), 0, bytes->size());
+  }
+
+  std::vector<std::shared_ptr<T>> pool_;
+};
+
+/// A set of InMemoryChannels, by name, shared by the diagrams of one process.
+///
+/// The bus can tap every channel for logging: StartLcmTap() starts a
+/// background thread which encodes each published message and publishes it
+/// on an LCM instance under its channel's name, so lcm-logger and other tools
+/// see the same channels as when the diagrams run as separate processes. The
+/// tap holds a reference to queued messages, so publishers never wait for it
+/// and never copy for it. If the tap falls behind by its queue's capacity,
+/// messages are dropped from the log (see GetNumTapDropped()).
+class InMemoryBus {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(InMemoryBus)
+
+  InMemoryBus() = default;
+  ~InMemoryBus();
+
+  /// Returns the channel with the given name, creating it if needed. Throws if
+  /// the channel exists with a different message type.
+  template <typename T>
+  InMemoryChannel<T>* GetChannel(const std::string& name) {
+    std::lock_guard<std::mutex> lock(channels_mutex_);
+    auto& channel = channels_[name];
+    if (channel == nullptr) {
+      channel.reset(new InMemoryChannel<T>(this, name));
+    } else if (channel->message_type() != typeid(T)) {
+      throw std::runtime_error(
+          "InMemoryBus channel " + name + " carries " +
+          drake::NiceTypeName::Get(channel->message_type()) + ", not " +
+          drake::NiceTypeName::Get<T>());
+    }
+    return static_cast<InMemoryChannel<T>*>(channel.get());
+  }
+
+  /// Names of the channels, sorted
+  std::vector<std::string> GetChannelNames() const;
+
+  /// Republishes every message on lcm, which must outlive the bus, from a
+  /// background thread, keeping up to capacity messages queued
+  void StartLcmTap(drake::lcm::DrakeLcmInterface* lcm, int capacity = 1024);
+
+  /// Messages which the tap had to drop because its queue was full
+  int64_t GetNumTapDropped() const { return num_tap_dropped_.load(); }
+
+ private:
+  friend class InMemoryChannelBase;
+
+  struct TapEntry {
+    const InMemoryChannelBase* channel;
+    std::shared_ptr<const void> message;
+  };
+
+  void Tap(const InMemoryChannelBase* channel,
+           const std::shared_ptr<const void>& message);
+  void StopLcmTap();
+
+  mutable std::mutex channels_mutex_;
+  std::map<std::string, std::unique_ptr<InMemoryChannelBase>> channels_;
+
+  std::atomic<bool> tap_enabled_{false};
+  std::thread tap_thread_;
+  std::mutex tap_mutex_;
+  std::condition_variable tap_condition_variable_;
+  std::deque<TapEntry> tap_queue_;
+  size_t tap_capacity_ = 0;
+  bool stop_tap_ = false;
+  std::atomic<int64_t> num_tap_dropped_{0};
+};
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "systems/framework/in_memory_channel.h"
+#include "systems/framework/loop_timing.h"
+#include "systems/framework/realtime.h"
+#include "drake/common/text_logging.h"
+#include "drake/lcm/drake_lcm_interface.h"
+#include "drake/systems/analysis/simulator.h"
+#include "drake/systems/framework/diagram.h"
+#include "drake/systems/framework/leaf_system.h"
+
+namespace dairlib {
+namespace systems {
+
+/// InMemoryDrivenLoop is the single-input LcmDrivenLoop for a diagram driven
+/// by an InMemoryChannel, so that several driven diagrams (e.g. a state
+/// estimator, a controller and a command dispatcher) can run on threads of
+/// one process, connected by an InMemoryBus instead of LCM.
+///
+/// Each new message on the channel is written into the first input port of
+/// `lcm_parser` (the same receiver system as with LcmDrivenLoop, e.g. a
+/// RobotOutputReceiver), the diagram is advanced to the message's utime, and
+/// forced publishes are dispatched if is_forced_publish is set. If several
+/// messages arrive during one iteration, only the latest is handled, as an
+/// LCM subscriber which keeps one message would.
+///
+/// Every iteration is timed by a LoopTimer from the time the message was
+/// published, so the receive_to_start statistic includes the handoff between
+/// threads.
+template <typename MessageType>
+class InMemoryDrivenLoop {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(InMemoryDrivenLoop)
+
+  ///     @param diagram A Drake diagram
+  ///     @param lcm_parser The LeafSystem of the diagram that parses the
+  ///     incoming message, or nullptr if only its time is needed
+  ///     @param channel The driving channel. Its life span must be longer
+  ///     than `this`.
+  ///     @param is_forced_publish A flag which enables publishing via diagram.
+  InMemoryDrivenLoop(std::unique_ptr<drake::systems::Diagram<double>> diagram,
+                     const drake::systems::LeafSystem<double>* lcm_parser,
+                     const InMemoryChannel<MessageType>* channel,
+                     bool is_forced_publish)
+      : lcm_parser_(lcm_parser),
+        channel_(channel),
+        is_forced_publish_(is_forced_publish) {
+    DRAKE_DEMAND(channel_ != nullptr);
+    if (!diagram->get_name().empty()) {
+      diagram_name_ = diagram->get_name();
+    }
+    diagram_ptr_ = diagram.get();
+    timer_ = std::make_unique<LoopTimer>(diagram_name_);
+    simulator_ =
+        std::make_unique<drake::systems::Simulator<double>>(std::move(diagram));
+  }
+
+  drake::systems::Diagram<double>* get_diagram() { return diagram_ptr_; }
+  drake::systems::Context<double>& get_diagram_mutable_context() {
+    return simulator_->get_mutable_context();
+  }
+
+  /// See LcmDrivenLoop::EnableTimingPublisher()
+  void EnableTimingPublisher(drake::lcm::DrakeLcmInterface* lcm,
+                             const std::string& channel, double period = 1.0) {
+    timer_->StartPublishing(lcm, channel, period);
+  }
+
+  /// See LcmDrivenLoop::set_deadline()
+  void set_deadline(double deadline) { timer_->set_deadline(deadline); }
+
+  LoopTimer& get_timer() { return *timer_; }
+
+  /// See LcmDrivenLoop::EnableRealtime(). With spin_wait, the loop polls the
+  /// channel's sequence number instead of sleeping.
+  void EnableRealtime(const RealtimeOptions& options) {
+    realtime_options_ = options;
+  }
+
+  // Start simulating the diagram
+  void Simulate(double end_time = std::numeric_limits<double>::infinity()) {
+    auto& diagram_context = simulator_->get_mutable_context();
+
+    if (realtime_options_.enabled()) {
+      ApplyRealtimeOptions(realtime_options_);
+      LogWakeupLatency(diagram_name_,
+                       MeasureWakeupLatency(realtime_options_.latency_samples,
+                                            realtime_options_.latency_period,
+                                            realtime_options_.spin_wait));
+    }
+
+    // Wait for the first message.
+    drake::log()->info("Waiting for first message on " + channel_->name());
+    channel_->WaitForMessage(0, realtime_options_.spin_wait);
+
+    // Initialize the context time, and the parser's input with the message,
+    // which is then only assigned to, reusing its storage
+    const auto first_message = channel_->GetLatest();
+    diagram_context.SetTime(first_message->utime * 1e-6);
+    drake::systems::FixedInputPortValue* input_value = nullptr;
+    if (lcm_parser_ != nullptr) {
+      input_value = &lcm_parser_->get_input_port(0).FixValue(
+          &(diagram_ptr_->GetMutableSubsystemContext(*lcm_parser_,
+                                                     &diagram_context)),
+          *first_message);
+    }
+    if (realtime_options_.prefault) {
+      PrefaultSystem(*diagram_ptr_, diagram_context);
+    }
+
+    drake::log()->info(diagram_name_ + " started");
+    double time = 0;
+    int64_t sequence = 0;
+    while (time < end_time) {
+      channel_->WaitForMessage(sequence, realtime_options_.spin_wait);
+      int64_t publish_ns;
+      const auto message = channel_->GetLatest(&sequence, &publish_ns);
+      timer_->BeginIteration(publish_ns);
+
+      if (input_value != nullptr) {
+        input_value->GetMutableData()->set_value(*message);
+      }
+      time = message->utime * 1e-6;
+
+      // Check if we are very far ahead or behind
+      // (likely due to a restart of the driving clock)
+      if (time > simulator_->get_context().get_time() + 1.0 ||
+          time < simulator_->get_context().get_time()) {
+        std::cout << diagram_name_ + " time is "
+                  << simulator_->get_context().get_time()
+                  << ", but stepping to " << time << std::endl;
+        std::cout << "Difference is too large, resetting " + diagram_name_ +
+                         " time.\n";
+        simulator_->get_mutable_context().SetTime(time);
+      }
+
+      simulator_->AdvanceTo(time);
+      timer_->MarkAdvanceEnd();
+      if (is_forced_publish_) {
+        // Force-publish via the diagram
+        diagram_ptr_->Publish(diagram_context);
+      }
+      timer_->EndIteration();
+    }
+  }
+
+ private:
+  drake::systems::Diagram<double>* diagram_ptr_;
+  const drake::systems::LeafSystem<double>* lcm_parser_;
+  const InMemoryChannel<MessageType>* channel_;
+  std::unique_ptr<drake::systems::Simulator<double>> simulator_;
+  std::unique_ptr<LoopTimer> timer_;
+  RealtimeOptions realtime_options_;
+
+  std::string diagram_name_ = "diagram";
+  bool is_forced_publish_;
+};
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "systems/framework/in_memory_channel.h"
+#include "drake/common/drake_copyable.h"
+#include "drake/common/hash.h"
+#include "drake/systems/framework/leaf_system.h"
+
+namespace dairlib {
+namespace systems {
+
+using InMemoryTriggerTypes =
+    std::unordered_set<drake::systems::TriggerType, drake::DefaultHash>;
+
+/// Publishes its abstract input, a message of type T, on an InMemoryChannel.
+/// The counterpart of LcmPublisherSystem, with the same publish triggers
+/// (forced, periodic and per-step).
+template <typename T>
+class InMemoryPublisherSystem : public drake::systems::LeafSystem<double> {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(InMemoryPublisherSystem)
+
+  /// @param publish_period Period of the periodic publish, which must be
+  ///   positive if and only if publish_triggers contains kPeriodic
+  InMemoryPublisherSystem(InMemoryChannel<T>* channel,
+                          const InMemoryTriggerTypes& publish_triggers,
+                          double publish_period = 0.0)
+      : channel_(channel) {
+    using drake::systems::TriggerType;
+    DRAKE_DEMAND(channel_ != nullptr);
+    DRAKE_DEMAND(!publish_triggers.empty());
+    for (const auto& trigger : publish_triggers) {
+      DRAKE_DEMAND((trigger == TriggerType::kForced) ||
+                   (trigger == TriggerType::kPeriodic) ||
+                   (trigger == TriggerType::kPerStep));
+    }
+
+    this->DeclareAbstractInputPort(channel_->name(), drake::Value<T>());
+    set_name("InMemoryPublisherSystem(" + channel_->name() + ")");
+
+    if (publish_triggers.count(TriggerType::kForced)) {
+      this->DeclareForcedPublishEvent(
+          &InMemoryPublisherSystem::PublishInputAsMessage);
+    }
+    if (publish_triggers.count(TriggerType::kPeriodic)) {
+      DRAKE_DEMAND(publish_period > 0);
+      this->DeclarePeriodicPublishEvent(
+          publish_period, 0.0,
+          &InMemoryPublisherSystem::PublishInputAsMessage);
+    } else {
+      DRAKE_DEMAND(publish_period == 0);
+    }
+    if (publish_triggers.count(TriggerType::kPerStep)) {
+      this->DeclarePerStepEvent(drake::systems::PublishEvent<double>(
+          [this](const drake::systems::Context<double>& context,
+                 const drake::systems::PublishEvent<double>&) {
+            this->PublishInputAsMessage(context);
+          }));
+    }
+  }
+
+  const InMemoryChannel<T>& channel() const { return *channel_; }
+
+ private:
+  drake::systems::EventStatus PublishInputAsMessage(
+      const drake::systems::Context<double>& context) const {
+    channel_->Publish(this->get_input_port(0).template Eval<T>(context));
+    return drake::systems::EventStatus::Succeeded();
+  }
+
+  InMemoryChannel<T>* const channel_;
+};
+
+/// Outputs the latest message of an InMemoryChannel. The counterpart of
+/// LcmSubscriberSystem: the message is stored in the context's abstract
+/// state by an unrestricted update, which is scheduled whenever the channel
+/// has a newer message than the state.
+template <typename T>
+class InMemorySubscriberSystem : public drake::systems::LeafSystem<double> {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(InMemorySubscriberSystem)
+
+  explicit InMemorySubscriberSystem(const InMemoryChannel<T>* channel)
+      : channel_(channel) {
+    DRAKE_DEMAND(channel_ != nullptr);
+    this->DeclareAbstractState(drake::AbstractValue::Make<T>(T()));
+    this->DeclareAbstractState(drake::AbstractValue::Make<int64_t>(0));
+    this->DeclareAbstractOutputPort(channel_->name(), T(),
+                                    &InMemorySubscriberSystem::CopyMessage);
+    set_name("InMemorySubscriberSystem(" + channel_->name() + ")");
+  }
+
+  /// Sequence number of the message in the context
+  int64_t GetMessageSequence(
+      const drake::systems::Context<double>& context) const {
+    return context.template get_abstract_state<int64_t>(kSequenceIndex);
+  }
+
+ private:
+  static constexpr int kMessageIndex = 0;
+  static constexpr int kSequenceIndex = 1;
+
+  void CopyMessage(const drake::systems::Context<double>& context,
+                   T* message) const {
+    *message = context.template get_abstract_state<T>(kMessageIndex);
+  }
+
+  void DoCalcNextUpdateTime(
+      const drake::systems::Context<double>& context,
+      drake::systems::CompositeEventCollection<double>* events,
+      double* time) const final {
+    drake::systems::LeafSystem<double>::DoCalcNextUpdateTime(context, events,
+                                                             time);
+    if (channel_->sequence() == GetMessageSequence(context)) {
+      return;
+    }
+    // Schedule an update event at the current time
+    *time = context.get_time();
+    events->get_mutable_unrestricted_update_events().add_event(
+        std::make_unique<drake::systems::UnrestrictedUpdateEvent<double>>(
+            drake::systems::TriggerType::kTimed));
+  }
+
+  void DoCalcUnrestrictedUpdate(
+      const drake::systems::Context<double>&,
+      const std::vector<
+          const drake::systems::UnrestrictedUpdateEvent<double>*>&,
+      drake::systems::State<double>* state) const final {
+    int64_t sequence;
+    const auto message = channel_->GetLatest(&sequence);
+    if (message == nullptr) {
+      return;
+    }
+    auto& abstract_state = state->get_mutable_abstract_state();
+    abstract_state.get_mutable_value(kMessageIndex)
+        .template get_mutable_value<T>() = *message;
+    abstract_state.get_mutable_value(kSequenceIndex)
+        .template get_mutable_value<int64_t>() = sequence;
+  }
+
+  const InMemoryChannel<T>* const channel_;
+};
+
+}  // namespace systems
+}  // namespace dairlib
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <limits>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "systems/framework/loop_timing.h"
+#include "systems/framework/realtime.h"
 #include "drake/lcm/drake_lcm.h"
 #include "drake/systems/analysis/simulator.h"
 #include "drake/systems/framework/diagram.h"
@@ -13,6 +17,7 @@
 #include "drake/systems/lcm/serializer.h"
 
 #include "dairlib/lcmt_controller_switch.hpp"
+#include "dairlib/lcmt_lockstep_ack.hpp"
 
 namespace dairlib {
 namespace systems {
@@ -46,7 +51,16 @@ namespace systems {
 /// 1. construct LcmDrivenLoop
 /// 2. (if it's multi-input) the user can set the initial channel that
 ///    LcmDrivenLoop listens to by calling SetInitActiveChannel().
-/// 3. run Simulate()
+/// 3. (optional) publish timing statistics by calling EnableTimingPublisher()
+/// 4. (optional) enable the real-time mode by calling EnableRealtime()
+/// 5. (optional) enable the lockstep mode by calling EnableLockstep()
+/// 6. run Simulate()
+
+/// Every iteration is timed by a LoopTimer, from the time the input message
+/// is received (in its subscription handler) until AdvanceTo() and the forced
+/// publish finish.
+/// Systems in the diagram can break the time down further with
+/// ScopedLoopSection.
 
 /// Note that we implement the class only in the header file because we don't
 /// know what MessageTypes are beforehand.
@@ -60,13 +74,13 @@ class LcmDrivenLoop {
   DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(LcmDrivenLoop)
 
   /// Constructor for single-input LcmDrivenLoop
-  ///     @param drake_lcm DrakeLcm
+  ///     @param drake_lcm DrakeLcm, or ShmLcm (see MakeLcmInterface())
   ///     @param diagram A Drake diagram
   ///     @param lcm_parser The LeafSystem of the diagram that parses the
   ///     incoming lcm message
   ///     @param input_channel The name of the input channel
   ///     @param is_forced_publish A flag which enables publishing via diagram.
-  LcmDrivenLoop(drake::lcm::DrakeLcm* drake_lcm,
+  LcmDrivenLoop(drake::lcm::DrakeLcmInterface* drake_lcm,
                 std::unique_ptr<drake::systems::Diagram<double>> diagram,
                 const drake::systems::LeafSystem<double>* lcm_parser,
                 const std::string& input_channel, bool is_forced_publish)
@@ -75,7 +89,7 @@ class LcmDrivenLoop {
                       "", is_forced_publish){};
 
   /// Constructor for multi-input LcmDrivenLoop
-  ///     @param drake_lcm DrakeLcm
+  ///     @param drake_lcm DrakeLcm, or ShmLcm (see MakeLcmInterface())
   ///     @param diagram A Drake diagram
   ///     @param lcm_parser The LeafSystem of the diagram that parses the
   ///     incoming lcm message
@@ -83,7 +97,7 @@ class LcmDrivenLoop {
   ///     @param active_channel The name of the initial active input channel
   ///     @param switch_channel The name of the switch channel
   ///     @param is_forced_publish A flag which enables publishing via diagram.
-  LcmDrivenLoop(drake::lcm::DrakeLcm* drake_lcm,
+  LcmDrivenLoop(drake::lcm::DrakeLcmInterface* drake_lcm,
                 std::unique_ptr<drake::systems::Diagram<double>> diagram,
                 const drake::systems::LeafSystem<double>* lcm_parser,
                 std::vector<std::string> input_channels,
@@ -97,6 +111,7 @@ class LcmDrivenLoop {
       diagram_name_ = diagram->get_name();
     }
     diagram_ptr_ = diagram.get();
+    timer_ = std::make_unique<LoopTimer>(diagram_name_);
     simulator_ =
         std::make_unique<drake::systems::Simulator<double>>(std::move(diagram));
 
@@ -113,6 +128,16 @@ class LcmDrivenLoop {
       std::cout << "Constructing subscriber for " << name << std::endl;
       name_to_input_sub_map_.insert(std::make_pair(
           name, drake::lcm::Subscriber<InputMessageType>(drake_lcm_, name)));
+      // Record when each message arrives, rather than when the loop gets to
+      // it, so that the time spent handling other channels is included
+      receive_ns_[name] = 0;
+      int64_t* receive_ns = &receive_ns_.at(name);
+      auto subscription = drake_lcm_->Subscribe(
+          name, [receive_ns](const void*, int) {
+            *receive_ns = LoopTimer::Now();
+          });
+      subscription->set_unsubscribe_on_delete(true);
+      receive_subscriptions_.push_back(subscription);
     }
 
     // Make sure input_channels contains active_channel, and then set initial
@@ -130,12 +155,12 @@ class LcmDrivenLoop {
   };
 
   /// Constructor for single-input LcmDrivenLoop without lcm_parser
-  ///     @param drake_lcm DrakeLcm
+  ///     @param drake_lcm DrakeLcm, or ShmLcm (see MakeLcmInterface())
   ///     @param diagram A Drake diagram
   ///     @param input_channel The name of the input channel
   ///     @param is_forced_publish A flag which enables publishing via diagram.
   /// The use case is that the user only need the time from lcm message.
-  LcmDrivenLoop(drake::lcm::DrakeLcm* drake_lcm,
+  LcmDrivenLoop(drake::lcm::DrakeLcmInterface* drake_lcm,
                 std::unique_ptr<drake::systems::Diagram<double>> diagram,
                 const std::string& input_channel, bool is_forced_publish)
       : LcmDrivenLoop(drake_lcm, std::move(diagram), nullptr,
@@ -150,14 +175,57 @@ class LcmDrivenLoop {
     return simulator_->get_mutable_context();
   }
 
+  /// Publishes timing statistics (lcmt_loop_timing) on the given channel
+  /// every period (in seconds), from a background thread
+  void EnableTimingPublisher(const std::string& channel, double period = 1.0) {
+    timer_->StartPublishing(drake_lcm_, channel, period);
+  }
+
+  /// Iterations taking longer than the deadline (in seconds), from message
+  /// receipt to the end of the forced publish, count as deadline misses
+  void set_deadline(double deadline) { timer_->set_deadline(deadline); }
+
+  LoopTimer& get_timer() { return *timer_; }
+
+  /// Runs Simulate() in real-time mode. The scheduler, affinity and memory
+  /// settings are applied to the thread which calls Simulate(), before it
+  /// waits for the first message, and the wake-up latency they achieve is then
+  /// measured and logged. With spin_wait, messages are polled for without
+  /// sleeping. With prefault, the diagram is run once on a copy of the context
+  /// with the first message, before the loop goes live.
+  void EnableRealtime(const RealtimeOptions& options) {
+    realtime_options_ = options;
+  }
+
+  /// Runs Simulate() in lockstep with the sender of the input messages, e.g.
+  /// multibody_sim with --lockstep_channel (see LcmLockstep). After each
+  /// iteration, including the forced publish, an lcmt_lockstep_ack with the
+  /// utime of the handled message is published on ack_channel. The sender
+  /// waits for it before it advances, so no message is dropped and the pair
+  /// runs as fast as both can compute, independently of the wall clock.
+  /// A message with the utime of the previous one (a resend) is acknowledged
+  /// again without advancing the diagram.
+  void EnableLockstep(const std::string& ack_channel) {
+    DRAKE_DEMAND(!ack_channel.empty());
+    lockstep_channel_ = ack_channel;
+  }
+
   // Start simulating the diagram
   void Simulate(double end_time = std::numeric_limits<double>::infinity()) {
     // Get mutable contexts
     auto& diagram_context = simulator_->get_mutable_context();
 
+    if (realtime_options_.enabled()) {
+      ApplyRealtimeOptions(realtime_options_);
+      LogWakeupLatency(diagram_name_,
+                       MeasureWakeupLatency(realtime_options_.latency_samples,
+                                            realtime_options_.latency_period,
+                                            realtime_options_.spin_wait));
+    }
+
     // Wait for the first message.
     drake::log()->info("Waiting for first lcm input message");
-    LcmHandleSubscriptionsUntil(drake_lcm_, [&]() {
+    HandleSubscriptionsUntil([&]() {
       return name_to_input_sub_map_.at(active_channel_).count() > 0;
     });
 
@@ -166,6 +234,17 @@ class LcmDrivenLoop {
         name_to_input_sub_map_.at(active_channel_).message().utime * 1e-6;
     diagram_context.SetTime(t0);
 
+    if (realtime_options_.prefault) {
+      // The first message is written into the context again by the loop
+      if (lcm_parser_ != nullptr) {
+        lcm_parser_->get_input_port(0).FixValue(
+            &(diagram_ptr_->GetMutableSubsystemContext(*lcm_parser_,
+                                                       &diagram_context)),
+            name_to_input_sub_map_.at(active_channel_).message());
+      }
+      PrefaultSystem(*diagram_ptr_, diagram_context);
+    }
+
     // "Simulator" time
     double time = 0;  // initialize the current time with 0
     // Variable needed for the driven loop
@@ -194,7 +273,7 @@ class LcmDrivenLoop {
       // Wait for new InputMessageType messages and SwitchMessageType messages.
       bool is_new_input_message = false;
       bool is_new_switch_message = false;
-      LcmHandleSubscriptionsUntil(drake_lcm_, [&]() {
+      HandleSubscriptionsUntil([&]() {
         if (name_to_input_sub_map_.at(active_channel_).count() > 0) {
           is_new_input_message = true;
         }
@@ -206,8 +285,19 @@ class LcmDrivenLoop {
         return is_new_input_message || is_new_switch_message;
       });
 
+      // Acknowledge a resent lockstep message again, without handling it
+      if (is_new_input_message && !lockstep_channel_.empty() &&
+          name_to_input_sub_map_.at(active_channel_).message().utime ==
+              lockstep_utime_) {
+        PublishLockstepAck();
+        name_to_input_sub_map_.at(active_channel_).clear();
+        is_new_input_message = false;
+      }
+
       // Update the diagram context when there is new input message
       if (is_new_input_message) {
+        timer_->BeginIteration(receive_ns_.at(active_channel_));
+
         // Write the InputMessageType message into the context if lcm_parser is
         // provided
         if (lcm_parser_ != nullptr) {
@@ -233,10 +323,18 @@ class LcmDrivenLoop {
         }
 
         simulator_->AdvanceTo(time);
+        timer_->MarkAdvanceEnd();
         if (is_forced_publish_) {
           // Force-publish via the diagram
           diagram_ptr_->Publish(diagram_context);
         }
+        timer_->EndIteration();
+
+        if (!lockstep_channel_.empty()) {
+          lockstep_utime_ =
+              name_to_input_sub_map_.at(active_channel_).message().utime;
+          PublishLockstepAck();
+        }
 
         // Clear messages in the current input channel
         name_to_input_sub_map_.at(active_channel_).clear();
@@ -268,10 +366,32 @@ class LcmDrivenLoop {
   };
 
  private:
-  drake::lcm::DrakeLcm* drake_lcm_;
+  void PublishLockstepAck() {
+    dairlib::lcmt_lockstep_ack ack;
+    ack.utime = lockstep_utime_;
+    ack.loop_name = diagram_name_;
+    drake::lcm::Publish(drake_lcm_, lockstep_channel_, ack);
+  }
+
+  // Handles LCM messages until predicate returns true, sleeping in between
+  // unless spin_wait is set
+  template <typename Predicate>
+  void HandleSubscriptionsUntil(Predicate predicate) {
+    if (realtime_options_.spin_wait) {
+      while (!predicate()) {
+        drake_lcm_->HandleSubscriptions(0);
+      }
+    } else {
+      LcmHandleSubscriptionsUntil(drake_lcm_, predicate);
+    }
+  }
+
+  drake::lcm::DrakeLcmInterface* drake_lcm_;
   drake::systems::Diagram<double>* diagram_ptr_;
   const drake::systems::LeafSystem<double>* lcm_parser_;
   std::unique_ptr<drake::systems::Simulator<double>> simulator_;
+  std::unique_ptr<LoopTimer> timer_;
+  RealtimeOptions realtime_options_;
 
   std::string diagram_name_ = "diagram";
   std::string active_channel_;
@@ -279,8 +399,18 @@ class LcmDrivenLoop {
       nullptr;
   std::map<std::string, drake::lcm::Subscriber<InputMessageType>>
       name_to_input_sub_map_;
+  // Arrival time of the latest message of each input channel, written by the
+  // subscription handlers
+  std::map<std::string, int64_t> receive_ns_;
+  std::vector<std::shared_ptr<drake::lcm::DrakeSubscriptionInterface>>
+      receive_subscriptions_;
 
   bool is_forced_publish_;
+
+  // Empty unless in lockstep mode
+  std::string lockstep_channel_;
+  // utime of the last acknowledged message
+  int64_t lockstep_utime_ = std::numeric_limits<int64_t>::min();
 };
 
 }  // namespace systems
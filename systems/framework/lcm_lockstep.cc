@@ -0,0 +1,59 @@
+#include "systems/framework/lcm_lockstep.h"
+
+#include <chrono>
+#include <stdexcept>
+
+#include "drake/common/drake_assert.h"
+
+namespace dairlib {
+namespace systems {
+
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+LcmLockstep::LcmLockstep(drake::lcm::DrakeLcmInterface* lcm,
+                         const std::string& ack_channel, double timeout)
+    : lcm_(lcm), ack_channel_(ack_channel), timeout_(timeout) {
+  DRAKE_DEMAND(lcm_ != nullptr);
+  DRAKE_DEMAND(!ack_channel_.empty());
+  DRAKE_DEMAND(timeout_ >= 0);
+  subscription_ = lcm_->Subscribe(
+      ack_channel_, [this](const void* data, int size) {
+        // Acknowledgements of resent messages may arrive out of order, so
+        // only the latest utime is kept
+        lcmt_lockstep_ack ack;
+        if (ack.decode(data, 0, size) != size) {
+          return;
+        }
+        if (!has_ack_ || ack.utime > ack_.utime) {
+          ack_ = ack;
+          has_ack_ = true;
+        }
+      });
+}
+
+void LcmLockstep::WaitForAck(int64_t utime,
+                             const std::function<void()>& resend) {
+  const auto start = steady_clock::now();
+  auto last_send = start;
+  while (!has_ack_ || ack_.utime < utime) {
+    lcm_->HandleSubscriptions(10);
+    const auto now = steady_clock::now();
+    if (resend &&
+        duration<double>(now - last_send).count() >= kResendPeriod &&
+        !(has_ack_ && ack_.utime >= utime)) {
+      resend();
+      last_send = now;
+    }
+    if (timeout_ > 0 && duration<double>(now - start).count() > timeout_) {
+      throw std::runtime_error(
+          "LcmLockstep: no acknowledgement of utime " + std::to_string(utime) +
+          " on " + ack_channel_ + " after " + std::to_string(timeout_) +
+          " s");
+    }
+  }
+  num_acks_++;
+}
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "dairlib/lcmt_lockstep_ack.hpp"
+
+#include "drake/lcm/drake_lcm_interface.h"
+
+namespace dairlib {
+namespace systems {
+
+/// LcmLockstep is the sender's side of a lockstep co-simulation with an
+/// LcmDrivenLoop in lockstep mode (see LcmDrivenLoop::EnableLockstep()), e.g.
+/// multibody_sim driving a controller. After publishing each input message of
+/// the loop, the sender calls WaitForAck() with the message's utime, which
+/// handles the subscriptions of `lcm` until the loop acknowledges it. By then
+/// the loop's outputs for that message (e.g. its command) have been received,
+/// so the sender can advance with them, and the pair runs as fast as both can
+/// compute, with the same result on every run.
+///
+/// The loop may not have subscribed yet when the first message is sent, so
+/// WaitForAck() can resend a message until it is acknowledged. The loop
+/// acknowledges a resend again without handling it.
+class LcmLockstep {
+ public:
+  /// @param lcm The interface to receive acknowledgements on. Its
+  ///   subscriptions are handled by WaitForAck(), on the calling thread.
+  /// @param ack_channel The loop's acknowledgement channel
+  /// @param timeout WaitForAck() throws if the loop has not acknowledged a
+  ///   message after this many seconds. 0 to wait forever.
+  LcmLockstep(drake::lcm::DrakeLcmInterface* lcm,
+              const std::string& ack_channel, double timeout = 0);
+
+  /// Blocks until the message with the given utime (or a later one) is
+  /// acknowledged. If resend is given, it is called every kResendPeriod
+  /// seconds until then.
+  /// @throws std::runtime_error on timeout
+  void WaitForAck(int64_t utime, const std::function<void()>& resend = {});
+
+  /// Number of acknowledged messages
+  int64_t num_acks() const { return num_acks_; }
+
+  static constexpr double kResendPeriod = 0.1;
+
+ private:
+  drake::lcm::DrakeLcmInterface* lcm_;
+  const std::string ack_channel_;
+  const double timeout_;
+  std::shared_ptr<drake::lcm::DrakeSubscriptionInterface> subscription_;
+
+  bool has_ack_ = false;
+  lcmt_lockstep_ack ack_;
+  int64_t num_acks_ = 0;
+};
+
+}  // namespace systems
+}  // namespace dairlib
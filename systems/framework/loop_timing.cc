@@ -0,0 +1,231 @@
+#include "systems/framework/loop_timing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace dairlib {
+namespace systems {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// The sample of the iteration active on this thread, if any
+thread_local LoopTimingSample* active_sample = nullptr;
+
+std::mutex& section_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+vector<string>& section_names() {
+  static vector<string> names;
+  return names;
+}
+
+// Histogram bin upper edges, in microseconds
+const vector<double>& bin_upper_edges_us() {
+  static const vector<double> edges{
+      10,   20,   50,   100,   200,   500,
+      1000, 2000, 5000, 10000, 20000, std::numeric_limits<double>::infinity()};
+  return edges;
+}
+
+lcmt_timing_histogram MakeHistogram(const string& name,
+                                    vector<int64_t> durations_ns) {
+  const auto& edges = bin_upper_edges_us();
+  lcmt_timing_histogram histogram;
+  histogram.name = name;
+  histogram.count = durations_ns.size();
+  histogram.num_bins = edges.size();
+  histogram.counts.assign(edges.size(), 0);
+  histogram.mean_us = 0;
+  histogram.p50_us = 0;
+  histogram.p90_us = 0;
+  histogram.p99_us = 0;
+  histogram.max_us = 0;
+  if (durations_ns.empty()) {
+    return histogram;
+  }
+
+  std::sort(durations_ns.begin(), durations_ns.end());
+  const auto percentile = [&durations_ns](double p) {
+    const int i = std::ceil(p * durations_ns.size()) - 1;
+    return 1e-3 * durations_ns[std::max(i, 0)];
+  };
+  double sum = 0;
+  for (int64_t d : durations_ns) {
+    const double us = 1e-3 * d;
+    sum += us;
+    const int bin =
+        std::lower_bound(edges.begin(), edges.end(), us) - edges.begin();
+    histogram.counts[bin]++;
+  }
+  histogram.mean_us = sum / durations_ns.size();
+  histogram.p50_us = percentile(0.5);
+  histogram.p90_us = percentile(0.9);
+  histogram.p99_us = percentile(0.99);
+  histogram.max_us = 1e-3 * durations_ns.back();
+  return histogram;
+}
+
+}  // namespace
+
+LoopTimer::LoopTimer(const string& loop_name, int capacity)
+    : loop_name_(loop_name),
+      ring_(capacity),
+      deadline_ns_(std::numeric_limits<int64_t>::max()) {}
+
+LoopTimer::~LoopTimer() { StopPublishing(); }
+
+void LoopTimer::set_deadline(double deadline) {
+  DRAKE_DEMAND(deadline > 0);
+  deadline_ns_.store(std::isinf(deadline)
+                         ? std::numeric_limits<int64_t>::max()
+                         : static_cast<int64_t>(deadline * 1e9),
+                     std::memory_order_relaxed);
+}
+
+int64_t LoopTimer::Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void LoopTimer::BeginIteration(int64_t receive_ns) {
+  sample_ = LoopTimingSample();
+  sample_.receive_ns = receive_ns;
+  sample_.start_ns = Now();
+  sample_.advance_end_ns = sample_.start_ns;
+  active_sample = &sample_;
+}
+
+void LoopTimer::MarkAdvanceEnd() { sample_.advance_end_ns = Now(); }
+
+void LoopTimer::EndIteration() {
+  sample_.end_ns = Now();
+  active_sample = nullptr;
+  if (!ring_.Push(sample_)) {
+    num_dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+lcmt_loop_timing LoopTimer::Summarize() {
+  vector<LoopTimingSample> samples;
+  LoopTimingSample sample;
+  while (ring_.Pop(&sample)) {
+    samples.push_back(sample);
+  }
+
+  lcmt_loop_timing msg;
+  msg.utime = Now() / 1000;
+  msg.loop_name = loop_name_;
+  msg.num_iterations = samples.size();
+  msg.num_dropped = num_dropped_.exchange(0, std::memory_order_relaxed);
+  const int64_t deadline_ns = deadline_ns_.load(std::memory_order_relaxed);
+  msg.deadline_us = (deadline_ns == std::numeric_limits<int64_t>::max())
+                        ? std::numeric_limits<double>::infinity()
+                        : 1e-3 * deadline_ns;
+  msg.bin_upper_edges_us = bin_upper_edges_us();
+  msg.num_bins = msg.bin_upper_edges_us.size();
+
+  vector<int64_t> receive_to_start, advance, publish, total;
+  msg.num_deadline_misses = 0;
+  for (const auto& s : samples) {
+    receive_to_start.push_back(s.start_ns - s.receive_ns);
+    advance.push_back(s.advance_end_ns - s.start_ns);
+    publish.push_back(s.end_ns - s.advance_end_ns);
+    total.push_back(s.end_ns - s.receive_ns);
+    if (total.back() > deadline_ns) {
+      msg.num_deadline_misses++;
+    }
+  }
+  msg.stats.push_back(MakeHistogram("receive_to_start", receive_to_start));
+  msg.stats.push_back(MakeHistogram("advance", advance));
+  msg.stats.push_back(MakeHistogram("publish", publish));
+  msg.stats.push_back(MakeHistogram("total", total));
+
+  // Sections, over the iterations in which they ran
+  vector<string> names;
+  {
+    std::lock_guard<std::mutex> lock(section_mutex());
+    names = section_names();
+  }
+  for (size_t i = 0; i < names.size(); i++) {
+    vector<int64_t> durations;
+    for (const auto& s : samples) {
+      if (s.section_ns[i] > 0) {
+        durations.push_back(s.section_ns[i]);
+      }
+    }
+    if (!durations.empty()) {
+      msg.stats.push_back(MakeHistogram(names[i], durations));
+    }
+  }
+  msg.num_stats = msg.stats.size();
+  return msg;
+}
+
+void LoopTimer::StartPublishing(drake::lcm::DrakeLcmInterface* lcm,
+                                const string& channel, double period) {
+  DRAKE_DEMAND(lcm != nullptr);
+  DRAKE_DEMAND(period > 0);
+  DRAKE_DEMAND(!publish_thread_.joinable());
+  publish_thread_ = std::thread([this, lcm, channel, period]() {
+    const auto wait = std::chrono::duration<double>(period);
+    std::unique_lock<std::mutex> lock(publish_mutex_);
+    while (!publish_cv_.wait_for(lock, wait,
+                                 [this]() { return stop_publishing_; })) {
+      lock.unlock();
+      const lcmt_loop_timing msg = Summarize();
+      if (msg.num_iterations > 0 || msg.num_dropped > 0) {
+        drake::lcm::Publish(lcm, channel, msg);
+      }
+      lock.lock();
+    }
+  });
+}
+
+void LoopTimer::StopPublishing() {
+  if (!publish_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    stop_publishing_ = true;
+  }
+  publish_cv_.notify_all();
+  publish_thread_.join();
+}
+
+int LoopTimer::RegisterSection(const string& name) {
+  std::lock_guard<std::mutex> lock(section_mutex());
+  auto& names = section_names();
+  const auto it = std::find(names.begin(), names.end(), name);
+  if (it != names.end()) {
+    return it - names.begin();
+  }
+  DRAKE_DEMAND(static_cast<int>(names.size()) <
+               LoopTimingSample::kMaxSections);
+  names.push_back(name);
+  return names.size() - 1;
+}
+
+ScopedLoopSection::ScopedLoopSection(int section)
+    : sample_(active_sample), section_(section) {
+  if (sample_ != nullptr) {
+    start_ns_ = LoopTimer::Now();
+  }
+}
+
+ScopedLoopSection::~ScopedLoopSection() {
+  if (sample_ != nullptr) {
+    sample_->section_ns[section_] += LoopTimer::Now() - start_ns_;
+  }
+}
+
+}  // namespace systems
+}  // namespace dairlib
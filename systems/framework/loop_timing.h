@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dairlib/lcmt_loop_timing.hpp"
+#include "drake/common/drake_assert.h"
+#include "drake/common/drake_copyable.h"
+#include "drake/lcm/drake_lcm_interface.h"
+#include "systems/framework/spsc_ring.h"
+
+namespace dairlib {
+namespace systems {
+
+/// Timestamps of one iteration of a driven loop, and the time spent in each
+/// registered section during it, in nanoseconds of the steady clock.
+struct LoopTimingSample {
+  static constexpr int kMaxSections = 16;
+
+  /// When the triggering message was received by the loop's subscription
+  int64_t receive_ns = 0;
+  /// When the loop started processing the message
+  int64_t start_ns = 0;
+  /// When the simulator finished advancing
+  int64_t advance_end_ns = 0;
+  /// When the iteration finished, including any forced publish
+  int64_t end_ns = 0;
+  std::array<int64_t, kMaxSections> section_ns{};
+};
+
+/// Per-iteration latency instrumentation for a driven loop.
+///
+/// The loop thread brackets each iteration with BeginIteration() and
+/// EndIteration(). Samples are pushed into a lock-free ring buffer, so the
+/// loop never blocks on the consumer. While an iteration is active, any
+/// ScopedLoopSection on the loop thread (e.g. in a system's update or output
+/// calculation) adds its duration to the iteration's sample.
+///
+/// A consumer drains the ring with Summarize(), or StartPublishing() starts a
+/// background thread which publishes a summary on an LCM channel at a fixed
+/// period. Summaries contain the percentiles and histograms of
+///   receive_to_start: message received -> processing started
+///   advance: simulator AdvanceTo, i.e. all of the diagram's updates
+///   publish: forced publish after AdvanceTo
+///   total: message received -> iteration finished
+/// and of each registered section.
+class LoopTimer {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(LoopTimer)
+
+  /// @param loop_name Reported in the summaries
+  /// @param capacity Capacity of the ring buffer, a power of two. Iterations
+  ///   which arrive while it is full are counted, but not recorded.
+  explicit LoopTimer(const std::string& loop_name, int capacity = 4096);
+
+  ~LoopTimer();
+
+  /// Iterations whose total time exceeds the deadline (in seconds) are counted
+  /// as deadline misses. Infinite by default. May be called while another
+  /// thread publishes summaries.
+  void set_deadline(double deadline);
+
+  void BeginIteration(int64_t receive_ns);
+  void MarkAdvanceEnd();
+  void EndIteration();
+
+  /// Publishes a summary every period (in seconds) from a background thread,
+  /// unless no iterations were recorded since the previous summary. The
+  /// publishing thread is then the ring's only consumer, so Summarize() must
+  /// not be called.
+  void StartPublishing(drake::lcm::DrakeLcmInterface* lcm,
+                       const std::string& channel, double period = 1.0);
+
+  /// Drains the ring buffer into a summary of the iterations since the
+  /// previous summary
+  lcmt_loop_timing Summarize();
+
+  /// Current steady clock time, in nanoseconds
+  static int64_t Now();
+
+  /// Returns the index of the section with the given name, registering it if
+  /// needed. Section names are shared by all timers. Call once per call site,
+  /// e.g. from a function-local static.
+  static int RegisterSection(const std::string& name);
+
+ private:
+  void StopPublishing();
+
+  const std::string loop_name_;
+  SpscRing<LoopTimingSample> ring_;
+  LoopTimingSample sample_;
+  std::atomic<int64_t> deadline_ns_;
+  std::atomic<int64_t> num_dropped_{0};
+
+  std::thread publish_thread_;
+  std::mutex publish_mutex_;
+  std::condition_variable publish_cv_;
+  bool stop_publishing_ = false;
+};
+
+/// Adds the time until it goes out of scope to the given section of the
+/// current thread's active LoopTimer iteration, if any. Nested sections are
+/// each counted in full.
+///
+///   static const int section = LoopTimer::RegisterSection("osc");
+///   ScopedLoopSection timing(section);
+class ScopedLoopSection {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(ScopedLoopSection)
+
+  explicit ScopedLoopSection(int section);
+  ~ScopedLoopSection();
+
+ private:
+  LoopTimingSample* sample_;
+  const int section_;
+  int64_t start_ns_ = 0;
+};
+
+}  // namespace systems
+}  // namespace dairlib
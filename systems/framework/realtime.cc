@@ -0,0 +1,230 @@
+#include "systems/framework/realtime.h"
+
+#include <alloca.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "drake/common/text_logging.h"
+#include "drake/systems/framework/diagram.h"
+
+namespace dairlib {
+namespace systems {
+
+using drake::systems::Context;
+using drake::systems::Diagram;
+using drake::systems::System;
+using std::string;
+using std::vector;
+
+namespace {
+
+int64_t MonotonicNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+timespec ToTimespec(int64_t ns) {
+  timespec ts;
+  ts.tv_sec = ns / 1000000000LL;
+  ts.tv_nsec = ns % 1000000000LL;
+  return ts;
+}
+
+// Evaluates the connected input ports of system and, recursively, of the
+// subsystems of a diagram
+void EvalInputPorts(const System<double>& system,
+                    const Context<double>& context) {
+  for (int i = 0; i < system.num_input_ports(); i++) {
+    const auto& port = system.get_input_port(i);
+    if (port.HasValue(context)) {
+      port.EvalAbstract(context);
+    }
+  }
+  const auto* diagram = dynamic_cast<const Diagram<double>*>(&system);
+  if (diagram != nullptr) {
+    for (const System<double>* subsystem : diagram->GetSystems()) {
+      EvalInputPorts(*subsystem,
+                     diagram->GetSubsystemContext(*subsystem, context));
+    }
+  }
+}
+
+}  // namespace
+
+bool ApplyRealtimeOptions(const RealtimeOptions& options) {
+  bool ok = true;
+
+  if (options.lock_memory) {
+    // Freed memory stays in the heap, already faulted in and locked, rather
+    // than going back to the kernel and faulting again when reused
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+      drake::log()->warn("Couldn't lock memory (mlockall: {})",
+                         std::strerror(errno));
+      ok = false;
+    }
+    PrefaultStack();
+  }
+
+  if (!options.cpus.empty()) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu : options.cpus) {
+      CPU_SET(cpu, &cpu_set);
+    }
+    const int error =
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (error != 0) {
+      drake::log()->warn("Couldn't set the CPU affinity: {}",
+                         std::strerror(error));
+      ok = false;
+    }
+  }
+
+  if (options.priority > 0) {
+    sched_param param{};
+    param.sched_priority = options.priority;
+    const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (error != 0) {
+      drake::log()->warn(
+          "Couldn't set SCHED_FIFO priority {}: {}. Running with the default "
+          "scheduler.",
+          options.priority, std::strerror(error));
+      ok = false;
+    }
+  }
+
+  return ok;
+}
+
+WakeupLatency MeasureWakeupLatency(int num_samples, double period,
+                                   bool spin) {
+  WakeupLatency latency;
+  if (num_samples <= 0) {
+    return latency;
+  }
+  const int64_t period_ns = std::max<int64_t>(1, std::llround(1e9 * period));
+  vector<int64_t> delays_ns;
+  delays_ns.reserve(num_samples);
+  int64_t wakeup_ns = MonotonicNs();
+  for (int i = 0; i < num_samples; i++) {
+    wakeup_ns += period_ns;
+    if (spin) {
+      while (MonotonicNs() < wakeup_ns) {
+      }
+    } else {
+      const timespec ts = ToTimespec(wakeup_ns);
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+             EINTR) {
+      }
+    }
+    const int64_t now_ns = MonotonicNs();
+    delays_ns.push_back(now_ns - wakeup_ns);
+    // Don't try to catch up on a missed period, as a driven loop wouldn't
+    wakeup_ns = std::max(wakeup_ns, now_ns);
+  }
+
+  std::sort(delays_ns.begin(), delays_ns.end());
+  double sum = 0;
+  for (int64_t d : delays_ns) {
+    sum += d;
+  }
+  const int p99 = std::max(
+      0, static_cast<int>(std::ceil(0.99 * delays_ns.size())) - 1);
+  latency.count = num_samples;
+  latency.min_us = 1e-3 * delays_ns.front();
+  latency.mean_us = 1e-3 * sum / num_samples;
+  latency.p99_us = 1e-3 * delays_ns[p99];
+  latency.max_us = 1e-3 * delays_ns.back();
+  return latency;
+}
+
+void LogWakeupLatency(const string& loop_name, const WakeupLatency& latency) {
+  drake::log()->info(
+      "{} wake-up latency over {} samples: min {:.1f} us, mean {:.1f} us, "
+      "p99 {:.1f} us, max {:.1f} us",
+      loop_name, latency.count, latency.min_us, latency.mean_us,
+      latency.p99_us, latency.max_us);
+}
+
+void PrefaultStack(int stack_bytes) {
+  auto* stack = static_cast<volatile char*>(alloca(stack_bytes));
+  for (int i = 0; i < stack_bytes; i += 4096) {
+    stack[i] = 0;
+  }
+}
+
+void PrefaultSystem(const System<double>& system,
+                    const Context<double>& context) {
+  std::unique_ptr<Context<double>> copy = context.Clone();
+
+  // Outputs, including those only read by publishers
+  EvalInputPorts(system, *copy);
+
+  // Per-step updates, and the timed updates of the next update time, which a
+  // loop about to go live is already at
+  auto events = system.AllocateCompositeEventCollection();
+  system.GetPerStepEvents(*copy, events.get());
+  auto timed_events = system.AllocateCompositeEventCollection();
+  const double next_time =
+      system.CalcNextUpdateTime(*copy, timed_events.get());
+  if (std::isfinite(next_time)) {
+    copy->SetTime(next_time);
+    events->AddToEnd(*timed_events);
+  }
+  auto discrete_state = system.AllocateDiscreteVariables();
+  system.CalcDiscreteVariableUpdates(
+      *copy, events->get_discrete_update_events(), discrete_state.get());
+  auto state = copy->CloneState();
+  system.CalcUnrestrictedUpdate(
+      *copy, events->get_unrestricted_update_events(), state.get());
+}
+
+vector<int> ParseCpuList(const string& cpus) {
+  vector<int> list;
+  std::stringstream stream(cpus);
+  string item;
+  while (std::getline(stream, item, ',')) {
+    if (item.empty()) {
+      continue;
+    }
+    const size_t dash = item.find('-');
+    try {
+      const string first_item = item.substr(0, dash);
+      size_t end;
+      const int first = std::stoi(first_item, &end);
+      bool valid = end == first_item.size();
+      int last = first;
+      if (dash != string::npos) {
+        const string last_item = item.substr(dash + 1);
+        last = std::stoi(last_item, &end);
+        valid = valid && end == last_item.size();
+      }
+      if (!valid || first < 0 || last < first || last >= CPU_SETSIZE) {
+        throw std::invalid_argument(item);
+      }
+      for (int cpu = first; cpu <= last; cpu++) {
+        list.push_back(cpu);
+      }
+    } catch (const std::logic_error&) {
+      throw std::runtime_error("Invalid CPU list: " + cpus);
+    }
+  }
+  return list;
+}
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "drake/systems/framework/context.h"
+#include "drake/systems/framework/system.h"
+
+namespace dairlib {
+namespace systems {
+
+/// Opt-in real-time settings for the thread running a driven loop (see
+/// LcmDrivenLoop::EnableRealtime() and UDPDrivenLoop::EnableRealtime()).
+/// Everything is off by default.
+///
+/// Raising the priority and locking memory need CAP_SYS_NICE and
+/// CAP_IPC_LOCK (or matching rtprio and memlock limits in
+/// /etc/security/limits.conf). Settings which cannot be applied are logged
+/// and skipped, so a controller still runs on a development machine.
+struct RealtimeOptions {
+  /// SCHED_FIFO priority (1 to 99) of the loop thread, or 0 to keep the
+  /// default scheduler
+  int priority = 0;
+  /// CPUs to pin the loop thread to. Empty to keep the current affinity.
+  std::vector<int> cpus;
+  /// Lock all current and future pages of the process into memory, and keep
+  /// freed heap memory in the process, so the loop never page faults once it
+  /// has run
+  bool lock_memory = false;
+  /// Poll for messages without sleeping, rather than blocking until one
+  /// arrives. Removes the scheduler's wake-up latency, at the cost of a core.
+  bool spin_wait = false;
+  /// Before going live, run the diagram's updates and outputs once on a copy
+  /// of the context, so that the first iteration does not pay for page
+  /// faults, lazy allocations and cold caches
+  bool prefault = false;
+  /// Number of timed sleeps used to measure the wake-up latency once the
+  /// settings are applied, or 0 to skip the measurement
+  int latency_samples = 1000;
+  /// Period of those sleeps (in seconds)
+  double latency_period = 0.0005;
+
+  bool enabled() const {
+    return priority > 0 || !cpus.empty() || lock_memory || spin_wait ||
+           prefault;
+  }
+};
+
+/// Statistics of the delay between a thread's requested and actual wake-up
+/// times, in microseconds
+struct WakeupLatency {
+  int count = 0;
+  double min_us = 0;
+  double mean_us = 0;
+  double p99_us = 0;
+  double max_us = 0;
+};
+
+/// Applies the scheduler, affinity and memory settings of options to the
+/// calling thread and process. Returns false, after logging why, if any of
+/// them could not be applied.
+bool ApplyRealtimeOptions(const RealtimeOptions& options);
+
+/// Sleeps num_samples times until an absolute time period seconds after the
+/// previous wake-up, as cyclictest does, and measures how late the calling
+/// thread wakes up. With spin set, the thread spins until each wake-up time
+/// instead, which measures the delay a spinning loop still sees (e.g. from
+/// interrupts or other threads on its core).
+WakeupLatency MeasureWakeupLatency(int num_samples, double period,
+                                   bool spin = false);
+
+/// Logs the wake-up latency of a loop, with its name
+void LogWakeupLatency(const std::string& loop_name,
+                      const WakeupLatency& latency);
+
+/// Touches stack_bytes of the calling thread's stack, so that it is mapped
+/// (and, after mlockall, locked) before the loop needs it
+void PrefaultStack(int stack_bytes = 256 * 1024);
+
+/// Evaluates every input port of the system and, for a diagram, of every
+/// subsystem (and so every output port which feeds one), then runs the
+/// per-step updates and those of the next update time, all on a copy of
+/// context. The loop's own context, and any publishers, are untouched.
+void PrefaultSystem(const drake::systems::System<double>& system,
+                    const drake::systems::Context<double>& context);
+
+/// Parses a comma-separated list of CPUs and ranges, e.g. "2,3" or "2-5", as
+/// used by taskset. Throws on malformed input.
+std::vector<int> ParseCpuList(const std::string& cpus);
+
+}  // namespace systems
+}  // namespace dairlib
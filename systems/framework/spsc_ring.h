@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "drake/common/drake_assert.h"
+#include "drake/common/drake_copyable.h"
+
+namespace dairlib {
+namespace systems {
+
+/// Fixed-capacity single-producer, single-consumer ring buffer. All operations
+/// but PopLatest(), which is lock-free, are wait-free, and none allocate. Push
+/// and Pop copy values in and out; the in-place operations
+/// (BeginPush/CommitPush, Front/PopFront) let large values be written and read
+/// in their slots instead.
+///
+/// A producer which would rather lose old values than new ones uses
+/// BeginPushOverwrite(), and its consumer must then only use PopLatest().
+template <typename T>
+class SpscRing {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(SpscRing)
+
+  /// @param capacity Must be a power of two
+  explicit SpscRing(int capacity) : buffer_(capacity), mask_(capacity - 1) {
+    DRAKE_DEMAND(capacity > 0 && (capacity & (capacity - 1)) == 0);
+  }
+
+  /// Returns false, leaving the buffer unchanged, if it is full
+  bool Push(const T& value) {
+    T* slot = BeginPush();
+    if (slot == nullptr) {
+      return false;
+    }
+    *slot = value;
+    CommitPush();
+    return true;
+  }
+
+  /// Returns false if the buffer is empty
+  bool Pop(T* value) {
+    const T* slot = Front();
+    if (slot == nullptr) {
+      return false;
+    }
+    *value = *slot;
+    PopFront();
+    return true;
+  }
+
+  /// (Producer) Returns the next free slot, or nullptr if the buffer is full.
+  /// The slot holds whatever value it last held, and is only visible to the
+  /// consumer after CommitPush().
+  T* BeginPush() {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == buffer_.size()) {
+      return nullptr;
+    }
+    return &buffer_[head & mask_];
+  }
+
+  /// (Producer) As BeginPush(), but if the buffer is full, drops its oldest
+  /// value to make room, and sets dropped. Returns nullptr only if the slot is
+  /// still being copied by PopLatest(), i.e. if the consumer stalled in it for
+  /// a whole lap of the ring.
+  T* BeginPushOverwrite(bool* dropped) {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    *dropped = false;
+    if (head - tail == buffer_.size()) {
+      // Fails only if the consumer released values meanwhile, which also
+      // makes room
+      *dropped = tail_.compare_exchange_strong(tail, tail + 1);
+    }
+    // Sequentially consistent with the claim in PopLatest(), so either the
+    // consumer sees the slot dropped, or this sees it claimed
+    const uint64_t reading = reading_.load();
+    if (reading != kNotReading && reading + buffer_.size() == head) {
+      return nullptr;
+    }
+    return &buffer_[head & mask_];
+  }
+
+  /// (Producer) Publishes the slot returned by BeginPush()
+  void CommitPush() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  /// (Consumer) Returns the oldest value, or nullptr if the buffer is empty.
+  /// The value stays valid, and is not overwritten, until PopFront().
+  const T* Front() const {
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &buffer_[tail & mask_];
+  }
+
+  /// (Consumer) Releases the value returned by Front() to the producer
+  void PopFront() {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  /// (Consumer) Copies the newest value and releases all of them, or returns
+  /// false if the buffer is empty. Unlike Pop(), it may be used with
+  /// BeginPushOverwrite().
+  bool PopLatest(T* value) {
+    while (true) {
+      const uint64_t head = head_.load(std::memory_order_acquire);
+      uint64_t tail = tail_.load(std::memory_order_acquire);
+      if (tail == head) {
+        return false;
+      }
+      // Claims the newest slot, unless the producer has already dropped it
+      reading_.store(head - 1);
+      tail = tail_.load();
+      if (tail < head) {
+        *value = buffer_[(head - 1) & mask_];
+        reading_.store(kNotReading, std::memory_order_release);
+        while (tail < head && !tail_.compare_exchange_weak(tail, head)) {
+        }
+        return true;
+      }
+      reading_.store(kNotReading, std::memory_order_release);
+    }
+  }
+
+  /// (Consumer) Number of values available to the consumer
+  int size() const {
+    return head_.load(std::memory_order_acquire) -
+           tail_.load(std::memory_order_relaxed);
+  }
+
+  int capacity() const { return buffer_.size(); }
+
+ private:
+  std::vector<T> buffer_;
+  const uint64_t mask_;
+  alignas(64) std::atomic<uint64_t> head_{0};
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  // Index of the slot PopLatest() is copying
+  static constexpr uint64_t kNotReading = ~uint64_t{0};
+  alignas(64) std::atomic<uint64_t> reading_{kNotReading};
+};
+
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,136 @@
+#include "systems/framework/async_lcm_publisher_system.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "dairlib/lcmt_robot_output.hpp"
+
+#include "drake/lcm/drake_lcm.h"
+#include "drake/lcm/lcm_messages.h"
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+using drake::systems::TriggerType;
+
+lcmt_robot_output MakeMessage(int i) {
+  lcmt_robot_output msg{};
+  msg.utime = 1000 * i;
+  msg.num_positions = 2;
+  msg.position = {1.0 * i, 2.0 * i};
+  return msg;
+}
+
+// Records the published messages, and blocks in Publish() while held
+class BlockingLcm : public drake::lcm::DrakeLcmInterface {
+ public:
+  std::string get_lcm_url() const override { return "blocking://"; }
+
+  void Publish(const std::string&, const void* data, int data_size,
+               std::optional<double>) override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    lcmt_robot_output message;
+    message.decode(data, 0, data_size);
+    utimes_.push_back(message.utime);
+    condition_variable_.notify_all();
+    condition_variable_.wait(lock, [this]() { return !held_; });
+  }
+
+  std::shared_ptr<drake::lcm::DrakeSubscriptionInterface> Subscribe(
+      const std::string&, HandlerFunction) override {
+    return nullptr;
+  }
+
+  int HandleSubscriptions(int) override { return 0; }
+
+  void Hold() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    held_ = true;
+  }
+
+  void Release() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      held_ = false;
+    }
+    condition_variable_.notify_all();
+  }
+
+  void WaitForPublish(int count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_variable_.wait(lock, [this, count]() {
+      return static_cast<int>(utimes_.size()) >= count;
+    });
+  }
+
+  std::vector<int64_t> utimes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return utimes_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condition_variable_;
+  bool held_{false};
+  std::vector<int64_t> utimes_;
+};
+
+TEST(AsyncLcmPublisherSystemTest, PublishesOffThread) {
+  drake::lcm::DrakeLcm lcm("memq://");
+  drake::lcm::Subscriber<lcmt_robot_output> sub(&lcm, "STATE");
+  auto publisher = AsyncLcmPublisherSystem::Make<lcmt_robot_output>(
+      "STATE", &lcm, {TriggerType::kForced});
+  auto context = publisher->CreateDefaultContext();
+  auto& input = publisher->get_input_port(0).FixValue(context.get(),
+                                                       MakeMessage(1));
+
+  publisher->Publish(*context);
+  publisher->Flush();
+  lcm.HandleSubscriptions(0);
+  EXPECT_EQ(sub.count(), 1);
+  EXPECT_EQ(sub.message().utime, 1000);
+
+  // The snapshot is a copy of the input
+  input.GetMutableData()->set_value(MakeMessage(2));
+  publisher->Publish(*context);
+  input.GetMutableData()->set_value(MakeMessage(3));
+  publisher->Flush();
+  lcm.HandleSubscriptions(0);
+  EXPECT_EQ(sub.count(), 2);
+  EXPECT_EQ(sub.message().utime, 2000);
+  EXPECT_EQ(sub.message().position[1], 4.0);
+  EXPECT_EQ(publisher->get_num_published(), 2);
+  EXPECT_EQ(publisher->get_num_dropped(), 0);
+}
+
+TEST(AsyncLcmPublisherSystemTest, DropsOldestWhileSending) {
+  BlockingLcm lcm;
+  auto publisher = AsyncLcmPublisherSystem::Make<lcmt_robot_output>(
+      "STATE", &lcm, {TriggerType::kForced});
+  auto context = publisher->CreateDefaultContext();
+  auto& input = publisher->get_input_port(0).FixValue(context.get(),
+                                                       MakeMessage(0));
+
+  // While message 0 is being sent, messages 1 to 3 are each replaced by the
+  // next one
+  lcm.Hold();
+  publisher->Publish(*context);
+  lcm.WaitForPublish(1);
+  for (int i = 1; i <= 4; i++) {
+    input.GetMutableData()->set_value(MakeMessage(i));
+    publisher->Publish(*context);
+  }
+  EXPECT_EQ(publisher->get_num_dropped(), 3);
+  lcm.Release();
+  publisher->Flush();
+  EXPECT_EQ(lcm.utimes(), std::vector<int64_t>({0, 4000}));
+  EXPECT_EQ(publisher->get_num_published(), 2);
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
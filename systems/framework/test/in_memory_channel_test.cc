@@ -0,0 +1,115 @@
+#include "systems/framework/in_memory_channel.h"
+
+#include <memory>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "dairlib/lcmt_controller_switch.hpp"
+#include "dairlib/lcmt_robot_output.hpp"
+#include "systems/framework/in_memory_driven_loop.h"
+#include "systems/framework/in_memory_systems.h"
+
+#include "drake/lcm/drake_lcm.h"
+#include "drake/lcm/lcm_messages.h"
+#include "drake/systems/framework/diagram_builder.h"
+#include "drake/systems/primitives/pass_through.h"
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+lcmt_robot_output MakeMessage(int i) {
+  lcmt_robot_output msg{};
+  msg.utime = 1000 * i;
+  msg.num_positions = 2;
+  msg.position = {1.0 * i, 2.0 * i};
+  return msg;
+}
+
+TEST(InMemoryChannelTest, PublishSharesAndReusesBuffers) {
+  InMemoryBus bus;
+  auto channel = bus.GetChannel<lcmt_robot_output>("STATE");
+  EXPECT_EQ(bus.GetChannel<lcmt_robot_output>("STATE"), channel);
+  EXPECT_THROW(bus.GetChannel<lcmt_controller_switch>("STATE"),
+               std::runtime_error);
+  EXPECT_EQ(channel->sequence(), 0);
+  EXPECT_EQ(channel->GetLatest(), nullptr);
+
+  channel->Publish(MakeMessage(1));
+  int64_t sequence;
+  const auto held = channel->GetLatest(&sequence);
+  EXPECT_EQ(sequence, 1);
+  EXPECT_EQ(held->utime, 1000);
+
+  // A held message is not overwritten, and released buffers are reused
+  channel->Publish(MakeMessage(2));
+  channel->Publish(MakeMessage(3));
+  EXPECT_EQ(held->position[1], 2.0);
+  const lcmt_robot_output* latest = channel->GetLatest(&sequence).get();
+  EXPECT_EQ(sequence, 3);
+  EXPECT_EQ(latest->utime, 3000);
+  channel->Publish(MakeMessage(4));
+  channel->Publish(MakeMessage(5));
+  EXPECT_EQ(channel->GetLatest().get(), latest);
+  EXPECT_EQ(bus.GetChannelNames(), std::vector<std::string>{"STATE"});
+}
+
+TEST(InMemoryChannelTest, LcmTap) {
+  drake::lcm::DrakeLcm lcm("memq://");
+  drake::lcm::Subscriber<lcmt_robot_output> sub(&lcm, "STATE");
+  {
+    InMemoryBus bus;
+    bus.StartLcmTap(&lcm);
+    auto channel = bus.GetChannel<lcmt_robot_output>("STATE");
+    for (int i = 0; i < 5; i++) {
+      channel->Publish(MakeMessage(i));
+    }
+    // The tap is drained when the bus is destroyed
+  }
+  lcm.HandleSubscriptions(0);
+  EXPECT_EQ(sub.count(), 5);
+  EXPECT_EQ(sub.message().utime, 4000);
+  EXPECT_EQ(sub.message().position[0], 4.0);
+}
+
+TEST(InMemoryChannelTest, DrivenLoopEchoesMessages) {
+  InMemoryBus bus;
+  auto state_channel = bus.GetChannel<lcmt_robot_output>("STATE");
+  auto echo_channel = bus.GetChannel<lcmt_robot_output>("ECHO");
+
+  drake::systems::DiagramBuilder<double> builder;
+  auto parser = builder.AddSystem<drake::systems::PassThrough<double>>(
+      *drake::AbstractValue::Make(lcmt_robot_output{}));
+  auto echo = builder.AddSystem<InMemoryPublisherSystem<lcmt_robot_output>>(
+      echo_channel,
+      InMemoryTriggerTypes({drake::systems::TriggerType::kForced}));
+  builder.Connect(parser->get_output_port(), echo->get_input_port(0));
+  auto subscriber =
+      builder.AddSystem<InMemorySubscriberSystem<lcmt_robot_output>>(
+          state_channel);
+  InMemoryDrivenLoop<lcmt_robot_output> loop(builder.Build(), parser,
+                                             state_channel, true);
+
+  std::thread loop_thread([&loop]() { loop.Simulate(0.005); });
+  int64_t echo_sequence = 0;
+  for (int i = 0; i <= 5; i++) {
+    state_channel->Publish(MakeMessage(i));
+    echo_sequence = echo_channel->WaitForMessage(echo_sequence);
+    EXPECT_EQ(echo_channel->GetLatest()->utime, 1000 * i);
+  }
+  loop_thread.join();
+
+  // The subscriber system stored the latest message during AdvanceTo
+  const auto& context = loop.get_diagram()->GetSubsystemContext(
+      *subscriber, loop.get_diagram_mutable_context());
+  EXPECT_EQ(subscriber->GetMessageSequence(context), 6);
+  EXPECT_EQ(subscriber->get_output_port(0)
+                .Eval<lcmt_robot_output>(context)
+                .utime,
+            5000);
+  EXPECT_EQ(loop.get_timer().Summarize().num_iterations, 6);
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,108 @@
+#include "systems/framework/lcm_lockstep.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "dairlib/lcmt_robot_output.hpp"
+#include "lcm/shm_lcm.h"
+#include "systems/framework/lcm_driven_loop.h"
+
+#include "drake/systems/framework/diagram_builder.h"
+#include "drake/systems/primitives/constant_vector_source.h"
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+using drake::systems::ConstantVectorSource;
+using drake::systems::Diagram;
+using drake::systems::DiagramBuilder;
+
+const char kStateChannel[] = "STATE";
+const char kAckChannel[] = "ACK";
+
+class LcmLockstepTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    url_ = "shm://lcm_lockstep_test_" + std::to_string(getpid());
+    ShmLcm::RemoveSegment(url_);
+  }
+  void TearDown() override { ShmLcm::RemoveSegment(url_); }
+
+  std::unique_ptr<Diagram<double>> MakeDiagram() {
+    DiagramBuilder<double> builder;
+    builder.AddSystem<ConstantVectorSource<double>>(1.0);
+    auto diagram = builder.Build();
+    diagram->set_name("lockstep_test");
+    return diagram;
+  }
+
+  static void PublishState(drake::lcm::DrakeLcmInterface* lcm, int64_t utime) {
+    lcmt_robot_output msg{};
+    msg.utime = utime;
+    drake::lcm::Publish(lcm, kStateChannel, msg);
+  }
+
+  std::string url_;
+};
+
+TEST_F(LcmLockstepTest, EveryMessageIsAcknowledged) {
+  const int num_steps = 200;
+  ShmLcm sender_lcm(url_);
+  ShmLcm loop_lcm(url_);
+  LcmLockstep lockstep(&sender_lcm, kAckChannel, 5.0);
+  LcmDrivenLoop<lcmt_robot_output> loop(&loop_lcm, MakeDiagram(),
+                                        kStateChannel, false);
+  loop.EnableLockstep(kAckChannel);
+  std::thread loop_thread(
+      [&loop]() { loop.Simulate((num_steps - 0.5) * 1e-3); });
+
+  // Without lockstep, the loop would only handle the latest of these messages
+  for (int i = 0; i < num_steps; i++) {
+    PublishState(&sender_lcm, 1000 * i);
+    lockstep.WaitForAck(1000 * i);
+  }
+  loop_thread.join();
+
+  EXPECT_EQ(lockstep.num_acks(), num_steps);
+  EXPECT_EQ(loop.get_timer().Summarize().num_iterations, num_steps);
+  EXPECT_DOUBLE_EQ(loop.get_diagram_mutable_context().get_time(),
+                   (num_steps - 1) * 1e-3);
+}
+
+TEST_F(LcmLockstepTest, FirstMessageIsResent) {
+  ShmLcm sender_lcm(url_);
+  LcmLockstep lockstep(&sender_lcm, kAckChannel, 5.0);
+  // Sent before the loop subscribes, so only the resends reach it
+  PublishState(&sender_lcm, 0);
+
+  ShmLcm loop_lcm(url_);
+  LcmDrivenLoop<lcmt_robot_output> loop(&loop_lcm, MakeDiagram(),
+                                        kStateChannel, false);
+  loop.EnableLockstep(kAckChannel);
+  std::thread loop_thread([&loop]() { loop.Simulate(0.5e-3); });
+
+  lockstep.WaitForAck(0, [&sender_lcm]() { PublishState(&sender_lcm, 0); });
+  PublishState(&sender_lcm, 1000);
+  lockstep.WaitForAck(1000);
+  loop_thread.join();
+
+  // A resend after the first acknowledgement is not handled again
+  EXPECT_EQ(loop.get_timer().Summarize().num_iterations, 2);
+}
+
+TEST_F(LcmLockstepTest, Timeout) {
+  ShmLcm sender_lcm(url_);
+  LcmLockstep lockstep(&sender_lcm, kAckChannel, 0.05);
+  PublishState(&sender_lcm, 0);
+  EXPECT_THROW(lockstep.WaitForAck(0), std::runtime_error);
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
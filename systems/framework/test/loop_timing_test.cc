@@ -0,0 +1,65 @@
+#include "systems/framework/loop_timing.h"
+
+#include <gtest/gtest.h>
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+TEST(LoopTimerTest, SummarizeSectionsAndDrops) {
+  LoopTimer timer("test", 2);
+  const int section = LoopTimer::RegisterSection("loop_timing_test");
+  EXPECT_EQ(LoopTimer::RegisterSection("loop_timing_test"), section);
+
+  // Sections outside of an iteration are ignored
+  { ScopedLoopSection timing(section); }
+
+  for (int i = 0; i < 3; i++) {
+    timer.BeginIteration(LoopTimer::Now());
+    {
+      ScopedLoopSection timing(section);
+      const int64_t start = LoopTimer::Now();
+      while (LoopTimer::Now() - start < 1000) {
+      }
+    }
+    timer.MarkAdvanceEnd();
+    timer.EndIteration();
+  }
+
+  const lcmt_loop_timing msg = timer.Summarize();
+  EXPECT_EQ(msg.loop_name, "test");
+  EXPECT_EQ(msg.num_iterations, 2);
+  EXPECT_EQ(msg.num_dropped, 1);
+  EXPECT_EQ(msg.num_deadline_misses, 0);
+  ASSERT_EQ(msg.num_stats, 5);
+  const auto& total = msg.stats[3];
+  EXPECT_EQ(total.name, "total");
+  const auto& timed = msg.stats[4];
+  EXPECT_EQ(timed.name, "loop_timing_test");
+  EXPECT_EQ(timed.count, 2);
+  EXPECT_GE(timed.p50_us, 1.0);
+  EXPECT_LE(timed.max_us, total.max_us);
+  int count = 0;
+  for (int c : timed.counts) {
+    count += c;
+  }
+  EXPECT_EQ(count, 2);
+
+  // The ring was drained
+  EXPECT_EQ(timer.Summarize().num_iterations, 0);
+}
+
+TEST(LoopTimerTest, DeadlineMisses) {
+  LoopTimer timer("test");
+  timer.set_deadline(1e-3);
+  const int64_t now = LoopTimer::Now();
+  timer.BeginIteration(now - 2000000);
+  timer.EndIteration();
+  timer.BeginIteration(now);
+  timer.EndIteration();
+  EXPECT_EQ(timer.Summarize().num_deadline_misses, 1);
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,50 @@
+#include "systems/framework/realtime.h"
+
+#include <gtest/gtest.h>
+
+#include "drake/systems/framework/diagram_builder.h"
+#include "drake/systems/primitives/constant_vector_source.h"
+#include "drake/systems/primitives/zero_order_hold.h"
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+TEST(RealtimeTest, ParseCpuList) {
+  EXPECT_EQ(ParseCpuList(""), std::vector<int>());
+  EXPECT_EQ(ParseCpuList("3"), std::vector<int>({3}));
+  EXPECT_EQ(ParseCpuList("1,4-6"), std::vector<int>({1, 4, 5, 6}));
+  EXPECT_THROW(ParseCpuList("2x"), std::runtime_error);
+  EXPECT_THROW(ParseCpuList("5-2"), std::runtime_error);
+  EXPECT_THROW(ParseCpuList("-1"), std::runtime_error);
+}
+
+TEST(RealtimeTest, MeasureWakeupLatency) {
+  for (bool spin : {false, true}) {
+    const WakeupLatency latency = MeasureWakeupLatency(20, 1e-4, spin);
+    EXPECT_EQ(latency.count, 20);
+    EXPECT_GE(latency.min_us, 0);
+    EXPECT_LE(latency.min_us, latency.mean_us);
+    EXPECT_LE(latency.p99_us, latency.max_us);
+  }
+  EXPECT_EQ(MeasureWakeupLatency(0, 1e-4).count, 0);
+}
+
+TEST(RealtimeTest, PrefaultLeavesContextUnchanged) {
+  drake::systems::DiagramBuilder<double> builder;
+  auto source = builder.AddSystem<drake::systems::ConstantVectorSource<double>>(
+      Eigen::Vector2d(1, 2));
+  auto hold = builder.AddSystem<drake::systems::ZeroOrderHold<double>>(0.01, 2);
+  builder.Connect(source->get_output_port(), hold->get_input_port());
+  auto diagram = builder.Build();
+  auto context = diagram->CreateDefaultContext();
+
+  PrefaultSystem(*diagram, *context);
+  EXPECT_EQ(context->get_time(), 0);
+  EXPECT_EQ(context->get_discrete_state_vector().CopyToVector(),
+            Eigen::Vector2d::Zero());
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
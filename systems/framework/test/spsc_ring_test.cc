@@ -0,0 +1,118 @@
+#include "systems/framework/spsc_ring.h"
+
+#include <array>
+#include <thread>
+#include <gtest/gtest.h>
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+TEST(SpscRingTest, PushPopWrapsAround) {
+  SpscRing<int> ring(4);
+  int value;
+  EXPECT_FALSE(ring.Pop(&value));
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 4; i++) {
+      EXPECT_TRUE(ring.Push(10 * round + i));
+    }
+    EXPECT_FALSE(ring.Push(-1));
+    for (int i = 0; i < 4; i++) {
+      ASSERT_TRUE(ring.Pop(&value));
+      EXPECT_EQ(value, 10 * round + i);
+    }
+    EXPECT_FALSE(ring.Pop(&value));
+  }
+}
+
+TEST(SpscRingTest, InPlace) {
+  SpscRing<std::array<int, 8>> ring(2);
+  EXPECT_EQ(ring.Front(), nullptr);
+  std::array<int, 8>* slot = ring.BeginPush();
+  ASSERT_NE(slot, nullptr);
+  slot->fill(1);
+  // Not visible until committed
+  EXPECT_EQ(ring.size(), 0);
+  ring.CommitPush();
+  ring.BeginPush()->fill(2);
+  ring.CommitPush();
+  EXPECT_EQ(ring.BeginPush(), nullptr);
+  EXPECT_EQ(ring.size(), 2);
+  EXPECT_EQ((*ring.Front())[7], 1);
+  ring.PopFront();
+  EXPECT_EQ((*ring.Front())[0], 2);
+  EXPECT_EQ(ring.size(), 1);
+}
+
+TEST(SpscRingTest, OverwriteDropsOldest) {
+  SpscRing<int> ring(4);
+  int value;
+  bool dropped;
+  EXPECT_FALSE(ring.PopLatest(&value));
+  for (int i = 0; i < 10; i++) {
+    *ring.BeginPushOverwrite(&dropped) = i;
+    EXPECT_EQ(dropped, i >= 4);
+    ring.CommitPush();
+  }
+  EXPECT_EQ(ring.size(), 4);
+  ASSERT_TRUE(ring.PopLatest(&value));
+  EXPECT_EQ(value, 9);
+  EXPECT_FALSE(ring.PopLatest(&value));
+
+  *ring.BeginPushOverwrite(&dropped) = 10;
+  EXPECT_FALSE(dropped);
+  ring.CommitPush();
+  ASSERT_TRUE(ring.PopLatest(&value));
+  EXPECT_EQ(value, 10);
+}
+
+TEST(SpscRingTest, OverwriteProducerConsumerThreads) {
+  constexpr int kCount = 100000;
+  SpscRing<std::array<int, 8>> ring(4);
+  std::thread producer([&ring]() {
+    bool dropped;
+    for (int i = 1; i <= kCount; i++) {
+      std::array<int, 8>* slot;
+      // Only null while the consumer copies the slot
+      while ((slot = ring.BeginPushOverwrite(&dropped)) == nullptr) {
+      }
+      slot->fill(i);
+      ring.CommitPush();
+    }
+  });
+  // The consumer sees whole values, in order, and ends with the last one
+  std::array<int, 8> value{};
+  int last = 0;
+  while (last < kCount) {
+    if (ring.PopLatest(&value)) {
+      EXPECT_GT(value[0], last);
+      EXPECT_EQ(value[7], value[0]);
+      last = value[0];
+    }
+  }
+  producer.join();
+}
+
+TEST(SpscRingTest, ProducerConsumerThreads) {
+  constexpr int kCount = 100000;
+  SpscRing<int> ring(64);
+  std::thread producer([&ring]() {
+    for (int i = 0; i < kCount; i++) {
+      while (!ring.Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  int value;
+  for (int i = 0; i < kCount; i++) {
+    while (!ring.Pop(&value)) {
+      std::this_thread::yield();
+    }
+    ASSERT_EQ(value, i);
+  }
+  producer.join();
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
@@ -1,13 +1,9 @@
 #pragma once
 
+#include <memory>
 #include <string>
-#include "drake/lcm/drake_lcm_log.h"
-#include "drake/systems/analysis/simulator.h"
-#include "drake/systems/framework/diagram_builder.h"
-#include "drake/systems/lcm/lcm_log_playback_system.h"
-#include "drake/systems/lcm/lcm_subscriber_system.h"
 
-#include "systems/primitives/vector_aggregator.h"
+#include "systems/log_parser/lcm_log_reader.h"
 
 namespace dairlib {
 namespace multibody {
@@ -28,39 +24,40 @@ namespace multibody {
 /// Output:
 ///   - VectorXd `t` to store time
 ///   - MatrixXd `x` to store the information in the lcm message
+///
+/// Messages are read with LcmLogReader and passed through `system` one at a
+/// time, without a Simulator. As with VectorAggregator, messages repeating the
+/// previous timestamp (or an initial timestamp of zero) are dropped. For
+/// lcmt_robot_output and lcmt_robot_input, LcmLogReader::ReadRobotOutput()
+/// and ReadRobotInput() avoid the system altogether.
 template <typename T, typename U>
 void parseLcmLog(std::unique_ptr<U> system, std::string file,
                  std::string channel, Eigen::VectorXd* t, Eigen::MatrixXd* x,
                  double duration = 1.0e6) {
-  using drake::systems::lcm::LcmSubscriberSystem;
-
-  drake::lcm::DrakeLcmLog r_log(file, false);
-
-  drake::systems::DiagramBuilder<double> builder;
-
-  builder.AddSystem<drake::systems::lcm::LcmLogPlaybackSystem>(&r_log);
-
-  auto output_sub =
-      builder.AddSystem(LcmSubscriberSystem::Make<T>(channel, &r_log));
-
-  auto output_receiver = builder.AddSystem(std::move(system));
-  builder.Connect(*output_sub, *output_receiver);
-
-  auto output_aggregator = builder.AddSystem<systems::VectorAggregator>(
-      output_receiver->get_output_port(0).size() - 1);
-
-  builder.Connect(*output_receiver, *output_aggregator);
-
-  auto diagram = builder.Build();
-
-  drake::systems::Simulator<double> sim(*diagram);
-
-  sim.AdvanceTo(r_log.GetNextMessageTime() + duration);
-
-  *t = output_aggregator->BuildTimestampVector();
-
-  *x = output_aggregator->BuildMatrixFromVectors();
-  }
-} // multibody
-} //dairlib
-
+  LcmLogReader reader(file);
+  const int n_x = system->get_output_port(0).size() - 1;
+
+  auto context = system->CreateDefaultContext();
+  auto& input = system->get_input_port(0).FixValue(context.get(), T{});
+  bool has_previous = false;
+  double previous = 0;
+
+  reader.ReadChannel<T>(
+      channel, n_x,
+      [&](const T& msg, double* t_i, Eigen::Ref<Eigen::VectorXd> column) {
+        input.GetMutableData()->template get_mutable_value<T>() = msg;
+        const auto& output = system->get_output_port(0).Eval(*context);
+        *t_i = output(n_x);
+        if (has_previous ? (*t_i == previous) : (*t_i == 0)) {
+          return false;
+        }
+        has_previous = true;
+        previous = *t_i;
+        column = output.head(n_x);
+        return true;
+      },
+      t, x, 0, duration);
+}
+
+}  // namespace multibody
+}  // namespace dairlib
@@ -0,0 +1,48 @@
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+
+#include <gflags/gflags.h>
+
+#include "systems/log_parser/lcm_log_reader.h"
+
+/**
+  Writes (or refreshes) the sidecar index of each of the given LCM logs, so
+  that later readers can skip scanning them, and prints a summary of their
+  channels. The usage is:
+
+    index_lcm_log [--rebuild] <log> [<log> ...]
+*/
+
+DEFINE_bool(rebuild, false, "Rebuild indices, even if they are current.");
+
+namespace dairlib {
+
+int do_main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  if (argc < 2) {
+    std::cerr << "usage: index_lcm_log [--rebuild] <log> [<log> ...]"
+              << std::endl;
+    return 1;
+  }
+
+  for (int i = 1; i < argc; i++) {
+    if (FLAGS_rebuild) {
+      std::remove(multibody::LcmLogReader::IndexFile(argv[i]).c_str());
+    }
+    multibody::LcmLogReader reader(argv[i]);
+    std::cout << argv[i] << (reader.loaded_index() ? " (index current)" : "")
+              << ": " << std::fixed << std::setprecision(1)
+              << reader.GetDuration() << " s" << std::endl;
+    for (const auto& channel : reader.GetChannels()) {
+      std::cout << "  " << std::left << std::setw(32) << channel
+                << std::right << std::setw(10)
+                << reader.GetNumMessages(channel) << std::endl;
+    }
+  }
+  return 0;
+}
+
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) { return dairlib::do_main(argc, argv); }
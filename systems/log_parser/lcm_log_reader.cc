@@ -0,0 +1,422 @@
+#include "systems/log_parser/lcm_log_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace dairlib {
+namespace multibody {
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Event header: sync word, event number, timestamp, channel length and data
+// length, all big-endian
+constexpr uint32_t kSyncWord = 0xEDA1DA01;
+constexpr uint64_t kHeaderSize = 4 + 8 + 8 + 4 + 4;
+
+// "DLCMIDX" and a version
+constexpr uint64_t kIndexMagic = 0x44'4C'43'4D'49'44'58'02;
+
+struct IndexHeader {
+  uint64_t magic;
+  uint64_t event_size;
+  uint64_t log_size;
+  int64_t log_mtime_ns;
+  int64_t first_utime;
+  int64_t last_utime;
+  uint64_t num_channels;
+};
+
+uint32_t ReadUint32(const uint8_t* p) {
+  return (static_cast<uint32_t>(p[0]) << 24) |
+         (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+int64_t ReadInt64(const uint8_t* p) {
+  return static_cast<int64_t>((static_cast<uint64_t>(ReadUint32(p)) << 32) |
+                              ReadUint32(p + 4));
+}
+
+}  // namespace
+
+LcmLogReader::LcmLogReader(const string& file, bool use_index) {
+  const int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("LcmLogReader: unable to open " + file + ": " +
+                             std::strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw std::runtime_error("LcmLogReader: unable to stat " + file);
+  }
+  size_ = st.st_size;
+  if (size_ > 0) {
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("LcmLogReader: unable to map " + file + ": " +
+                               std::strerror(errno));
+    }
+    data_ = static_cast<const uint8_t*>(data);
+  }
+  // The mapping keeps the file open
+  close(fd);
+
+  const int64_t mtime_ns =
+      static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+      st.st_mtim.tv_nsec;
+  if (use_index && LoadIndex(IndexFile(file), mtime_ns)) {
+    loaded_index_ = true;
+    return;
+  }
+  BuildIndex();
+  if (use_index) {
+    WriteIndex(IndexFile(file), mtime_ns);
+  }
+}
+
+LcmLogReader::~LcmLogReader() {
+  if (data_ != nullptr) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+  }
+}
+
+void LcmLogReader::BuildIndex() {
+  if (data_ == nullptr) {
+    return;
+  }
+  // The index is one sequential pass over the headers
+  madvise(const_cast<uint8_t*>(data_), size_, MADV_SEQUENTIAL);
+
+  bool first = true;
+  // Reused, so that looking up a channel does not allocate
+  string channel;
+  vector<Event>* channel_events = nullptr;
+  uint64_t offset = 0;
+  while (offset + kHeaderSize <= size_) {
+    const uint8_t* header = data_ + offset;
+    if (ReadUint32(header) != kSyncWord) {
+      offset++;
+      continue;
+    }
+    const int64_t utime = ReadInt64(header + 12);
+    const int32_t channel_size = ReadUint32(header + 20);
+    const int32_t data_size = ReadUint32(header + 24);
+    if (channel_size < 0 || data_size < 0 ||
+        offset + kHeaderSize + channel_size + data_size > size_) {
+      // A corrupt or truncated event; resynchronize after its sync word
+      offset++;
+      continue;
+    }
+
+    const char* name = reinterpret_cast<const char*>(header + kHeaderSize);
+    if (channel_events == nullptr ||
+        channel.compare(0, string::npos, name, channel_size) != 0) {
+      channel.assign(name, channel_size);
+      channel_events = &events_[channel];
+    }
+    channel_events->push_back(
+        {utime, offset + kHeaderSize + channel_size, data_size});
+
+    // Logs which need rectifying are not quite in order
+    if (first) {
+      first_utime_ = utime;
+      last_utime_ = utime;
+      first = false;
+    }
+    first_utime_ = std::min(first_utime_, utime);
+    last_utime_ = std::max(last_utime_, utime);
+    offset += kHeaderSize + channel_size + data_size;
+  }
+
+  // Decoding jumps between channels
+  madvise(const_cast<uint8_t*>(data_), size_, MADV_NORMAL);
+}
+
+string LcmLogReader::IndexFile(const string& file) { return file + ".idx"; }
+
+// The sidecar is a cache for this machine, so it is written in native byte
+// order, as
+//   header: kIndexMagic, sizeof(Event), log size, log mtime, first and last
+//     log times, number of channels
+//   per channel: name length, name, number of events, events
+bool LcmLogReader::LoadIndex(const string& index_file, int64_t mtime_ns) {
+  std::FILE* f = std::fopen(index_file.c_str(), "rb");
+  if (f == nullptr) {
+    return false;
+  }
+  const auto read = [f](void* data, size_t size) {
+    return std::fread(data, 1, size, f) == size;
+  };
+  IndexHeader header;
+  bool ok = read(&header, sizeof(header)) && header.magic == kIndexMagic &&
+            header.event_size == sizeof(Event) && header.log_size == size_ &&
+            header.log_mtime_ns == mtime_ns;
+  for (uint64_t c = 0; ok && c < header.num_channels; c++) {
+    uint64_t name_size;
+    uint64_t num_events;
+    string name;
+    ok = read(&name_size, sizeof(name_size)) && name_size <= size_;
+    if (ok) {
+      name.resize(name_size);
+      ok = read(&name[0], name_size) && read(&num_events, sizeof(num_events)) &&
+           num_events <= size_ / kHeaderSize;
+    }
+    if (ok) {
+      auto& events = events_[name];
+      events.resize(num_events);
+      ok = read(events.data(), num_events * sizeof(Event));
+      // Decoding trusts the events, so they must lie within the log
+      for (uint64_t i = 0; ok && i < num_events; i++) {
+        const Event& e = events[i];
+        ok = e.data_size >= 0 && e.data_offset <= size_ &&
+             static_cast<uint64_t>(e.data_size) <= size_ - e.data_offset;
+      }
+    }
+  }
+  std::fclose(f);
+  if (!ok) {
+    events_.clear();
+    return false;
+  }
+  first_utime_ = header.first_utime;
+  last_utime_ = header.last_utime;
+  return true;
+}
+
+void LcmLogReader::WriteIndex(const string& index_file,
+                              int64_t mtime_ns) const {
+  // Written to a temporary file and renamed, so concurrent readers never see
+  // a partial index
+  const string tmp_file = index_file + ".tmp" + std::to_string(getpid());
+  std::FILE* f = std::fopen(tmp_file.c_str(), "wb");
+  if (f == nullptr) {
+    return;
+  }
+  const auto write = [f](const void* data, size_t size) {
+    return std::fwrite(data, 1, size, f) == size;
+  };
+  IndexHeader header;
+  header.magic = kIndexMagic;
+  header.event_size = sizeof(Event);
+  header.log_size = size_;
+  header.log_mtime_ns = mtime_ns;
+  header.first_utime = first_utime_;
+  header.last_utime = last_utime_;
+  header.num_channels = events_.size();
+  bool ok = write(&header, sizeof(header));
+  for (const auto& [name, events] : events_) {
+    const uint64_t name_size = name.size();
+    const uint64_t num_events = events.size();
+    ok = ok && write(&name_size, sizeof(name_size)) &&
+         write(name.data(), name_size) &&
+         write(&num_events, sizeof(num_events)) &&
+         write(events.data(), num_events * sizeof(Event));
+  }
+  ok = (std::fclose(f) == 0) && ok;
+  if (!ok || std::rename(tmp_file.c_str(), index_file.c_str()) != 0) {
+    std::remove(tmp_file.c_str());
+  }
+}
+
+vector<string> LcmLogReader::GetChannels() const {
+  vector<string> channels;
+  for (const auto& it : events_) {
+    channels.push_back(it.first);
+  }
+  std::sort(channels.begin(), channels.end());
+  return channels;
+}
+
+bool LcmLogReader::HasChannel(const string& channel) const {
+  return events_.find(channel) != events_.end();
+}
+
+const vector<LcmLogReader::Event>& LcmLogReader::GetEvents(
+    const string& channel) const {
+  static const vector<Event> no_events;
+  const auto it = events_.find(channel);
+  return (it == events_.end()) ? no_events : it->second;
+}
+
+int LcmLogReader::GetNumMessages(const string& channel) const {
+  return GetEvents(channel).size();
+}
+
+VectorXd LcmLogReader::GetLogTimes(const string& channel) const {
+  const auto& events = GetEvents(channel);
+  VectorXd t(events.size());
+  for (size_t i = 0; i < events.size(); i++) {
+    t(i) = 1e-6 * (events[i].log_utime - first_utime_);
+  }
+  return t;
+}
+
+double LcmLogReader::GetDuration() const {
+  return 1e-6 * (last_utime_ - first_utime_);
+}
+
+vector<LcmLogReader::EventRef> LcmLogReader::GetEvents(
+    const vector<string>& channels, double start, double end) const {
+  const int64_t start_utime = first_utime_ + std::ceil(start * 1e6);
+  const int64_t end_utime = std::isinf(end)
+                                ? std::numeric_limits<int64_t>::max()
+                                : first_utime_ + std::ceil(end * 1e6);
+  // Filtered exactly, rather than by bisection as in GetWindow(), since this
+  // is also used on logs whose events are out of order
+  vector<EventRef> refs;
+  for (const auto& [name, events] : events_) {
+    if (!channels.empty() &&
+        std::find(channels.begin(), channels.end(), name) == channels.end()) {
+      continue;
+    }
+    for (const Event& event : events) {
+      if (event.log_utime >= start_utime && event.log_utime < end_utime) {
+        refs.push_back({&name, event.log_utime, data_ + event.data_offset,
+                        event.data_size});
+      }
+    }
+  }
+  // Offsets into the log give its order
+  std::sort(refs.begin(), refs.end(),
+            [](const EventRef& a, const EventRef& b) { return a.data < b.data; });
+  return refs;
+}
+
+const uint8_t* LcmLogReader::GetMessageData(const string& channel,
+                                            int i) const {
+  const auto& events = GetEvents(channel);
+  DRAKE_DEMAND(i >= 0 && i < static_cast<int>(events.size()));
+  return data_ + events[i].data_offset;
+}
+
+int LcmLogReader::GetMessageSize(const string& channel, int i) const {
+  const auto& events = GetEvents(channel);
+  DRAKE_DEMAND(i >= 0 && i < static_cast<int>(events.size()));
+  return events[i].data_size;
+}
+
+std::pair<int, int> LcmLogReader::GetWindow(const string& channel,
+                                            double start, double end) const {
+  const auto& events = GetEvents(channel);
+  const auto before = [this](const Event& event, double t) {
+    return 1e-6 * (event.log_utime - first_utime_) < t;
+  };
+  // Log times are nondecreasing within a log
+  const int first =
+      std::lower_bound(events.begin(), events.end(), start, before) -
+      events.begin();
+  const int last =
+      std::isinf(end)
+          ? static_cast<int>(events.size())
+          : std::lower_bound(events.begin() + first, events.end(), end,
+                             before) -
+                events.begin();
+  return {first, last};
+}
+
+RobotOutputLog LcmLogReader::ReadRobotOutput(const string& channel,
+                                             double start, double end) const {
+  RobotOutputLog log;
+  const auto [first, last] = GetWindow(channel, start, end);
+
+  // Sizes and layout from the first message in the window which can be
+  // decoded
+  lcmt_robot_output msg;
+  int i = first;
+  while (i < last && !DecodeMessage(channel, i, &msg)) {
+    i++;
+  }
+  if (i == last) {
+    log.t.resize(0);
+    log.num_skipped = last - first;
+    return log;
+  }
+  const int n_q = msg.num_positions;
+  const int n_v = msg.num_velocities;
+  const int n_u = msg.num_efforts;
+  log.position_names = msg.position_names;
+  log.velocity_names = msg.velocity_names;
+  log.effort_names = msg.effort_names;
+
+  // Everything is decoded into one stacked column [q; v; u; imu_accel] per
+  // message, then split, so that each message is decoded once
+  MatrixXd x;
+  log.num_skipped = ReadChannel<lcmt_robot_output>(
+      channel, n_q + n_v + n_u + 3,
+      [&](const lcmt_robot_output& m, double* t,
+          Eigen::Ref<VectorXd> column) {
+        if (m.position_names != log.position_names ||
+            m.velocity_names != log.velocity_names ||
+            m.effort_names != log.effort_names) {
+          return false;
+        }
+        *t = 1e-6 * m.utime;
+        column.head(n_q) = Eigen::Map<const VectorXd>(m.position.data(), n_q);
+        column.segment(n_q, n_v) =
+            Eigen::Map<const VectorXd>(m.velocity.data(), n_v);
+        column.segment(n_q + n_v, n_u) =
+            Eigen::Map<const VectorXd>(m.effort.data(), n_u);
+        column.tail(3) = Eigen::Map<const Eigen::Vector3d>(m.imu_accel);
+        return true;
+      },
+      &log.t, &x, start, end);
+  log.positions = x.topRows(n_q);
+  log.velocities = x.middleRows(n_q, n_v);
+  log.efforts = x.middleRows(n_q + n_v, n_u);
+  log.imu_accel = x.bottomRows(3);
+  return log;
+}
+
+RobotInputLog LcmLogReader::ReadRobotInput(const string& channel,
+                                           double start, double end) const {
+  RobotInputLog log;
+  const auto [first, last] = GetWindow(channel, start, end);
+
+  // Sizes and layout from the first message in the window which can be
+  // decoded
+  lcmt_robot_input msg;
+  int i = first;
+  while (i < last && !DecodeMessage(channel, i, &msg)) {
+    i++;
+  }
+  if (i == last) {
+    log.t.resize(0);
+    log.num_skipped = last - first;
+    return log;
+  }
+  const int n_u = msg.num_efforts;
+  log.effort_names = msg.effort_names;
+
+  log.num_skipped = ReadChannel<lcmt_robot_input>(
+      channel, n_u,
+      [&](const lcmt_robot_input& m, double* t, Eigen::Ref<VectorXd> column) {
+        if (m.effort_names != log.effort_names) {
+          return false;
+        }
+        *t = 1e-6 * m.utime;
+        column = Eigen::Map<const VectorXd>(m.efforts.data(), n_u);
+        return true;
+      },
+      &log.t, &log.efforts, start, end);
+  return log;
+}
+
+}  // namespace multibody
+}  // namespace dairlib
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "dairlib/lcmt_robot_input.hpp"
+#include "dairlib/lcmt_robot_output.hpp"
+#include "drake/common/drake_assert.h"
+#include "drake/common/drake_copyable.h"
+
+namespace dairlib {
+namespace multibody {
+
+/// Messages of an lcmt_robot_output channel, one column per message, with
+/// the rows in message order
+struct RobotOutputLog {
+  Eigen::VectorXd t;
+  Eigen::MatrixXd positions;
+  Eigen::MatrixXd velocities;
+  Eigen::MatrixXd efforts;
+  Eigen::MatrixXd imu_accel;
+  std::vector<std::string> position_names;
+  std::vector<std::string> velocity_names;
+  std::vector<std::string> effort_names;
+  /// Messages which could not be decoded, or whose layout differs from the
+  /// first message's
+  int num_skipped = 0;
+};
+
+/// Messages of an lcmt_robot_input channel, one column per message
+struct RobotInputLog {
+  Eigen::VectorXd t;
+  Eigen::MatrixXd efforts;
+  std::vector<std::string> effort_names;
+  int num_skipped = 0;
+};
+
+/// LcmLogReader reads LCM event logs without a Simulator or an LCM instance.
+///
+/// The constructor memory-maps the log and makes a single pass over the event
+/// headers, indexing the offset, size and log time of every message by
+/// channel. Messages are only decoded when a channel is read, directly from
+/// the mapped file into preallocated, column-major matrices. Channels which
+/// are not read cost nothing beyond the index.
+///
+/// The index is persisted next to the log, in a sidecar file (see
+/// IndexFile()), so later readers of the same log skip the scan entirely and
+/// only touch the pages of the messages they decode. The sidecar records the
+/// log's size and modification time, and is rebuilt if either changes, e.g.
+/// while a log is still being recorded.
+///
+/// Times returned by the Read functions are the messages' own timestamps (in
+/// seconds), as used by the receiver systems. Time windows are in seconds of
+/// log time, relative to the earliest event of the log.
+class LcmLogReader {
+ public:
+  DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(LcmLogReader)
+
+  /// An indexed event, pointing into the mapped log
+  struct EventRef {
+    const std::string* channel;
+    int64_t log_utime;
+    const uint8_t* data;
+    int32_t data_size;
+  };
+
+  /// Throws if the file cannot be opened or mapped. A truncated final event is
+  /// ignored, and corrupt events are skipped by searching for the next sync
+  /// word, as lcm-logplayer does.
+  /// @param use_index Load the sidecar index if it is current, and otherwise
+  ///   write it after scanning. Failing to write it (e.g. in a read-only
+  ///   directory) is not an error.
+  explicit LcmLogReader(const std::string& file, bool use_index = true);
+
+  ~LcmLogReader();
+
+  /// Path of the sidecar index of a log
+  static std::string IndexFile(const std::string& file);
+
+  /// Whether the index was loaded from the sidecar rather than scanned
+  bool loaded_index() const { return loaded_index_; }
+
+  std::vector<std::string> GetChannels() const;
+
+  bool HasChannel(const std::string& channel) const;
+
+  /// Zero if the channel is not in the log
+  int GetNumMessages(const std::string& channel) const;
+
+  /// Log time (in seconds, relative to the earliest event) of each of the
+  /// channel's messages
+  Eigen::VectorXd GetLogTimes(const std::string& channel) const;
+
+  /// Log time of the latest event, relative to the earliest
+  double GetDuration() const;
+
+  /// Events of the given channels (all channels if empty) with log time in
+  /// [start, end), in the order of the log. Only the index is read.
+  std::vector<EventRef> GetEvents(
+      const std::vector<std::string>& channels, double start = 0,
+      double end = std::numeric_limits<double>::infinity()) const;
+
+  /// Encoded bytes of the channel's i-th message
+  const uint8_t* GetMessageData(const std::string& channel, int i) const;
+  int GetMessageSize(const std::string& channel, int i) const;
+
+  /// Decodes the channel's i-th message into msg. Returns false if it could
+  /// not be decoded.
+  template <typename T>
+  bool DecodeMessage(const std::string& channel, int i, T* msg) const {
+    return msg->decode(GetMessageData(channel, i), 0,
+                       GetMessageSize(channel, i)) >= 0;
+  }
+
+  /// Decodes the channel's messages with log time in [start, end) into the
+  /// columns of x, with rows rows. fill(msg, &t, column) writes one message
+  /// into its column (an Eigen::Ref<Eigen::VectorXd>) and time, returning
+  /// false to skip the message. Columns are preallocated for every message in
+  /// the window and trimmed to those written. Returns the number of messages
+  /// skipped, including those which could not be decoded.
+  template <typename T, typename F>
+  int ReadChannel(const std::string& channel, int rows, F fill,
+                  Eigen::VectorXd* t, Eigen::MatrixXd* x, double start = 0,
+                  double end = std::numeric_limits<double>::infinity()) const {
+    const auto [first, last] = GetWindow(channel, start, end);
+    t->resize(last - first);
+    x->resize(rows, last - first);
+    // A single message, so its vectors' storage is reused between decodes
+    T msg;
+    int n = 0;
+    for (int i = first; i < last; i++) {
+      double t_i;
+      if (DecodeMessage(channel, i, &msg) && fill(msg, &t_i, x->col(n))) {
+        (*t)(n++) = t_i;
+      }
+    }
+    if (n < last - first) {
+      t->conservativeResize(n);
+      x->conservativeResize(rows, n);
+    }
+    return last - first - n;
+  }
+
+  /// Reads an lcmt_robot_output channel. Rows follow the layout, i.e. the
+  /// names, of the first message in the window, and messages with a different
+  /// layout are skipped.
+  RobotOutputLog ReadRobotOutput(
+      const std::string& channel, double start = 0,
+      double end = std::numeric_limits<double>::infinity()) const;
+
+  /// Reads an lcmt_robot_input channel
+  RobotInputLog ReadRobotInput(
+      const std::string& channel, double start = 0,
+      double end = std::numeric_limits<double>::infinity()) const;
+
+ private:
+  struct Event {
+    int64_t log_utime;
+    uint64_t data_offset;
+    int32_t data_size;
+  };
+
+  const std::vector<Event>& GetEvents(const std::string& channel) const;
+
+  // Range of indices of the channel's events in the time window
+  std::pair<int, int> GetWindow(const std::string& channel, double start,
+                                double end) const;
+
+  void BuildIndex();
+  bool LoadIndex(const std::string& index_file, int64_t mtime_ns);
+  void WriteIndex(const std::string& index_file, int64_t mtime_ns) const;
+
+  const uint8_t* data_ = nullptr;
+  uint64_t size_ = 0;
+  bool loaded_index_ = false;
+  int64_t first_utime_ = 0;
+  int64_t last_utime_ = 0;
+  std::unordered_map<std::string, std::vector<Event>> events_;
+};
+
+}  // namespace multibody
+}  // namespace dairlib
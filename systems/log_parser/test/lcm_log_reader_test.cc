@@ -0,0 +1,185 @@
+#include "systems/log_parser/lcm_log_reader.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "dairlib/lcmt_robot_input.hpp"
+#include "dairlib/lcmt_robot_output.hpp"
+#include "examples/Cassie/cassie_utils.h"
+#include "multibody/multibody_utils.h"
+#include "systems/log_parser/generic_lcm_log_parser.h"
+#include "systems/robot_lcm_systems.h"
+
+#include "drake/common/temp_directory.h"
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/lcm/drake_lcm_log.h"
+
+namespace dairlib {
+namespace multibody {
+namespace {
+
+using drake::lcm::DrakeLcmLog;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::string;
+using std::vector;
+
+lcmt_robot_output MakeOutput(int i) {
+  lcmt_robot_output msg{};
+  msg.utime = 1000 * i;
+  msg.num_positions = 2;
+  msg.num_velocities = 1;
+  msg.num_efforts = 1;
+  msg.position_names = {"a", "b"};
+  msg.velocity_names = {"adot"};
+  msg.effort_names = {"a_motor"};
+  msg.position = {1.0 * i, 2.0 * i};
+  msg.velocity = {-1.0 * i};
+  msg.effort = {0.5 * i};
+  msg.imu_accel[0] = 0;
+  msg.imu_accel[1] = 0;
+  msg.imu_accel[2] = 9.81;
+  return msg;
+}
+
+TEST(LcmLogReaderTest, IndexAndReadRobotOutput) {
+  const string file = drake::temp_directory() + "/robot_output.lcmlog";
+  {
+    DrakeLcmLog log(file, true);
+    for (int i = 0; i < 10; i++) {
+      drake::lcm::Publish(&log, "OUTPUT", MakeOutput(i), 1.0 + 0.01 * i);
+      lcmt_robot_input input{};
+      input.utime = 1000 * i;
+      drake::lcm::Publish(&log, "INPUT", input, 1.0 + 0.01 * i + 0.005);
+    }
+  }
+  // A truncated final event is ignored
+  {
+    std::ofstream out(file, std::ios::app | std::ios::binary);
+    const char partial[] = {'\xED', '\xA1', '\xDA', '\x01', 0, 0};
+    out.write(partial, sizeof(partial));
+  }
+
+  LcmLogReader reader(file);
+  EXPECT_EQ(reader.GetChannels(), (vector<string>{"INPUT", "OUTPUT"}));
+  EXPECT_FALSE(reader.HasChannel("OTHER"));
+  EXPECT_EQ(reader.GetNumMessages("OTHER"), 0);
+  EXPECT_EQ(reader.GetNumMessages("OUTPUT"), 10);
+  EXPECT_NEAR(reader.GetDuration(), 0.095, 1e-9);
+  EXPECT_NEAR(reader.GetLogTimes("INPUT")(2), 0.025, 1e-9);
+
+  const RobotOutputLog log = reader.ReadRobotOutput("OUTPUT", 0.015, 0.055);
+  EXPECT_EQ(log.position_names, (vector<string>{"a", "b"}));
+  EXPECT_EQ(log.effort_names, (vector<string>{"a_motor"}));
+  EXPECT_EQ(log.num_skipped, 0);
+  ASSERT_EQ(log.t.size(), 4);
+  EXPECT_TRUE(drake::CompareMatrices(log.t, Eigen::Vector4d(2, 3, 4, 5) * 1e-3,
+                                     1e-12));
+  EXPECT_EQ(log.positions.rows(), 2);
+  EXPECT_EQ(log.positions(1, 0), 4.0);
+  EXPECT_EQ(log.velocities(0, 3), -5.0);
+  EXPECT_EQ(log.efforts(0, 1), 1.5);
+  EXPECT_EQ(log.imu_accel(2, 2), 9.81);
+
+  // Every message carries its names
+  EXPECT_EQ(reader.ReadRobotOutput("OUTPUT", 0.05).velocity_names,
+            (vector<string>{"adot"}));
+
+  // Events of several channels, in the order of the log
+  const auto events = reader.GetEvents({"INPUT", "OUTPUT"}, 0.02, 0.04);
+  ASSERT_EQ(events.size(), 4u);
+  EXPECT_EQ(*events[0].channel, "OUTPUT");
+  EXPECT_EQ(*events[1].channel, "INPUT");
+  EXPECT_EQ(events[3].log_utime - events[0].log_utime, 15000);
+  EXPECT_EQ(reader.GetEvents({"INPUT"}).size(), 10u);
+
+  // The second reader loads the index written by the first
+  EXPECT_FALSE(reader.loaded_index());
+  LcmLogReader indexed_reader(file);
+  EXPECT_TRUE(indexed_reader.loaded_index());
+  EXPECT_EQ(indexed_reader.GetChannels(), reader.GetChannels());
+  EXPECT_EQ(indexed_reader.GetDuration(), reader.GetDuration());
+  const RobotOutputLog indexed_log =
+      indexed_reader.ReadRobotOutput("OUTPUT", 0.015, 0.055);
+  EXPECT_TRUE(drake::CompareMatrices(indexed_log.positions, log.positions));
+
+  // An index with an event outside of the log is rejected. The offset of the
+  // first event of the first channel follows the header, the channel's name
+  // and number of events, and that event's time.
+  {
+    std::fstream index(LcmLogReader::IndexFile(file),
+                       std::ios::in | std::ios::out | std::ios::binary);
+    uint64_t name_size;
+    index.seekg(7 * sizeof(uint64_t));
+    index.read(reinterpret_cast<char*>(&name_size), sizeof(name_size));
+    const uint64_t bad_offset = uint64_t{1} << 40;
+    index.seekp(9 * sizeof(uint64_t) + name_size + sizeof(int64_t));
+    index.write(reinterpret_cast<const char*>(&bad_offset),
+                sizeof(bad_offset));
+  }
+  LcmLogReader rescanned_reader(file);
+  EXPECT_FALSE(rescanned_reader.loaded_index());
+  EXPECT_TRUE(drake::CompareMatrices(
+      rescanned_reader.ReadRobotOutput("OUTPUT", 0.015, 0.055).positions,
+      log.positions));
+
+  // A changed log invalidates the index
+  {
+    std::ofstream out(file, std::ios::app | std::ios::binary);
+    out.put(0);
+  }
+  EXPECT_FALSE(LcmLogReader(file).loaded_index());
+}
+
+TEST(LcmLogReaderTest, ParseLcmLogMatchesReadRobotInput) {
+  drake::multibody::MultibodyPlant<double> plant(0.0);
+  addCassieMultibody(&plant);
+  plant.Finalize();
+  const auto actuator_map = makeNameToActuatorsMap(plant);
+
+  const string file = drake::temp_directory() + "/robot_input.lcmlog";
+  {
+    DrakeLcmLog log(file, true);
+    for (int i = 0; i < 20; i++) {
+      lcmt_robot_input msg{};
+      // The first message repeats the timestamp of the second
+      msg.utime = 1000 * std::max(i, 1);
+      for (const auto& [name, index] : actuator_map) {
+        msg.effort_names.push_back(name);
+        msg.efforts.push_back(i + 0.1 * index);
+      }
+      msg.num_efforts = msg.efforts.size();
+      drake::lcm::Publish(&log, "CASSIE_INPUT", msg, 0.001 * i);
+    }
+  }
+
+  VectorXd t;
+  MatrixXd x;
+  parseLcmLog<lcmt_robot_input>(
+      std::make_unique<systems::RobotInputReceiver>(plant), file,
+      "CASSIE_INPUT", &t, &x);
+  ASSERT_EQ(t.size(), 19);
+  EXPECT_EQ(t(0), 0.001);
+  EXPECT_EQ(x(3, 5), 6 + 0.3);
+
+  // The receiver orders efforts by actuator index, and the message by name
+  LcmLogReader reader(file);
+  const RobotInputLog log = reader.ReadRobotInput("CASSIE_INPUT");
+  ASSERT_EQ(log.t.size(), 20);
+  int row = 0;
+  for (const auto& [name, index] : actuator_map) {
+    EXPECT_EQ(log.effort_names[row], name);
+    EXPECT_TRUE(drake::CompareMatrices(log.efforts.row(row).tail(19),
+                                       x.row(index)));
+    row++;
+  }
+}
+
+}  // namespace
+}  // namespace multibody
+}  // namespace dairlib
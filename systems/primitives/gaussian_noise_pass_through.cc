@@ -5,6 +5,11 @@
 namespace dairlib {
 namespace systems {
 
+using drake::AbstractValue;
+using drake::systems::Context;
+using drake::systems::EventStatus;
+using drake::systems::State;
+
 GaussianNoisePassThrough::GaussianNoisePassThrough(
     int num_positions, int num_velocities, int num_inputs,
     const drake::MatrixX<double>& pos_variance,
@@ -21,6 +26,55 @@ GaussianNoisePassThrough::GaussianNoisePassThrough(
   this->DeclareVectorInputPort(input);
   this->DeclareVectorOutputPort(output,
                                 &GaussianNoisePassThrough::DoCalcVectorOutput);
+
+  // Noise of the positions and velocities in the current step
+  noise_idx_ = this->DeclareDiscreteState(
+      Eigen::VectorXd::Zero(num_positions + num_velocities));
+  generator_idx_ =
+      this->DeclareAbstractState(
+          AbstractValue::Make<std::mt19937>(std::mt19937()));
+  DeclarePerStepUnrestrictedUpdateEvent(&GaussianNoisePassThrough::DrawNoise);
+}
+
+void GaussianNoisePassThrough::SetDefaultState(const Context<double>& context,
+                                               State<double>* state) const {
+  LeafSystem<double>::SetDefaultState(context, state);
+  SampleNoise(state);
+}
+
+void GaussianNoisePassThrough::SetRandomState(
+    const Context<double>& context, State<double>* state,
+    drake::RandomGenerator* generator) const {
+  LeafSystem<double>::SetRandomState(context, state, generator);
+  state->get_mutable_abstract_state<std::mt19937>(generator_idx_)
+      .seed((*generator)());
+  SampleNoise(state);
+}
+
+EventStatus GaussianNoisePassThrough::DrawNoise(const Context<double>& context,
+                                                State<double>* state) const {
+  SampleNoise(state);
+  return EventStatus::Succeeded();
+}
+
+void GaussianNoisePassThrough::SampleNoise(State<double>* state) const {
+  auto& generator =
+      state->get_mutable_abstract_state<std::mt19937>(generator_idx_);
+  std::uniform_real_distribution<double> uniform(-1, 1);
+  Eigen::VectorXd pos_sample(num_positions_);
+  Eigen::VectorXd vel_sample(num_velocities_);
+  for (int i = 0; i < num_positions_; i++) {
+    pos_sample(i) = uniform(generator);
+  }
+  for (int i = 0; i < num_velocities_; i++) {
+    vel_sample(i) = uniform(generator);
+  }
+
+  auto noise = state->get_mutable_discrete_state()
+                   .get_mutable_vector(noise_idx_)
+                   .get_mutable_value();
+  noise.head(num_positions_) = pos_variance_ * pos_sample;
+  noise.tail(num_velocities_) = vel_variance_ * vel_sample;
 }
 
 void GaussianNoisePassThrough::DoCalcVectorOutput(
@@ -28,13 +82,11 @@ void GaussianNoisePassThrough::DoCalcVectorOutput(
     systems::OutputVector<double>* output) const {
   const systems::OutputVector<double>& input =
       *this->template EvalVectorInput<OutputVector>(context, 0);
+  const auto& noise = context.get_discrete_state(noise_idx_).get_value();
 
   output->SetFrom(input);
-  output->GetMutablePositions() +=
-      pos_variance_ * Eigen::VectorXd::Random(num_positions_);
-  output->GetMutableVelocities() +=
-      vel_variance_ * Eigen::VectorXd::Random(num_velocities_);
-//  std::cout << output->
+  output->GetMutablePositions() += noise.head(num_positions_);
+  output->GetMutableVelocities() += noise.tail(num_velocities_);
 }
 
 }  // namespace systems
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <memory>
+#include <random>
 #include <drake/common/eigen_types.h>
 
 #include "systems/framework/output_vector.h"
 #include "drake/common/drake_copyable.h"
+#include "drake/common/random.h"
 #include "drake/systems/framework/leaf_system.h"
 
 namespace dairlib {
@@ -12,7 +14,12 @@ namespace systems {
 
 /// this class is copied from drake/systems/primitives/Passthrough
 /// with the modification that it adds random noise to the values it is
-/// passing through
+/// passing through. The noise is drawn once per simulator step and held in the
+/// Context, from a generator in the Context's state, so that contexts can be
+/// simulated on separate threads. The generator is seeded by
+/// System::SetRandomContext(), and with a fixed seed otherwise. The first
+/// sample is drawn when the state is set, so the output is noisy before the
+/// first step too.
 class GaussianNoisePassThrough final : public
     drake::systems::LeafSystem<double> {
  public:
@@ -52,14 +59,30 @@ class GaussianNoisePassThrough final : public
   void DoCalcVectorOutput(const drake::systems::Context<double>& context,
                           systems::OutputVector<double>* output) const;
 
+  void SetDefaultState(const drake::systems::Context<double>& context,
+                       drake::systems::State<double>* state) const override;
+
+  void SetRandomState(const drake::systems::Context<double>& context,
+                      drake::systems::State<double>* state,
+                      drake::RandomGenerator* generator) const override;
+
  private:
   bool is_abstract() const { return false; }
 
+  drake::systems::EventStatus DrawNoise(
+      const drake::systems::Context<double>& context,
+      drake::systems::State<double>* state) const;
+
+  // Draws the noise of the positions and velocities into `state`
+  void SampleNoise(drake::systems::State<double>* state) const;
+
   int num_positions_;
   int num_velocities_;
   int num_inputs_;
   Eigen::MatrixXd pos_variance_;
   Eigen::MatrixXd vel_variance_;
+  int noise_idx_;
+  int generator_idx_;
 };
 
 }  // namespace systems
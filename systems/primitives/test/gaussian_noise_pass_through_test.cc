@@ -0,0 +1,67 @@
+#include "systems/primitives/gaussian_noise_pass_through.h"
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+
+using drake::CompareMatrices;
+using drake::systems::Context;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+class GaussianNoisePassThroughTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    noise_ = std::make_unique<GaussianNoisePassThrough>(
+        2, 2, 1, MatrixXd::Identity(2, 2), MatrixXd::Identity(2, 2));
+  }
+
+  // A context whose input is the zero state
+  std::unique_ptr<Context<double>> MakeContext() const {
+    auto context = noise_->CreateDefaultContext();
+    OutputVector<double> input(VectorXd::Zero(2), VectorXd::Zero(2),
+                               VectorXd::Zero(1));
+    input.set_timestamp(0);
+    noise_->get_input_port().FixValue(context.get(), input);
+    return context;
+  }
+
+  // The positions and velocities of the output, i.e. the noise
+  VectorXd EvalNoise(const Context<double>& context) const {
+    return noise_->get_output_port().Eval(context).head(4);
+  }
+
+  std::unique_ptr<GaussianNoisePassThrough> noise_;
+};
+
+// The output of a new context is already noisy, and the default noise is the
+// same in every context
+TEST_F(GaussianNoisePassThroughTest, DefaultContextIsNoisy) {
+  const auto context = MakeContext();
+  const VectorXd noise = EvalNoise(*context);
+  EXPECT_TRUE((noise.array() != 0).all());
+  EXPECT_TRUE(CompareMatrices(EvalNoise(*MakeContext()), noise));
+}
+
+// Random contexts draw their first noise from their own seed
+TEST_F(GaussianNoisePassThroughTest, RandomContextIsNoisy) {
+  drake::RandomGenerator generator_1(1);
+  drake::RandomGenerator generator_2(2);
+  auto context_1 = MakeContext();
+  auto context_2 = MakeContext();
+  noise_->SetRandomContext(context_1.get(), &generator_1);
+  noise_->SetRandomContext(context_2.get(), &generator_2);
+  const VectorXd noise_1 = EvalNoise(*context_1);
+  EXPECT_TRUE((noise_1.array() != 0).all());
+  EXPECT_FALSE(CompareMatrices(noise_1, EvalNoise(*context_2)));
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
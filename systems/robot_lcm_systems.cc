@@ -7,59 +7,332 @@ namespace systems {
 
 using std::string;
 using Eigen::VectorXd;
+using drake::AbstractValue;
 using drake::systems::Context;
+using drake::systems::DiscreteValues;
+using drake::systems::EventStatus;
 using drake::systems::LeafSystem;
+using drake::systems::State;
 using drake::multibody::JointActuatorIndex;
 using drake::multibody::JointIndex;
 using systems::OutputVector;
+using std::vector;
+
+int64_t HashRobotMessageLayout(
+    std::initializer_list<const vector<string>*> names) {
+  // FNV-1a, with a separator after each name and each list
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  const auto mix = [&hash](unsigned char c) {
+    hash = (hash ^ c) * 0x100000001b3ULL;
+  };
+  for (const auto* list : names) {
+    for (const auto& name : *list) {
+      for (char c : name) {
+        mix(c);
+      }
+      mix(0);
+    }
+    mix(1);
+  }
+  return (hash == 0) ? 1 : static_cast<int64_t>(hash);
+}
+
+namespace {
+
+// Plant indices of the given names
+vector<int> MapNames(const vector<string>& names,
+                     const std::map<string, int>& index_map) {
+  vector<int> indices;
+  indices.reserve(names.size());
+  for (const auto& name : names) {
+    indices.push_back(index_map.at(name));
+  }
+  return indices;
+}
+
+vector<string> OrderedNames(const std::map<string, int>& index_map) {
+  vector<string> names(index_map.size());
+  for (const auto& x : index_map) {
+    names.at(x.second) = x.first;
+  }
+  return names;
+}
+
+bool IsIdentity(const vector<int>& indices, int size) {
+  if (static_cast<int>(indices.size()) != size) {
+    return false;
+  }
+  for (int i = 0; i < size; i++) {
+    if (indices[i] != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Scatters the values of a message into plant order
+void Scatter(const vector<double>& values, const vector<int>& indices,
+             Eigen::Ref<VectorXd> out) {
+  DRAKE_DEMAND(values.size() == indices.size());
+  for (size_t i = 0; i < indices.size(); i++) {
+    out(indices[i]) = values[i];
+  }
+}
+
+// The layout hash of a message. Messages which always carry their names are
+// hashed by them, so that their layouts are cached too.
+int64_t LayoutHash(const dairlib::lcmt_robot_output& state_msg) {
+  return HashRobotMessageLayout({&state_msg.position_names,
+                                 &state_msg.velocity_names,
+                                 &state_msg.effort_names});
+}
+
+int64_t LayoutHash(const dairlib::lcmt_robot_output_compact& state_msg) {
+  return state_msg.layout_hash;
+}
+
+int64_t LayoutHash(const dairlib::lcmt_robot_input& input_msg) {
+  return HashRobotMessageLayout({&input_msg.effort_names});
+}
+
+int64_t LayoutHash(const dairlib::lcmt_robot_input_compact& input_msg) {
+  return input_msg.layout_hash;
+}
+
+bool HasNames(const dairlib::lcmt_robot_output&) { return true; }
+
+bool HasNames(const dairlib::lcmt_robot_output_compact& state_msg) {
+  return state_msg.num_position_names == state_msg.num_positions &&
+         state_msg.num_velocity_names == state_msg.num_velocities &&
+         state_msg.num_effort_names == state_msg.num_efforts;
+}
+
+bool HasNames(const dairlib::lcmt_robot_input&) { return true; }
+
+bool HasNames(const dairlib::lcmt_robot_input_compact& input_msg) {
+  return input_msg.num_effort_names == input_msg.num_efforts;
+}
+
+// Whether a sender includes the names in the current message, given its step
+// counter. The counter is incremented before the step's message is published,
+// so the message of step k (and any before the first step) sees k.
+bool SendNames(const Context<double>& context, int step_count_index,
+               int name_period) {
+  if (step_count_index < 0) {
+    return true;
+  }
+  const int64_t steps = context.get_discrete_state(step_count_index)[0];
+  return steps <= 1 || (steps - 1) % name_period == 0;
+}
+
+// Sets names to the first num_names of ordered_names, if its size differs
+void AssignNames(const vector<string>& ordered_names, int num_names,
+                 vector<string>* names) {
+  if (static_cast<int>(names->size()) != num_names) {
+    names->assign(ordered_names.begin(), ordered_names.begin() + num_names);
+  }
+}
+
+// Sets the names of a state message, which carries them in every message
+void SetLayout(int64_t, bool, const vector<string>& positions,
+               const vector<string>& velocities,
+               const vector<string>& efforts,
+               dairlib::lcmt_robot_output* state_msg) {
+  AssignNames(positions, state_msg->num_positions, &state_msg->position_names);
+  AssignNames(velocities, state_msg->num_velocities,
+              &state_msg->velocity_names);
+  AssignNames(efforts, state_msg->num_efforts, &state_msg->effort_names);
+}
+
+// Sets the layout hash of a compact state message, and its names if
+// send_names
+void SetLayout(int64_t layout_hash, bool send_names,
+               const vector<string>& positions,
+               const vector<string>& velocities,
+               const vector<string>& efforts,
+               dairlib::lcmt_robot_output_compact* state_msg) {
+  state_msg->layout_hash = layout_hash;
+  state_msg->num_position_names = send_names ? state_msg->num_positions : 0;
+  state_msg->num_velocity_names = send_names ? state_msg->num_velocities : 0;
+  state_msg->num_effort_names = send_names ? state_msg->num_efforts : 0;
+  AssignNames(positions, state_msg->num_position_names,
+              &state_msg->position_names);
+  AssignNames(velocities, state_msg->num_velocity_names,
+              &state_msg->velocity_names);
+  AssignNames(efforts, state_msg->num_effort_names, &state_msg->effort_names);
+}
+
+// See the state message overloads
+void SetLayout(int64_t, bool, const vector<string>& efforts,
+               dairlib::lcmt_robot_input* input_msg) {
+  AssignNames(efforts, input_msg->num_efforts, &input_msg->effort_names);
+}
+
+void SetLayout(int64_t layout_hash, bool send_names,
+               const vector<string>& efforts,
+               dairlib::lcmt_robot_input_compact* input_msg) {
+  input_msg->layout_hash = layout_hash;
+  input_msg->num_effort_names = send_names ? input_msg->num_efforts : 0;
+  AssignNames(efforts, input_msg->num_effort_names, &input_msg->effort_names);
+}
+
+}  // namespace
 
 
 /*--------------------------------------------------------------------------*/
 // methods implementation for RobotOutputReceiver.
 
 RobotOutputReceiver::RobotOutputReceiver(
-    const drake::multibody::MultibodyPlant<double>& plant) {
+    const drake::multibody::MultibodyPlant<double>& plant, bool compact) {
   num_positions_ = plant.num_positions();
   num_velocities_ = plant.num_velocities();
   num_efforts_ = plant.num_actuators();
   positionIndexMap_ = multibody::makeNameToPositionsMap(plant);
   velocityIndexMap_ = multibody::makeNameToVelocitiesMap(plant);
   effortIndexMap_ = multibody::makeNameToActuatorsMap(plant);
-  this->DeclareAbstractInputPort("lcmt_robot_output",
-    drake::Value<dairlib::lcmt_robot_output>{});
-  this->DeclareVectorOutputPort(OutputVector<double>(
-    plant.num_positions(), plant.num_velocities(),
-    plant.num_actuators()),
-    &RobotOutputReceiver::CopyOutput);
+
+  // The layouts of senders with the same plant, with or without efforts, so
+  // that their compact messages need no names
+  const vector<string> positions = OrderedNames(positionIndexMap_);
+  const vector<string> velocities = OrderedNames(velocityIndexMap_);
+  const vector<string> efforts = OrderedNames(effortIndexMap_);
+  const vector<string> no_efforts;
+  RobotMessageLayout identity;
+  identity.positions = MapNames(positions, positionIndexMap_);
+  identity.velocities = MapNames(velocities, velocityIndexMap_);
+  identity.is_identity = true;
+  plant_layouts_[HashRobotMessageLayout(
+      {&positions, &velocities, &no_efforts})] = identity;
+  identity.efforts = MapNames(efforts, effortIndexMap_);
+  plant_layouts_[HashRobotMessageLayout({&positions, &velocities, &efforts})] =
+      identity;
+
+  const OutputVector<double> model_output(
+      plant.num_positions(), plant.num_velocities(), plant.num_actuators());
+  if (compact) {
+    this->DeclareAbstractInputPort("lcmt_robot_output_compact",
+      drake::Value<dairlib::lcmt_robot_output_compact>{});
+    this->DeclareVectorOutputPort(model_output,
+      &RobotOutputReceiver::CopyOutput<dairlib::lcmt_robot_output_compact>);
+    this->DeclarePerStepUnrestrictedUpdateEvent(
+        &RobotOutputReceiver::LearnLayout<dairlib::lcmt_robot_output_compact>);
+    held_output_index_ =
+        this->DeclareDiscreteState(VectorXd::Zero(model_output.size()));
+  } else {
+    this->DeclareAbstractInputPort("lcmt_robot_output",
+      drake::Value<dairlib::lcmt_robot_output>{});
+    this->DeclareVectorOutputPort(model_output,
+      &RobotOutputReceiver::CopyOutput<dairlib::lcmt_robot_output>);
+    this->DeclarePerStepUnrestrictedUpdateEvent(
+        &RobotOutputReceiver::LearnLayout<dairlib::lcmt_robot_output>);
+  }
+  layouts_index_ = this->DeclareAbstractState(
+      AbstractValue::Make<RobotMessageLayoutMap>(RobotMessageLayoutMap()));
+}
+
+const RobotMessageLayout* RobotOutputReceiver::FindLayout(
+    const Context<double>& context, int64_t layout_hash) const {
+  if (layout_hash == 0) {
+    return nullptr;
+  }
+  auto it = plant_layouts_.find(layout_hash);
+  if (it != plant_layouts_.end()) {
+    return &it->second;
+  }
+  const auto& layouts =
+      context.get_abstract_state<RobotMessageLayoutMap>(layouts_index_);
+  it = layouts.find(layout_hash);
+  return (it != layouts.end()) ? &it->second : nullptr;
 }
 
+template <typename Message>
+RobotMessageLayout RobotOutputReceiver::MakeLayout(
+    const Message& state_msg) const {
+  RobotMessageLayout layout;
+  layout.positions = MapNames(state_msg.position_names, positionIndexMap_);
+  layout.velocities = MapNames(state_msg.velocity_names, velocityIndexMap_);
+  layout.efforts = MapNames(state_msg.effort_names, effortIndexMap_);
+  layout.is_identity = IsIdentity(layout.positions, num_positions_) &&
+                       IsIdentity(layout.velocities, num_velocities_) &&
+                       (layout.efforts.empty() ||
+                        IsIdentity(layout.efforts, num_efforts_));
+  return layout;
+}
+
+template <typename Message>
+EventStatus RobotOutputReceiver::LearnLayout(const Context<double>& context,
+                                             State<double>* state) const {
+  const AbstractValue* input = this->EvalAbstractInput(context, 0);
+  if (input == nullptr) {
+    return EventStatus::Succeeded();
+  }
+  const auto& state_msg = input->get_value<Message>();
+  const int64_t layout_hash = LayoutHash(state_msg);
+  const RobotMessageLayout* layout = FindLayout(context, layout_hash);
+  RobotMessageLayout name_layout;
+  if (layout == nullptr && HasNames(state_msg)) {
+    name_layout = MakeLayout(state_msg);
+    layout = &name_layout;
+    if (layout_hash != 0) {
+      state->get_mutable_abstract_state<RobotMessageLayoutMap>(
+          layouts_index_)[layout_hash] = name_layout;
+    }
+  }
+  if (layout != nullptr && held_output_index_ >= 0) {
+    Decode(*layout, state_msg,
+           state->get_mutable_discrete_state(held_output_index_)
+               .get_mutable_value());
+  }
+  return EventStatus::Succeeded();
+}
+
+template <typename Message>
+void RobotOutputReceiver::Decode(const RobotMessageLayout& layout,
+                                 const Message& state_msg,
+                                 Eigen::Ref<VectorXd> data) const {
+  data.head(num_positions_ + num_velocities_ + num_efforts_).setZero();
+  auto positions = data.head(num_positions_);
+  auto velocities = data.segment(num_positions_, num_velocities_);
+  auto efforts = data.segment(num_positions_ + num_velocities_, num_efforts_);
+  if (layout.is_identity) {
+    positions = Eigen::Map<const VectorXd>(state_msg.position.data(),
+                                           num_positions_);
+    velocities = Eigen::Map<const VectorXd>(state_msg.velocity.data(),
+                                            num_velocities_);
+    efforts.head(state_msg.num_efforts) = Eigen::Map<const VectorXd>(
+        state_msg.effort.data(), state_msg.num_efforts);
+  } else {
+    Scatter(state_msg.position, layout.positions, positions);
+    Scatter(state_msg.velocity, layout.velocities, velocities);
+    Scatter(state_msg.effort, layout.efforts, efforts);
+  }
+  // The timestamp is the last element of the value
+  data(data.size() - 1) = state_msg.utime * 1.0e-6;
+}
+
+template <typename Message>
 void RobotOutputReceiver::CopyOutput(
     const Context<double>& context, OutputVector<double>* output) const {
   const drake::AbstractValue* input =
       this->EvalAbstractInput(context, 0);
   DRAKE_ASSERT(input != nullptr);
-  const auto& state_msg = input->get_value<dairlib::lcmt_robot_output>();
-
-  VectorXd positions = VectorXd::Zero(num_positions_);
-  for (int i = 0; i < state_msg.num_positions; i++) {
-    int j = positionIndexMap_.at(state_msg.position_names[i]);
-    positions(j) = state_msg.position[i];
-  }
-  VectorXd velocities = VectorXd::Zero(num_velocities_);
-  for (int i = 0; i < state_msg.num_velocities; i++) {
-    int j = velocityIndexMap_.at(state_msg.velocity_names[i]);
-    velocities(j) = state_msg.velocity[i];
-  }
-  VectorXd efforts = VectorXd::Zero(num_efforts_);
-  for (int i = 0; i < state_msg.num_efforts; i++) {
-    int j = effortIndexMap_.at(state_msg.effort_names[i]);
-    efforts(j) = state_msg.effort[j];
+  const auto& state_msg = input->get_value<Message>();
+  // Messages with an unknown layout are decoded by name, or replaced by the
+  // held output if they have no names. Their layout is learned by the next
+  // update, if they have a layout hash.
+  const RobotMessageLayout* known_layout =
+      FindLayout(context, LayoutHash(state_msg));
+  RobotMessageLayout name_layout;
+  if (known_layout == nullptr) {
+    if (!HasNames(state_msg)) {
+      output->set_value(
+          context.get_discrete_state(held_output_index_).get_value());
+      return;
+    }
+    name_layout = MakeLayout(state_msg);
   }
-
-  output->SetPositions(positions);
-  output->SetVelocities(velocities);
-  output->SetEfforts(efforts);
-  output->set_timestamp(state_msg.utime * 1.0e-6);
+  Decode((known_layout != nullptr) ? *known_layout : name_layout, state_msg,
+         output->get_mutable_value());
 }
 
 /*--------------------------------------------------------------------------*/
@@ -67,7 +340,8 @@ void RobotOutputReceiver::CopyOutput(
 
 RobotOutputSender::RobotOutputSender(
     const drake::multibody::MultibodyPlant<double>& plant,
-    const bool publish_efforts):publish_efforts_(publish_efforts) {
+    const bool publish_efforts, bool compact)
+    : publish_efforts_(publish_efforts), compact_(compact) {
   num_positions_ = plant.num_positions();
   num_velocities_ = plant.num_velocities();
   num_efforts_ = plant.num_actuators();
@@ -104,18 +378,48 @@ RobotOutputSender::RobotOutputSender(
     }
   }
 
+  const vector<string> no_efforts;
+  layout_hash_ = HashRobotMessageLayout(
+      {&ordered_position_names_, &ordered_velocity_names_,
+       publish_efforts_ ? &ordered_effort_names_ : &no_efforts});
+
   state_input_port_ = this->DeclareVectorInputPort(BasicVector<double>(
       num_positions_ + num_velocities_)).get_index();
   if (publish_efforts_) {
     effort_input_port_ = this->DeclareVectorInputPort(BasicVector<double>(
           num_efforts_)).get_index();
   }
-  this->DeclareAbstractOutputPort(&RobotOutputSender::Output);
+  if (compact_) {
+    this->DeclareAbstractOutputPort(
+        &RobotOutputSender::Output<dairlib::lcmt_robot_output_compact>);
+  } else {
+    this->DeclareAbstractOutputPort(
+        &RobotOutputSender::Output<dairlib::lcmt_robot_output>);
+  }
+}
+
+void RobotOutputSender::set_name_period(int name_period) {
+  DRAKE_DEMAND(name_period >= 1);
+  DRAKE_DEMAND(compact_ || name_period == 1);
+  name_period_ = name_period;
+  if (name_period_ > 1 && step_count_index_ < 0) {
+    step_count_index_ = this->DeclareDiscreteState(VectorXd::Zero(1));
+    this->DeclarePerStepDiscreteUpdateEvent(&RobotOutputSender::CountStep);
+  }
+}
+
+EventStatus RobotOutputSender::CountStep(
+    const Context<double>& context,
+    DiscreteValues<double>* discrete_state) const {
+  discrete_state->get_mutable_vector(step_count_index_)[0] =
+      context.get_discrete_state(step_count_index_)[0] + 1;
+  return EventStatus::Succeeded();
 }
 
 /// Populate a state message with all states
+template <typename Message>
 void RobotOutputSender::Output(const Context<double>& context,
-                               dairlib::lcmt_robot_output* state_msg) const {
+                               Message* state_msg) const {
   const auto state = this->EvalVectorInput(context, state_input_port_);
 
   // using the time from the context
@@ -123,69 +427,161 @@ void RobotOutputSender::Output(const Context<double>& context,
 
   state_msg->num_positions = num_positions_;
   state_msg->num_velocities = num_velocities_;
-  state_msg->position_names.resize(num_positions_);
-  state_msg->velocity_names.resize(num_velocities_);
   state_msg->position.resize(num_positions_);
   state_msg->velocity.resize(num_velocities_);
-
   for (int i = 0; i < num_positions_; i++) {
     state_msg->position[i] = state->GetAtIndex(i);
-    state_msg->position_names[i] = ordered_position_names_[i];
   }
   for (int i = 0; i < num_velocities_; i++) {
     state_msg->velocity[i] = state->GetAtIndex(num_positions_ + i);
-    state_msg->velocity_names[i] = ordered_velocity_names_[i];
   }
 
+  state_msg->num_efforts = publish_efforts_ ? num_efforts_ : 0;
+  state_msg->effort.resize(state_msg->num_efforts);
   if (publish_efforts_) {
     const auto efforts = this->EvalVectorInput(context, effort_input_port_);
-
-    state_msg->num_efforts = num_efforts_;
-    state_msg->effort_names.resize(num_efforts_);
-    state_msg->effort.resize(num_efforts_);
-
     for (int i = 0; i < num_efforts_; i++) {
       state_msg->effort[i] = efforts->GetAtIndex(i);
-      state_msg->effort_names[i] = ordered_effort_names_[i];
     }
   }
+
+  // The names are copied only when the name arrays change size, so an output
+  // value which is reused across messages copies them once
+  SetLayout(layout_hash_, SendNames(context, step_count_index_, name_period_),
+            ordered_position_names_, ordered_velocity_names_,
+            ordered_effort_names_, state_msg);
 }
 
 /*--------------------------------------------------------------------------*/
 // methods implementation for RobotInputReceiver.
 
 RobotInputReceiver::RobotInputReceiver(
-      const drake::multibody::MultibodyPlant<double>& plant) {
+      const drake::multibody::MultibodyPlant<double>& plant, bool compact) {
   num_actuators_ = plant.num_actuators();
   actuatorIndexMap_ = multibody::makeNameToActuatorsMap(plant);
-  this->DeclareAbstractInputPort("lcmt_robot_input",
-    drake::Value<dairlib::lcmt_robot_input>{});
-  this->DeclareVectorOutputPort(TimestampedVector<double>(num_actuators_),
-                                &RobotInputReceiver::CopyInputOut);
+
+  const vector<string> efforts = OrderedNames(actuatorIndexMap_);
+  RobotMessageLayout identity;
+  identity.efforts = MapNames(efforts, actuatorIndexMap_);
+  identity.is_identity = true;
+  plant_layouts_[HashRobotMessageLayout({&efforts})] = identity;
+
+  if (compact) {
+    this->DeclareAbstractInputPort("lcmt_robot_input_compact",
+      drake::Value<dairlib::lcmt_robot_input_compact>{});
+    this->DeclareVectorOutputPort(TimestampedVector<double>(num_actuators_),
+      &RobotInputReceiver::CopyInputOut<dairlib::lcmt_robot_input_compact>);
+    this->DeclarePerStepUnrestrictedUpdateEvent(
+        &RobotInputReceiver::LearnLayout<dairlib::lcmt_robot_input_compact>);
+    held_output_index_ =
+        this->DeclareDiscreteState(VectorXd::Zero(num_actuators_ + 1));
+  } else {
+    this->DeclareAbstractInputPort("lcmt_robot_input",
+      drake::Value<dairlib::lcmt_robot_input>{});
+    this->DeclareVectorOutputPort(TimestampedVector<double>(num_actuators_),
+      &RobotInputReceiver::CopyInputOut<dairlib::lcmt_robot_input>);
+    this->DeclarePerStepUnrestrictedUpdateEvent(
+        &RobotInputReceiver::LearnLayout<dairlib::lcmt_robot_input>);
+  }
+  layouts_index_ = this->DeclareAbstractState(
+      AbstractValue::Make<RobotMessageLayoutMap>(RobotMessageLayoutMap()));
+}
+
+const RobotMessageLayout* RobotInputReceiver::FindLayout(
+    const Context<double>& context, int64_t layout_hash) const {
+  if (layout_hash == 0) {
+    return nullptr;
+  }
+  auto it = plant_layouts_.find(layout_hash);
+  if (it != plant_layouts_.end()) {
+    return &it->second;
+  }
+  const auto& layouts =
+      context.get_abstract_state<RobotMessageLayoutMap>(layouts_index_);
+  it = layouts.find(layout_hash);
+  return (it != layouts.end()) ? &it->second : nullptr;
+}
+
+template <typename Message>
+RobotMessageLayout RobotInputReceiver::MakeLayout(
+    const Message& input_msg) const {
+  RobotMessageLayout layout;
+  layout.efforts = MapNames(input_msg.effort_names, actuatorIndexMap_);
+  layout.is_identity = IsIdentity(layout.efforts, num_actuators_);
+  return layout;
+}
+
+template <typename Message>
+EventStatus RobotInputReceiver::LearnLayout(const Context<double>& context,
+                                            State<double>* state) const {
+  const AbstractValue* input = this->EvalAbstractInput(context, 0);
+  if (input == nullptr) {
+    return EventStatus::Succeeded();
+  }
+  const auto& input_msg = input->get_value<Message>();
+  const int64_t layout_hash = LayoutHash(input_msg);
+  const RobotMessageLayout* layout = FindLayout(context, layout_hash);
+  RobotMessageLayout name_layout;
+  if (layout == nullptr && HasNames(input_msg)) {
+    name_layout = MakeLayout(input_msg);
+    layout = &name_layout;
+    if (layout_hash != 0) {
+      state->get_mutable_abstract_state<RobotMessageLayoutMap>(
+          layouts_index_)[layout_hash] = name_layout;
+    }
+  }
+  if (layout != nullptr && held_output_index_ >= 0) {
+    Decode(*layout, input_msg,
+           state->get_mutable_discrete_state(held_output_index_)
+               .get_mutable_value());
+  }
+  return EventStatus::Succeeded();
 }
 
+template <typename Message>
+void RobotInputReceiver::Decode(const RobotMessageLayout& layout,
+                                const Message& input_msg,
+                                Eigen::Ref<VectorXd> data) const {
+  auto input_vector = data.head(num_actuators_);
+  if (layout.is_identity) {
+    input_vector = Eigen::Map<const VectorXd>(input_msg.efforts.data(),
+                                              num_actuators_);
+  } else {
+    input_vector.setZero();
+    Scatter(input_msg.efforts, layout.efforts, input_vector);
+  }
+  data(num_actuators_) = input_msg.utime * 1.0e-6;
+}
+
+template <typename Message>
 void RobotInputReceiver::CopyInputOut(const Context<double>& context,
                                       TimestampedVector<double>* output) const {
   const drake::AbstractValue* input =
       this->EvalAbstractInput(context, 0);
   DRAKE_ASSERT(input != nullptr);
-  const auto& input_msg = input->get_value<dairlib::lcmt_robot_input>();
-
-  VectorXd input_vector = VectorXd::Zero(num_actuators_);
-
-  for (int i = 0; i < input_msg.num_efforts; i++) {
-    int j = actuatorIndexMap_.at(input_msg.effort_names[i]);
-    input_vector(j) = input_msg.efforts[i];
+  const auto& input_msg = input->get_value<Message>();
+  // See RobotOutputReceiver::CopyOutput
+  const RobotMessageLayout* known_layout =
+      FindLayout(context, LayoutHash(input_msg));
+  RobotMessageLayout name_layout;
+  if (known_layout == nullptr) {
+    if (!HasNames(input_msg)) {
+      output->set_value(
+          context.get_discrete_state(held_output_index_).get_value());
+      return;
+    }
+    name_layout = MakeLayout(input_msg);
   }
-  output->SetDataVector(input_vector);
-  output->set_timestamp(input_msg.utime * 1.0e-6);
+  Decode((known_layout != nullptr) ? *known_layout : name_layout, input_msg,
+         output->get_mutable_value());
 }
 
 /*--------------------------------------------------------------------------*/
 // methods implementation for RobotCommandSender.
 
 RobotCommandSender::RobotCommandSender(
-    const drake::multibody::MultibodyPlant<double>& plant) {
+    const drake::multibody::MultibodyPlant<double>& plant, bool compact)
+    : compact_(compact) {
   num_actuators_ = plant.num_actuators();
   actuatorIndexMap_ = multibody::makeNameToActuatorsMap(plant);
 
@@ -193,24 +589,51 @@ for (JointActuatorIndex i(0); i < plant.num_actuators(); ++i) {
     ordered_actuator_names_.push_back(
       plant.get_joint_actuator(i).name());
   }
+  layout_hash_ = HashRobotMessageLayout({&ordered_actuator_names_});
 
   this->DeclareVectorInputPort(TimestampedVector<double>(num_actuators_));
-  this->DeclareAbstractOutputPort(&RobotCommandSender::OutputCommand);
+  if (compact_) {
+    this->DeclareAbstractOutputPort(
+        &RobotCommandSender::OutputCommand<dairlib::lcmt_robot_input_compact>);
+  } else {
+    this->DeclareAbstractOutputPort(
+        &RobotCommandSender::OutputCommand<dairlib::lcmt_robot_input>);
+  }
 }
 
+void RobotCommandSender::set_name_period(int name_period) {
+  DRAKE_DEMAND(name_period >= 1);
+  DRAKE_DEMAND(compact_ || name_period == 1);
+  name_period_ = name_period;
+  if (name_period_ > 1 && step_count_index_ < 0) {
+    step_count_index_ = this->DeclareDiscreteState(VectorXd::Zero(1));
+    this->DeclarePerStepDiscreteUpdateEvent(&RobotCommandSender::CountStep);
+  }
+}
+
+EventStatus RobotCommandSender::CountStep(
+    const Context<double>& context,
+    DiscreteValues<double>* discrete_state) const {
+  discrete_state->get_mutable_vector(step_count_index_)[0] =
+      context.get_discrete_state(step_count_index_)[0] + 1;
+  return EventStatus::Succeeded();
+}
+
+template <typename Message>
 void RobotCommandSender::OutputCommand(const Context<double>& context,
-    dairlib::lcmt_robot_input* input_msg) const {
+    Message* input_msg) const {
   const TimestampedVector<double>* command = (TimestampedVector<double>*)
       this->EvalVectorInput(context, 0);
 
   input_msg->utime = command->get_timestamp() * 1e6;
   input_msg->num_efforts = num_actuators_;
-  input_msg->effort_names.resize(num_actuators_);
   input_msg->efforts.resize(num_actuators_);
   for (int i = 0; i < num_actuators_; i++) {
-    input_msg->effort_names[i] = ordered_actuator_names_[i];
     input_msg->efforts[i] = command->GetAtIndex(i);
   }
+
+  SetLayout(layout_hash_, SendNames(context, step_count_index_, name_period_),
+            ordered_actuator_names_, input_msg);
 }
 
 }  // namespace systems
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <initializer_list>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 #include "drake/multibody/plant/multibody_plant.h"
@@ -10,7 +12,9 @@
 #include "systems/framework/timestamped_vector.h"
 
 #include "dairlib/lcmt_robot_output.hpp"
+#include "dairlib/lcmt_robot_output_compact.hpp"
 #include "dairlib/lcmt_robot_input.hpp"
+#include "dairlib/lcmt_robot_input_compact.hpp"
 
 namespace dairlib {
 namespace systems {
@@ -18,33 +22,107 @@ namespace systems {
 /// @file This file contains classes dealing with sending/receiving
 /// LCM messages related to a robot. The classes in this file are based on
 /// acrobot_lcm.h
+///
+/// Receivers decode messages through a name-to-index permutation cached per
+/// layout hash, i.e. per ordered list of joint/actuator names, rather than by
+/// looking up each name. A receiver knows the layout of its own plant, and
+/// learns any other layout from the first message with it.
+///
+/// lcmt_robot_output and lcmt_robot_input carry the names in every message.
+/// Senders and receivers constructed with compact = true use
+/// lcmt_robot_output_compact and lcmt_robot_input_compact instead, which carry
+/// the layout hash, so that senders can include the names only every few
+/// messages. Messages from a sender with the same plant never need names.
+///
+/// A compact receiver which gets a message without names, whose layout it has
+/// not seen, e.g. because it started between two messages with names, holds
+/// the output of the last message it could decode (zero before the first
+/// one) until a message with names arrives.
+///
+/// The learned layouts, the held outputs and the message counters are stored
+/// in the Context, so one system can be used from several threads, each with
+/// its own Context.
+
+/// The plant index of each entry of a message, for a given message layout
+struct RobotMessageLayout {
+  std::vector<int> positions;
+  std::vector<int> velocities;
+  std::vector<int> efforts;
+  /// True if every index equals its position, so the arrays can be copied
+  bool is_identity = false;
+};
+
+/// Hash of an ordered list of names, as stored in the layout_hash field of
+/// lcmt_robot_output_compact and lcmt_robot_input_compact. Never zero.
+int64_t HashRobotMessageLayout(
+    std::initializer_list<const std::vector<std::string>*> names);
+
+/// Layouts keyed by layout hash
+using RobotMessageLayoutMap = std::unordered_map<int64_t, RobotMessageLayout>;
 
 /// Receives the output of an LcmSubsriberSystem that subsribes to the
 /// Robot output channel with LCM type lcmt_robot_output, and outputs the
 /// robot states as a OutputVector.
 class RobotOutputReceiver : public drake::systems::LeafSystem<double> {
  public:
+  /// @param compact Receive lcmt_robot_output_compact instead
   explicit RobotOutputReceiver(
-    const drake::multibody::MultibodyPlant<double>& plant);
+    const drake::multibody::MultibodyPlant<double>& plant,
+    bool compact = false);
 
  private:
+  template <typename Message>
   void CopyOutput(const drake::systems::Context<double>& context,
                     OutputVector<double>* output) const;
+  // Returns the known layout of a message with the given layout hash, or
+  // nullptr
+  const RobotMessageLayout* FindLayout(
+      const drake::systems::Context<double>& context,
+      int64_t layout_hash) const;
+  // Builds the layout of a message from its names
+  template <typename Message>
+  RobotMessageLayout MakeLayout(const Message& state_msg) const;
+  // Decodes a message with a known layout into the value of an OutputVector
+  template <typename Message>
+  void Decode(const RobotMessageLayout& layout, const Message& state_msg,
+              Eigen::Ref<Eigen::VectorXd> data) const;
+  // Learns the layout of the current message, if it is new and has names, and
+  // holds its output if it can be decoded
+  template <typename Message>
+  drake::systems::EventStatus LearnLayout(
+      const drake::systems::Context<double>& context,
+      drake::systems::State<double>* state) const;
   int num_positions_;
   int num_velocities_;
   int num_efforts_;
   std::map<std::string, int> positionIndexMap_;
   std::map<std::string, int> velocityIndexMap_;
   std::map<std::string, int> effortIndexMap_;
+  // Layouts of the receiver's own plant
+  RobotMessageLayoutMap plant_layouts_;
+  // Abstract state with the other layouts seen so far
+  drake::systems::AbstractStateIndex layouts_index_;
+  // Discrete state with the output of the last message which could be
+  // decoded. Only declared for compact receivers.
+  int held_output_index_ = -1;
 };
 
 
 /// Converts a OutputVector object to LCM type lcmt_robot_output
 class RobotOutputSender : public drake::systems::LeafSystem<double> {
  public:
+  /// @param compact Send lcmt_robot_output_compact instead
   explicit RobotOutputSender(
     const drake::multibody::MultibodyPlant<double>& plant,
-    const bool publish_efforts=false);;
+    const bool publish_efforts=false, bool compact=false);
+
+  /// Includes the joint names only in every name_period-th message (and the
+  /// first). Other messages carry only the layout hash. Defaults to 1, i.e.
+  /// names in every message. Messages are counted by simulator steps, i.e.
+  /// one per step when the message is published once per step (as in
+  /// LcmDrivenLoop). Only for compact senders, and must be called before a
+  /// Context is created.
+  void set_name_period(int name_period);
 
   const drake::systems::InputPort<double>& get_input_port_state()
       const {
@@ -57,8 +135,12 @@ class RobotOutputSender : public drake::systems::LeafSystem<double> {
   }
 
  private:
+  template <typename Message>
   void Output(const drake::systems::Context<double>& context,
-                   dairlib::lcmt_robot_output* output) const;
+                   Message* output) const;
+  drake::systems::EventStatus CountStep(
+      const drake::systems::Context<double>& context,
+      drake::systems::DiscreteValues<double>* discrete_state) const;
 
   int num_positions_;
   int num_velocities_;
@@ -72,6 +154,12 @@ class RobotOutputSender : public drake::systems::LeafSystem<double> {
   int state_input_port_;
   int effort_input_port_;
   bool publish_efforts_;
+  bool compact_;
+  int64_t layout_hash_;
+  int name_period_ = 1;
+  // Discrete state counting simulator steps, for the name period. Only
+  // declared for name periods above one.
+  int step_count_index_ = -1;
 };
 
 /// Receives the output of an LcmSubsriberSystem that subsribes to the
@@ -79,16 +167,37 @@ class RobotOutputSender : public drake::systems::LeafSystem<double> {
 /// robot inputs as a TimestampedVector.
 class RobotInputReceiver : public drake::systems::LeafSystem<double> {
  public:
+  /// @param compact Receive lcmt_robot_input_compact instead
   explicit RobotInputReceiver(
-      const drake::multibody::MultibodyPlant<double>& plant);
+      const drake::multibody::MultibodyPlant<double>& plant,
+      bool compact = false);
 
 
  private:
+  template <typename Message>
   void CopyInputOut(const drake::systems::Context<double>& context,
                     TimestampedVector<double>* output) const;
+  // See RobotOutputReceiver
+  const RobotMessageLayout* FindLayout(
+      const drake::systems::Context<double>& context,
+      int64_t layout_hash) const;
+  template <typename Message>
+  RobotMessageLayout MakeLayout(const Message& input_msg) const;
+  // Decodes a message with a known layout into the value of a
+  // TimestampedVector
+  template <typename Message>
+  void Decode(const RobotMessageLayout& layout, const Message& input_msg,
+              Eigen::Ref<Eigen::VectorXd> data) const;
+  template <typename Message>
+  drake::systems::EventStatus LearnLayout(
+      const drake::systems::Context<double>& context,
+      drake::systems::State<double>* state) const;
 
   int num_actuators_;
   std::map<std::string, int> actuatorIndexMap_;
+  RobotMessageLayoutMap plant_layouts_;
+  drake::systems::AbstractStateIndex layouts_index_;
+  int held_output_index_ = -1;
 };
 
 
@@ -98,16 +207,30 @@ class RobotInputReceiver : public drake::systems::LeafSystem<double> {
 class RobotCommandSender : public drake::systems::LeafSystem<double> {
  public:
 
+  /// @param compact Send lcmt_robot_input_compact instead
   explicit RobotCommandSender(
-      const drake::multibody::MultibodyPlant<double>& plant);
+      const drake::multibody::MultibodyPlant<double>& plant,
+      bool compact = false);
+
+  /// See RobotOutputSender::set_name_period()
+  void set_name_period(int name_period);
 
  private:
+  template <typename Message>
   void OutputCommand(const drake::systems::Context<double>& context,
-                     dairlib::lcmt_robot_input* output) const;
+                     Message* output) const;
+  drake::systems::EventStatus CountStep(
+      const drake::systems::Context<double>& context,
+      drake::systems::DiscreteValues<double>* discrete_state) const;
 
   int num_actuators_;
   std::vector<std::string> ordered_actuator_names_;
   std::map<std::string, int> actuatorIndexMap_;
+  bool compact_;
+  int64_t layout_hash_;
+  int name_period_ = 1;
+  // See RobotOutputSender
+  int step_count_index_ = -1;
 };
 
 }  // namespace systems
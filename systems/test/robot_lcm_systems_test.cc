@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "common/find_resource.h"
+#include "systems/robot_lcm_systems.h"
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/multibody/parsing/parser.h"
+#include "drake/systems/analysis/simulator.h"
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+using drake::CompareMatrices;
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using drake::systems::BasicVector;
+using drake::systems::Context;
+using drake::systems::Simulator;
+using Eigen::VectorXd;
+using std::string;
+using std::vector;
+
+// Reverses the order of the values and names of a message
+template <typename Values>
+void Reverse(Values* values, vector<string>* names) {
+  std::reverse(values->begin(), values->end());
+  std::reverse(names->begin(), names->end());
+}
+
+// Removes the names of a compact message
+void StripNames(lcmt_robot_output_compact* msg) {
+  msg->num_position_names = 0;
+  msg->num_velocity_names = 0;
+  msg->num_effort_names = 0;
+  msg->position_names.clear();
+  msg->velocity_names.clear();
+  msg->effort_names.clear();
+}
+
+void StripNames(lcmt_robot_input_compact* msg) {
+  msg->num_effort_names = 0;
+  msg->effort_names.clear();
+}
+
+class RobotLcmSystemsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Parser parser(&plant_);
+    parser.AddModelFromFile(
+        FindResourceOrThrow("examples/PlanarWalker/PlanarWalker.urdf"));
+    plant_.WeldFrames(plant_.world_frame(), plant_.GetFrameByName("base"),
+                      drake::math::RigidTransform<double>());
+    plant_.Finalize();
+    n_q_ = plant_.num_positions();
+    n_v_ = plant_.num_velocities();
+    n_u_ = plant_.num_actuators();
+    x_ = VectorXd::LinSpaced(n_q_ + n_v_, 1, n_q_ + n_v_);
+    u_ = VectorXd::LinSpaced(n_u_, -1, -n_u_);
+  }
+
+  // The expected positions, velocities and efforts of the state message
+  VectorXd ExpectedState() const {
+    VectorXd expected(n_q_ + n_v_ + n_u_);
+    expected << x_, u_;
+    return expected;
+  }
+
+  // A message of a sender with the test's plant, of type lcmt_robot_output or
+  // lcmt_robot_output_compact
+  template <typename Message>
+  Message MakeStateMessage() const {
+    RobotOutputSender sender(
+        plant_, true, std::is_same_v<Message, lcmt_robot_output_compact>);
+    auto context = sender.CreateDefaultContext();
+    sender.get_input_port_state().FixValue(context.get(), x_);
+    sender.get_input_port_effort().FixValue(context.get(), u_);
+    return sender.get_output_port(0).Eval<Message>(*context);
+  }
+
+  template <typename Message>
+  Message MakeInputMessage() const {
+    RobotCommandSender sender(
+        plant_, std::is_same_v<Message, lcmt_robot_input_compact>);
+    auto context = sender.CreateDefaultContext();
+    TimestampedVector<double> command(n_u_);
+    command.SetDataVector(u_);
+    sender.get_input_port(0).FixValue(context.get(), command);
+    return sender.get_output_port(0).Eval<Message>(*context);
+  }
+
+  template <typename Message>
+  static VectorXd Decode(const RobotOutputReceiver& receiver,
+                         Context<double>* context, const Message& msg) {
+    receiver.get_input_port(0).FixValue(context, msg);
+    return receiver.get_output_port(0)
+        .Eval<BasicVector<double>>(*context)
+        .get_value()
+        .head(msg.num_positions + msg.num_velocities + msg.num_efforts);
+  }
+
+  template <typename Message>
+  static VectorXd Decode(const RobotInputReceiver& receiver,
+                         Context<double>* context, const Message& msg) {
+    receiver.get_input_port(0).FixValue(context, msg);
+    return receiver.get_output_port(0)
+        .Eval<BasicVector<double>>(*context)
+        .get_value()
+        .head(msg.num_efforts);
+  }
+
+  MultibodyPlant<double> plant_{0.0};
+  int n_q_;
+  int n_v_;
+  int n_u_;
+  VectorXd x_;
+  VectorXd u_;
+};
+
+TEST_F(RobotLcmSystemsTest, OutputMessagesCarryNames) {
+  RobotOutputReceiver receiver(plant_);
+  Simulator<double> simulator(receiver);
+  auto& context = simulator.get_mutable_context();
+  const VectorXd expected = ExpectedState();
+
+  lcmt_robot_output msg = MakeStateMessage<lcmt_robot_output>();
+  ASSERT_EQ(msg.position_names.size(), msg.position.size());
+  ASSERT_EQ(msg.velocity_names.size(), msg.velocity.size());
+  ASSERT_EQ(msg.effort_names.size(), msg.effort.size());
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, msg), expected));
+
+  // A permuted layout, before and after a step caches it
+  lcmt_robot_output permuted = msg;
+  Reverse(&permuted.position, &permuted.position_names);
+  Reverse(&permuted.velocity, &permuted.velocity_names);
+  Reverse(&permuted.effort, &permuted.effort_names);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, permuted), expected));
+  simulator.AdvanceTo(0.1);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, permuted), expected));
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, msg), expected));
+}
+
+TEST_F(RobotLcmSystemsTest, OutputLayoutHashMatchesNameLookup) {
+  RobotOutputReceiver receiver(plant_, true /*compact*/);
+  Simulator<double> simulator(receiver);
+  auto& context = simulator.get_mutable_context();
+  const VectorXd expected = ExpectedState();
+
+  // The receiver's own layout, by hash
+  lcmt_robot_output_compact msg =
+      MakeStateMessage<lcmt_robot_output_compact>();
+  ASSERT_NE(msg.layout_hash, 0);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, msg), expected));
+
+  // ... without names
+  lcmt_robot_output_compact no_names = msg;
+  StripNames(&no_names);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, no_names), expected));
+
+  // ... and by name
+  lcmt_robot_output_compact by_name = msg;
+  by_name.layout_hash = 0;
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, by_name), expected));
+
+  // A permuted layout, by name, with and without its hash
+  lcmt_robot_output_compact permuted = msg;
+  Reverse(&permuted.position, &permuted.position_names);
+  Reverse(&permuted.velocity, &permuted.velocity_names);
+  Reverse(&permuted.effort, &permuted.effort_names);
+  permuted.layout_hash = HashRobotMessageLayout(
+      {&permuted.position_names, &permuted.velocity_names,
+       &permuted.effort_names});
+  lcmt_robot_output_compact permuted_by_name = permuted;
+  permuted_by_name.layout_hash = 0;
+  EXPECT_TRUE(
+      CompareMatrices(Decode(receiver, &context, permuted_by_name), expected));
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, permuted), expected));
+
+  // The permuted layout is unknown until a step learns it from the message.
+  // No step has decoded a message yet, so the held output is zero.
+  const VectorXd zero = VectorXd::Zero(expected.size());
+  lcmt_robot_output_compact permuted_no_names = permuted;
+  StripNames(&permuted_no_names);
+  EXPECT_TRUE(
+      CompareMatrices(Decode(receiver, &context, permuted_no_names), zero));
+  receiver.get_input_port(0).FixValue(&context, permuted);
+  simulator.AdvanceTo(0.1);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, permuted_no_names),
+                              expected));
+
+  // A second context has not learned it
+  auto other_context = receiver.CreateDefaultContext();
+  EXPECT_TRUE(CompareMatrices(
+      Decode(receiver, other_context.get(), permuted_no_names), zero));
+}
+
+TEST_F(RobotLcmSystemsTest, OutputReceiverJoinsMidStream) {
+  RobotOutputReceiver receiver(plant_, true /*compact*/);
+  Simulator<double> simulator(receiver);
+  auto& context = simulator.get_mutable_context();
+  const VectorXd expected = ExpectedState();
+
+  // A sender with another layout, which only sends names now and then
+  lcmt_robot_output_compact with_names =
+      MakeStateMessage<lcmt_robot_output_compact>();
+  with_names.utime = 1000;
+  Reverse(&with_names.position, &with_names.position_names);
+  Reverse(&with_names.velocity, &with_names.velocity_names);
+  Reverse(&with_names.effort, &with_names.effort_names);
+  with_names.layout_hash = HashRobotMessageLayout(
+      {&with_names.position_names, &with_names.velocity_names,
+       &with_names.effort_names});
+  lcmt_robot_output_compact no_names = with_names;
+  StripNames(&no_names);
+  no_names.utime = 2000;
+  for (double& q : no_names.position) {
+    q *= 2;
+  }
+  VectorXd expected_no_names = expected;
+  expected_no_names.head(n_q_) *= 2;
+
+  // The receiver starts between two messages with names, and has nothing to
+  // hold yet
+  receiver.get_input_port(0).FixValue(&context, no_names);
+  simulator.AdvanceTo(0.1);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, no_names),
+                              VectorXd::Zero(expected.size())));
+
+  // The next message with names is decoded, and a step learns its layout
+  EXPECT_TRUE(
+      CompareMatrices(Decode(receiver, &context, with_names), expected));
+  simulator.AdvanceTo(0.2);
+  EXPECT_TRUE(
+      CompareMatrices(Decode(receiver, &context, no_names), expected_no_names));
+
+  // A message without names of yet another layout holds the output of the
+  // last message decoded by a step, with its timestamp
+  lcmt_robot_output_compact unknown = no_names;
+  unknown.layout_hash = with_names.layout_hash + 1;
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, unknown), expected));
+  EXPECT_DOUBLE_EQ(receiver.get_output_port(0)
+                       .Eval<OutputVector<double>>(context)
+                       .get_timestamp(),
+                   1e-3);
+}
+
+TEST_F(RobotLcmSystemsTest, InputMessagesCarryNames) {
+  RobotInputReceiver receiver(plant_);
+  Simulator<double> simulator(receiver);
+  auto& context = simulator.get_mutable_context();
+
+  lcmt_robot_input msg = MakeInputMessage<lcmt_robot_input>();
+  ASSERT_EQ(msg.effort_names.size(), msg.efforts.size());
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, msg), u_));
+
+  lcmt_robot_input permuted = msg;
+  Reverse(&permuted.efforts, &permuted.effort_names);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, permuted), u_));
+  simulator.AdvanceTo(0.1);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, permuted), u_));
+}
+
+TEST_F(RobotLcmSystemsTest, InputLayoutHashMatchesNameLookup) {
+  RobotInputReceiver receiver(plant_, true /*compact*/);
+  Simulator<double> simulator(receiver);
+  auto& context = simulator.get_mutable_context();
+
+  lcmt_robot_input_compact msg = MakeInputMessage<lcmt_robot_input_compact>();
+  ASSERT_NE(msg.layout_hash, 0);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, msg), u_));
+
+  lcmt_robot_input_compact no_names = msg;
+  StripNames(&no_names);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, no_names), u_));
+
+  lcmt_robot_input_compact by_name = msg;
+  by_name.layout_hash = 0;
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, by_name), u_));
+
+  lcmt_robot_input_compact permuted = msg;
+  Reverse(&permuted.efforts, &permuted.effort_names);
+  permuted.layout_hash = HashRobotMessageLayout({&permuted.effort_names});
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, permuted), u_));
+
+  lcmt_robot_input_compact permuted_no_names = permuted;
+  StripNames(&permuted_no_names);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, permuted_no_names),
+                              VectorXd::Zero(n_u_)));
+  receiver.get_input_port(0).FixValue(&context, permuted);
+  simulator.AdvanceTo(0.1);
+  EXPECT_TRUE(
+      CompareMatrices(Decode(receiver, &context, permuted_no_names), u_));
+}
+
+TEST_F(RobotLcmSystemsTest, InputReceiverJoinsMidStream) {
+  RobotInputReceiver receiver(plant_, true /*compact*/);
+  Simulator<double> simulator(receiver);
+  auto& context = simulator.get_mutable_context();
+
+  // See OutputReceiverJoinsMidStream
+  lcmt_robot_input_compact with_names =
+      MakeInputMessage<lcmt_robot_input_compact>();
+  Reverse(&with_names.efforts, &with_names.effort_names);
+  with_names.layout_hash = HashRobotMessageLayout({&with_names.effort_names});
+  lcmt_robot_input_compact no_names = with_names;
+  StripNames(&no_names);
+  for (double& u : no_names.efforts) {
+    u *= 2;
+  }
+
+  receiver.get_input_port(0).FixValue(&context, no_names);
+  simulator.AdvanceTo(0.1);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, no_names),
+                              VectorXd::Zero(n_u_)));
+
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, with_names), u_));
+  simulator.AdvanceTo(0.2);
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, no_names), 2 * u_));
+
+  lcmt_robot_input_compact unknown = no_names;
+  unknown.layout_hash = with_names.layout_hash + 1;
+  EXPECT_TRUE(CompareMatrices(Decode(receiver, &context, unknown), u_));
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
@@ -2,6 +2,7 @@
 
 #include "multibody/kinematic/kinematic_constraints.h"
 #include "multibody/multibody_utils.h"
+#include "solvers/parallel_constraint_batch.h"
 #include "systems/trajectory_optimization/dircon/dircon_opt_constraints.h"
 
 namespace dairlib {
@@ -10,7 +11,10 @@ namespace trajectory_optimization {
 
 using drake::VectorX;
 using drake::multibody::MultibodyPlant;
+using drake::solvers::Binding;
+using drake::solvers::Constraint;
 using drake::solvers::MathematicalProgramResult;
+using drake::solvers::VariableRefList;
 using drake::solvers::VectorXDecisionVariable;
 using drake::symbolic::Expression;
 using drake::systems::Context;
@@ -22,6 +26,7 @@ using Eigen::VectorXd;
 using multibody::KinematicAccelerationConstraint;
 using multibody::KinematicPositionConstraint;
 using multibody::KinematicVelocityConstraint;
+using solvers::ParallelConstraintBatch;
 
 template <typename T>
 Dircon<T>::Dircon(const DirconModeSequence<T>& mode_sequence)
@@ -130,6 +135,24 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
       }
     }
 
+    // When evaluating in parallel, the collocation, kinematic and impact
+    // constraints are collected into groups which are safe to evaluate
+    // concurrently, and added as a single ParallelConstraintBatch below.
+    // Collocation and impact constraints then own their contexts, while the
+    // kinematic constraints at each knotpoint share contexts_ within a group.
+    const bool parallel = mode.num_threads() > 1;
+    std::vector<ParallelConstraintBatch::ConstraintGroup> batch_groups;
+    auto add_constraint = [&](std::shared_ptr<Constraint> constraint,
+                              const VariableRefList& vars,
+                              ParallelConstraintBatch::ConstraintGroup* group) {
+      if (parallel) {
+        group->emplace_back(constraint,
+                            drake::solvers::ConcatenateVariableRefList(vars));
+      } else {
+        AddConstraint(constraint, vars);
+      }
+    };
+
     //
     // Create and add collocation constraints
     //
@@ -137,29 +160,38 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
     // Want to set cache_size > number of decision variables. While we have not
     // declared every decision variable yet (see impulse variables below), the
     // impulse variables do not enter into any dynamics evaluations, so we are
-    // safe. Add a small factor (10%) just for safety margin.
-    int cache_size = 1.1 * num_vars();
-    cache_.push_back(
-        std::make_unique<DynamicsCache<T>>(mode.evaluators(), cache_size));
+    // safe. Add a small factor (10%) just for safety margin. The mode may
+    // override this, e.g. after inspecting get_dynamics_cache(mode).GetStats().
+    int cache_size = mode.dynamics_cache_size() > 0 ? mode.dynamics_cache_size()
+                                                    : 1.1 * num_vars();
+    cache_.push_back(std::make_unique<DynamicsCache<T>>(
+        mode.evaluators(), cache_size, mode.num_threads()));
     for (int j = 0; j < mode.num_knotpoints() - 1; j++) {
       auto constraint = std::make_shared<DirconCollocationConstraint<T>>(
-          plant_, mode.evaluators(), contexts_[i_mode].at(j).get(),
-          contexts_[i_mode].at(j + 1).get(), i_mode, j, cache_[i_mode].get());
+          plant_, mode.evaluators(),
+          parallel ? nullptr : contexts_[i_mode].at(j).get(),
+          parallel ? nullptr : contexts_[i_mode].at(j + 1).get(), i_mode, j,
+          cache_[i_mode].get(), mode.analytic_collocation_gradient());
       constraint->SetConstraintScaling(mode.GetDynamicsScale());
-      AddConstraint(
+      batch_groups.emplace_back();
+      add_constraint(
           constraint,
           {timestep(mode_start_[i_mode] + j), state_vars(i_mode, j),
            state_vars(i_mode, j + 1), input_vars(i_mode, j),
            input_vars(i_mode, j + 1), force_vars(i_mode, j),
            force_vars(i_mode, j + 1), collocation_force_vars(i_mode, j),
            collocation_slack_vars(i_mode, j),
-           quaternion_slack_vars(i_mode, j)});
+           quaternion_slack_vars(i_mode, j)},
+          &batch_groups.back());
     }
 
     //
     // Create and add kinematic constraints
     //
     for (int j = 0; j < mode.num_knotpoints(); j++) {
+      batch_groups.emplace_back();
+      auto knot_group = &batch_groups.back();
+
       // Position constraints if type is All
       if (mode.get_constraint_type(j) == KinematicConstraintType::kAll) {
         VectorXd lb = VectorXd::Zero(mode.evaluators().count_active());
@@ -186,9 +218,10 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
             "kinematic_position[" + std::to_string(i_mode) + "][" +
                 std::to_string(j) + "]");
         pos_constraint->SetConstraintScaling(mode.GetKinPositionScale());
-        AddConstraint(pos_constraint,
-                      {state_vars(i_mode, j).head(plant_.num_positions()),
-                       offset_vars(i_mode)});
+        add_constraint(pos_constraint,
+                       {state_vars(i_mode, j).head(plant_.num_positions()),
+                        offset_vars(i_mode)},
+                       knot_group);
       }
 
       // Velocity constraints if type is not acceleration only. Also skip if
@@ -205,7 +238,7 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
                   "kinematic_velocity[" + std::to_string(i_mode) + "][" +
                       std::to_string(j) + "]");
           vel_constraint->SetConstraintScaling(mode.GetKinVelocityScale());
-          AddConstraint(vel_constraint, state_vars(i_mode, j));
+          add_constraint(vel_constraint, {state_vars(i_mode, j)}, knot_group);
         }
       }
 
@@ -216,9 +249,10 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
               std::to_string(j) + "]",
           cache_[i_mode].get());
       accel_constraint->SetConstraintScaling(mode.GetKinAccelerationScale());
-      AddConstraint(accel_constraint,
-                    {state_vars(i_mode, j), input_vars(i_mode, j),
-                     force_vars(i_mode, j)});
+      add_constraint(accel_constraint,
+                     {state_vars(i_mode, j), input_vars(i_mode, j),
+                      force_vars(i_mode, j)},
+                     knot_group);
     }
 
     //
@@ -233,14 +267,17 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
 
         // Use pre-impact context
         auto impact_constraint = std::make_shared<ImpactConstraint<T>>(
-            plant_, mode.evaluators(), contexts_[i_mode - 1].back().get(),
+            plant_, mode.evaluators(),
+            parallel ? nullptr : contexts_[i_mode - 1].back().get(),
             "impact[" + std::to_string(i_mode) + "]");
         impact_constraint->SetConstraintScaling(mode.GetImpactScale());
 
-        AddConstraint(
+        batch_groups.emplace_back();
+        add_constraint(
             impact_constraint,
             {state_vars(i_mode - 1, pre_impact_index), impulse_vars(i_mode - 1),
-             post_impact_velocity_vars(i_mode - 1)});
+             post_impact_velocity_vars(i_mode - 1)},
+            &batch_groups.back());
       } else {
         // Add empty decision variables
         impulse_vars_.push_back(NewContinuousVariables(0, ""));
@@ -253,6 +290,13 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
       }
     }
 
+    if (parallel) {
+      auto batch = std::make_shared<ParallelConstraintBatch>(
+          batch_groups, mode.num_threads(),
+          "dircon_batch[" + std::to_string(i_mode) + "]");
+      AddConstraint(batch, batch->variables());
+    }
+
     //
     // Create and add quaternion constraints
     //
@@ -195,6 +195,12 @@ class Dircon
     return mode_sequence_.mode(mode);
   }
 
+  /// The dynamics cache shared by the constraints of a mode, e.g. to inspect
+  /// its hit/miss/eviction counts.
+  const DynamicsCache<T>& get_dynamics_cache(int mode) const {
+    return *cache_.at(mode);
+  }
+
   const drake::systems::Context<T>& get_context(int mode, int knotpoint_index) {
     return *contexts_.at(mode).at(knotpoint_index);
   }
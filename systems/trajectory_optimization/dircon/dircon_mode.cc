@@ -1,5 +1,7 @@
 #include "systems/trajectory_optimization/dircon/dircon_mode.h"
 
+#include <type_traits>
+
 namespace dairlib {
 namespace systems {
 namespace trajectory_optimization {
@@ -33,6 +35,24 @@ void DirconMode<T>::MakeConstraintRelative(int evaluator_index,
   }
 }
 
+template <typename T>
+void DirconMode<T>::set_num_threads(int num_threads) {
+  DRAKE_DEMAND(num_threads >= 1);
+  num_threads_ = num_threads;
+}
+
+template <typename T>
+void DirconMode<T>::set_analytic_collocation_gradient(bool analytic_gradient) {
+  DRAKE_DEMAND(!analytic_gradient || std::is_same<T, double>::value);
+  analytic_collocation_gradient_ = analytic_gradient;
+}
+
+template <typename T>
+void DirconMode<T>::set_dynamics_cache_size(int cache_size) {
+  DRAKE_DEMAND(cache_size >= 0);
+  dynamics_cache_size_ = cache_size;
+}
+
 template <typename T>
 void DirconMode<T>::SkipQuaternionConstraint(int knotpoint_index) {
   skip_quaternion_.insert(knotpoint_index);
@@ -68,6 +68,32 @@ class DirconMode {
   /// included
   KinematicConstraintType get_constraint_type(int knotpoint_index) const;
 
+  /// Evaluate the collocation, kinematic and impact constraints of this mode
+  /// in parallel, using num_threads threads (including the solver's thread).
+  /// All such constraints are wrapped in a single
+  /// solvers::ParallelConstraintBatch, and each collocation and impact
+  /// constraint is given its own contexts. The default, 1, adds every
+  /// constraint to the program individually.
+  void set_num_threads(int num_threads);
+
+  int num_threads() const { return num_threads_; };
+
+  /// Use an analytic gradient for the collocation constraints of this mode,
+  /// rather than numerical differentiation over every decision variable.
+  /// Only supported for DirconMode<double>, which lets SNOPT avoid
+  /// Dircon<AutoDiffXd> entirely. See DirconCollocationConstraint.
+  void set_analytic_collocation_gradient(bool analytic_gradient);
+
+  bool analytic_collocation_gradient() const {
+    return analytic_collocation_gradient_;
+  };
+
+  /// Set the capacity of the DynamicsCache for this mode. By default (0),
+  /// Dircon uses slightly more than the number of decision variables.
+  void set_dynamics_cache_size(int cache_size);
+
+  int dynamics_cache_size() const { return dynamics_cache_size_; };
+
   /// Set the impact constraint, for the start of this mode, to use a scale
   /// factor
   void SetImpactScale(int velocity_index, double scale);
@@ -185,6 +211,9 @@ class DirconMode {
   const double min_T_;
   const double max_T_;
   const double force_regularization_;
+  int num_threads_ = 1;
+  bool analytic_collocation_gradient_ = false;
+  int dynamics_cache_size_ = 0;
   std::set<int> relative_constraints_;
   std::set<int> skip_quaternion_;
 
@@ -1,5 +1,8 @@
 #include "systems/trajectory_optimization/dircon/dircon_opt_constraints.h"
 
+#include <functional>
+#include <type_traits>
+
 #include "multibody/multibody_utils.h"
 
 namespace dairlib {
@@ -34,7 +37,7 @@ template <typename T>
 DirconCollocationConstraint<T>::DirconCollocationConstraint(
     const MultibodyPlant<T>& plant, const KinematicEvaluatorSet<T>& evaluators,
     Context<T>* context_0, Context<T>* context_1, int mode_index,
-    int knot_index, DynamicsCache<T>* cache)
+    int knot_index, DynamicsCache<T>* cache, bool analytic_gradient)
     : NonlinearConstraint<T>(
           plant.num_positions() + plant.num_velocities(),
           1 +
@@ -55,7 +58,52 @@ DirconCollocationConstraint<T>::DirconCollocationConstraint(
       n_x_(plant.num_positions() + plant.num_velocities()),
       n_u_(plant.num_actuators()),
       n_l_(evaluators.count_full()),
-      cache_(cache) {}
+      cache_(cache),
+      analytic_gradient_(analytic_gradient) {
+  DRAKE_DEMAND(!analytic_gradient_ || std::is_same<T, double>::value);
+
+  // Create new contexts for any that were not provided
+  if (context_0_ == nullptr) {
+    owned_context_0_ = plant_.CreateDefaultContext();
+    context_0_ = owned_context_0_.get();
+  }
+  if (context_1_ == nullptr) {
+    owned_context_1_ = plant_.CreateDefaultContext();
+    context_1_ = owned_context_1_.get();
+  }
+
+  // The knot point variables enter every row through the interpolated state,
+  // but the collocation force, velocity slack and quaternion slack only enter
+  // the dynamics at the collocation point:
+  //   lc affects vdot only, within the subtrees its evaluator acts on
+  //   gamma affects qdot only, through N(q) J^T, for the joints it acts on
+  //   quat_slack affects the rows of its quaternion only
+  const int n_q = plant.num_positions();
+  const int lc_start = 1 + 2 * (n_x_ + n_u_) + 2 * n_l_;
+  const int gamma_start = lc_start + n_l_;
+  const int quat_slack_start = gamma_start + n_l_;
+  drake::MatrixX<bool> sparsity = drake::MatrixX<bool>::Constant(
+      this->num_constraints(), this->num_vars(), true);
+  sparsity.rightCols(this->num_vars() - lc_start).setConstant(false);
+  sparsity.block(n_q, lc_start, plant.num_velocities(), n_l_) =
+      evaluators.GetTimeDerivativeDependencies().rightCols(n_l_);
+  const auto J_mask = evaluators.GetFullDependencies(true);
+  const auto v_to_q = multibody::VelocityToPositionIndices(plant);
+  for (int k = 0; k < n_l_; k++) {
+    for (int j = 0; j < plant.num_velocities(); j++) {
+      if (J_mask(k, j)) {
+        for (int i : v_to_q.at(j)) {
+          sparsity(i, gamma_start + k) = true;
+        }
+      }
+    }
+  }
+  for (uint i = 0; i < quat_start_indices_.size(); i++) {
+    sparsity.block(quat_start_indices_.at(i), quat_slack_start + i, 4, 1)
+        .setConstant(true);
+  }
+  this->SetGradientSparsity(sparsity);
+}
 
 /// The format of the input to the eval() function is in the order
 ///   - timestep h
@@ -95,13 +143,20 @@ void DirconCollocationConstraint<T>::EvaluateConstraint(
   const auto& xdotcol = -1.5 * (x0 - x1) / h - .25 * (xdot0 + xdot1);
   const auto& ucol = 0.5 * (u0 + u1);
 
-  static drake::MatrixX<T> J(evaluators_.count_full(), plant_.num_velocities());
-
   // Evaluate dynamics at colocation point
+  *y = xdotcol - CalcCollocationDynamics(xcol, ucol, lc, gamma, quat_slack);
+}
+
+template <typename T>
+VectorX<T> DirconCollocationConstraint<T>::CalcCollocationDynamics(
+    const VectorX<T>& xcol, const VectorX<T>& ucol, const VectorX<T>& lc,
+    const VectorX<T>& gamma, const VectorX<T>& quat_slack,
+    bool use_cache) const {
   multibody::setContext<T>(plant_, xcol, ucol, context_col_.get());
-  auto g = CalcTimeDerivativesWithForce(context_col_.get(), lc);
+  auto g = CalcTimeDerivativesWithForce(context_col_.get(), lc, use_cache);
 
   // Add velocity slack contribution, J^T * gamma
+  drake::MatrixX<T> J(evaluators_.count_full(), plant_.num_velocities());
   evaluators_.EvalFullJacobian(*context_col_, &J);
   VectorX<T> gamma_in_qdot_space(plant_.num_positions());
   plant_.MapVelocityToQDot(*context_col_, J.transpose() * gamma,
@@ -113,21 +168,195 @@ void DirconCollocationConstraint<T>::EvaluateConstraint(
     g.segment(quat_start_indices_.at(i), 4) +=
         xcol.segment(quat_start_indices_.at(i), 4) * quat_slack(i);
   }
-
-  *y = xdotcol - g;
+  return g;
 }
 
 template <typename T>
 drake::VectorX<T> DirconCollocationConstraint<T>::CalcTimeDerivativesWithForce(
     drake::systems::Context<T>* context,
-    const drake::VectorX<T>& forces) const {
-  if (cache_) {
+    const drake::VectorX<T>& forces, bool use_cache) const {
+  if (cache_ && use_cache) {
     return cache_->CalcTimeDerivativesWithForce(context, forces);
   } else {
-    return evaluators_.CalcTimeDerivativesWithForce(context, forces);
+    return evaluators_.CalcTimeDerivativesWithForce(context, forces,
+                                                    GetFactorization(context));
   }
 }
 
+template <typename T>
+multibody::ConstrainedDynamicsFactorization<T>*
+DirconCollocationConstraint<T>::GetFactorization(
+    const Context<T>* context) const {
+  if (context == context_0_) {
+    return &factorization_0_;
+  } else if (context == context_1_) {
+    return &factorization_1_;
+  }
+  DRAKE_DEMAND(context == context_col_.get());
+  return &factorization_col_;
+}
+
+namespace {
+
+// Forward difference of f about x, given f(x)
+MatrixXd ForwardDifference(
+    const std::function<VectorXd(const VectorXd&)>& f, const VectorXd& x,
+    const VectorXd& f_x, double eps) {
+  MatrixXd df(f_x.size(), x.size());
+  VectorXd x_i = x;
+  for (int i = 0; i < x.size(); i++) {
+    x_i(i) += eps;
+    df.col(i) = (f(x_i) - f_x) / eps;
+    x_i(i) -= eps;
+  }
+  return df;
+}
+
+// Partials of xdot = [qdot; vdot] w.r.t. u and lambda, at the state and input
+// of the context. These are analytic, as the dynamics are affine in both:
+//   M(q) vdot = B u + J(q)^T lambda + f(q, v)
+// Uses (and updates, if q changed) the factorization of M(q) for the context.
+// If J is not nullptr, also returns the full Jacobian J(q).
+void CalcInputAndForceGradient(
+    const MultibodyPlant<double>& plant,
+    const KinematicEvaluatorSet<double>& evaluators,
+    const Context<double>& context,
+    multibody::ConstrainedDynamicsFactorization<double>* factorization,
+    MatrixXd* dxdot_du, MatrixXd* dxdot_dl, MatrixXd* J = nullptr) {
+  const int n_q = plant.num_positions();
+  const int n_v = plant.num_velocities();
+  evaluators.UpdateFactorization(context, false, factorization);
+  const auto& f = *factorization;
+
+  *dxdot_du = MatrixXd::Zero(n_q + n_v, plant.num_actuators());
+  dxdot_du->bottomRows(n_v) = f.M_llt.solve(f.B);
+  *dxdot_dl = MatrixXd::Zero(n_q + n_v, evaluators.count_full());
+  dxdot_dl->bottomRows(n_v) = f.M_llt.solve(f.J_full.transpose());
+
+  if (J) {
+    *J = f.J_full;
+  }
+}
+
+}  // namespace
+
+template <typename T>
+void DirconCollocationConstraint<T>::EvaluateConstraintWithGradient(
+    const Eigen::Ref<const VectorXd>& x, VectorXd* y, MatrixXd* dy) const {
+  NonlinearConstraint<T>::EvaluateConstraintWithGradient(x, y, dy);
+}
+
+/// Analytic gradient, via the chain rule through the Hermite interpolation
+///   xcol    = (x0 + x1) / 2 + h / 8 (xdot0 - xdot1)
+///   xdotcol = -3 / (2h) (x0 - x1) - (xdot0 + xdot1) / 4
+///   y       = xdotcol - g(xcol, ucol, lc, gamma, quat_slack)
+/// where xdot_k = f(x_k, u_k, l_k). Partials of f and g w.r.t. u, lambda,
+/// gamma and quat_slack are analytic. Drake does not yet provide analytic
+/// derivatives of the forward dynamics w.r.t. the state, so those partials
+/// (only n_x directions per point) are forward differenced.
+template <>
+void DirconCollocationConstraint<double>::EvaluateConstraintWithGradient(
+    const Eigen::Ref<const VectorXd>& x, VectorXd* y, MatrixXd* dy) const {
+  if (!analytic_gradient_) {
+    NonlinearConstraint<double>::EvaluateConstraintWithGradient(x, y, dy);
+    return;
+  }
+
+  const int n_q = plant_.num_positions();
+  const int n_quat = quat_start_indices_.size();
+
+  // Extract decision variables
+  const int u_start = 1 + 2 * n_x_;
+  const int l_start = 1 + 2 * (n_x_ + n_u_);
+  const double h = x(0);
+  const VectorXd x0 = x.segment(1, n_x_);
+  const VectorXd x1 = x.segment(1 + n_x_, n_x_);
+  const VectorXd u0 = x.segment(u_start, n_u_);
+  const VectorXd u1 = x.segment(u_start + n_u_, n_u_);
+  const VectorXd l0 = x.segment(l_start, n_l_);
+  const VectorXd l1 = x.segment(l_start + n_l_, n_l_);
+  const VectorXd lc = x.segment(l_start + 2 * n_l_, n_l_);
+  const VectorXd gamma = x.segment(l_start + 3 * n_l_, n_l_);
+  const VectorXd quat_slack = x.segment(l_start + 4 * n_l_, n_quat);
+
+  // Dynamics at the knot points, and their partials A_x, A_u, A_l
+  auto knot_dynamics = [&](const VectorXd& x_k, const VectorXd& u_k,
+                           const VectorXd& l_k, Context<double>* context,
+                           VectorXd* xdot, MatrixXd* A_x, MatrixXd* A_u,
+                           MatrixXd* A_l) {
+    multibody::setContext<double>(plant_, x_k, u_k, context);
+    *xdot = CalcTimeDerivativesWithForce(context, l_k);
+    CalcInputAndForceGradient(plant_, evaluators_, *context,
+                              GetFactorization(context), A_u, A_l);
+    // Perturbing v reuses the factorization at q
+    *A_x = ForwardDifference(
+        [&](const VectorXd& x_i) {
+          multibody::setContext<double>(plant_, x_i, u_k, context);
+          return evaluators_.CalcTimeDerivativesWithForce(
+              context, l_k, GetFactorization(context));
+        },
+        x_k, *xdot, this->eps());
+    multibody::setContext<double>(plant_, x_k, u_k, context);
+  };
+  VectorXd xdot0, xdot1;
+  MatrixXd A0_x, A0_u, A0_l, A1_x, A1_u, A1_l;
+  knot_dynamics(x0, u0, l0, context_0_, &xdot0, &A0_x, &A0_u, &A0_l);
+  knot_dynamics(x1, u1, l1, context_1_, &xdot1, &A1_x, &A1_u, &A1_l);
+
+  // Cubic interpolation to get xcol and xdotcol.
+  const VectorXd xcol = 0.5 * (x0 + x1) + h / 8 * (xdot0 - xdot1);
+  const VectorXd xdotcol = -1.5 * (x0 - x1) / h - .25 * (xdot0 + xdot1);
+  const VectorXd ucol = 0.5 * (u0 + u1);
+
+  // Dynamics at the collocation point, and their partials G_x, G_u, G_l,
+  // G_gamma and G_quat
+  const VectorXd g =
+      CalcCollocationDynamics(xcol, ucol, lc, gamma, quat_slack);
+  MatrixXd G_u, G_l, J;
+  CalcInputAndForceGradient(plant_, evaluators_, *context_col_,
+                            &factorization_col_, &G_u, &G_l, &J);
+  MatrixXd G_gamma = MatrixXd::Zero(n_x_, n_l_);
+  VectorXd gamma_col_in_qdot_space(n_q);
+  for (int i = 0; i < n_l_; i++) {
+    plant_.MapVelocityToQDot(*context_col_, J.row(i).transpose(),
+                             &gamma_col_in_qdot_space);
+    G_gamma.col(i).head(n_q) = gamma_col_in_qdot_space;
+  }
+  MatrixXd G_quat = MatrixXd::Zero(n_x_, n_quat);
+  for (int i = 0; i < n_quat; i++) {
+    G_quat.col(i).segment(quat_start_indices_.at(i), 4) =
+        xcol.segment(quat_start_indices_.at(i), 4);
+  }
+  const MatrixXd G_x = ForwardDifference(
+      [&](const VectorXd& x_i) {
+        return CalcCollocationDynamics(x_i, ucol, lc, gamma, quat_slack,
+                                       false);
+      },
+      xcol, g, this->eps());
+  multibody::setContext<double>(plant_, xcol, ucol, context_col_.get());
+
+  *y = xdotcol - g;
+
+  // dy/dz = dxdotcol/dz - G_x dxcol/dz - (direct partials of g). Terms which
+  // enter through xdot0 and xdot1 are premultiplied by P0 and P1:
+  //   dy/dxdot0 = -I/4 - h/8 G_x,   dy/dxdot1 = -I/4 + h/8 G_x
+  const MatrixXd I = MatrixXd::Identity(n_x_, n_x_);
+  const MatrixXd P0 = -0.25 * I - h / 8 * G_x;
+  const MatrixXd P1 = -0.25 * I + h / 8 * G_x;
+
+  dy->resize(n_x_, x.size());
+  dy->col(0) = 1.5 * (x0 - x1) / (h * h) - G_x * (xdot0 - xdot1) / 8;
+  dy->middleCols(1, n_x_) = -1.5 / h * I - 0.5 * G_x + P0 * A0_x;
+  dy->middleCols(1 + n_x_, n_x_) = 1.5 / h * I - 0.5 * G_x + P1 * A1_x;
+  dy->middleCols(u_start, n_u_) = P0 * A0_u - 0.5 * G_u;
+  dy->middleCols(u_start + n_u_, n_u_) = P1 * A1_u - 0.5 * G_u;
+  dy->middleCols(l_start, n_l_) = P0 * A0_l;
+  dy->middleCols(l_start + n_l_, n_l_) = P1 * A1_l;
+  dy->middleCols(l_start + 2 * n_l_, n_l_) = -G_l;
+  dy->middleCols(l_start + 3 * n_l_, n_l_) = -G_gamma;
+  dy->middleCols(l_start + 4 * n_l_, n_quat) = -G_quat;
+}
+
 template <typename T>
 ImpactConstraint<T>::ImpactConstraint(
     const MultibodyPlant<T>& plant, const KinematicEvaluatorSet<T>& evaluators,
@@ -142,7 +371,34 @@ ImpactConstraint<T>::ImpactConstraint(
       evaluators_(evaluators),
       context_(context),
       n_x_(plant.num_positions() + plant.num_velocities()),
-      n_l_(evaluators.count_full()) {}
+      n_l_(evaluators.count_full()) {
+  // Create a new context if one was not provided
+  if (context_ == nullptr) {
+    owned_context_ = plant_.CreateDefaultContext();
+    context_ = owned_context_.get();
+  }
+
+  // M(q) only couples velocities in the same subtree of the world, and
+  // J^T * impulse only reaches the velocities on each evaluator's kinematic
+  // path. Dependence on q is taken to be dense.
+  const int n_q = plant.num_positions();
+  const int n_v = plant.num_velocities();
+  const std::vector<int> groups = multibody::VelocityCouplingGroups(plant);
+  drake::MatrixX<bool> sparsity = drake::MatrixX<bool>::Constant(
+      this->num_constraints(), this->num_vars(), false);
+  sparsity.leftCols(n_q).setConstant(true);
+  for (int i = 0; i < n_v; i++) {
+    for (int j = 0; j < n_v; j++) {
+      if (groups[i] == groups[j]) {
+        sparsity(i, n_q + j) = true;
+        sparsity(i, n_x_ + n_l_ + j) = true;
+      }
+    }
+  }
+  sparsity.block(0, n_x_, n_v, n_l_) =
+      evaluators.GetFullDependencies(true).transpose();
+  this->SetGradientSparsity(sparsity);
+}
 
 /// The format of the input to the eval() function is in the order
 ///   - x0, pre-impact state (q,v)
@@ -185,6 +441,9 @@ CachedAccelerationConstraint<T>::CachedAccelerationConstraint(
   } else {
     context_ = context;
   }
+
+  this->SetGradientSparsity(
+      evaluators.GetActiveSecondTimeDerivativeDependencies());
 }
 
 template <typename T>
@@ -198,8 +457,9 @@ void CachedAccelerationConstraint<T>::EvaluateConstraint(
 
   if (cache_) {
     const auto& xdot = cache_->CalcTimeDerivativesWithForce(context_, lambda);
-    const auto& J = evaluators_.EvalActiveJacobian(*context_);
-    const auto& Jdotv = evaluators_.EvalActiveJacobianDotTimesV(*context_);
+    drake::MatrixX<T> J(evaluators_.count_active(), plant_.num_velocities());
+    VectorX<T> Jdotv(evaluators_.count_active());
+    evaluators_.EvalActiveInto(*context_, nullptr, nullptr, &J, &Jdotv);
     *y = J * xdot.tail(plant_.num_velocities()) + Jdotv;
   } else {
     *y = evaluators_.EvalActiveSecondTimeDerivative(context_, lambda);
@@ -35,35 +35,66 @@ class DirconCollocationConstraint : public solvers::NonlinearConstraint<T> {
  public:
 
  public:
-  /// Requires two context pointers to be pasesd as arguments, one for each
-  /// knot point. The constraint will create its own pointer for the collocation
-  /// point context.
+  /// Takes two context pointers as arguments, one for each knot point. The
+  /// constraint will create its own pointer for the collocation point context.
+  /// If either knot point context is nullptr, the constraint will create and
+  /// own that context as well. A constraint owning all of its contexts may be
+  /// evaluated concurrently with other constraints.
+  ///
+  /// If analytic_gradient is true (T = double only), the gradient is built
+  /// from the chain rule through the Hermite interpolation, with the dynamics
+  /// partials w.r.t. u, lambda and the slack variables computed analytically.
+  /// Only the partials of the dynamics w.r.t. the state are differenced. This
+  /// avoids both AutoDiffXd and differencing over every decision variable.
   DirconCollocationConstraint(const drake::multibody::MultibodyPlant<T>& plant,
       const multibody::KinematicEvaluatorSet<T>& evaluators,
       drake::systems::Context<T>* context_0,
       drake::systems::Context<T>* context_1,
       int mode_index, int knot_index,
-      DynamicsCache<T>* cache = nullptr);
+      DynamicsCache<T>* cache = nullptr,
+      bool analytic_gradient = false);
 
  public:
   void EvaluateConstraint(const Eigen::Ref<const drake::VectorX<T>>& x,
                           drake::VectorX<T>* y) const override;
 
+  void EvaluateConstraintWithGradient(
+      const Eigen::Ref<const Eigen::VectorXd>& x, Eigen::VectorXd* y,
+      Eigen::MatrixXd* dy) const override;
+
  private:
   drake::VectorX<T> CalcTimeDerivativesWithForce(
     drake::systems::Context<T>* context,
-    const drake::VectorX<T>& forces) const;
+    const drake::VectorX<T>& forces, bool use_cache = true) const;
+
+  // The factorization of the dynamics at one of the three contexts
+  multibody::ConstrainedDynamicsFactorization<T>* GetFactorization(
+      const drake::systems::Context<T>* context) const;
+
+  // Evaluates the dynamics at the collocation point, including the velocity
+  // and quaternion slack contributions. Sets context_col_.
+  drake::VectorX<T> CalcCollocationDynamics(const drake::VectorX<T>& xcol,
+      const drake::VectorX<T>& ucol, const drake::VectorX<T>& lc,
+      const drake::VectorX<T>& gamma, const drake::VectorX<T>& quat_slack,
+      bool use_cache = true) const;
 
   const drake::multibody::MultibodyPlant<T>& plant_;
   const multibody::KinematicEvaluatorSet<T>& evaluators_;
   drake::systems::Context<T>* context_0_;
   drake::systems::Context<T>* context_1_;
+  std::unique_ptr<drake::systems::Context<T>> owned_context_0_;
+  std::unique_ptr<drake::systems::Context<T>> owned_context_1_;
   std::unique_ptr<drake::systems::Context<T>> context_col_;
   const std::vector<int> quat_start_indices_;
   int n_x_;
   int n_u_;
   int n_l_;
   DynamicsCache<T>* cache_;
+  const bool analytic_gradient_;
+  // Reused across evaluations at the same positions, e.g. while differencing
+  mutable multibody::ConstrainedDynamicsFactorization<T> factorization_0_;
+  mutable multibody::ConstrainedDynamicsFactorization<T> factorization_1_;
+  mutable multibody::ConstrainedDynamicsFactorization<T> factorization_col_;
 };
 
 /// Implements the impact constraint used by Dircon on mode transitions
@@ -73,6 +104,7 @@ class DirconCollocationConstraint : public solvers::NonlinearConstraint<T> {
 template <typename T>
 class ImpactConstraint : public solvers::NonlinearConstraint<T> {
  public:
+  /// If context is nullptr, the constraint will create and own its context.
   ImpactConstraint(
       const drake::multibody::MultibodyPlant<T>& plant,
       const multibody::KinematicEvaluatorSet<T>& evaluators,
@@ -86,6 +118,7 @@ class ImpactConstraint : public solvers::NonlinearConstraint<T> {
   const drake::multibody::MultibodyPlant<T>& plant_;
   const multibody::KinematicEvaluatorSet<T>& evaluators_;
   drake::systems::Context<T>* context_;
+  std::unique_ptr<drake::systems::Context<T>> owned_context_;
   const int n_x_;
   const int n_l_;
 };
@@ -1,96 +1,349 @@
 #include "systems/trajectory_optimization/dircon/dynamics_cache.h"
 
-#include "drake/math/autodiff_gradient.h"
+#include <cstring>
+#include <mutex>
 
 namespace dairlib {
 namespace systems {
 namespace trajectory_optimization {
 
 using drake::AutoDiffXd;
-using drake::AutoDiffVecXd;
+using drake::VectorX;
+using drake::systems::Context;
+using drake::systems::VectorBase;
 
-inline void hash_combine(std::size_t& seed, const double& v) {
-    seed ^= std::hash<double>{}(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+namespace {
+
+inline double value_of(double v) { return v; }
+inline double value_of(const AutoDiffXd& v) { return v.value(); }
+
+// Mixes the bit pattern of a double into the seed (FNV-1a over 64-bit words)
+inline void hash_combine(uint64_t* seed, double v) {
+  uint64_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  *seed = (*seed ^ bits) * 0x100000001b3ULL;
+}
+
+// Final avalanche, so that both the low bits (table slot) and high bits
+// (shard) are well distributed
+inline uint64_t finalize(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+inline bool IsEqual(double a, double b) { return a == b; }
+
+inline bool IsEqual(const AutoDiffXd& a, const AutoDiffXd& b) {
+  return a.value() == b.value() &&
+         a.derivatives().size() == b.derivatives().size() &&
+         a.derivatives() == b.derivatives();
 }
 
-inline void hash_combine(std::size_t& seed,
-    const Eigen::Ref<const Eigen::VectorXd>& v) {
-  for (int i = 0; i < v.size(); i++) {
-    hash_combine(seed, v(i)); 
+template <typename T>
+bool IsEqual(const VectorBase<T>& a, const VectorX<T>& b) {
+  for (int i = 0; i < b.size(); i++) {
+    if (!IsEqual(a.GetAtIndex(i), b(i))) {
+      return false;
+    }
   }
+  return true;
 }
 
-inline void hash_combine(std::size_t& seed,
-    const Eigen::Ref<const AutoDiffVecXd>& v) {
-  for (int i = 0; i < v.size(); i++) {
-    hash_combine(seed, v(i).value());
-    hash_combine(seed, v(i).derivatives());
+template <typename T>
+bool IsEqual(const VectorX<T>& a, const VectorX<T>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (int i = 0; i < b.size(); i++) {
+    if (!IsEqual(a(i), b(i))) {
+      return false;
+    }
   }
+  return true;
 }
 
+// A view of a cache key, without copying it out of the context
 template <typename T>
-DynamicsCache<T>::DynamicsCache(
-    const multibody::KinematicEvaluatorSet<T>& evaluators, int max_size)
-  : evaluators_(evaluators),
-    max_size_(max_size) {}
+struct KeyView {
+  const VectorBase<T>& state;
+  const VectorX<T>& input;
+  const VectorX<T>& forces;
+
+  uint64_t Hash() const {
+    uint64_t seed = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < state.size(); i++) {
+      hash_combine(&seed, value_of(state.GetAtIndex(i)));
+    }
+    for (int i = 0; i < input.size(); i++) {
+      hash_combine(&seed, value_of(input(i)));
+    }
+    for (int i = 0; i < forces.size(); i++) {
+      hash_combine(&seed, value_of(forces(i)));
+    }
+    return finalize(seed);
+  }
+};
+
+}  // namespace
 
+/// One independently locked partition of the cache. Entries live in a fixed
+/// pool, threaded onto an intrusive LRU list. The hash table is an array of
+/// pool indices with linear probing, sized to at least twice the capacity,
+/// and uses backward-shift deletion on eviction (no tombstones).
 template <typename T>
-drake::VectorX<T> DynamicsCache<T>::CalcTimeDerivativesWithForce(
-    drake::systems::Context<T>* context,
-    const drake::VectorX<T>& forces) {
-  CacheKey<T> key{evaluators_.plant().GetPositionsAndVelocities(*context), 
-                  evaluators_.plant().get_actuation_input_port().Eval(*context),
-                  forces};
-  auto it = map_.find(key);
-  if (it == map_.end()) {
-    auto xdot = evaluators_.CalcTimeDerivativesWithForce(context, forces);
-    map_[key] = xdot;
-
-    // Add to the queue_
-    if (map_.size() >= max_size_) {
-      map_.erase(queue_.front());
-      queue_.pop_front();
-    }
-    queue_.push_back(key);
-    return xdot;
-  } else {
-    return it->second;
+class DynamicsCache<T>::Shard {
+ public:
+  Shard(int capacity, int n_x, int n_u, int n_l) : entries_(capacity) {
+    int table_size = 1;
+    while (table_size < 2 * capacity) {
+      table_size *= 2;
+    }
+    table_.assign(table_size, kEmpty);
+    mask_ = table_size - 1;
+    for (auto& entry : entries_) {
+      entry.state.resize(n_x);
+      entry.input.resize(n_u);
+      entry.forces.resize(n_l);
+      entry.xdot.resize(n_x);
+    }
+  }
+
+  // On a hit, copies the cached value to xdot and marks it most recently used
+  bool Find(uint64_t hash, const KeyView<T>& key, VectorX<T>* xdot) {
+    const int index = FindIndex(hash, key);
+    if (index == kEmpty) {
+      stats.misses++;
+      return false;
+    }
+    stats.hits++;
+    MoveToFront(index);
+    *xdot = entries_[index].xdot;
+    return true;
+  }
+
+  void Insert(uint64_t hash, const KeyView<T>& key, const VectorX<T>& xdot) {
+    // Another thread may have inserted the same key in the meantime
+    if (FindIndex(hash, key) != kEmpty) {
+      return;
+    }
+
+    int index;
+    if (size_ < static_cast<int>(entries_.size())) {
+      index = size_++;
+    } else {
+      // Evict the least recently used entry
+      index = tail_;
+      EraseSlot(entries_[index].slot);
+      Unlink(index);
+      stats.evictions++;
+    }
+
+    Entry& entry = entries_[index];
+    entry.hash = hash;
+    for (int i = 0; i < entry.state.size(); i++) {
+      entry.state(i) = key.state.GetAtIndex(i);
+    }
+    entry.input = key.input;
+    entry.forces = key.forces;
+    entry.xdot = xdot;
+
+    int slot = hash & mask_;
+    while (table_[slot] != kEmpty) {
+      slot = (slot + 1) & mask_;
+    }
+    table_[slot] = index;
+    entry.slot = slot;
+    PushFront(index);
+  }
+
+  int size() const { return size_; }
+
+  int capacity() const { return entries_.size(); }
+
+  std::mutex mutex;
+  Stats stats;
+
+ private:
+  static constexpr int kEmpty = -1;
+
+  struct Entry {
+    uint64_t hash = 0;
+    VectorX<T> state;
+    VectorX<T> input;
+    VectorX<T> forces;
+    VectorX<T> xdot;
+    int slot = kEmpty;
+    int prev = kEmpty;
+    int next = kEmpty;
+  };
+
+  int FindIndex(uint64_t hash, const KeyView<T>& key) const {
+    for (int slot = hash & mask_; table_[slot] != kEmpty;
+         slot = (slot + 1) & mask_) {
+      const Entry& entry = entries_[table_[slot]];
+      if (entry.hash == hash && IsEqual(key.state, entry.state) &&
+          IsEqual(key.input, entry.input) &&
+          IsEqual(key.forces, entry.forces)) {
+        return table_[slot];
+      }
+    }
+    return kEmpty;
+  }
+
+  // Removes the entry at slot i, shifting back any later entries in the same
+  // probe sequence which could no longer be reached
+  void EraseSlot(int i) {
+    int j = i;
+    while (true) {
+      j = (j + 1) & mask_;
+      if (table_[j] == kEmpty) {
+        break;
+      }
+      // Leave the entry at j if its home slot k lies cyclically in (i, j]
+      const int k = entries_[table_[j]].hash & mask_;
+      if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) {
+        continue;
+      }
+      table_[i] = table_[j];
+      entries_[table_[i]].slot = i;
+      i = j;
+    }
+    table_[i] = kEmpty;
+  }
+
+  void Unlink(int index) {
+    Entry& entry = entries_[index];
+    if (entry.prev != kEmpty) {
+      entries_[entry.prev].next = entry.next;
+    } else {
+      head_ = entry.next;
+    }
+    if (entry.next != kEmpty) {
+      entries_[entry.next].prev = entry.prev;
+    } else {
+      tail_ = entry.prev;
+    }
+    entry.prev = kEmpty;
+    entry.next = kEmpty;
+  }
+
+  void PushFront(int index) {
+    Entry& entry = entries_[index];
+    entry.prev = kEmpty;
+    entry.next = head_;
+    if (head_ != kEmpty) {
+      entries_[head_].prev = index;
+    }
+    head_ = index;
+    if (tail_ == kEmpty) {
+      tail_ = index;
+    }
+  }
+
+  void MoveToFront(int index) {
+    if (head_ != index) {
+      Unlink(index);
+      PushFront(index);
+    }
+  }
+
+  std::vector<Entry> entries_;
+  std::vector<int> table_;
+  int mask_;
+  int size_ = 0;
+  int head_ = kEmpty;
+  int tail_ = kEmpty;
+};
+
+template <typename T>
+DynamicsCache<T>::DynamicsCache(
+    const multibody::KinematicEvaluatorSet<T>& evaluators, int max_size,
+    int num_shards)
+    : evaluators_(evaluators) {
+  DRAKE_DEMAND(max_size >= 1);
+  DRAKE_DEMAND(num_shards >= 1);
+  DRAKE_DEMAND(!evaluators.plant().is_discrete());
+  const auto& plant = evaluators.plant();
+  const int shard_capacity = (max_size + num_shards - 1) / num_shards;
+  for (int i = 0; i < num_shards; i++) {
+    shards_.push_back(std::make_unique<Shard>(
+        shard_capacity, plant.num_positions() + plant.num_velocities(),
+        plant.num_actuators(), evaluators.count_full()));
   }
 }
 
-bool AreVectorsEqual(const Eigen::Ref<const AutoDiffVecXd>& a,
-                     const Eigen::Ref<const AutoDiffVecXd>& b) {
-  if (a.value() != b.value()) {
-    return false;
+template <typename T>
+DynamicsCache<T>::~DynamicsCache() = default;
+
+template <typename T>
+VectorX<T> DynamicsCache<T>::CalcTimeDerivativesWithForce(
+    Context<T>* context, const VectorX<T>& forces) {
+  const auto& input_port = evaluators_.plant().get_actuation_input_port();
+  const KeyView<T> key{context->get_continuous_state_vector(),
+                       input_port.Eval(*context), forces};
+  const uint64_t hash = key.Hash();
+  Shard& shard = *shards_[(hash >> 32) % shards_.size()];
+
+  VectorX<T> xdot;
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.Find(hash, key, &xdot)) {
+      return xdot;
+    }
   }
-  const Eigen::MatrixXd& a_gradient = drake::math::autoDiffToGradientMatrix(a);
-  const Eigen::MatrixXd& b_gradient = drake::math::autoDiffToGradientMatrix(b);
 
-  return a_gradient == b_gradient;
+  // Evaluate outside of the lock, so that concurrent misses do not serialize
+  // on the dynamics computation.
+  xdot = evaluators_.CalcTimeDerivativesWithForce(context, forces);
+
+  const KeyView<T> inserted_key{context->get_continuous_state_vector(),
+                                input_port.Eval(*context), forces};
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.Insert(hash, inserted_key, xdot);
+  return xdot;
 }
 
 template <typename T>
-std::size_t CacheHasher<T>::operator()(const CacheKey<T>& key) const {
-  std::size_t seed = 0;
-  hash_combine(seed, key.state);
-  hash_combine(seed, key.input);
-  hash_combine(seed, key.forces);
-  return seed;
+typename DynamicsCache<T>::Stats DynamicsCache<T>::GetStats() const {
+  Stats total;
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    total.hits += shard->stats.hits;
+    total.misses += shard->stats.misses;
+    total.evictions += shard->stats.evictions;
+  }
+  return total;
 }
 
-template <>
-bool CacheComparer<double>::operator()(const CacheKey<double>& a,
-    const CacheKey<double>& b) const {
-  return (a.state == b.state) && (a.forces == b.forces) &&
-      (a.input == b.input);
+template <typename T>
+void DynamicsCache<T>::ResetStats() {
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->stats = Stats();
+  }
 }
 
-template <>
-bool CacheComparer<AutoDiffXd>::operator()(const CacheKey<AutoDiffXd>& a,
-    const CacheKey<AutoDiffXd>& b) const {
-  return AreVectorsEqual(a.state, b.state) &&
-         AreVectorsEqual(a.input, b.input) &&
-        AreVectorsEqual(a.forces, b.forces);
+template <typename T>
+int DynamicsCache<T>::size() const {
+  int size = 0;
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    size += shard->size();
+  }
+  return size;
+}
+
+template <typename T>
+int DynamicsCache<T>::capacity() const {
+  int capacity = 0;
+  for (const auto& shard : shards_) {
+    capacity += shard->capacity();
+  }
+  return capacity;
 }
 
 }  // namespace trajectory_optimization
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <unordered_map>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 #include "multibody/kinematic/kinematic_evaluator_set.h"
 
@@ -8,44 +10,56 @@ namespace dairlib {
 namespace systems {
 namespace trajectory_optimization {
 
+/// Memoizes KinematicEvaluatorSet::CalcTimeDerivativesWithForce, keyed on
+/// the state, input and constraint forces.
+///
+/// The cache is a fixed-capacity, open-addressing hash table with a
+/// least-recently-used eviction policy. Entries, including their keys, are
+/// stored inline and allocated at construction, so lookups and insertions do
+/// not allocate (for AutoDiffXd, an entry's gradients are sized on first use).
+/// Keys are hashed by a fingerprint of their values only. The gradients of
+/// AutoDiffXd keys are compared on lookup, but never hashed.
+///
+/// The table is split into independently locked shards, so a single cache may
+/// be shared by constraints that are evaluated concurrently, provided each
+/// caller supplies its own context. Requires a continuous plant.
 template <typename T>
-struct CacheKey {
-  const drake::VectorX<T> state;
-  const drake::VectorX<T> input;
-  const drake::VectorX<T> forces;
-};
-
-// == operation for two CacheKeys
-template <typename T>
-class CacheComparer {
+class DynamicsCache {
  public:
-  bool operator()(const CacheKey<T>& a, const CacheKey<T>& b) const;
-};
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t evictions = 0;
+  };
 
-// Hashes a CacheKey by bit shifting and combining hashes of the double
-// elements
-template <typename T>
-class CacheHasher {
- public:
-  std::size_t operator()(const CacheKey<T>& key) const;
-};
+  /// @param evaluators The constraint set whose dynamics are cached
+  /// @param max_size The total capacity, across all shards
+  /// @param num_shards The number of independently locked shards. Use more
+  ///   than one when the cache is shared by concurrently evaluated constraints.
+  DynamicsCache(const multibody::KinematicEvaluatorSet<T>& evaluators,
+      int max_size, int num_shards = 1);
 
-template <typename T>
-class DynamicsCache {
- public:
-  DynamicsCache(const multibody::KinematicEvaluatorSet<T>& constraints,
-      int max_size);
+  ~DynamicsCache();
 
   drake::VectorX<T> CalcTimeDerivativesWithForce(
       drake::systems::Context<T>* context,
       const drake::VectorX<T>& forces);
 
+  /// Hit, miss and eviction counts, summed over all shards
+  Stats GetStats() const;
+
+  void ResetStats();
+
+  /// The number of entries currently stored
+  int size() const;
+
+  int capacity() const;
+
  private:
+  class Shard;
+
   const multibody::KinematicEvaluatorSet<T>& evaluators_;
-  size_t max_size_;
-  std::unordered_map<CacheKey<T>, drake::VectorX<T>, CacheHasher<T>,
-      CacheComparer<T>> map_;
-  std::list<CacheKey<T>> queue_;
+  std::vector<std::unique_ptr<Shard>> shards_;
 };
 
 }  // namespace trajectory_optimization
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "common/find_resource.h"
+#include "multibody/kinematic/distance_evaluator.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "systems/trajectory_optimization/dircon/dircon_opt_constraints.h"
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/math/autodiff.h"
+#include "drake/math/autodiff_gradient.h"
+#include "drake/multibody/parsing/parser.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+namespace {
+
+using drake::AutoDiffVecXd;
+using drake::AutoDiffXd;
+using drake::CompareMatrices;
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+
+// A floating acrobot, pinned to the world at its base and with a distance
+// constraint between the links, as in passive_constrained_pendulum_dircon.
+template <typename T>
+struct ConstrainedAcrobot {
+  explicit ConstrainedAcrobot(const MultibodyPlant<T>& plant)
+      : distance(plant, Vector3d::Zero(), plant.GetFrameByName("base_link"),
+                 Vector3d(-1, 0, 0), plant.GetFrameByName("lower_link"), .7),
+        pin(plant, Vector3d::Zero(), plant.GetFrameByName("base_link")),
+        evaluators(plant) {
+    evaluators.add_evaluator(&distance);
+    evaluators.add_evaluator(&pin);
+  }
+
+  multibody::DistanceEvaluator<T> distance;
+  multibody::WorldPointEvaluator<T> pin;
+  multibody::KinematicEvaluatorSet<T> evaluators;
+};
+
+class DirconCollocationConstraintTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Parser parser(&plant_);
+    parser.AddModelFromFile(FindResourceOrThrow(
+        "systems/trajectory_optimization/dircon/test/acrobot_floating.urdf"));
+    plant_.Finalize();
+    plant_ad_ = drake::systems::System<double>::ToAutoDiffXd(plant_);
+  }
+
+  MultibodyPlant<double> plant_{0.0};
+  std::unique_ptr<MultibodyPlant<AutoDiffXd>> plant_ad_;
+};
+
+TEST_F(DirconCollocationConstraintTest, AnalyticGradientMatchesAutoDiff) {
+  ConstrainedAcrobot<double> acrobot(plant_);
+  ConstrainedAcrobot<AutoDiffXd> acrobot_ad(*plant_ad_);
+
+  DirconCollocationConstraint<double> analytic(
+      plant_, acrobot.evaluators, nullptr, nullptr, 0, 0, nullptr, true);
+  DirconCollocationConstraint<AutoDiffXd> autodiff(
+      *plant_ad_, acrobot_ad.evaluators, nullptr, nullptr, 0, 0);
+  ASSERT_EQ(analytic.num_vars(), autodiff.num_vars());
+
+  // Decision variables, in the order documented by EvaluateConstraint, with
+  // unit quaternions at both knot points
+  const int n_q = plant_.num_positions();
+  const int n_x = n_q + plant_.num_velocities();
+  std::srand(0);
+  VectorXd vars = VectorXd::Random(analytic.num_vars());
+  vars(0) = 0.1;
+  for (int k = 0; k < 2; k++) {
+    vars.segment(1 + k * n_x, 4).normalize();
+  }
+
+  VectorXd y_analytic, y_autodiff;
+  MatrixXd dy_analytic, dy_autodiff;
+  analytic.EvaluateConstraintWithGradient(vars, &y_analytic, &dy_analytic);
+  autodiff.EvaluateConstraintWithGradient(vars, &y_autodiff, &dy_autodiff);
+
+  EXPECT_TRUE(CompareMatrices(y_analytic, y_autodiff, 1e-10));
+  // Only the state partials of the dynamics are differenced
+  const double tol = 1e-4 * std::max(1.0, dy_autodiff.cwiseAbs().maxCoeff());
+  EXPECT_TRUE(CompareMatrices(dy_analytic, dy_autodiff, tol));
+
+  // The value agrees with EvaluateConstraint
+  VectorXd y;
+  analytic.EvaluateConstraint(vars, &y);
+  EXPECT_TRUE(CompareMatrices(y, y_analytic, 1e-12));
+
+  // And the gradient is used by Eval
+  AutoDiffVecXd y_eval;
+  analytic.Eval(drake::math::initializeAutoDiff(vars), &y_eval);
+  EXPECT_TRUE(CompareMatrices(drake::math::autoDiffToGradientMatrix(y_eval),
+                              dy_analytic, 1e-12));
+}
+
+TEST_F(DirconCollocationConstraintTest, GradientSparsityPattern) {
+  ConstrainedAcrobot<double> acrobot(plant_);
+  ConstrainedAcrobot<AutoDiffXd> acrobot_ad(*plant_ad_);
+  DirconCollocationConstraint<double> analytic(
+      plant_, acrobot.evaluators, nullptr, nullptr, 0, 0, nullptr, true);
+  DirconCollocationConstraint<AutoDiffXd> autodiff(
+      *plant_ad_, acrobot_ad.evaluators, nullptr, nullptr, 0, 0);
+
+  const int n_x = plant_.num_positions() + plant_.num_velocities();
+  std::srand(1);
+  VectorXd vars = VectorXd::Random(analytic.num_vars());
+  vars(0) = 0.1;
+  for (int k = 0; k < 2; k++) {
+    vars.segment(1 + k * n_x, 4).normalize();
+  }
+
+  // The analytic gradient, which does not use the pattern, is zero outside
+  // of it
+  VectorXd y;
+  MatrixXd dy;
+  analytic.EvaluateConstraintWithGradient(vars, &y, &dy);
+  ASSERT_TRUE(analytic.gradient_sparsity_pattern().has_value());
+  MatrixXd outside = dy;
+  for (const auto& entry : analytic.gradient_sparsity_pattern().value()) {
+    outside(entry.first, entry.second) = 0;
+  }
+  EXPECT_TRUE(outside.isZero(0));
+  EXPECT_LT(analytic.gradient_sparsity_pattern()->size(),
+            static_cast<size_t>(dy.size()));
+
+  // AutoDiffXd, with derivative directions shared by the column groups
+  autodiff.EvaluateConstraintWithGradient(vars, &y, &dy);
+  MatrixXd dy_analytic;
+  analytic.EvaluateConstraintWithGradient(vars, &y, &dy_analytic);
+  const double tol = 1e-4 * std::max(1.0, dy.cwiseAbs().maxCoeff());
+  EXPECT_TRUE(CompareMatrices(dy_analytic, dy, tol));
+}
+
+}  // namespace
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
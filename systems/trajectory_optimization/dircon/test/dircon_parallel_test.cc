@@ -0,0 +1,137 @@
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "common/find_resource.h"
+#include "multibody/kinematic/distance_evaluator.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "systems/trajectory_optimization/dircon/dircon.h"
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/math/autodiff.h"
+#include "drake/math/autodiff_gradient.h"
+#include "drake/multibody/parsing/parser.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+namespace {
+
+using drake::AutoDiffVecXd;
+using drake::CompareMatrices;
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+
+// The passive constrained pendulum of passive_constrained_pendulum_dircon: a
+// floating acrobot pinned to the world at its base, with a distance constraint
+// between the links. Two modes, so that the impact constraint is included.
+class DirconParallelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Parser parser(&plant_);
+    parser.AddModelFromFile(FindResourceOrThrow(
+        "systems/trajectory_optimization/dircon/test/acrobot_floating.urdf"));
+    plant_.Finalize();
+
+    distance_ = std::make_unique<multibody::DistanceEvaluator<double>>(
+        plant_, Vector3d::Zero(), plant_.GetFrameByName("base_link"),
+        Vector3d(-1, 0, 0), plant_.GetFrameByName("lower_link"), .7);
+    pin_ = std::make_unique<multibody::WorldPointEvaluator<double>>(
+        plant_, Vector3d::Zero(), plant_.GetFrameByName("base_link"));
+    evaluators_ =
+        std::make_unique<multibody::KinematicEvaluatorSet<double>>(plant_);
+    evaluators_->add_evaluator(distance_.get());
+    evaluators_->add_evaluator(pin_.get());
+  }
+
+  // Builds the two-mode problem, evaluating each mode with num_threads
+  std::unique_ptr<Dircon<double>> MakeDircon(int num_threads) {
+    modes_.push_back(
+        std::make_unique<DirconMode<double>>(*evaluators_, 5, 0.5, 1));
+    modes_.push_back(
+        std::make_unique<DirconMode<double>>(*evaluators_, 4, 0.5, 1));
+    // Dircon keeps a pointer to the sequence, so it is owned by the fixture
+    sequences_.push_back(
+        std::make_unique<DirconModeSequence<double>>(plant_));
+    for (int i = modes_.size() - 2; i < static_cast<int>(modes_.size()); i++) {
+      modes_.at(i)->set_num_threads(num_threads);
+      sequences_.back()->AddMode(modes_.at(i).get());
+    }
+    return std::make_unique<Dircon<double>>(*sequences_.back());
+  }
+
+  // Evaluates every generic constraint of `trajopt` at `x`, and stacks the
+  // values and their gradients w.r.t. all decision variables. Dircon adds the
+  // batch of a mode where the serial constraints would have been, and the
+  // batch stacks their rows in the same order, so the two stacks line up.
+  static void EvalGenericConstraints(const Dircon<double>& trajopt,
+                                     const VectorXd& x, VectorXd* y,
+                                     MatrixXd* dy) {
+    AutoDiffVecXd x_ad = drake::math::initializeAutoDiff(x);
+    int num_rows = 0;
+    for (const auto& binding : trajopt.generic_constraints()) {
+      num_rows += binding.evaluator()->num_constraints();
+    }
+    y->resize(num_rows);
+    dy->resize(num_rows, x.size());
+    int row = 0;
+    for (const auto& binding : trajopt.generic_constraints()) {
+      AutoDiffVecXd y_i = trajopt.EvalBinding(binding, x_ad);
+      y->segment(row, y_i.size()) = drake::math::autoDiffToValueMatrix(y_i);
+      dy->middleRows(row, y_i.size()) =
+          drake::math::autoDiffToGradientMatrix(y_i, x.size());
+      row += y_i.size();
+    }
+  }
+
+  MultibodyPlant<double> plant_{0.0};
+  std::unique_ptr<multibody::DistanceEvaluator<double>> distance_;
+  std::unique_ptr<multibody::WorldPointEvaluator<double>> pin_;
+  std::unique_ptr<multibody::KinematicEvaluatorSet<double>> evaluators_;
+  std::vector<std::unique_ptr<DirconMode<double>>> modes_;
+  std::vector<std::unique_ptr<DirconModeSequence<double>>> sequences_;
+};
+
+TEST_F(DirconParallelTest, SerialAndParallelConstraintsMatch) {
+  const double tolerance = 1e-10;
+
+  auto serial = MakeDircon(1);
+  auto parallel = MakeDircon(3);
+  ASSERT_EQ(serial->num_vars(), parallel->num_vars());
+  EXPECT_LT(parallel->generic_constraints().size(),
+            serial->generic_constraints().size());
+
+  std::srand(0);
+  for (int trial = 0; trial < 3; trial++) {
+    VectorXd x = VectorXd::Random(serial->num_vars());
+    for (int i = 0; i < serial->N() - 1; i++) {
+      x(serial->FindDecisionVariableIndex(serial->timestep(i)(0))) = 0.1;
+    }
+
+    VectorXd y_serial, y_parallel;
+    MatrixXd dy_serial, dy_parallel;
+    EvalGenericConstraints(*serial, x, &y_serial, &dy_serial);
+    EvalGenericConstraints(*parallel, x, &y_parallel, &dy_parallel);
+    ASSERT_EQ(y_serial.size(), y_parallel.size());
+    EXPECT_TRUE(CompareMatrices(y_serial, y_parallel, tolerance));
+    EXPECT_TRUE(CompareMatrices(dy_serial, dy_parallel, tolerance));
+
+    // The same values through the double evaluation path
+    VectorXd y_double(y_parallel.size());
+    int row = 0;
+    for (const auto& binding : parallel->generic_constraints()) {
+      VectorXd y_i = parallel->EvalBinding(binding, x);
+      y_double.segment(row, y_i.size()) = y_i;
+      row += y_i.size();
+    }
+    EXPECT_TRUE(CompareMatrices(y_serial, y_double, tolerance));
+  }
+}
+
+}  // namespace
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
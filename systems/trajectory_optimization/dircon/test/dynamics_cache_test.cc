@@ -0,0 +1,125 @@
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "common/find_resource.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "multibody/multibody_utils.h"
+#include "systems/trajectory_optimization/dircon/dynamics_cache.h"
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/math/autodiff.h"
+#include "drake/multibody/parsing/parser.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+namespace {
+
+using drake::AutoDiffVecXd;
+using drake::AutoDiffXd;
+using drake::CompareMatrices;
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+
+class DynamicsCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Parser parser(&plant_);
+    parser.AddModelFromFile(FindResourceOrThrow(
+        "systems/trajectory_optimization/dircon/test/acrobot_floating.urdf"));
+    plant_.Finalize();
+    pin_ = std::make_unique<multibody::WorldPointEvaluator<double>>(
+        plant_, Vector3d::Zero(), plant_.GetFrameByName("base_link"));
+    evaluators_ =
+        std::make_unique<multibody::KinematicEvaluatorSet<double>>(plant_);
+    evaluators_->add_evaluator(pin_.get());
+    context_ = plant_.CreateDefaultContext();
+  }
+
+  // Sets the context to a state determined by index, returning the forces
+  VectorXd SetState(int index) {
+    VectorXd x = VectorXd::Zero(plant_.num_positions() +
+                                plant_.num_velocities());
+    x(0) = 1;
+    x(plant_.num_positions()) = index;
+    VectorXd u = VectorXd::Zero(plant_.num_actuators());
+    multibody::setContext<double>(plant_, x, u, context_.get());
+    return VectorXd::Ones(evaluators_->count_full());
+  }
+
+  MultibodyPlant<double> plant_{0.0};
+  std::unique_ptr<multibody::WorldPointEvaluator<double>> pin_;
+  std::unique_ptr<multibody::KinematicEvaluatorSet<double>> evaluators_;
+  std::unique_ptr<drake::systems::Context<double>> context_;
+};
+
+TEST_F(DynamicsCacheTest, LeastRecentlyUsedEviction) {
+  DynamicsCache<double> cache(*evaluators_, 2);
+  EXPECT_EQ(cache.capacity(), 2);
+
+  VectorXd forces = SetState(0);
+  const VectorXd xdot_0 = cache.CalcTimeDerivativesWithForce(
+      context_.get(), forces);
+  EXPECT_TRUE(CompareMatrices(
+      xdot_0,
+      evaluators_->CalcTimeDerivativesWithForce(context_.get(), forces)));
+  forces = SetState(1);
+  cache.CalcTimeDerivativesWithForce(context_.get(), forces);
+
+  // Touch 0, so that 1 is evicted by 2
+  forces = SetState(0);
+  EXPECT_TRUE(CompareMatrices(
+      cache.CalcTimeDerivativesWithForce(context_.get(), forces), xdot_0));
+  forces = SetState(2);
+  cache.CalcTimeDerivativesWithForce(context_.get(), forces);
+  forces = SetState(0);
+  cache.CalcTimeDerivativesWithForce(context_.get(), forces);
+  forces = SetState(1);
+  cache.CalcTimeDerivativesWithForce(context_.get(), forces);
+
+  const auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 4);
+  EXPECT_EQ(stats.evictions, 2);
+  EXPECT_EQ(cache.size(), 2);
+
+  cache.ResetStats();
+  EXPECT_EQ(cache.GetStats().hits, 0);
+}
+
+TEST_F(DynamicsCacheTest, AutoDiffKeysCompareGradients) {
+  auto plant_ad = drake::systems::System<double>::ToAutoDiffXd(plant_);
+  multibody::WorldPointEvaluator<AutoDiffXd> pin(
+      *plant_ad, Vector3d::Zero(), plant_ad->GetFrameByName("base_link"));
+  multibody::KinematicEvaluatorSet<AutoDiffXd> evaluators(*plant_ad);
+  evaluators.add_evaluator(&pin);
+  auto context = plant_ad->CreateDefaultContext();
+  DynamicsCache<AutoDiffXd> cache(evaluators, 10);
+
+  const int n_x = plant_.num_positions() + plant_.num_velocities();
+  VectorXd x = VectorXd::Zero(n_x);
+  x(0) = 1;
+  const AutoDiffVecXd u =
+      VectorXd::Zero(plant_.num_actuators()).cast<AutoDiffXd>();
+  const AutoDiffVecXd forces =
+      VectorXd::Ones(evaluators.count_full()).cast<AutoDiffXd>();
+
+  // Same values, different gradients: both must miss
+  multibody::setContext<AutoDiffXd>(
+      *plant_ad, drake::math::initializeAutoDiff(x), u, context.get());
+  cache.CalcTimeDerivativesWithForce(context.get(), forces);
+  multibody::setContext<AutoDiffXd>(
+      *plant_ad, drake::math::initializeAutoDiff(x, 2 * n_x), u,
+      context.get());
+  cache.CalcTimeDerivativesWithForce(context.get(), forces);
+  EXPECT_EQ(cache.GetStats().misses, 2);
+
+  cache.CalcTimeDerivativesWithForce(context.get(), forces);
+  EXPECT_EQ(cache.GetStats().hits, 1);
+}
+
+}  // namespace
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib